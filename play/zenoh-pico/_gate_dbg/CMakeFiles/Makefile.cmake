@@ -0,0 +1,78 @@
+# CMAKE generated file: DO NOT EDIT!
+# Generated by "Unix Makefiles" Generator, CMake Version 3.25
+
+# The generator used is:
+set(CMAKE_DEPENDS_GENERATOR "Unix Makefiles")
+
+# The top level Makefile was generated from the following files:
+set(CMAKE_MAKEFILE_DEPENDS
+  "CMakeCache.txt"
+  "/root/repo/play/zenoh-pico/CMakeLists.txt"
+  "CMakeFiles/3.25.1/CMakeCCompiler.cmake"
+  "CMakeFiles/3.25.1/CMakeSystem.cmake"
+  "/root/repo/play/zenoh-pico/tests/routed.sh"
+  "/usr/share/cmake-3.25/Modules/CMakeCInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCommonLanguageInclude.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeGenericSystem.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeInitializeConfigs.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeLanguageInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeSystemSpecificInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeSystemSpecificInitialize.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckCSourceCompiles.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckIncludeFile.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckLibraryExists.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/CMakeCommonCompilerMacros.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU-C.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPackageHandleStandardArgs.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPackageMessage.cmake"
+  "/usr/share/cmake-3.25/Modules/FindThreads.cmake"
+  "/usr/share/cmake-3.25/Modules/Internal/CheckSourceCompiles.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU-C.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/UnixPaths.cmake"
+  )
+
+# The corresponding makefile is:
+set(CMAKE_MAKEFILE_OUTPUTS
+  "Makefile"
+  "CMakeFiles/cmake.check_cache"
+  )
+
+# Byproducts of CMake generate step:
+set(CMAKE_MAKEFILE_PRODUCTS
+  "tests/routed.sh"
+  "CMakeFiles/CMakeDirectoryInformation.cmake"
+  )
+
+# Dependency information for all targets:
+set(CMAKE_DEPEND_INFO_FILES
+  "CMakeFiles/zenohpico.dir/DependInfo.cmake"
+  "CMakeFiles/zn_write.dir/DependInfo.cmake"
+  "CMakeFiles/zn_pub.dir/DependInfo.cmake"
+  "CMakeFiles/zn_sub.dir/DependInfo.cmake"
+  "CMakeFiles/zn_pull.dir/DependInfo.cmake"
+  "CMakeFiles/zn_query.dir/DependInfo.cmake"
+  "CMakeFiles/zn_eval.dir/DependInfo.cmake"
+  "CMakeFiles/zn_info.dir/DependInfo.cmake"
+  "CMakeFiles/zn_pub_thr.dir/DependInfo.cmake"
+  "CMakeFiles/zn_sub_thr.dir/DependInfo.cmake"
+  "CMakeFiles/zn_scout.dir/DependInfo.cmake"
+  "CMakeFiles/z_iobuf_test.dir/DependInfo.cmake"
+  "CMakeFiles/z_data_struct_test.dir/DependInfo.cmake"
+  "CMakeFiles/z_mvar_test.dir/DependInfo.cmake"
+  "CMakeFiles/z_mpsc_test.dir/DependInfo.cmake"
+  "CMakeFiles/z_spsc_test.dir/DependInfo.cmake"
+  "CMakeFiles/z_timer_test.dir/DependInfo.cmake"
+  "CMakeFiles/zn_rname_test.dir/DependInfo.cmake"
+  "CMakeFiles/zn_client_test.dir/DependInfo.cmake"
+  "CMakeFiles/zn_msgcodec_test.dir/DependInfo.cmake"
+  "CMakeFiles/zn_reliability_test.dir/DependInfo.cmake"
+  "CMakeFiles/zn_batch_test.dir/DependInfo.cmake"
+  "CMakeFiles/zn_fragment_test.dir/DependInfo.cmake"
+  "CMakeFiles/zn_resource_test.dir/DependInfo.cmake"
+  "CMakeFiles/zn_dispatcher_test.dir/DependInfo.cmake"
+  "CMakeFiles/zn_loop_test.dir/DependInfo.cmake"
+  "CMakeFiles/zn_ping_test.dir/DependInfo.cmake"
+  )
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/z_spsc_test.dir/tests/z_spsc_test.c.o"
+  "CMakeFiles/z_spsc_test.dir/tests/z_spsc_test.c.o.d"
+  "tests/z_spsc_test"
+  "tests/z_spsc_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/z_spsc_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,60 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/play/zenoh-pico/src/collections/arena.c" "CMakeFiles/zenohpico.dir/src/collections/arena.c.o" "gcc" "CMakeFiles/zenohpico.dir/src/collections/arena.c.o.d"
+  "/root/repo/play/zenoh-pico/src/collections/bytes.c" "CMakeFiles/zenohpico.dir/src/collections/bytes.c.o" "gcc" "CMakeFiles/zenohpico.dir/src/collections/bytes.c.o.d"
+  "/root/repo/play/zenoh-pico/src/collections/idmap.c" "CMakeFiles/zenohpico.dir/src/collections/idmap.c.o" "gcc" "CMakeFiles/zenohpico.dir/src/collections/idmap.c.o.d"
+  "/root/repo/play/zenoh-pico/src/collections/intmap.c" "CMakeFiles/zenohpico.dir/src/collections/intmap.c.o" "gcc" "CMakeFiles/zenohpico.dir/src/collections/intmap.c.o.d"
+  "/root/repo/play/zenoh-pico/src/collections/list.c" "CMakeFiles/zenohpico.dir/src/collections/list.c.o" "gcc" "CMakeFiles/zenohpico.dir/src/collections/list.c.o.d"
+  "/root/repo/play/zenoh-pico/src/collections/mpsc.c" "CMakeFiles/zenohpico.dir/src/collections/mpsc.c.o" "gcc" "CMakeFiles/zenohpico.dir/src/collections/mpsc.c.o.d"
+  "/root/repo/play/zenoh-pico/src/collections/mvar.c" "CMakeFiles/zenohpico.dir/src/collections/mvar.c.o" "gcc" "CMakeFiles/zenohpico.dir/src/collections/mvar.c.o.d"
+  "/root/repo/play/zenoh-pico/src/collections/spsc.c" "CMakeFiles/zenohpico.dir/src/collections/spsc.c.o" "gcc" "CMakeFiles/zenohpico.dir/src/collections/spsc.c.o.d"
+  "/root/repo/play/zenoh-pico/src/collections/string.c" "CMakeFiles/zenohpico.dir/src/collections/string.c.o" "gcc" "CMakeFiles/zenohpico.dir/src/collections/string.c.o.d"
+  "/root/repo/play/zenoh-pico/src/collections/timer.c" "CMakeFiles/zenohpico.dir/src/collections/timer.c.o" "gcc" "CMakeFiles/zenohpico.dir/src/collections/timer.c.o.d"
+  "/root/repo/play/zenoh-pico/src/collections/vec.c" "CMakeFiles/zenohpico.dir/src/collections/vec.c.o" "gcc" "CMakeFiles/zenohpico.dir/src/collections/vec.c.o.d"
+  "/root/repo/play/zenoh-pico/src/system/common.c" "CMakeFiles/zenohpico.dir/src/system/common.c.o" "gcc" "CMakeFiles/zenohpico.dir/src/system/common.c.o.d"
+  "/root/repo/play/zenoh-pico/src/system/unix/network.c" "CMakeFiles/zenohpico.dir/src/system/unix/network.c.o" "gcc" "CMakeFiles/zenohpico.dir/src/system/unix/network.c.o.d"
+  "/root/repo/play/zenoh-pico/src/system/unix/system.c" "CMakeFiles/zenohpico.dir/src/system/unix/system.c.o" "gcc" "CMakeFiles/zenohpico.dir/src/system/unix/system.c.o.d"
+  "/root/repo/play/zenoh-pico/src/zenoh/api.c" "CMakeFiles/zenohpico.dir/src/zenoh/api.c.o" "gcc" "CMakeFiles/zenohpico.dir/src/zenoh/api.c.o.d"
+  "/root/repo/play/zenoh-pico/src/zenoh/link/manager.c" "CMakeFiles/zenohpico.dir/src/zenoh/link/manager.c.o" "gcc" "CMakeFiles/zenohpico.dir/src/zenoh/link/manager.c.o.d"
+  "/root/repo/play/zenoh-pico/src/zenoh/link/tcp.c" "CMakeFiles/zenohpico.dir/src/zenoh/link/tcp.c.o" "gcc" "CMakeFiles/zenohpico.dir/src/zenoh/link/tcp.c.o.d"
+  "/root/repo/play/zenoh-pico/src/zenoh/link/udp.c" "CMakeFiles/zenohpico.dir/src/zenoh/link/udp.c.o" "gcc" "CMakeFiles/zenohpico.dir/src/zenoh/link/udp.c.o.d"
+  "/root/repo/play/zenoh-pico/src/zenoh/protocol/codec.c" "CMakeFiles/zenohpico.dir/src/zenoh/protocol/codec.c.o" "gcc" "CMakeFiles/zenohpico.dir/src/zenoh/protocol/codec.c.o.d"
+  "/root/repo/play/zenoh-pico/src/zenoh/protocol/iobuf.c" "CMakeFiles/zenohpico.dir/src/zenoh/protocol/iobuf.c.o" "gcc" "CMakeFiles/zenohpico.dir/src/zenoh/protocol/iobuf.c.o.d"
+  "/root/repo/play/zenoh-pico/src/zenoh/protocol/msgcodec.c" "CMakeFiles/zenohpico.dir/src/zenoh/protocol/msgcodec.c.o" "gcc" "CMakeFiles/zenohpico.dir/src/zenoh/protocol/msgcodec.c.o.d"
+  "/root/repo/play/zenoh-pico/src/zenoh/protocol/property.c" "CMakeFiles/zenohpico.dir/src/zenoh/protocol/property.c.o" "gcc" "CMakeFiles/zenohpico.dir/src/zenoh/protocol/property.c.o.d"
+  "/root/repo/play/zenoh-pico/src/zenoh/protocol/rname.c" "CMakeFiles/zenohpico.dir/src/zenoh/protocol/rname.c.o" "gcc" "CMakeFiles/zenohpico.dir/src/zenoh/protocol/rname.c.o.d"
+  "/root/repo/play/zenoh-pico/src/zenoh/protocol/utils.c" "CMakeFiles/zenohpico.dir/src/zenoh/protocol/utils.c.o" "gcc" "CMakeFiles/zenohpico.dir/src/zenoh/protocol/utils.c.o.d"
+  "/root/repo/play/zenoh-pico/src/zenoh/session/dispatcher.c" "CMakeFiles/zenohpico.dir/src/zenoh/session/dispatcher.c.o" "gcc" "CMakeFiles/zenohpico.dir/src/zenoh/session/dispatcher.c.o.d"
+  "/root/repo/play/zenoh-pico/src/zenoh/session/query.c" "CMakeFiles/zenohpico.dir/src/zenoh/session/query.c.o" "gcc" "CMakeFiles/zenohpico.dir/src/zenoh/session/query.c.o.d"
+  "/root/repo/play/zenoh-pico/src/zenoh/session/queryable.c" "CMakeFiles/zenohpico.dir/src/zenoh/session/queryable.c.o" "gcc" "CMakeFiles/zenohpico.dir/src/zenoh/session/queryable.c.o.d"
+  "/root/repo/play/zenoh-pico/src/zenoh/session/resource.c" "CMakeFiles/zenohpico.dir/src/zenoh/session/resource.c.o" "gcc" "CMakeFiles/zenohpico.dir/src/zenoh/session/resource.c.o.d"
+  "/root/repo/play/zenoh-pico/src/zenoh/session/rx.c" "CMakeFiles/zenohpico.dir/src/zenoh/session/rx.c.o" "gcc" "CMakeFiles/zenohpico.dir/src/zenoh/session/rx.c.o.d"
+  "/root/repo/play/zenoh-pico/src/zenoh/session/scout.c" "CMakeFiles/zenohpico.dir/src/zenoh/session/scout.c.o" "gcc" "CMakeFiles/zenohpico.dir/src/zenoh/session/scout.c.o.d"
+  "/root/repo/play/zenoh-pico/src/zenoh/session/subscription.c" "CMakeFiles/zenohpico.dir/src/zenoh/session/subscription.c.o" "gcc" "CMakeFiles/zenohpico.dir/src/zenoh/session/subscription.c.o.d"
+  "/root/repo/play/zenoh-pico/src/zenoh/session/tx.c" "CMakeFiles/zenohpico.dir/src/zenoh/session/tx.c.o" "gcc" "CMakeFiles/zenohpico.dir/src/zenoh/session/tx.c.o.d"
+  "/root/repo/play/zenoh-pico/src/zenoh/session/utils.c" "CMakeFiles/zenohpico.dir/src/zenoh/session/utils.c.o" "gcc" "CMakeFiles/zenohpico.dir/src/zenoh/session/utils.c.o.d"
+  "/root/repo/play/zenoh-pico/src/zenoh/transport/link/rx.c" "CMakeFiles/zenohpico.dir/src/zenoh/transport/link/rx.c.o" "gcc" "CMakeFiles/zenohpico.dir/src/zenoh/transport/link/rx.c.o.d"
+  "/root/repo/play/zenoh-pico/src/zenoh/transport/link/task/lease.c" "CMakeFiles/zenohpico.dir/src/zenoh/transport/link/task/lease.c.o" "gcc" "CMakeFiles/zenohpico.dir/src/zenoh/transport/link/task/lease.c.o.d"
+  "/root/repo/play/zenoh-pico/src/zenoh/transport/link/task/loop.c" "CMakeFiles/zenohpico.dir/src/zenoh/transport/link/task/loop.c.o" "gcc" "CMakeFiles/zenohpico.dir/src/zenoh/transport/link/task/loop.c.o.d"
+  "/root/repo/play/zenoh-pico/src/zenoh/transport/link/task/read.c" "CMakeFiles/zenohpico.dir/src/zenoh/transport/link/task/read.c.o" "gcc" "CMakeFiles/zenohpico.dir/src/zenoh/transport/link/task/read.c.o.d"
+  "/root/repo/play/zenoh-pico/src/zenoh/transport/link/task/tx.c" "CMakeFiles/zenohpico.dir/src/zenoh/transport/link/task/tx.c.o" "gcc" "CMakeFiles/zenohpico.dir/src/zenoh/transport/link/task/tx.c.o.d"
+  "/root/repo/play/zenoh-pico/src/zenoh/transport/link/tx.c" "CMakeFiles/zenohpico.dir/src/zenoh/transport/link/tx.c.o" "gcc" "CMakeFiles/zenohpico.dir/src/zenoh/transport/link/tx.c.o.d"
+  "/root/repo/play/zenoh-pico/src/zenoh/transport/ping.c" "CMakeFiles/zenohpico.dir/src/zenoh/transport/ping.c.o" "gcc" "CMakeFiles/zenohpico.dir/src/zenoh/transport/ping.c.o.d"
+  "/root/repo/play/zenoh-pico/src/zenoh/transport/reliability.c" "CMakeFiles/zenohpico.dir/src/zenoh/transport/reliability.c.o" "gcc" "CMakeFiles/zenohpico.dir/src/zenoh/transport/reliability.c.o.d"
+  "/root/repo/play/zenoh-pico/src/zenoh/transport/rx.c" "CMakeFiles/zenohpico.dir/src/zenoh/transport/rx.c.o" "gcc" "CMakeFiles/zenohpico.dir/src/zenoh/transport/rx.c.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,93 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/zenohpico.dir/src/collections/arena.c.o"
+  "CMakeFiles/zenohpico.dir/src/collections/arena.c.o.d"
+  "CMakeFiles/zenohpico.dir/src/collections/bytes.c.o"
+  "CMakeFiles/zenohpico.dir/src/collections/bytes.c.o.d"
+  "CMakeFiles/zenohpico.dir/src/collections/idmap.c.o"
+  "CMakeFiles/zenohpico.dir/src/collections/idmap.c.o.d"
+  "CMakeFiles/zenohpico.dir/src/collections/intmap.c.o"
+  "CMakeFiles/zenohpico.dir/src/collections/intmap.c.o.d"
+  "CMakeFiles/zenohpico.dir/src/collections/list.c.o"
+  "CMakeFiles/zenohpico.dir/src/collections/list.c.o.d"
+  "CMakeFiles/zenohpico.dir/src/collections/mpsc.c.o"
+  "CMakeFiles/zenohpico.dir/src/collections/mpsc.c.o.d"
+  "CMakeFiles/zenohpico.dir/src/collections/mvar.c.o"
+  "CMakeFiles/zenohpico.dir/src/collections/mvar.c.o.d"
+  "CMakeFiles/zenohpico.dir/src/collections/spsc.c.o"
+  "CMakeFiles/zenohpico.dir/src/collections/spsc.c.o.d"
+  "CMakeFiles/zenohpico.dir/src/collections/string.c.o"
+  "CMakeFiles/zenohpico.dir/src/collections/string.c.o.d"
+  "CMakeFiles/zenohpico.dir/src/collections/timer.c.o"
+  "CMakeFiles/zenohpico.dir/src/collections/timer.c.o.d"
+  "CMakeFiles/zenohpico.dir/src/collections/vec.c.o"
+  "CMakeFiles/zenohpico.dir/src/collections/vec.c.o.d"
+  "CMakeFiles/zenohpico.dir/src/system/common.c.o"
+  "CMakeFiles/zenohpico.dir/src/system/common.c.o.d"
+  "CMakeFiles/zenohpico.dir/src/system/unix/network.c.o"
+  "CMakeFiles/zenohpico.dir/src/system/unix/network.c.o.d"
+  "CMakeFiles/zenohpico.dir/src/system/unix/system.c.o"
+  "CMakeFiles/zenohpico.dir/src/system/unix/system.c.o.d"
+  "CMakeFiles/zenohpico.dir/src/zenoh/api.c.o"
+  "CMakeFiles/zenohpico.dir/src/zenoh/api.c.o.d"
+  "CMakeFiles/zenohpico.dir/src/zenoh/link/manager.c.o"
+  "CMakeFiles/zenohpico.dir/src/zenoh/link/manager.c.o.d"
+  "CMakeFiles/zenohpico.dir/src/zenoh/link/tcp.c.o"
+  "CMakeFiles/zenohpico.dir/src/zenoh/link/tcp.c.o.d"
+  "CMakeFiles/zenohpico.dir/src/zenoh/link/udp.c.o"
+  "CMakeFiles/zenohpico.dir/src/zenoh/link/udp.c.o.d"
+  "CMakeFiles/zenohpico.dir/src/zenoh/protocol/codec.c.o"
+  "CMakeFiles/zenohpico.dir/src/zenoh/protocol/codec.c.o.d"
+  "CMakeFiles/zenohpico.dir/src/zenoh/protocol/iobuf.c.o"
+  "CMakeFiles/zenohpico.dir/src/zenoh/protocol/iobuf.c.o.d"
+  "CMakeFiles/zenohpico.dir/src/zenoh/protocol/msgcodec.c.o"
+  "CMakeFiles/zenohpico.dir/src/zenoh/protocol/msgcodec.c.o.d"
+  "CMakeFiles/zenohpico.dir/src/zenoh/protocol/property.c.o"
+  "CMakeFiles/zenohpico.dir/src/zenoh/protocol/property.c.o.d"
+  "CMakeFiles/zenohpico.dir/src/zenoh/protocol/rname.c.o"
+  "CMakeFiles/zenohpico.dir/src/zenoh/protocol/rname.c.o.d"
+  "CMakeFiles/zenohpico.dir/src/zenoh/protocol/utils.c.o"
+  "CMakeFiles/zenohpico.dir/src/zenoh/protocol/utils.c.o.d"
+  "CMakeFiles/zenohpico.dir/src/zenoh/session/dispatcher.c.o"
+  "CMakeFiles/zenohpico.dir/src/zenoh/session/dispatcher.c.o.d"
+  "CMakeFiles/zenohpico.dir/src/zenoh/session/query.c.o"
+  "CMakeFiles/zenohpico.dir/src/zenoh/session/query.c.o.d"
+  "CMakeFiles/zenohpico.dir/src/zenoh/session/queryable.c.o"
+  "CMakeFiles/zenohpico.dir/src/zenoh/session/queryable.c.o.d"
+  "CMakeFiles/zenohpico.dir/src/zenoh/session/resource.c.o"
+  "CMakeFiles/zenohpico.dir/src/zenoh/session/resource.c.o.d"
+  "CMakeFiles/zenohpico.dir/src/zenoh/session/rx.c.o"
+  "CMakeFiles/zenohpico.dir/src/zenoh/session/rx.c.o.d"
+  "CMakeFiles/zenohpico.dir/src/zenoh/session/scout.c.o"
+  "CMakeFiles/zenohpico.dir/src/zenoh/session/scout.c.o.d"
+  "CMakeFiles/zenohpico.dir/src/zenoh/session/subscription.c.o"
+  "CMakeFiles/zenohpico.dir/src/zenoh/session/subscription.c.o.d"
+  "CMakeFiles/zenohpico.dir/src/zenoh/session/tx.c.o"
+  "CMakeFiles/zenohpico.dir/src/zenoh/session/tx.c.o.d"
+  "CMakeFiles/zenohpico.dir/src/zenoh/session/utils.c.o"
+  "CMakeFiles/zenohpico.dir/src/zenoh/session/utils.c.o.d"
+  "CMakeFiles/zenohpico.dir/src/zenoh/transport/link/rx.c.o"
+  "CMakeFiles/zenohpico.dir/src/zenoh/transport/link/rx.c.o.d"
+  "CMakeFiles/zenohpico.dir/src/zenoh/transport/link/task/lease.c.o"
+  "CMakeFiles/zenohpico.dir/src/zenoh/transport/link/task/lease.c.o.d"
+  "CMakeFiles/zenohpico.dir/src/zenoh/transport/link/task/loop.c.o"
+  "CMakeFiles/zenohpico.dir/src/zenoh/transport/link/task/loop.c.o.d"
+  "CMakeFiles/zenohpico.dir/src/zenoh/transport/link/task/read.c.o"
+  "CMakeFiles/zenohpico.dir/src/zenoh/transport/link/task/read.c.o.d"
+  "CMakeFiles/zenohpico.dir/src/zenoh/transport/link/task/tx.c.o"
+  "CMakeFiles/zenohpico.dir/src/zenoh/transport/link/task/tx.c.o.d"
+  "CMakeFiles/zenohpico.dir/src/zenoh/transport/link/tx.c.o"
+  "CMakeFiles/zenohpico.dir/src/zenoh/transport/link/tx.c.o.d"
+  "CMakeFiles/zenohpico.dir/src/zenoh/transport/ping.c.o"
+  "CMakeFiles/zenohpico.dir/src/zenoh/transport/ping.c.o.d"
+  "CMakeFiles/zenohpico.dir/src/zenoh/transport/reliability.c.o"
+  "CMakeFiles/zenohpico.dir/src/zenoh/transport/reliability.c.o.d"
+  "CMakeFiles/zenohpico.dir/src/zenoh/transport/rx.c.o"
+  "CMakeFiles/zenohpico.dir/src/zenoh/transport/rx.c.o.d"
+  "lib/libzenohpico.pdb"
+  "lib/libzenohpico.so"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/zenohpico.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
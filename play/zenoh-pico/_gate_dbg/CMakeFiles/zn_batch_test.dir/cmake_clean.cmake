@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/zn_batch_test.dir/tests/zn_batch_test.c.o"
+  "CMakeFiles/zn_batch_test.dir/tests/zn_batch_test.c.o.d"
+  "tests/zn_batch_test"
+  "tests/zn_batch_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/zn_batch_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
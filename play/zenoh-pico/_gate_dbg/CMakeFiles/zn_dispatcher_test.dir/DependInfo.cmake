@@ -0,0 +1,21 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/play/zenoh-pico/tests/zn_dispatcher_test.c" "CMakeFiles/zn_dispatcher_test.dir/tests/zn_dispatcher_test.c.o" "gcc" "CMakeFiles/zn_dispatcher_test.dir/tests/zn_dispatcher_test.c.o.d"
+  "/root/repo/play/zenoh-pico/tests/zn_test_session.c" "CMakeFiles/zn_dispatcher_test.dir/tests/zn_test_session.c.o" "gcc" "CMakeFiles/zn_dispatcher_test.dir/tests/zn_test_session.c.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/play/zenoh-pico/_gate_dbg/CMakeFiles/zenohpico.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
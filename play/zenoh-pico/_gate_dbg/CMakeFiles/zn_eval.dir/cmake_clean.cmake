@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/zn_eval.dir/examples/net/zn_eval.c.o"
+  "CMakeFiles/zn_eval.dir/examples/net/zn_eval.c.o.d"
+  "examples/zn_eval"
+  "examples/zn_eval.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/zn_eval.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/zn_info.dir/examples/net/zn_info.c.o"
+  "CMakeFiles/zn_info.dir/examples/net/zn_info.c.o.d"
+  "examples/zn_info"
+  "examples/zn_info.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/zn_info.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
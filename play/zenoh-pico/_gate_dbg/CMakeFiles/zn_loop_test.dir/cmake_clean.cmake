@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/zn_loop_test.dir/tests/zn_loop_test.c.o"
+  "CMakeFiles/zn_loop_test.dir/tests/zn_loop_test.c.o.d"
+  "CMakeFiles/zn_loop_test.dir/tests/zn_test_session.c.o"
+  "CMakeFiles/zn_loop_test.dir/tests/zn_test_session.c.o.d"
+  "tests/zn_loop_test"
+  "tests/zn_loop_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/zn_loop_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/zn_msgcodec_test.dir/tests/zn_msgcodec_test.c.o"
+  "CMakeFiles/zn_msgcodec_test.dir/tests/zn_msgcodec_test.c.o.d"
+  "tests/zn_msgcodec_test"
+  "tests/zn_msgcodec_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/zn_msgcodec_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/zn_pub.dir/examples/net/zn_pub.c.o"
+  "CMakeFiles/zn_pub.dir/examples/net/zn_pub.c.o.d"
+  "examples/zn_pub"
+  "examples/zn_pub.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/zn_pub.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/zn_pub_thr.dir/examples/net/zn_pub_thr.c.o"
+  "CMakeFiles/zn_pub_thr.dir/examples/net/zn_pub_thr.c.o.d"
+  "examples/zn_pub_thr"
+  "examples/zn_pub_thr.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/zn_pub_thr.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/zn_pull.dir/examples/net/zn_pull.c.o"
+  "CMakeFiles/zn_pull.dir/examples/net/zn_pull.c.o.d"
+  "examples/zn_pull"
+  "examples/zn_pull.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/zn_pull.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
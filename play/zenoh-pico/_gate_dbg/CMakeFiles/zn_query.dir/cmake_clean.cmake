@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/zn_query.dir/examples/net/zn_query.c.o"
+  "CMakeFiles/zn_query.dir/examples/net/zn_query.c.o.d"
+  "examples/zn_query"
+  "examples/zn_query.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/zn_query.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
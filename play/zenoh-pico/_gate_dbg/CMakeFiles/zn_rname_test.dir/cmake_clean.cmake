@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/zn_rname_test.dir/tests/zn_rname_test.c.o"
+  "CMakeFiles/zn_rname_test.dir/tests/zn_rname_test.c.o.d"
+  "tests/zn_rname_test"
+  "tests/zn_rname_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/zn_rname_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/zn_scout.dir/examples/net/zn_scout.c.o"
+  "CMakeFiles/zn_scout.dir/examples/net/zn_scout.c.o.d"
+  "examples/zn_scout"
+  "examples/zn_scout.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/zn_scout.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
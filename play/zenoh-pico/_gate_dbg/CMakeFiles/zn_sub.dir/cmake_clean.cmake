@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/zn_sub.dir/examples/net/zn_sub.c.o"
+  "CMakeFiles/zn_sub.dir/examples/net/zn_sub.c.o.d"
+  "examples/zn_sub"
+  "examples/zn_sub.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/zn_sub.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
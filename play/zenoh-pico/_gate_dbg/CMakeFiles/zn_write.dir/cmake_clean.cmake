@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/zn_write.dir/examples/net/zn_write.c.o"
+  "CMakeFiles/zn_write.dir/examples/net/zn_write.c.o.d"
+  "examples/zn_write"
+  "examples/zn_write.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/zn_write.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
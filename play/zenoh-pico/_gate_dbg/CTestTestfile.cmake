@@ -0,0 +1,36 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo/play/zenoh-pico
+# Build directory: /root/repo/play/zenoh-pico/_gate_dbg
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+add_test(zn_client_test "bash" "/root/repo/play/zenoh-pico/_gate_dbg/tests/routed.sh" "zn_client_test")
+set_tests_properties(zn_client_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/play/zenoh-pico/CMakeLists.txt;214;add_test;/root/repo/play/zenoh-pico/CMakeLists.txt;0;")
+add_test(z_iobuf_test "/root/repo/play/zenoh-pico/_gate_dbg/tests/z_iobuf_test")
+set_tests_properties(z_iobuf_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/play/zenoh-pico/CMakeLists.txt;215;add_test;/root/repo/play/zenoh-pico/CMakeLists.txt;0;")
+add_test(z_data_struct_test "/root/repo/play/zenoh-pico/_gate_dbg/tests/z_data_struct_test")
+set_tests_properties(z_data_struct_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/play/zenoh-pico/CMakeLists.txt;216;add_test;/root/repo/play/zenoh-pico/CMakeLists.txt;0;")
+add_test(z_mpsc_test "/root/repo/play/zenoh-pico/_gate_dbg/tests/z_mpsc_test")
+set_tests_properties(z_mpsc_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/play/zenoh-pico/CMakeLists.txt;217;add_test;/root/repo/play/zenoh-pico/CMakeLists.txt;0;")
+add_test(z_spsc_test "/root/repo/play/zenoh-pico/_gate_dbg/tests/z_spsc_test")
+set_tests_properties(z_spsc_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/play/zenoh-pico/CMakeLists.txt;218;add_test;/root/repo/play/zenoh-pico/CMakeLists.txt;0;")
+add_test(z_timer_test "/root/repo/play/zenoh-pico/_gate_dbg/tests/z_timer_test")
+set_tests_properties(z_timer_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/play/zenoh-pico/CMakeLists.txt;219;add_test;/root/repo/play/zenoh-pico/CMakeLists.txt;0;")
+add_test(zn_rname_test "/root/repo/play/zenoh-pico/_gate_dbg/tests/zn_rname_test")
+set_tests_properties(zn_rname_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/play/zenoh-pico/CMakeLists.txt;220;add_test;/root/repo/play/zenoh-pico/CMakeLists.txt;0;")
+add_test(zn_msgcodec_test "/root/repo/play/zenoh-pico/_gate_dbg/tests/zn_msgcodec_test")
+set_tests_properties(zn_msgcodec_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/play/zenoh-pico/CMakeLists.txt;221;add_test;/root/repo/play/zenoh-pico/CMakeLists.txt;0;")
+add_test(zn_reliability_test "/root/repo/play/zenoh-pico/_gate_dbg/tests/zn_reliability_test")
+set_tests_properties(zn_reliability_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/play/zenoh-pico/CMakeLists.txt;222;add_test;/root/repo/play/zenoh-pico/CMakeLists.txt;0;")
+add_test(zn_batch_test "/root/repo/play/zenoh-pico/_gate_dbg/tests/zn_batch_test")
+set_tests_properties(zn_batch_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/play/zenoh-pico/CMakeLists.txt;223;add_test;/root/repo/play/zenoh-pico/CMakeLists.txt;0;")
+add_test(zn_fragment_test "/root/repo/play/zenoh-pico/_gate_dbg/tests/zn_fragment_test")
+set_tests_properties(zn_fragment_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/play/zenoh-pico/CMakeLists.txt;224;add_test;/root/repo/play/zenoh-pico/CMakeLists.txt;0;")
+add_test(zn_resource_test "/root/repo/play/zenoh-pico/_gate_dbg/tests/zn_resource_test")
+set_tests_properties(zn_resource_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/play/zenoh-pico/CMakeLists.txt;225;add_test;/root/repo/play/zenoh-pico/CMakeLists.txt;0;")
+add_test(zn_dispatcher_test "/root/repo/play/zenoh-pico/_gate_dbg/tests/zn_dispatcher_test")
+set_tests_properties(zn_dispatcher_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/play/zenoh-pico/CMakeLists.txt;226;add_test;/root/repo/play/zenoh-pico/CMakeLists.txt;0;")
+add_test(zn_loop_test "/root/repo/play/zenoh-pico/_gate_dbg/tests/zn_loop_test")
+set_tests_properties(zn_loop_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/play/zenoh-pico/CMakeLists.txt;227;add_test;/root/repo/play/zenoh-pico/CMakeLists.txt;0;")
+add_test(zn_ping_test "/root/repo/play/zenoh-pico/_gate_dbg/tests/zn_ping_test")
+set_tests_properties(zn_ping_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/play/zenoh-pico/CMakeLists.txt;228;add_test;/root/repo/play/zenoh-pico/CMakeLists.txt;0;")
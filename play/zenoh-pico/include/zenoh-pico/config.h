@@ -98,6 +98,41 @@ extern "C" {
 #define ZN_CONFIG_ADD_TIMESTAMP_KEY 0x4A
 #define ZN_CONFIG_ADD_TIMESTAMP_DEFAULT "false"
 
+/**
+ * Activates/Desactivates the automatic batching of zenoh messages on transmission.
+ * When active, consecutive messages with the same reliability are appended to the
+ * same frame, which is sent when full, when the linger time expires or when
+ * :c:func:`zn_flush` is called.
+ * String key : `"batching"`.
+ * Accepted values : `"true"`, `"false"`.
+ * Default value : `"false"`.
+ */
+#define ZN_CONFIG_BATCHING_KEY 0x70
+#define ZN_CONFIG_BATCHING_DEFAULT "false"
+
+/**
+ * The maximum time a batched message may wait before its frame is sent.
+ * A value of `0` means that a batch is sent only when full or explicitly flushed.
+ * String key : `"batching_linger"`.
+ * Accepted values : `<int in milliseconds>`.
+ * Default value : `"1"`.
+ */
+#define ZN_CONFIG_BATCHING_LINGER_KEY 0x71
+#define ZN_CONFIG_BATCHING_LINGER_DEFAULT "1"
+
+/**
+ * Activates/Desactivates the reliability of the reliable channel on datagram links (e.g., UDP).
+ * When active, reliable frames are kept until the peer acknowledges them with an ACK_NACK
+ * message, solicited by periodic SYNC messages, and the missing ones are selectively
+ * retransmitted. Reliable frames received out of order are buffered and delivered in order.
+ * It has no effect on stream links (e.g., TCP), which are already reliable.
+ * String key : `"datagram_reliability"`.
+ * Accepted values : `"true"`, `"false"`.
+ * Default value : `"false"`.
+ */
+#define ZN_CONFIG_DATAGRAM_RELIABILITY_KEY 0x72
+#define ZN_CONFIG_DATAGRAM_RELIABILITY_DEFAULT "false"
+
 /*------------------ Configuration properties ------------------*/
 #define ZN_ATTACHMENT_BUF_LEN 16384
 #define ZN_PID_LENGTH 8
@@ -119,9 +154,75 @@ extern "C" {
 
 #define ZN_CONGESTION_CONTROL_DEFAULT zn_congestion_control_t_DROP
 
+#define ZN_PRIORITY_DEFAULT zn_priority_t_DATA
+
 #define ZN_TRANSPORT_TCP_IP 1
 //#define ZN_TRANSPORT_BLE 1
 
+/**
+ * Number of encoded zenoh messages the transmission queue of each priority
+ * can hold when the transmit task is running. Rounded up to the next power of two.
+ */
+#define ZN_TX_QUEUE_SIZE 64
+
+/**
+ * Number of reliable frames waiting for an acknowledgement, and of reliable frames
+ * received ahead of a missing one, that are kept on datagram links when the
+ * datagram reliability is active. It must not exceed the number of bits of a z_zint_t.
+ */
+#define ZN_RELIABILITY_WINDOW 32
+
+/**
+ * Interval in milliseconds between two SYNC messages while reliable frames are
+ * waiting for an acknowledgement.
+ */
+#define ZN_RELIABILITY_SYNC_INTERVAL 50
+
+/**
+ * Interval in milliseconds after which the timer task tries again to send a message
+ * the link of the session was too busy to take.
+ */
+#define ZN_TIMER_RETRY_INTERVAL 10
+
+/**
+ * Number of the most recent round trip times measured with zn_ping that the
+ * minimum, average and 99th percentile published in the statistics are computed over.
+ */
+#define ZN_RTT_WINDOW 64
+
+/**
+ * Maximum number of datagrams sent or received with a single system call on the
+ * datagram links supporting it (sendmmsg/recvmmsg). Each received datagram needs its
+ * own ZN_READ_BUF_LEN buffer, set it to 1 to read and write one datagram at a time.
+ */
+#if defined(ZENOH_LINUX)
+#define ZN_MMSG_LEN 8
+#else
+#define ZN_MMSG_LEN 1
+#endif
+
+/**
+ * Number of ZN_READ_BUF_LEN buffers of the read pipeline. When not zero, the read task
+ * is split in two stages: a task only reading the batches from the link into these
+ * buffers and the read task decoding and handling them. The batches of stream links are
+ * then copied out of the ring buffer. Set it to 0 to read, decode and handle the batches
+ * in a single task.
+ */
+#define ZN_RX_PIPELINE_SIZE 0
+
+/**
+ * Number of samples the queue of each worker of the dispatcher can hold, see
+ * znp_start_dispatcher.
+ */
+#define ZN_DISPATCH_QUEUE_SIZE 64
+
+/**
+ * Size in bytes of the arena serving the values decoded from a received batch (strings,
+ * declarations, decorators), released all at once before reading the next batch.
+ * The values not fitting in it are allocated on the heap until then.
+ */
+#define ZN_RX_ARENA_SIZE 4096
+
 #define ZN_FRAG_BUF_TX_CHUNK 128
 #define ZN_FRAG_BUF_RX_LIMIT 10000000
 
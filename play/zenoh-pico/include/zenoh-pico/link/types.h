@@ -23,6 +23,7 @@ extern "C" {
 
 #include "../system/types.h"
 #include "../system/result.h"
+#include "../utils/types.h"
 
 #define TCP_SCHEMA "tcp"
 #define UDP_SCHEMA "udp"
@@ -32,8 +33,11 @@ typedef int (*_zn_f_link_close)(void *arg);
 typedef void (*_zn_f_link_release)(void *arg);
 typedef size_t (*_zn_f_link_write)(void *arg, const uint8_t *ptr, size_t len);
 typedef size_t (*_zn_f_link_write_all)(void *arg, const uint8_t *ptr, size_t len);
+typedef size_t (*_zn_f_link_write_vec)(void *arg, const z_bytes_t *iov, size_t iovcnt);
 typedef size_t (*_zn_f_link_read)(void *arg, uint8_t *ptr, size_t len);
 typedef size_t (*_zn_f_link_read_exact)(void *arg, uint8_t *ptr, size_t len);
+typedef size_t (*_zn_f_link_write_batch)(void *arg, const z_bytes_t *iov, const size_t *iovcnts, size_t count);
+typedef size_t (*_zn_f_link_read_batch)(void *arg, z_bytes_t *bufs, size_t count);
 
 typedef struct {
     _zn_socket_t sock;
@@ -50,8 +54,12 @@ typedef struct {
     _zn_f_link_release release_f;
     _zn_f_link_write write_f;
     _zn_f_link_write_all write_all_f;
+    _zn_f_link_write_vec write_vec_f;
     _zn_f_link_read read_f;
     _zn_f_link_read_exact read_exact_f;
+    // Optional, only datagram links moving many datagrams per system call provide them
+    _zn_f_link_write_batch write_batch_f;
+    _zn_f_link_read_batch read_batch_f;
 } _zn_link_t;
 
 #endif /* _ZENOH_PICO_TRANSPORT_PRIVATE_LINK_H */
@@ -35,6 +35,8 @@ int _z_uint8_encode(_z_wbuf_t *buf, uint8_t v);
 _z_uint8_result_t _z_uint8_decode(_z_zbuf_t *buf);
 
 _Z_RESULT_DECLARE(z_zint_t, zint)
+// The maximum number of bytes of an encoded z_zint_t, 7 bits per byte
+#define _Z_ZINT_MAX_LEN ((sizeof(z_zint_t) * 8 + 6) / 7)
 int _z_zint_encode(_z_wbuf_t *buf, z_zint_t v);
 _z_zint_result_t _z_zint_decode(_z_zbuf_t *buf);
 
@@ -47,6 +49,9 @@ _Z_RESULT_DECLARE(z_str_t, str)
 int _z_str_encode(_z_wbuf_t *buf, const z_str_t s);
 _z_str_result_t _z_str_decode(_z_zbuf_t *buf);
 
+_Z_RESULT_DECLARE(z_string_t, string)
+_z_string_result_t _z_string_decode(_z_zbuf_t *buf);
+
 /*------------------ Internal Zenoh-net Encoding/Decoding ------------------*/
 _ZN_RESULT_DECLARE(zn_property_t, property)
 int _zn_property_encode(_z_wbuf_t *wbf, const zn_property_t *m);
@@ -68,6 +68,27 @@ void _z_zbuf_clear(_z_zbuf_t *zbf);
 void _z_zbuf_compact(_z_zbuf_t *zbf);
 void _z_zbuf_free(_z_zbuf_t *zbf);
 
+void *_z_zbuf_alloc(_z_zbuf_t *zbf, size_t size);
+int _z_zbuf_append_bytes(_z_zbuf_t *zbf, const uint8_t *bs, size_t length, size_t limit);
+
+/*------------------ RBuf ------------------*/
+_z_rbuf_t _z_rbuf_make(size_t capacity);
+
+size_t _z_rbuf_capacity(const _z_rbuf_t *rbf);
+size_t _z_rbuf_len(const _z_rbuf_t *rbf);
+size_t _z_rbuf_space_left(const _z_rbuf_t *rbf);
+
+uint8_t _z_rbuf_read(_z_rbuf_t *rbf);
+uint8_t _z_rbuf_get(const _z_rbuf_t *rbf, size_t pos);
+uint8_t *_z_rbuf_get_wptr(const _z_rbuf_t *rbf);
+void _z_rbuf_produce(_z_rbuf_t *rbf, size_t len);
+void _z_rbuf_consume(_z_rbuf_t *rbf, size_t len);
+
+int _z_rbuf_reserve(_z_rbuf_t *rbf, size_t len);
+_z_zbuf_t _z_rbuf_view(const _z_rbuf_t *rbf, size_t len);
+
+void _z_rbuf_free(_z_rbuf_t *rbf);
+
 /*------------------ WBuf ------------------*/
 _z_wbuf_t _z_wbuf_make(size_t capacity, int is_expandable);
 
@@ -78,6 +99,8 @@ size_t _z_wbuf_space_left(const _z_wbuf_t *wbf);
 int _z_wbuf_write(_z_wbuf_t *wbf, uint8_t b);
 int _z_wbuf_write_bytes(_z_wbuf_t *wbf, const uint8_t *bs, size_t offset, size_t length);
 void _z_wbuf_put(_z_wbuf_t *wbf, uint8_t b, size_t pos);
+uint8_t *_z_wbuf_get_wptr(const _z_wbuf_t *wbf, size_t len);
+void _z_wbuf_produce(_z_wbuf_t *wbf, size_t len);
 
 size_t _z_wbuf_get_rpos(const _z_wbuf_t *wbf);
 size_t _z_wbuf_get_wpos(const _z_wbuf_t *wbf);
@@ -86,6 +109,7 @@ void _z_wbuf_set_wpos(_z_wbuf_t *wbf, size_t w_pos);
 
 void _z_wbuf_add_iosli(_z_wbuf_t *wbf, _z_iosli_t *ios);
 void _z_wbuf_add_iosli_from(_z_wbuf_t *wbf, const uint8_t *buf, size_t capacity);
+void _z_wbuf_add_iosli_wrap(_z_wbuf_t *wbf, const uint8_t *buf, size_t capacity);
 _z_iosli_t *_z_wbuf_get_iosli(const _z_wbuf_t *wbf, size_t idx);
 size_t _z_wbuf_len_iosli(const _z_wbuf_t *wbf);
 
@@ -111,6 +111,7 @@ extern "C" {
 #define _ZN_FLAGS(h) (_ZN_FLAGS_MASK & h)
 #define _ZN_HAS_FLAG(h, f) ((h & f) != 0)
 #define _ZN_SET_FLAG(h, f) (h |= f)
+#define _ZN_PRIORITY(h) ((_ZN_FLAGS_MASK & h) >> 5)
 
 /*=============================*/
 /*       Declaration IDs       */
@@ -233,10 +234,13 @@ typedef struct
 //
 //  7 6 5 4 3 2 1 0
 // +-+-+-+-+-+-+-+-+
-// | ID  |  Prio   |
+// | Prio|   ID    |
 // +-+-+-+---------+
 //
-// WARNING: zenoh-pico does not support priorities and QoS.
+// The decorator is omitted when the priority is the default one.
+//
+// WARNING: zenoh-pico does not support QoS, hence all the priorities share
+//          the same sequence number space.
 
 /*=============================*/
 /*     Transport Messages      */
@@ -906,6 +910,7 @@ typedef struct
 {
     _zn_attachment_t *attachment;
     _zn_reply_context_t *reply_context;
+    zn_priority_t priority;
     union
     {
         _zn_declare_t declare;
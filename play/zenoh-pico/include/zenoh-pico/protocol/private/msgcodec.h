@@ -37,7 +37,9 @@ _ZN_RESULT_DECLARE(zn_query_consolidation_t, query_consolidation)
 
 _ZN_RESULT_DECLARE(_zn_payload_t, payload)
 _ZN_RESULT_DECLARE(_zn_locators_t, locators)
+_ZN_RESULT_DECLARE(_zn_attachment_t, attachment)
 _ZN_P_RESULT_DECLARE(_zn_attachment_t, attachment)
+_ZN_RESULT_DECLARE(_zn_reply_context_t, reply_context)
 _ZN_P_RESULT_DECLARE(_zn_reply_context_t, reply_context)
 _ZN_RESULT_DECLARE(_zn_scout_t, scout)
 _ZN_RESULT_DECLARE(_zn_hello_t, hello)
@@ -114,6 +116,19 @@ _ZN_DECLARE_ENCODE_NOH(zenoh_message);
 _ZN_DECLARE_P_DECODE_NOH(zenoh_message);
 _ZN_DECLARE_FREE_NOH(zenoh_message);
 
+// Encode a DATA zenoh message but its payload, to be prepended as is to payloads
+int _zn_data_header_encode(_z_wbuf_t *wbf, const _zn_zenoh_message_t *msg);
+
+// Decode a zenoh message without allocating it: the decorators are decoded in the given
+// storage and the payloads are borrowed from the zbuf. Release it with _zn_zenoh_message_clear.
+int _zn_zenoh_message_decode_in_place(_z_zbuf_t *zbf, _zn_zenoh_message_t *msg, _zn_reply_context_t *reply_context, _zn_attachment_t *attachment);
+void _zn_zenoh_message_clear(_zn_zenoh_message_t *msg);
+
+// Decode the zenoh messages of a frame body one at a time, handing each of them to the visitor.
+// The messages live on the stack and are only valid for the duration of the visitor call.
+typedef int (*_zn_zenoh_message_visitor_t)(_zn_zenoh_message_t *msg, void *arg);
+int _zn_frame_messages_visit(_z_zbuf_t *zbf, _zn_zenoh_message_visitor_t visitor, void *arg);
+
 /*------------------ Free Helpers ------------------*/
 void _zn_reskey_free(zn_reskey_t *rk);
 
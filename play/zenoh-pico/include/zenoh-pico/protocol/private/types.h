@@ -49,8 +49,22 @@ typedef struct
 typedef struct
 {
     _z_iosli_t ios;
+    // The arena serving the values decoded from the buffer, if any
+    z_arena_t *arena;
 } _z_zbuf_t;
 
+typedef struct
+{
+    // When mirrored the memory is mapped twice back to back, the readable bytes are always
+    // contiguous even when they wrap around. Otherwise the readable bytes are moved back to
+    // the start of the memory when the next ones would not fit in the tail.
+    uint8_t *buf;
+    size_t capacity;
+    size_t r_pos;
+    size_t w_pos;
+    int is_mirrored;
+} _z_rbuf_t;
+
 typedef struct
 {
     size_t r_idx;
@@ -58,8 +72,71 @@ typedef struct
     size_t capacity;
     z_vec_t ioss;
     int is_expandable;
+    int is_zero_copy;
 } _z_wbuf_t;
 
+/*------------------ Resource name ------------------*/
+#define _ZN_RNAME_CHUNK_LITERAL 0
+#define _ZN_RNAME_CHUNK_PATTERN 1
+#define _ZN_RNAME_CHUNK_ANY 2
+
+/**
+ * A chunk of a resource name, between two ``/``.
+ *
+ * Members:
+ *   const char *val: The start of the chunk, not NULL terminated.
+ *   size_t len: The length of the chunk.
+ *   uint8_t kind: Whether the chunk has no wildcard, contains ``*`` wildcards, or is the ``**`` wildcard.
+ */
+typedef struct _zn_rname_chunk_t
+{
+    const char *val;
+    size_t len;
+    uint8_t kind;
+} _zn_rname_chunk_t;
+
+/*------------------ Resource name trie ------------------*/
+/**
+ * A node of a resource name trie, one per chunk of the indexed resource names.
+ *
+ * Members:
+ *   _zn_rname_chunk_t chunk: The chunk leading from the parent to this node.
+ *   size_t hash: The hash of the chunk.
+ *   struct _zn_rname_trie_node_t *parent: The parent node, NULL for the root.
+ *   struct _zn_rname_trie_node_t *collision: The next child of the parent whose chunk has the same hash.
+ *   z_id_map_t literals: The children whose chunk has no wildcard, indexed by the hash of their chunk.
+ *   z_list_t *patterns: The children whose chunk contains a ``*`` wildcard.
+ *   struct _zn_rname_trie_node_t *any: The child whose chunk is the ``**`` wildcard.
+ *   z_list_t *values: The values indexed by the resource name ending at this node.
+ */
+typedef struct _zn_rname_trie_node_t
+{
+    _zn_rname_chunk_t chunk;
+    size_t hash;
+    struct _zn_rname_trie_node_t *parent;
+    struct _zn_rname_trie_node_t *collision;
+    z_id_map_t literals;
+    z_list_t *patterns;
+    struct _zn_rname_trie_node_t *any;
+    z_list_t *values;
+} _zn_rname_trie_node_t;
+
+/**
+ * A trie indexing values by resource names, possibly with wildcards, and returning the
+ * values whose resource name intersects a given one without comparing them all.
+ *
+ * Members:
+ *   _zn_rname_trie_node_t root: The node of the empty resource name.
+ *   size_t len: The number of values.
+ */
+typedef struct
+{
+    _zn_rname_trie_node_t root;
+    size_t len;
+} _zn_rname_trie_t;
+
+typedef void (*_zn_rname_trie_visitor_t)(void *value, void *arg);
+
 #endif /* _ZENOH_PICO_PROTOCOL_PRIVATE_TYPES_H */
 
 
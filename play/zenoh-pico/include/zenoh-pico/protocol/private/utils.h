@@ -35,6 +35,14 @@ zn_reskey_t _zn_reskey_clone(const zn_reskey_t *resky);
 z_timestamp_t z_timestamp_clone(const z_timestamp_t *tstamp);
 void z_timestamp_reset(z_timestamp_t *tstamp);
 
+/*------------------ Resource name trie ------------------*/
+void _zn_rname_trie_init(_zn_rname_trie_t *trie);
+size_t _zn_rname_trie_len(const _zn_rname_trie_t *trie);
+void _zn_rname_trie_insert(_zn_rname_trie_t *trie, const char *rname, void *value);
+int _zn_rname_trie_remove(_zn_rname_trie_t *trie, const char *rname, void *value);
+void _zn_rname_trie_match(const _zn_rname_trie_t *trie, const char *rname, _zn_rname_trie_visitor_t visitor, void *arg);
+void _zn_rname_trie_clear(_zn_rname_trie_t *trie);
+
 #endif /* _ZENOH_PICO_PROTOCOL_PRIVATE_UTILS_H */
 
 #ifdef __cplusplus
@@ -71,6 +71,22 @@ typedef struct
     z_str_t rname;
 } zn_reskey_t;
 
+/**
+ * A zenoh-net key expression, i.e. a resource name split in chunks once to be
+ * matched repeatedly. See :c:func:`zn_keyexpr_compile`.
+ *
+ * Members:
+ *   z_str_t val: The resource name.
+ *   struct _zn_rname_chunk_t *chunks: The chunks of the resource name, pointing into it.
+ *   size_t len: The number of chunks.
+ */
+typedef struct
+{
+    z_str_t val;
+    struct _zn_rname_chunk_t *chunks;
+    size_t len;
+} zn_keyexpr_t;
+
 /**
  * A zenoh-net data sample.
  *
@@ -199,6 +215,32 @@ typedef enum
     zn_reliability_t_RELIABLE,
 } zn_reliability_t;
 
+/**
+ * The priority of a zenoh message, from the most to the least urgent.
+ * Messages of a higher priority are always transmitted before the ones
+ * of a lower priority that are waiting to be sent.
+ *
+ *     - **zn_priority_t_CONTROL**
+ *     - **zn_priority_t_REAL_TIME**
+ *     - **zn_priority_t_INTERACTIVE_HIGH**
+ *     - **zn_priority_t_INTERACTIVE_LOW**
+ *     - **zn_priority_t_DATA_HIGH**
+ *     - **zn_priority_t_DATA**
+ *     - **zn_priority_t_DATA_LOW**
+ *     - **zn_priority_t_BACKGROUND**
+ */
+typedef enum
+{
+    zn_priority_t_CONTROL,
+    zn_priority_t_REAL_TIME,
+    zn_priority_t_INTERACTIVE_HIGH,
+    zn_priority_t_INTERACTIVE_LOW,
+    zn_priority_t_DATA_HIGH,
+    zn_priority_t_DATA,
+    zn_priority_t_DATA_LOW,
+    zn_priority_t_BACKGROUND,
+} zn_priority_t;
+
 /**
  * The congestion control.
  *
@@ -238,6 +280,20 @@ typedef enum
     zn_submode_t_PULL,
 } zn_submode_t;
 
+/**
+ * The behavior of a subscription when its queue of the dispatcher is full.
+ *
+ *     - **zn_queue_full_t_BLOCK**: Wait for room in the queue, stalling the reception.
+ *     - **zn_queue_full_t_DROP_OLDEST**: Drop the oldest sample of the queue.
+ *     - **zn_queue_full_t_DROP_NEWEST**: Drop the sample being dispatched.
+ */
+typedef enum
+{
+    zn_queue_full_t_BLOCK,
+    zn_queue_full_t_DROP_OLDEST,
+    zn_queue_full_t_DROP_NEWEST,
+} zn_queue_full_t;
+
 /**
  * Informations to be passed to :c:func:`zn_declare_subscriber` to configure the created :c:type:`zn_subscriber_t`.
  *
@@ -245,12 +301,15 @@ typedef enum
  *     zn_reliability_t reliability: The subscription reliability.
  *     zn_submode_t mode: The subscription mode.
  *     zn_period_t *period: The subscription period.
+ *     zn_queue_full_t on_full: The behavior when the queue of the dispatcher is full, see :c:func:`znp_start_dispatcher`.
+ *                              It is local to the subscriber and not sent to the network.
  */
 typedef struct
 {
     zn_reliability_t reliability;
     zn_submode_t mode;
     zn_period_t *period;
+    zn_queue_full_t on_full;
 } zn_subinfo_t;
 
 #endif /* _ZENOH_PICO_PROTOCOL_TYPES_H */
@@ -18,6 +18,8 @@ extern "C" {
 #ifndef _ZENOH_PICO_PROTOCOL_UTILS_H
 #define _ZENOH_PICO_PROTOCOL_UTILS_H
 
+#include "./types.h"
+
 /**
  * Intersects two resource names. This function compares two resource names
  * and verifies that the first resource name intersects (i.e., matches) the
@@ -31,6 +33,63 @@ extern "C" {
  */
 int zn_rname_intersect(const char *left, const char *right);
 
+/**
+ * Verifies that a resource name includes another one, i.e. that every resource
+ * name matching the second one also matches the first one. E.g., /foo/\** includes
+ * /foo/\*.
+ *
+ * Parameters:
+ *     left: The including resource name.
+ *     right: The included resource name.
+ * Returns:
+ *     ``1`` if left includes right, ``0`` otherwise.
+ */
+int zn_rname_includes(const char *left, const char *right);
+
+/**
+ * Compiles a resource name into a key expression, splitting it in chunks once
+ * to intersect it repeatedly with :c:func:`zn_keyexpr_intersect` and
+ * :c:func:`zn_keyexpr_includes`. The resource name is copied.
+ *
+ * Parameters:
+ *     rname: The resource name to compile.
+ * Returns:
+ *     The key expression, to be freed with :c:func:`zn_keyexpr_free`.
+ */
+zn_keyexpr_t zn_keyexpr_compile(const char *rname);
+
+/**
+ * Intersects two key expressions, like :c:func:`zn_rname_intersect` does with
+ * the resource names they have been compiled from.
+ *
+ * Parameters:
+ *     left: The key expression to match against.
+ *     right: The key expression to be compared.
+ * Returns:
+ *     ``1`` if the key expressions intersect, ``0`` otherwise.
+ */
+int zn_keyexpr_intersect(const zn_keyexpr_t *left, const zn_keyexpr_t *right);
+
+/**
+ * Verifies that a key expression includes another one, like :c:func:`zn_rname_includes`
+ * does with the resource names they have been compiled from.
+ *
+ * Parameters:
+ *     left: The including key expression.
+ *     right: The included key expression.
+ * Returns:
+ *     ``1`` if left includes right, ``0`` otherwise.
+ */
+int zn_keyexpr_includes(const zn_keyexpr_t *left, const zn_keyexpr_t *right);
+
+/**
+ * Frees the memory of a key expression.
+ *
+ * Parameters:
+ *     keyexpr: The key expression to free.
+ */
+void zn_keyexpr_free(zn_keyexpr_t *keyexpr);
+
 #endif /* _ZENOH_PICO_PROTOCOL_UTILS_H */
 
 #ifdef __cplusplus
@@ -110,6 +110,49 @@ void zn_close(zn_session_t *session);
  */
 zn_properties_t *zn_info(zn_session_t *session);
 
+/**
+ * Get a snapshot of the statistics of a zenoh-net session.
+ *
+ * Parameters:
+ *     session: A zenoh-net session.
+ *
+ * Returns:
+ *     A :c:type:`zn_stats_t` holding the counters of the given zenoh-net session.
+ */
+zn_stats_t zn_session_stats(zn_session_t *session);
+
+/**
+ * Declare a :c:type:`zn_queryable_t` exposing the statistics of a zenoh-net session
+ * under the ``/@/pico/<pid>/stats`` admin key. The queryable replies to each query
+ * with a JSON object mapping the name of every :c:type:`zn_stats_t` counter to its value.
+ * The queryable is not declared by default to avoid any unsolicited traffic.
+ *
+ * Parameters:
+ *     session: A zenoh-net session.
+ *
+ * Returns:
+ *    The created :c:type:`zn_queryable_t` or null if the declaration failed.
+ *    It is undeclared with :c:func:`zn_undeclare_queryable`.
+ */
+zn_queryable_t *zn_declare_stats_queryable(zn_session_t *session);
+
+/**
+ * Measure the round trip time of the transport of a zenoh-net session by sending a
+ * ``Ping`` message and waiting for the matching ``Pong``. The ``Pong`` is timed when it
+ * is handled, so a read task or an event loop must be serving the session. Incoming
+ * ``Ping`` messages are answered automatically. The measured times are also summarized
+ * in the ``rtt_*`` counters of :c:type:`zn_stats_t`.
+ *
+ * Parameters:
+ *     session: A zenoh-net session.
+ *     timeout: The time to wait for the ``Pong``, in milliseconds.
+ *
+ * Returns:
+ *     The round trip time in microseconds, or ``-1`` if no ``Pong`` has been received
+ *     within the timeout, another ping is outstanding, or in case of failure.
+ */
+int zn_ping(zn_session_t *session, unsigned int timeout);
+
 /*------------------ Declarations ------------------*/
 /**
  * Associate a numerical id with the given resource key.
@@ -156,6 +199,37 @@ void zn_undeclare_resource(zn_session_t *session, z_zint_t rid);
  */
 zn_publisher_t *zn_declare_publisher(zn_session_t *session, zn_reskey_t reskey);
 
+/**
+ * Set the priority of the data written through a :c:type:`zn_publisher_t`.
+ * Publishers are created with the :c:macro:`ZN_PRIORITY_DEFAULT` priority.
+ *
+ * This function is not thread-safe: the publisher must not be written through
+ * with :c:func:`zn_publisher_write`, nor undeclared, while its priority is set.
+ *
+ * Parameters:
+ *     pub: The :c:type:`zn_publisher_t`.
+ *     priority: The priority of the written data.
+ *
+ * Returns:
+ *     ``0`` in case of success, ``-1`` if the priority is not valid, the
+ *     priority of the publisher being left unchanged.
+ */
+int zn_publisher_set_priority(zn_publisher_t *pub, zn_priority_t priority);
+
+/**
+ * Write data through a :c:type:`zn_publisher_t`.
+ * The message header is encoded once when the publisher is declared, making this
+ * function cheaper than :c:func:`zn_write` for publishers writing at high rates.
+ *
+ * Parameters:
+ *     pub: The :c:type:`zn_publisher_t` to write through.
+ *     payload: The value to write.
+ *     len: The length of the value to write.
+ * Returns:
+ *     ``0`` in case of success, ``-1`` in case of failure.
+ */
+int zn_publisher_write(zn_publisher_t *pub, const uint8_t *payload, size_t len);
+
 /**
  * Undeclare a :c:type:`zn_publisher_t`.
  *
@@ -165,7 +239,8 @@ zn_publisher_t *zn_declare_publisher(zn_session_t *session, zn_reskey_t reskey);
 void zn_undeclare_publisher(zn_publisher_t *publ);
 
 /**
- * Declare a :c:type:`zn_subscriber_t` for the given resource key.
+ * Declare a :c:type:`zn_subscriber_t` for the given resource key. The callbacks run
+ * without holding the locks of the session, hence they may declare and undeclare entities.
  *
  * Parameters:
  *     session: The zenoh-net session.
@@ -184,7 +259,12 @@ zn_subscriber_t *zn_declare_subscriber(zn_session_t *session,
                                        void *arg);
 
 /**
- * Undeclare a :c:type:`zn_subscriber_t`.
+ * Undeclare a :c:type:`zn_subscriber_t`. If the dispatcher is running, the samples
+ * already queued for the subscriber are delivered before returning, except when called
+ * from a subscription callback running on a worker: the samples queued on that worker
+ * for the subscriber are dropped instead. Otherwise, it waits for the samples being
+ * delivered by the read task to leave the **callback**, unless it is called from a
+ * subscription callback itself.
  *
  * Parameters:
  *     sub: The :c:type:`zn_subscriber_t` to undeclare.
@@ -285,10 +365,23 @@ int zn_write(zn_session_t *zn, zn_reskey_t reskey, const uint8_t *payload, size_
  *     encoding: The encoding of the payload.
  *     kind: The kind of the value.
  *     cong_ctrl: The congestion control of this write.
+ *     priority: The priority of this write.
+ *     express: If ``1``, the data is sent right away bypassing the batching.
  * Returns:
  *     ``0`` in case of success, ``-1`` in case of failure.
  */
-int zn_write_ext(zn_session_t *zn, zn_reskey_t reskey, const uint8_t *payload, size_t len, uint8_t encoding, uint8_t kind, zn_congestion_control_t cong_ctrl);
+int zn_write_ext(zn_session_t *zn, zn_reskey_t reskey, const uint8_t *payload, size_t len, uint8_t encoding, uint8_t kind, zn_congestion_control_t cong_ctrl, zn_priority_t priority, int express);
+
+/**
+ * Send the batch of messages pending transmission, if any. This is only relevant
+ * when batching has been enabled via :c:macro:`ZN_CONFIG_BATCHING_KEY`.
+ *
+ * Parameters:
+ *     session: The zenoh-net session.
+ * Returns:
+ *     ``0`` in case of success, ``-1`` in case of failure.
+ */
+int zn_flush(zn_session_t *zn);
 
 /**
  * Pull data for a pull mode :c:type:`zn_subscriber_t`. The pulled data will be provided
@@ -404,6 +497,7 @@ void zn_send_reply(zn_query_t *query, const char *key, const uint8_t *payload, s
 /**
  * Read from the network. This function should be called manually called when
  * the read loop has not been started, e.g., when running in a single thread.
+ * If the remote peer closes the session, the session is freed.
  *
  * Parameters:
  *     session: The zenoh-net session.
@@ -424,8 +518,11 @@ int znp_send_keep_alive(zn_session_t *z);
 
 /**
  * Start a separate task to read from the network and process the messages
- * as soon as they are received. Note that the task can be implemented in
- * form of thread, process, etc. and its implementation is platform-dependent.
+ * as soon as they are received. When :c:macro:`ZN_RX_PIPELINE_SIZE` is not zero,
+ * a second task reads the batches into a pool of as many buffers while this
+ * one decodes and handles them, so that reading overlaps with decoding. Note that
+ * the task can be implemented in form of thread, process, etc. and its implementation
+ * is platform-dependent.
  *
  * Parameters:
  *     session: The zenoh-net session.
@@ -446,10 +543,74 @@ int znp_start_read_task(zn_session_t *z);
 int znp_stop_read_task(zn_session_t *z);
 
 /**
- * Start a separate task to handle the session lease. This task will send ``KeepAlive``
- * messages when needed and will close the session when the lease is expired. Note that
- * the task can be implemented in form of thread, process, etc. and its implementation
- * is platform-dependent.
+ * Start a separate task owning the transmission on the network. Once started,
+ * zenoh messages are encoded by the calling threads and handed over to the task
+ * through a bounded lock-free queue of :c:macro:`ZN_TX_QUEUE_SIZE` messages per
+ * priority. Queues are served in strict priority order, so that urgent messages
+ * never wait behind less urgent ones. The congestion control then applies to
+ * the queue occupancy: a ``DROP`` message is dropped when the queue is full
+ * while a ``BLOCK`` message waits for room in the queue. Note that the task can be implemented in form of thread,
+ * process, etc. and its implementation is platform-dependent.
+ *
+ * Parameters:
+ *     session: The zenoh-net session.
+ * Returns:
+ *     ``0`` in case of success, ``-1`` in case of failure.
+ */
+int znp_start_tx_task(zn_session_t *z);
+
+/**
+ * Stop the transmit task. The messages still in the queue are sent before this
+ * function returns, hence it must not be called from the transmit task itself.
+ * This may result in stopping a thread or a process depending on the target platform.
+ *
+ * Parameters:
+ *     session: The zenoh-net session.
+ * Returns:
+ *     ``0`` in case of success, ``-1`` in case of failure.
+ */
+int znp_stop_tx_task(zn_session_t *z);
+
+/**
+ * Start a pool of tasks running the subscription callbacks. Once started, the
+ * received samples are copied and handed over to one of the ``workers`` tasks,
+ * chosen by hashing the resource name: samples of a same resource are always
+ * delivered in order by the same task, while samples of different resources are
+ * delivered in parallel. Each task has a bounded queue of :c:macro:`ZN_DISPATCH_QUEUE_SIZE`
+ * samples and the ``on_full`` field of the subscriber :c:type:`zn_subinfo_t`
+ * decides what happens when the queue is full. Note that the tasks can be implemented
+ * in form of thread, process, etc. and its implementation is platform-dependent.
+ *
+ * Parameters:
+ *     session: The zenoh-net session.
+ *     workers: The number of tasks to start.
+ * Returns:
+ *     ``0`` in case of success, ``-1`` in case of failure.
+ */
+int znp_start_dispatcher(zn_session_t *z, unsigned int workers);
+
+/**
+ * Stop the tasks running the subscription callbacks. The samples still in the
+ * queues are delivered before the tasks terminate, then the callbacks are run
+ * again by the read task. This function must not be called from a subscription callback.
+ *
+ * Parameters:
+ *     session: The zenoh-net session.
+ * Returns:
+ *     ``0`` in case of success, ``-1`` in case of failure.
+ */
+int znp_stop_dispatcher(zn_session_t *z);
+
+/**
+ * Start handling the session lease. ``KeepAlive`` messages are sent once the session
+ * has not transmitted anything for :c:macro:`ZN_KEEP_ALIVE_INTERVAL` milliseconds, and
+ * the session is closed when the lease is expired. The pending batch is also flushed
+ * when its linger time expires. The timers of all the sessions are run by a single task
+ * shared by the whole process, started along with the first session. The messages due
+ * to the timers are sent by the transmit task of the session if running, see
+ * :c:func:`znp_start_tx_task`, so that a stalled link does not delay the other sessions.
+ * Note that the task can be implemented in form of thread, process, etc. and its
+ * implementation is platform-dependent.
  *
  * Parameters:
  *     session: The zenoh-net session.
@@ -459,8 +620,8 @@ int znp_stop_read_task(zn_session_t *z);
 int znp_start_lease_task(zn_session_t *z);
 
 /**
- * Stop the lease task. This may result in stopping a thread or a process depending
- * on the target platform.
+ * Stop handling the session lease. The timers of the session are cancelled, waiting
+ * for the one running, if any, to complete.
  *
  * Parameters:
  *     session: The zenoh-net session.
@@ -469,6 +630,70 @@ int znp_start_lease_task(zn_session_t *z);
  */
 int znp_stop_lease_task(zn_session_t *z);
 
+/**
+ * Create an event loop serving many sessions on a single task, in place of their
+ * own read and lease tasks. Several loops can run on as many tasks, each one serving
+ * its own sessions. A loop is not thread-safe: the sessions are added and removed
+ * before running it or from the callbacks it runs.
+ *
+ * Returns:
+ *     The created :c:type:`zn_loop_t` or null if event loops are not supported on the target platform.
+ */
+zn_loop_t *zn_loop_make(void);
+
+/**
+ * Add a session to an event loop. The loop reads and handles the messages received
+ * by the session as soon as its link is readable, and handles its lease, keep alive,
+ * batching linger and reliability timers. The session must not have its own read
+ * or lease task running.
+ *
+ * Parameters:
+ *     loop: The :c:type:`zn_loop_t`.
+ *     session: The zenoh-net session to serve.
+ * Returns:
+ *     ``0`` in case of success, ``-1`` in case of failure.
+ */
+int zn_loop_add_session(zn_loop_t *loop, zn_session_t *session);
+
+/**
+ * Remove a session from an event loop. Note that a session whose link is closed, or
+ * whose lease expires, is removed by the loop itself.
+ *
+ * Parameters:
+ *     loop: The :c:type:`zn_loop_t`.
+ *     session: The zenoh-net session to remove.
+ * Returns:
+ *     ``0`` in case of success, ``-1`` in case of failure.
+ */
+int zn_loop_remove_session(zn_loop_t *loop, zn_session_t *session);
+
+/**
+ * Run an event loop on the calling task until :c:func:`zn_loop_stop` is called.
+ *
+ * Parameters:
+ *     loop: The :c:type:`zn_loop_t` to run.
+ * Returns:
+ *     ``0`` in case of success, ``-1`` in case of failure.
+ */
+int zn_loop_run(zn_loop_t *loop);
+
+/**
+ * Stop an event loop. The loop returns once its current iteration is over, within
+ * :c:macro:`ZN_KEEP_ALIVE_INTERVAL` milliseconds at most.
+ *
+ * Parameters:
+ *     loop: The :c:type:`zn_loop_t` to stop.
+ */
+void zn_loop_stop(zn_loop_t *loop);
+
+/**
+ * Free an event loop that is not running. The sessions it was serving are not closed.
+ *
+ * Parameters:
+ *     loop: The :c:type:`zn_loop_t` to free.
+ */
+void zn_loop_free(zn_loop_t *loop);
+
 #endif /* _ZENOH_PICO_SESSION_API_H */
 
 #ifdef __cplusplus
@@ -33,7 +33,20 @@ void _zn_unregister_subscription(zn_session_t *zn, int is_local, _zn_subscriber_
 void _zn_flush_subscriptions(zn_session_t *zn);
 void _zn_trigger_subscriptions(zn_session_t *zn, const zn_reskey_t reskey, const z_bytes_t payload);
 
-void __unsafe_zn_add_rem_res_to_loc_sub_map(zn_session_t *zn, z_zint_t id, zn_reskey_t *reskey);
+/*------------------ Snapshot ------------------*/
+_zn_subscription_snapshot_t *_zn_subscription_snapshot_acquire(zn_session_t *zn);
+void _zn_subscription_snapshot_release(zn_session_t *zn, _zn_subscription_snapshot_t *snap);
+void _zn_subscription_snapshot_synchronize(zn_session_t *zn);
+_zn_subscription_snapshot_t *__unsafe_zn_subscription_snapshot_make(zn_session_t *zn);
+void __unsafe_zn_publish_subscription_snapshot(zn_session_t *zn);
+void __unsafe_zn_drop_subscription_snapshot(zn_session_t *zn);
+void __unsafe_zn_update_subscription_route(zn_session_t *zn, z_zint_t id);
+
+/*------------------ Dispatcher ------------------*/
+_zn_dispatch_job_t *_zn_dispatch_job_make(const _zn_subscriber_t *sub, const zn_sample_t *sample, size_t hash);
+_zn_dispatch_worker_t *_zn_dispatch_acquire(zn_session_t *zn, unsigned int *num);
+void _zn_dispatch_jobs(zn_session_t *zn, _zn_dispatch_worker_t *workers, unsigned int num, z_list_t *jobs);
+void _zn_dispatch_flush(zn_session_t *zn, z_zint_t id);
 
 /*------------------ Pull ------------------*/
 z_zint_t _zn_get_pull_id(zn_session_t *zn);
@@ -31,17 +31,80 @@ typedef struct
 {
     z_zint_t id;
     zn_reskey_t key;
+    // The complete resource name expanded once at registration, with its hash. The name is
+    // NULL when the resource builds on an unknown or forgotten one.
+    z_string_t name;
+    size_t name_hash;
 } _zn_resource_t;
 
 typedef struct
 {
     z_zint_t id;
     zn_reskey_t key;
+    // The complete resource name of a local subscription, indexing it in the trie
+    z_str_t rname;
     zn_subinfo_t info;
     zn_data_handler_t callback;
     void *arg;
 } _zn_subscriber_t;
 
+/**
+ * The local subscriptions matching a remote resource.
+ *
+ * Members:
+ *   z_string_t name: The complete name of the remote resource.
+ *   size_t hash: The hash of the name.
+ *   _zn_subscriber_t **subs: The matching subscriptions.
+ *   size_t len: The number of matching subscriptions.
+ */
+typedef struct
+{
+    z_string_t name;
+    size_t hash;
+    _zn_subscriber_t **subs;
+    size_t len;
+} _zn_subscription_route_t;
+
+/**
+ * A copy of the local subscriptions, and of the remote resources they match, shared with the
+ * reading thread. It is replaced rather than modified when the local subscriptions change,
+ * its routes are patched when the remote resources change, and it is freed once released
+ * by its last holder.
+ *
+ * Members:
+ *   size_t refcount: The number of holders, including the session while it is published.
+ *   _zn_subscriber_t *subs: The copies of the local subscriptions.
+ *   size_t len: The number of local subscriptions.
+ *   _zn_rname_trie_t trie: The copies of the local subscriptions, indexed by their resource name.
+ *   z_id_map_t routes: The :c:type:`_zn_subscription_route_t` of the named remote resources, indexed by id.
+ */
+typedef struct _zn_subscription_snapshot_t
+{
+    size_t refcount;
+    _zn_subscriber_t *subs;
+    size_t len;
+    _zn_rname_trie_t trie;
+    z_id_map_t routes;
+} _zn_subscription_snapshot_t;
+
+typedef struct
+{
+    // The key and the value of the sample are stored right after the job
+    zn_sample_t sample;
+    size_t hash;
+    z_zint_t id;
+    zn_queue_full_t on_full;
+    zn_data_handler_t callback;
+    void *arg;
+} _zn_dispatch_job_t;
+
+typedef struct
+{
+    zn_loop_t *loop;
+    zn_session_t *zn;
+    int is_removed;
+} _zn_loop_entry_t;
+
 typedef struct
 {
     z_zint_t id;
@@ -77,6 +140,8 @@ typedef struct
 {
     z_zint_t id;
     zn_reskey_t key;
+    // The complete resource name, indexing the queryable in the trie
+    z_str_t rname;
     unsigned int kind;
     zn_queryable_handler_t callback;
     void *arg;
@@ -32,9 +32,20 @@ int _zn_session_close(zn_session_t *zn, uint8_t reason);
 void _zn_session_free(zn_session_t *zn);
 
 int _zn_send_close(zn_session_t *zn, uint8_t reason, int link_only);
+int _zn_try_send_close(zn_session_t *zn, uint8_t reason, int link_only);
 
 int _zn_handle_zenoh_message(zn_session_t *zn, _zn_zenoh_message_t *z_msg);
 
+/*------------------ Statistics ------------------*/
+// The counters are updated concurrently by the user threads and the session tasks
+#define _ZN_STATS_ADD(zn, field, n) __atomic_fetch_add(&(zn)->stats.field, (z_zint_t)(n), __ATOMIC_RELAXED)
+#define _ZN_STATS_INC(zn, field) _ZN_STATS_ADD(zn, field, 1)
+
+// The statistics admin key is /@/pico/<pid>/stats
+#define _ZN_STATS_KEY_PREFIX "/@/pico/"
+#define _ZN_STATS_KEY_SUFFIX "/stats"
+#define _ZN_STATS_JSON_LEN 2048
+
 #endif /* _ZENOH_PICO_SESSION_PRIVATE_UTILS_H */
 
 #ifdef __cplusplus
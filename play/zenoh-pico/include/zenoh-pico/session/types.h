@@ -31,6 +31,125 @@ extern "C" {
  */
 typedef void (*zn_on_disconnect_t)(void *zn);
 
+/**
+ * The state of the reliable channel on datagram links. Frames are kept in rings of
+ * :c:macro:`ZN_RELIABILITY_WINDOW` slots, an empty slot has a NULL buffer.
+ *
+ * Members:
+ *   z_bytes_t *tx_frames: The serialized frames waiting for an acknowledgement, oldest first.
+ *   size_t tx_head: The slot of the oldest unacknowledged frame.
+ *   size_t tx_len: The number of unacknowledged frames.
+ *   z_zint_t tx_sn: The SN of the oldest unacknowledged frame.
+ *   z_clock_t sync_start: The time the last SYNC message was sent.
+ *   _z_zbuf_t **rx_frames: The frames received ahead of the next expected one, by distance.
+ *   size_t rx_head: The slot of the next expected frame.
+ */
+typedef struct
+{
+    z_bytes_t *tx_frames;
+    size_t tx_head;
+    size_t tx_len;
+    z_zint_t tx_sn;
+    z_clock_t sync_start;
+
+    _z_zbuf_t **rx_frames;
+    size_t rx_head;
+} _zn_reliable_channel_t;
+
+/**
+ * The statistics of a zenoh-net session, counted since the session has been opened.
+ * Batches are the transport messages, frames carrying zenoh messages or fragments included.
+ *
+ * Members:
+ *   z_zint_t tx_bytes: The number of bytes sent.
+ *   z_zint_t tx_batches: The number of batches sent.
+ *   z_zint_t tx_msgs: The number of zenoh messages sent.
+ *   z_zint_t tx_fragments: The number of fragments sent.
+ *   z_zint_t tx_retransmissions: The number of frames retransmitted on datagram links.
+ *   z_zint_t tx_dropped_congestion: The number of zenoh messages dropped because of congestion control.
+ *   z_zint_t tx_dropped_errors: The number of zenoh messages dropped because they could not be encoded or sent.
+ *   z_zint_t rx_bytes: The number of bytes received.
+ *   z_zint_t rx_batches: The number of batches received.
+ *   z_zint_t rx_msgs: The number of zenoh messages received.
+ *   z_zint_t rx_fragments: The number of fragments received.
+ *   z_zint_t rx_dropped_out_of_order: The number of frames dropped because they were received out of order.
+ *   z_zint_t rx_decode_errors: The number of batches and reassembled messages that could not be decoded.
+ *   z_zint_t rx_dropped_oversize: The number of fragmented messages dropped because they exceed ZN_FRAG_BUF_RX_LIMIT.
+ *   z_zint_t rx_dropped_dispatch: The number of samples dropped because the queue of the dispatcher was full.
+ *   z_zint_t reconnects: The number of times the link has been reopened.
+ *   z_zint_t tx_lock_contentions: The number of times a writer found the transmission lock taken.
+ *   z_zint_t rtt_samples: The number of round trip times measured with :c:func:`zn_ping`.
+ *   z_zint_t rtt_min: The minimum of the last ZN_RTT_WINDOW round trip times, in microseconds.
+ *   z_zint_t rtt_avg: The average of the last ZN_RTT_WINDOW round trip times, in microseconds.
+ *   z_zint_t rtt_p99: The 99th percentile of the last ZN_RTT_WINDOW round trip times, in microseconds.
+ */
+typedef struct
+{
+    // NOTE: all the members must be z_zint_t, the snapshot reads them as an array
+    z_zint_t tx_bytes;
+    z_zint_t tx_batches;
+    z_zint_t tx_msgs;
+    z_zint_t tx_fragments;
+    z_zint_t tx_retransmissions;
+    z_zint_t tx_dropped_congestion;
+    z_zint_t tx_dropped_errors;
+
+    z_zint_t rx_bytes;
+    z_zint_t rx_batches;
+    z_zint_t rx_msgs;
+    z_zint_t rx_fragments;
+    z_zint_t rx_dropped_out_of_order;
+    z_zint_t rx_decode_errors;
+    z_zint_t rx_dropped_oversize;
+    z_zint_t rx_dropped_dispatch;
+
+    z_zint_t reconnects;
+    z_zint_t tx_lock_contentions;
+
+    z_zint_t rtt_samples;
+    z_zint_t rtt_min;
+    z_zint_t rtt_avg;
+    z_zint_t rtt_p99;
+} zn_stats_t;
+
+/**
+ * The reassembly buffer of the fragmented messages of a channel.
+ *
+ * Members:
+ *   _z_zbuf_t buf: The fragments received so far, appended in a single contiguous allocation.
+ *   int is_discarding: Whether the fragments left of a message exceeding the limit are being discarded.
+ */
+typedef struct
+{
+    _z_zbuf_t buf;
+    int is_discarding;
+} _zn_dbuf_t;
+
+/**
+ * A worker of the dispatcher, running the subscription callbacks of the samples
+ * hashed onto it in the order they have been received.
+ *
+ * Members:
+ *   void **jobs: The bounded circular queue of the samples to be delivered.
+ *   size_t head: The position of the oldest sample in the queue.
+ *   size_t len: The number of samples in the queue.
+ *   int is_busy: Whether a subscription callback is running.
+ *   int is_running: Whether the worker accepts new samples.
+ */
+typedef struct
+{
+    void **jobs;
+    size_t head;
+    size_t len;
+    int is_busy;
+    int is_running;
+    z_mutex_t mutex;
+    z_condvar_t cond_not_empty;
+    z_condvar_t cond_not_full;
+    z_condvar_t cond_idle;
+    z_task_t task;
+} _zn_dispatch_worker_t;
+
 /**
  * A zenoh-net session.
  */
@@ -45,8 +164,20 @@ typedef struct
     _z_wbuf_t wbuf;
     _z_zbuf_t zbuf;
 
-    _z_wbuf_t dbuf_reliable;
-    _z_wbuf_t dbuf_best_effort;
+    // Bytes read ahead on stream links, and the view of the batch read from them last
+    _z_rbuf_t rbuf;
+    _z_zbuf_t rbatch;
+
+    // Datagrams read at once on links supporting batched reads, decoded one at a time
+    _z_zbuf_t *dgrams;
+    size_t dgrams_len;
+    size_t dgrams_idx;
+
+    // Arena of the values decoded from the batch being handled
+    z_arena_t rx_arena;
+
+    _zn_dbuf_t dbuf_reliable;
+    _zn_dbuf_t dbuf_best_effort;
 
     // Connection state
     z_bytes_t local_pid;
@@ -64,37 +195,122 @@ typedef struct
     z_zint_t sn_rx_reliable;
     z_zint_t sn_rx_best_effort;
 
+    // Batching
+    int batching;
+    unsigned int batch_linger;
+    volatile int batch_open;
+    zn_reliability_t batch_reliability;
+    zn_priority_t batch_priority;
+    z_zint_t batch_sn;
+    z_clock_t batch_start;
+
+    // Reliability on datagram links
+    _zn_reliable_channel_t *reliable_channel;
+
+    // Statistics
+    zn_stats_t stats;
+
+    // Round trip time measurement, protected by mutex_inner
+    z_condvar_t cond_ping;
+    z_zint_t ping_hash;
+    z_zint_t ping_count;
+    z_clock_t ping_start;
+    clock_t ping_rtt;
+    clock_t rtt_window[ZN_RTT_WINDOW];
+    size_t rtt_len;
+    size_t rtt_head;
+
     // Counters
     z_zint_t resource_id;
     z_zint_t entity_id;
     z_zint_t pull_id;
     z_zint_t query_id;
 
-    // Declarations
-    z_list_t *local_resources;
-    z_list_t *remote_resources;
+    // Declarations, indexed by their id
+    z_id_map_t local_resources;
+    z_id_map_t remote_resources;
+    // The resources building on a resource id, declared or not yet, to expand their names again
+    z_id_map_t local_resource_children;
+    z_id_map_t remote_resource_children;
+
+    z_id_map_t local_subscriptions;
+    z_id_map_t remote_subscriptions;
 
-    z_list_t *local_subscriptions;
-    z_list_t *remote_subscriptions;
-    z_i_map_t *rem_res_loc_sub_map;
+    z_id_map_t local_queryables;
+    z_id_map_t rem_res_loc_qle_map;
 
-    z_list_t *local_queryables;
-    z_i_map_t *rem_res_loc_qle_map;
+    z_id_map_t pending_queries;
 
-    z_list_t *pending_queries;
+    // Local subscriptions and queryables, indexed by their resource name
+    _zn_rname_trie_t local_subscriptions_trie;
+    _zn_rname_trie_t local_queryables_trie;
+
+    // Immutable view of the local subscriptions matched by the reading thread without locking,
+    // built again whenever they change
+    struct _zn_subscription_snapshot_t *subscription_snapshot;
+    size_t subscription_snapshot_readers;
+    // The dropped snapshots not freed yet, some readers still hold them
+    size_t subscription_snapshots_dropped;
+    z_mutex_t mutex_snapshot;
+    z_condvar_t cond_snapshot;
 
     // Runtime
     zn_on_disconnect_t on_disconnect;
 
     volatile int read_task_running;
     z_task_t *read_task;
+    // The stages of the read task, published while it runs
+    struct _zn_rx_pipeline_t *read_pipeline;
+
+    volatile int tx_task_running;
+    z_mpsc_t *tx_queue[_ZN_PRIORITIES_NUM];
+    z_mutex_t mutex_tx_queue;
+    z_condvar_t cond_tx_queue;
+    volatile int tx_queue_waiting;
+    volatile int tx_queue_wakeup;
+    z_task_t *tx_task;
+    // The transmissions requested by the timers, see _zn_tx_work_post
+    volatile int tx_work;
 
+    // Workers running the subscription callbacks, null when they run on the reading thread
+    _zn_dispatch_worker_t *dispatch_workers;
+    unsigned int dispatch_workers_num;
+    // The threads pushing samples to the workers or waiting for them, see _zn_dispatch_acquire
+    volatile unsigned int dispatch_pushing;
+    volatile unsigned int dispatch_flushing;
+
+    // Whether the timers are served by the shared timer service
     volatile int lease_task_running;
     volatile int received;
-    volatile int transmitted;
-    z_task_t *lease_task;
+    // The last time a batch has been transmitted, protected by mutex_tx
+    z_clock_t last_tx;
+
+    // Lease, keep alive, batching linger and reliability timers
+    z_timer_t lease_timer;
+    z_timer_t keep_alive_timer;
+    z_timer_t flush_timer;
+    z_timer_t sync_timer;
 } zn_session_t;
 
+/**
+ * An event loop serving the reception and the timers of many sessions on a single task.
+ *
+ * Members:
+ *   int poll: The platform poller waiting for the readiness of the session links.
+ *   z_list_t *entries: The sessions served by the loop, including the removed ones not released yet.
+ *   z_timer_wheel_t timers: The timers of the sessions, in milliseconds since the start of the loop.
+ *   z_clock_t start: The instant the loop has been created.
+ *   int is_running: Whether the loop is running.
+ */
+typedef struct
+{
+    int poll;
+    z_list_t *entries;
+    z_timer_wheel_t timers;
+    z_clock_t start;
+    volatile int is_running;
+} zn_loop_t;
+
 /**
  * Return type when declaring a publisher.
  */
@@ -103,6 +319,8 @@ typedef struct
     zn_session_t *zn;
     z_zint_t id;
     zn_reskey_t key;
+    zn_priority_t priority;
+    z_bytes_t encoded_header;
 } zn_publisher_t;
 
 /**
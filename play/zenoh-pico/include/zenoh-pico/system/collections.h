@@ -29,6 +29,44 @@ z_mvar_t *z_mvar_of(void *e);
 void *z_mvar_get(z_mvar_t *mv);
 void z_mvar_put(z_mvar_t *mv, void *e);
 
+/*-------- Mpsc --------*/
+/**
+ * A bounded lock-free multi-producer single-consumer queue of pointers.
+ * The capacity is rounded up to the next power of two. Pushing and popping
+ * never take a lock, the mutex is only used to park producers when the queue
+ * is full. Popping never blocks, a consumer waiting for elements parks on its own.
+ */
+z_mpsc_t *z_mpsc_make(size_t capacity);
+size_t z_mpsc_capacity(const z_mpsc_t *q);
+size_t z_mpsc_len(const z_mpsc_t *q);
+
+int z_mpsc_try_push(z_mpsc_t *q, void *e);
+void z_mpsc_push(z_mpsc_t *q, void *e);
+
+void *z_mpsc_try_pop(z_mpsc_t *q);
+
+void z_mpsc_free(z_mpsc_t **q);
+
+/*-------- Spsc --------*/
+/**
+ * A bounded lock-free single-producer single-consumer queue of pointers.
+ * The capacity is rounded up to the next power of two. Only one thread may push
+ * and only one thread may pop at any time, in which case no atomic read-modify-write
+ * is needed. The mutex is only used to park a side.
+ */
+z_spsc_t *z_spsc_make(size_t capacity);
+size_t z_spsc_capacity(const z_spsc_t *q);
+size_t z_spsc_len(const z_spsc_t *q);
+
+int z_spsc_try_push(z_spsc_t *q, void *e);
+void z_spsc_push(z_spsc_t *q, void *e);
+
+void *z_spsc_try_pop(z_spsc_t *q);
+void *z_spsc_pop(z_spsc_t *q);
+void z_spsc_wakeup(z_spsc_t *q);
+
+void z_spsc_free(z_spsc_t **q);
+
 #endif /* _ZENOH_PICO_SYSTEM_PRIVATE_COLLECTIONS_H */
 
 
@@ -26,6 +26,7 @@ extern "C" {
 
 /*------------------ Thread ------------------*/
 int z_task_init(z_task_t *task, z_task_attr_t *attr, void *(*fun)(void *), void *arg);
+int z_task_join(z_task_t *task);
 
 /*------------------ Mutex ------------------*/
 int z_mutex_init(z_mutex_t *m);
@@ -41,6 +42,27 @@ int z_condvar_free(z_condvar_t *cv);
 
 int z_condvar_signal(z_condvar_t *cv);
 int z_condvar_wait(z_condvar_t *cv, z_mutex_t *m);
+/**
+ * Wait on a condition variable for ``timeout`` milliseconds at most.
+ *
+ * Returns:
+ *     ``0`` if signaled, non-zero if the timeout expired or in case of failure.
+ */
+int z_condvar_timedwait(z_condvar_t *cv, z_mutex_t *m, unsigned int timeout);
+
+/*------------------ Memory ------------------*/
+/**
+ * Allocate a memory region mapped twice back to back, so that the byte at ``buf[i]`` is
+ * also found at ``buf[i + capacity]``. The capacity is rounded up to the page size.
+ *
+ * Parameters:
+ *     capacity: The requested capacity, updated with the allocated one.
+ *
+ * Returns:
+ *     The start of the region, or ``NULL`` if mirrored regions are not supported.
+ */
+uint8_t *z_mirror_alloc(size_t *capacity);
+void z_mirror_free(uint8_t *buf, size_t capacity);
 
 /*------------------ Sleep ------------------*/
 int z_sleep_us(unsigned int time);
@@ -60,9 +82,19 @@ time_t z_time_elapsed_ms(z_time_t *time);
 time_t z_time_elapsed_s(z_time_t *time);
 
 /*------------------ Network ------------------*/
+// The maximum number of buffers handed over to a single vectored write
+#define _ZN_IOV_MAX 32
+
+int _zn_send_bytes(_zn_link_t *link, const uint8_t *ptr, size_t len);
+int _zn_send_iov(_zn_link_t *link, z_bytes_t *iov, size_t iovcnt);
 int _zn_send_wbuf(_zn_link_t *link, const _z_wbuf_t *wbf);
+int _zn_send_wbuf_range(_zn_link_t *link, const _z_wbuf_t *hdr, _z_wbuf_t *wbf, size_t len);
 int _zn_recv_zbuf(_zn_link_t *link, _z_zbuf_t *zbf);
 int _zn_recv_exact_zbuf(_zn_link_t *link, _z_zbuf_t *zbf, size_t len);
+int _zn_recv_rbuf(_zn_link_t *link, _z_rbuf_t *rbf, size_t len);
+int _zn_send_dgrams(_zn_link_t *link, const z_bytes_t *iov, const size_t *iovcnts, size_t count);
+int _zn_recv_dgrams(_zn_link_t *link, _z_zbuf_t *zbfs, size_t count);
+size_t _zn_wbuf_gather_range(_z_wbuf_t *wbf, size_t len, z_bytes_t *iov);
 
 char *_zn_select_scout_iface(void);
 
@@ -74,6 +106,7 @@ int _zn_close_tcp(_zn_socket_t sock);
 int _zn_read_exact_tcp(_zn_socket_t sock, uint8_t *ptr, size_t len);
 int _zn_read_tcp(_zn_socket_t sock, uint8_t *ptr, size_t len);
 int _zn_send_tcp(_zn_socket_t sock, const uint8_t *ptr, size_t len);
+int _zn_send_vec_tcp(_zn_socket_t sock, const z_bytes_t *iov, size_t iovcnt);
 
 // UDP
 void* _zn_create_endpoint_udp(const char *s_addr, const char *port);
@@ -83,6 +116,21 @@ int _zn_close_udp(_zn_socket_t sock);
 int _zn_read_exact_udp(_zn_socket_t sock, uint8_t *ptr, size_t len);
 int _zn_read_udp(_zn_socket_t sock, uint8_t *ptr, size_t len);
 int _zn_send_udp(_zn_socket_t sock, const uint8_t *ptr, size_t len, void *arg);
+int _zn_send_vec_udp(_zn_socket_t sock, const z_bytes_t *iov, size_t iovcnt, void *arg);
+#if ZN_MMSG_LEN > 1
+int _zn_send_batch_udp(_zn_socket_t sock, const z_bytes_t *iov, const size_t *iovcnts, size_t count, void *arg);
+int _zn_read_batch_udp(_zn_socket_t sock, z_bytes_t *bufs, size_t count);
+#endif
+
+// Poll, the readiness of many sockets waited for at once (epoll on Linux)
+// The maximum number of ready sockets returned by a single wait
+#define _ZN_POLL_EVENTS_MAX 64
+
+int _zn_poll_make(void);
+int _zn_poll_add(int poll, _zn_socket_t sock, void *arg);
+int _zn_poll_remove(int poll, _zn_socket_t sock);
+int _zn_poll_wait(int poll, void **args, size_t count, unsigned int timeout);
+void _zn_poll_free(int poll);
 
 #endif /* _ZENOH_PICO_SYSTEM_PRIVATE_COMMON_H */
 
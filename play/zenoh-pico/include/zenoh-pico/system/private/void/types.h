@@ -24,6 +24,9 @@ typedef void *z_task_attr_t;
 typedef void *z_mutex_t;
 typedef void *z_condvar_t;
 
+// Initializer of the mutexes with static storage, the condition variables are initialized at runtime
+#define Z_MUTEX_INITIALIZER NULL
+
 typedef void *z_clock_t;
 typedef void *z_time_t;
 
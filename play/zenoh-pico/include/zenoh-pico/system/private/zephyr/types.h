@@ -26,6 +26,9 @@ typedef pthread_attr_t z_task_attr_t;
 typedef pthread_mutex_t z_mutex_t;
 typedef pthread_cond_t z_condvar_t;
 
+// Initializer of the mutexes with static storage, the condition variables are initialized at runtime
+#define Z_MUTEX_INITIALIZER PTHREAD_MUTEX_INITIALIZER
+
 typedef struct timespec z_clock_t;
 typedef struct timeval z_time_t;
 
@@ -19,6 +19,8 @@ extern "C" {
 #ifndef _ZENOH_PICO_SYSTEM_TYPES_H
 #define _ZENOH_PICO_SYSTEM_TYPES_H
 
+#include <stddef.h>
+
 #if defined(ZENOH_LINUX) || defined(ZENOH_MACOS)
 #include "zenoh-pico/system/private/unix/types.h"
 #elif defined(ZENOH_ZEPHYR)
@@ -39,6 +41,37 @@ typedef struct
     z_condvar_t can_get;
 } z_mvar_t;
 
+typedef struct
+{
+    volatile size_t seq;
+    void *elem;
+} _z_mpsc_cell_t;
+
+typedef struct
+{
+    _z_mpsc_cell_t *cells;
+    size_t capacity;
+    volatile size_t head;
+    volatile size_t tail;
+    volatile unsigned int prod_waiting;
+    z_mutex_t mtx;
+    z_condvar_t can_push;
+} z_mpsc_t;
+
+typedef struct
+{
+    void **cells;
+    size_t capacity;
+    volatile size_t head;
+    volatile size_t tail;
+    volatile int wakeup;
+    volatile int cons_waiting;
+    volatile int prod_waiting;
+    z_mutex_t mtx;
+    z_condvar_t can_push;
+    z_condvar_t can_pop;
+} z_spsc_t;
+
 #endif /* _ZENOH_PICO_SYSTEM_TYPES_H */
 
 #ifdef __cplusplus
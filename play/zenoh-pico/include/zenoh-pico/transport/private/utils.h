@@ -26,17 +26,87 @@ extern "C" {
 #include "zenoh-pico/protocol/private/msg.h"
 #include "zenoh-pico/protocol/private/msgcodec.h"
 
+/*------------------ Transmission queue ------------------*/
+/**
+ * A zenoh message encoded by a producer and waiting in the transmission queue.
+ */
+typedef struct
+{
+    _z_wbuf_t wbf;
+    zn_reliability_t reliability;
+    zn_priority_t priority;
+    int is_express;
+} _zn_tx_entry_t;
+
+void _zn_tx_entry_free(_zn_tx_entry_t **entry);
+int _zn_send_tx_entry(zn_session_t *zn, _zn_tx_entry_t *entry);
+
+_zn_tx_entry_t *_zn_tx_queue_try_pop(zn_session_t *zn);
+_zn_tx_entry_t *_zn_tx_queue_pop(zn_session_t *zn);
+void _zn_tx_queue_wakeup(zn_session_t *zn);
+
+// The transmissions requested by the timers to the transmit task
+#define _ZN_TX_WORK_KEEP_ALIVE 0x01
+#define _ZN_TX_WORK_FLUSH 0x02
+#define _ZN_TX_WORK_SYNC 0x04
+
+int _zn_tx_work_post(zn_session_t *zn, int work);
+void _zn_tx_work_run(zn_session_t *zn);
+
+/*------------------ Reliability on datagram links ------------------*/
+_zn_reliable_channel_t *_zn_reliable_channel_make(void);
+void _zn_reliable_channel_free(_zn_reliable_channel_t **rc);
+
+void __unsafe_zn_retx_store(zn_session_t *zn, zn_reliability_t reliability, z_zint_t sn, const _z_wbuf_t *hdr, const _z_wbuf_t *wbf, size_t len);
+int _zn_send_sync(zn_session_t *zn);
+int _zn_try_send_sync(zn_session_t *zn);
+
+int _zn_handle_sync(zn_session_t *zn, uint8_t header, const _zn_sync_t *msg);
+int _zn_handle_ack_nack(zn_session_t *zn, uint8_t header, const _zn_ack_nack_t *msg);
+int _zn_handle_reliable_frame(zn_session_t *zn, _zn_transport_message_t *msg);
+int _zn_reliable_frame_accept(zn_session_t *zn, z_zint_t sn);
+int _zn_reliable_channel_deliver(zn_session_t *zn);
+
+/*------------------ Round trip time ------------------*/
+int _zn_send_ping_pong(zn_session_t *zn, z_zint_t hash, int is_ping);
+int _zn_handle_ping_pong(zn_session_t *zn, uint8_t header, const _zn_ping_pong_t *msg);
+
+/*------------------ Timers ------------------*/
+int _zn_lease_renew(zn_session_t *zn);
+uint64_t _zn_keep_alive_timer(void *arg);
+uint64_t _zn_flush_timer(void *arg);
+uint64_t _zn_sync_timer(void *arg);
+
+int _zn_timer_schedule(z_timer_t *timer, uint64_t delay);
+void _zn_timer_cancel(z_timer_t *timer);
+
 /*------------------ SN helpers ------------------*/
 int _zn_sn_precedes(z_zint_t sn_resolution_half, z_zint_t sn_left, z_zint_t sn_right);
 
 /*------------------ Transmission and Reception helpers ------------------*/
 int _zn_send_t_msg(zn_session_t *zn, _zn_transport_message_t *m);
+int _zn_try_send_t_msg(zn_session_t *zn, _zn_transport_message_t *m);
+int __unsafe_zn_send_t_msg(zn_session_t *zn, _zn_transport_message_t *m);
 int _zn_send_z_msg(zn_session_t *zn, _zn_zenoh_message_t *m, zn_reliability_t reliability, zn_congestion_control_t cong_ctrl);
+int _zn_send_z_msg_ext(zn_session_t *zn, _zn_zenoh_message_t *m, zn_reliability_t reliability, zn_congestion_control_t cong_ctrl, int is_express);
+int _zn_send_pre_encoded_z_msg(zn_session_t *zn, const z_bytes_t *header, const uint8_t *payload, size_t length, zn_reliability_t reliability, zn_priority_t priority, zn_congestion_control_t cong_ctrl);
+
+int _zn_flush_batch(zn_session_t *zn);
+int _zn_flush_expired_batch(zn_session_t *zn);
 
+_z_zbuf_t *__unsafe_zn_recv_stream(zn_session_t *zn);
+int __unsafe_zn_fill_stream(zn_session_t *zn);
+_z_zbuf_t *__unsafe_zn_next_stream_batch(zn_session_t *zn);
+_z_zbuf_t *__unsafe_zn_recv_dgram(zn_session_t *zn);
+_z_zbuf_t *__unsafe_zn_recv_batch(zn_session_t *zn);
 _zn_transport_message_p_result_t _zn_recv_t_msg(zn_session_t *zn);
 void _zn_recv_t_msg_na(zn_session_t *zn, _zn_transport_message_p_result_t *r);
 
 int _zn_handle_transport_message(zn_session_t *zn, _zn_transport_message_t *msg);
+int _zn_handle_transport_zbuf(zn_session_t *zn, _z_zbuf_t *zbf);
+int __unsafe_znp_handle_batch(zn_session_t *z, _z_zbuf_t *src, size_t to_read);
+int _zn_handle_frame(zn_session_t *zn, _zn_transport_message_t *msg);
+void _zn_dbuf_reset(_zn_dbuf_t *dbuf);
 
 #endif /* _ZENOH_PICO_TRANSPORT_PRIVATE_UTILS_H */
 
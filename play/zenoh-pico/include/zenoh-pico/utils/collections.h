@@ -70,6 +70,36 @@ void z_i_map_remove(z_i_map_t *map, size_t k);
 
 void z_i_map_free(z_i_map_t *map);
 
+/*-------- Id Map --------*/
+void z_id_map_init(z_id_map_t *map);
+
+size_t z_id_map_len(const z_id_map_t *map);
+
+int z_id_map_insert(z_id_map_t *map, size_t k, void *v);
+void *z_id_map_get(const z_id_map_t *map, size_t k);
+void *z_id_map_remove(z_id_map_t *map, size_t k);
+void *z_id_map_next(const z_id_map_t *map, size_t *pos);
+
+void z_id_map_clear(z_id_map_t *map);
+
+/*-------- Arena --------*/
+z_arena_t z_arena_make(size_t capacity);
+void *z_arena_alloc(z_arena_t *arena, size_t size);
+void z_arena_reset(z_arena_t *arena);
+void z_arena_free(z_arena_t *arena);
+
+/*-------- Timer wheel --------*/
+void z_timer_init(z_timer_t *timer, z_timer_callback_t callback, void *arg);
+int z_timer_is_armed(const z_timer_t *timer);
+
+void z_timer_wheel_init(z_timer_wheel_t *tw, uint64_t now);
+size_t z_timer_wheel_len(const z_timer_wheel_t *tw);
+void z_timer_wheel_add(z_timer_wheel_t *tw, z_timer_t *timer, uint64_t expiry);
+void z_timer_wheel_remove(z_timer_wheel_t *tw, z_timer_t *timer);
+void z_timer_wheel_advance(z_timer_wheel_t *tw, uint64_t now);
+z_timer_t *z_timer_wheel_pop_expired(z_timer_wheel_t *tw);
+uint64_t z_timer_wheel_next(const z_timer_wheel_t *tw);
+
 /*-------- Operations on Bytes --------*/
 z_bytes_t _z_bytes_make(size_t capacity);
 void _z_bytes_init(z_bytes_t *bs, size_t capacity);
@@ -84,6 +114,7 @@ void _z_string_move(z_string_t *dst, z_string_t *src);
 void _z_string_free(z_string_t *str);
 void _z_string_reset(z_string_t *str);
 z_string_t _z_string_from_bytes(z_bytes_t *bs);
+size_t _z_string_hash(const z_string_t *str);
 
 /*-------- Operations on StrArray --------*/
 z_str_array_t _z_str_array_make(size_t len);
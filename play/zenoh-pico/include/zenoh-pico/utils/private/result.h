@@ -32,7 +32,9 @@ typedef enum _z_err_t
 typedef enum _z_res_t
 {
     _z_res_t_OK = 0,
-    _z_res_t_ERR = -1
+    _z_res_t_ERR = -1,
+    _z_res_t_CLOSED = -2,
+    _z_res_t_BUSY = -3
 } _z_res_t;
 
 /*------------------ Internal Zenoh-net Errors ------------------*/
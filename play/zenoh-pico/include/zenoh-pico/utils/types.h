@@ -75,6 +75,99 @@ typedef struct
     size_t len;
 } z_i_map_t;
 
+/**
+ * An entry of an open addressing hashmap with integer keys.
+ *
+ * Members:
+ *   size_t key: the key of the value
+ *   void *value: the value, NULL for the empty slots
+ */
+typedef struct
+{
+    size_t key;
+    void *value;
+} z_id_map_entry_t;
+
+/**
+ * An open addressing hashmap with integer keys, resolving collisions by linear probing.
+ *
+ * Members:
+ *   z_id_map_entry_t *entries: the slots of the hashmap
+ *   size_t capacity: the number of slots, a power of two
+ *   size_t len: the actual length of the hashmap
+ */
+typedef struct
+{
+    z_id_map_entry_t *entries;
+    size_t capacity;
+    size_t len;
+} z_id_map_t;
+
+/**
+ * A bump-pointer allocator whose allocations are all released at once.
+ *
+ * Members:
+ *   uint8_t *buf: The memory the allocations are served from.
+ *   size_t capacity: The size of the memory.
+ *   size_t len: The number of bytes already allocated.
+ *   z_list_t *overflow: The allocations that did not fit, served by the heap.
+ */
+typedef struct
+{
+    uint8_t *buf;
+    size_t capacity;
+    size_t len;
+    z_list_t *overflow;
+} z_arena_t;
+
+#define _Z_TIMER_WHEEL_LEVELS 4
+#define _Z_TIMER_WHEEL_SLOT_BITS 6
+#define _Z_TIMER_WHEEL_SLOTS (1 << _Z_TIMER_WHEEL_SLOT_BITS)
+
+/**
+ * A timer of a timer wheel, embedded in the structure it belongs to.
+ *
+ * Members:
+ *   z_timer_callback_t callback: The function run when the timer expires. It returns the delay
+ *       in ticks before the timer expires again, or ``0`` to disarm it.
+ *   void *arg: The argument of the callback.
+ *   uint64_t expiry: The tick the timer expires at.
+ *   struct z_timer_t **slot: The list of the wheel the timer is linked in, null if disarmed.
+ *   struct z_timer_t *prev: The previous timer of the list.
+ *   struct z_timer_t *next: The next timer of the list.
+ */
+typedef uint64_t (*z_timer_callback_t)(void *arg);
+typedef struct z_timer_t
+{
+    z_timer_callback_t callback;
+    void *arg;
+    uint64_t expiry;
+    struct z_timer_t **slot;
+    struct z_timer_t *prev;
+    struct z_timer_t *next;
+} z_timer_t;
+
+/**
+ * A hierarchical timer wheel. Each level has as many slots as the resolution of the
+ * level above, so that timers are armed and disarmed in constant time and only cascade
+ * down a bounded number of times before expiring.
+ *
+ * Members:
+ *   z_timer_t *slots: The timers of each slot of each level.
+ *   uint64_t occupied: The bitmap of the non empty slots of each level.
+ *   z_timer_t *expired: The timers that expired and have not been popped yet.
+ *   uint64_t now: The current tick of the wheel.
+ *   size_t len: The number of timers armed, including the expired ones.
+ */
+typedef struct
+{
+    z_timer_t *slots[_Z_TIMER_WHEEL_LEVELS][_Z_TIMER_WHEEL_SLOTS];
+    uint64_t occupied[_Z_TIMER_WHEEL_LEVELS];
+    z_timer_t *expired;
+    uint64_t now;
+    size_t len;
+} z_timer_wheel_t;
+
 /*------------------ Zenoh ------------------*/
 /**
  * A string with null terminator.
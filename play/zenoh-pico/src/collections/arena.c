@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2017, 2021 ADLINK Technology Inc.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License 2.0 which is available at
+ * http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+ * which is available at https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+ *
+ * Contributors:
+ *   ADLINK zenoh team, <zenoh@adlink-labs.tech>
+ */
+
+#include <stdlib.h>
+#include "zenoh-pico/utils/collections.h"
+#include "zenoh-pico/utils/private/logging.h"
+
+/*-------- arena --------*/
+// All the allocations are aligned as the largest scalar type found in the decoded values
+#define _Z_ARENA_ALIGN sizeof(uint64_t)
+
+z_arena_t z_arena_make(size_t capacity)
+{
+    z_arena_t arena;
+    arena.buf = (uint8_t *)malloc(capacity);
+    // Without its buffer the arena falls back to the heap for all the allocations
+    arena.capacity = arena.buf != NULL ? capacity : 0;
+    arena.len = 0;
+    arena.overflow = z_list_empty;
+    return arena;
+}
+
+void *z_arena_alloc(z_arena_t *arena, size_t size)
+{
+    size_t start = (arena->len + _Z_ARENA_ALIGN - 1) & ~(_Z_ARENA_ALIGN - 1);
+    if (arena->buf != NULL && start + size <= arena->capacity)
+    {
+        arena->len = start + size;
+        return arena->buf + start;
+    }
+
+    // The arena is full, fall back to the heap until the next reset
+    _Z_DEBUG_VA("Arena of %zu bytes exhausted, allocating %zu bytes on the heap\n", arena->capacity, size);
+    void *ptr = malloc(size);
+    if (ptr == NULL)
+        return NULL;
+    arena->overflow = z_list_cons(arena->overflow, ptr);
+    return ptr;
+}
+
+void z_arena_reset(z_arena_t *arena)
+{
+    arena->len = 0;
+    z_list_free_deep(arena->overflow);
+    arena->overflow = z_list_empty;
+}
+
+void z_arena_free(z_arena_t *arena)
+{
+    z_arena_reset(arena);
+    free(arena->buf);
+    arena->buf = NULL;
+    arena->capacity = 0;
+}
@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2017, 2021 ADLINK Technology Inc.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License 2.0 which is available at
+ * http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+ * which is available at https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+ *
+ * Contributors:
+ *     ADLINK zenoh team, <zenoh@adlink-labs.tech>
+ */
+
+#include <stdlib.h>
+#include "zenoh-pico/utils/collections.h"
+#include "zenoh-pico/utils/types.h"
+
+/*-------- idmap --------*/
+// NOTE: the slots are kept at most half full, so that probing stays short. The values
+//       are never NULL, a NULL value marks an empty slot.
+#define _Z_ID_MAP_MIN_CAPACITY 16
+
+size_t __z_id_map_slot(const z_id_map_t *map, size_t k)
+{
+    // Spread the sequential ids over the slots
+    uint64_t h = (uint64_t)k * 0x9E3779B97F4A7C15ULL;
+    h ^= h >> 32;
+    return (size_t)h & (map->capacity - 1);
+}
+
+void z_id_map_init(z_id_map_t *map)
+{
+    map->entries = NULL;
+    map->capacity = 0;
+    map->len = 0;
+}
+
+size_t z_id_map_len(const z_id_map_t *map)
+{
+    return map->len;
+}
+
+void __z_id_map_place(z_id_map_t *map, size_t k, void *v)
+{
+    size_t i = __z_id_map_slot(map, k);
+    while (map->entries[i].value != NULL)
+        i = (i + 1) & (map->capacity - 1);
+
+    map->entries[i].key = k;
+    map->entries[i].value = v;
+}
+
+void __z_id_map_grow(z_id_map_t *map)
+{
+    z_id_map_entry_t *entries = map->entries;
+    size_t capacity = map->capacity;
+
+    map->capacity = capacity == 0 ? _Z_ID_MAP_MIN_CAPACITY : 2 * capacity;
+    map->entries = (z_id_map_entry_t *)calloc(map->capacity, sizeof(z_id_map_entry_t));
+    for (size_t i = 0; i < capacity; i++)
+    {
+        if (entries[i].value != NULL)
+            __z_id_map_place(map, entries[i].key, entries[i].value);
+    }
+    free(entries);
+}
+
+int z_id_map_insert(z_id_map_t *map, size_t k, void *v)
+{
+    if (z_id_map_get(map, k) != NULL)
+        return -1;
+
+    if (2 * (map->len + 1) > map->capacity)
+        __z_id_map_grow(map);
+
+    __z_id_map_place(map, k, v);
+    map->len++;
+    return 0;
+}
+
+void *z_id_map_get(const z_id_map_t *map, size_t k)
+{
+    if (map->len == 0)
+        return NULL;
+
+    size_t i = __z_id_map_slot(map, k);
+    while (map->entries[i].value != NULL)
+    {
+        if (map->entries[i].key == k)
+            return map->entries[i].value;
+        i = (i + 1) & (map->capacity - 1);
+    }
+
+    return NULL;
+}
+
+void *z_id_map_remove(z_id_map_t *map, size_t k)
+{
+    if (map->len == 0)
+        return NULL;
+
+    size_t mask = map->capacity - 1;
+    size_t i = __z_id_map_slot(map, k);
+    while (map->entries[i].value != NULL && map->entries[i].key != k)
+        i = (i + 1) & mask;
+
+    void *v = map->entries[i].value;
+    if (v == NULL)
+        return NULL;
+
+    // Shift back the entries of the run following the removed one, unless it would move
+    // them before their own slot, so that no lookup stops at the hole
+    size_t j = i;
+    while (1)
+    {
+        j = (j + 1) & mask;
+        if (map->entries[j].value == NULL)
+            break;
+
+        size_t h = __z_id_map_slot(map, map->entries[j].key);
+        if (((j - h) & mask) >= ((j - i) & mask))
+        {
+            map->entries[i] = map->entries[j];
+            i = j;
+        }
+    }
+    map->entries[i].value = NULL;
+    map->len--;
+
+    return v;
+}
+
+void *z_id_map_next(const z_id_map_t *map, size_t *pos)
+{
+    while (*pos < map->capacity)
+    {
+        void *v = map->entries[*pos].value;
+        (*pos)++;
+        if (v != NULL)
+            return v;
+    }
+
+    return NULL;
+}
+
+void z_id_map_clear(z_id_map_t *map)
+{
+    free(map->entries);
+    z_id_map_init(map);
+}
@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2017, 2021 ADLINK Technology Inc.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License 2.0 which is available at
+ * http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+ * which is available at https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+ *
+ * Contributors:
+ *     ADLINK zenoh team, <zenoh@adlink-labs.tech>
+ */
+
+#include <stdint.h>
+#include "zenoh-pico/system/collections.h"
+#include "zenoh-pico/system/common.h"
+
+/*-------- mpsc --------*/
+// NOTE: this is a bounded ring where each cell carries a sequence number telling
+//       whether it is ready to be written (seq == pos) or read (seq == pos + 1),
+//       so that producers only contend on the head index with a CAS.
+z_mpsc_t *z_mpsc_make(size_t capacity)
+{
+    size_t cap = 1;
+    while (cap < capacity)
+        cap <<= 1;
+
+    z_mpsc_t *q = (z_mpsc_t *)malloc(sizeof(z_mpsc_t));
+    if (q == NULL)
+        return NULL;
+    memset(q, 0, sizeof(z_mpsc_t));
+    q->cells = (_z_mpsc_cell_t *)malloc(cap * sizeof(_z_mpsc_cell_t));
+    if (q->cells == NULL)
+    {
+        free(q);
+        return NULL;
+    }
+    for (size_t i = 0; i < cap; i++)
+    {
+        q->cells[i].seq = i;
+        q->cells[i].elem = NULL;
+    }
+    q->capacity = cap;
+
+    z_mutex_init(&q->mtx);
+    z_condvar_init(&q->can_push);
+    return q;
+}
+
+size_t z_mpsc_capacity(const z_mpsc_t *q)
+{
+    return q->capacity;
+}
+
+size_t z_mpsc_len(const z_mpsc_t *q)
+{
+    size_t tail = __atomic_load_n(&q->tail, __ATOMIC_ACQUIRE);
+    size_t head = __atomic_load_n(&q->head, __ATOMIC_ACQUIRE);
+    return head - tail;
+}
+
+int __z_mpsc_enqueue(z_mpsc_t *q, void *e)
+{
+    size_t mask = q->capacity - 1;
+    size_t pos = __atomic_load_n(&q->head, __ATOMIC_RELAXED);
+    _z_mpsc_cell_t *cell;
+    do
+    {
+        cell = &q->cells[pos & mask];
+        size_t seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+        intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+        if (dif == 0)
+        {
+            // The cell is free, try to claim it
+            if (__atomic_compare_exchange_n(&q->head, &pos, pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                break;
+        }
+        else if (dif < 0)
+        {
+            // The consumer has not released this cell yet: the queue is full
+            return -1;
+        }
+        else
+        {
+            // Another producer claimed this cell, retry with the new head
+            pos = __atomic_load_n(&q->head, __ATOMIC_RELAXED);
+        }
+    } while (1);
+
+    cell->elem = e;
+    __atomic_store_n(&cell->seq, pos + 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+void *__z_mpsc_dequeue(z_mpsc_t *q)
+{
+    size_t mask = q->capacity - 1;
+    size_t pos = __atomic_load_n(&q->tail, __ATOMIC_RELAXED);
+    _z_mpsc_cell_t *cell = &q->cells[pos & mask];
+    size_t seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+    if ((intptr_t)seq - (intptr_t)(pos + 1) < 0)
+        return NULL;
+
+    void *e = cell->elem;
+    cell->elem = NULL;
+    __atomic_store_n(&q->tail, pos + 1, __ATOMIC_RELAXED);
+    // Make the cell available to the producers of the next lap
+    __atomic_store_n(&cell->seq, pos + q->capacity, __ATOMIC_RELEASE);
+    return e;
+}
+
+void __z_mpsc_notify_producer(z_mpsc_t *q)
+{
+    // Pairs with the fence in z_mpsc_push: either the producer sees the free cell
+    // or we see that it is parked and wake it up
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&q->prod_waiting, __ATOMIC_RELAXED) > 0)
+    {
+        z_mutex_lock(&q->mtx);
+        z_condvar_signal(&q->can_push);
+        z_mutex_unlock(&q->mtx);
+    }
+}
+
+int z_mpsc_try_push(z_mpsc_t *q, void *e)
+{
+    return __z_mpsc_enqueue(q, e);
+}
+
+void z_mpsc_push(z_mpsc_t *q, void *e)
+{
+    if (__z_mpsc_enqueue(q, e) != 0)
+    {
+        // The queue is full, park until the consumer frees a cell
+        z_mutex_lock(&q->mtx);
+        __atomic_add_fetch(&q->prod_waiting, 1, __ATOMIC_SEQ_CST);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        while (__z_mpsc_enqueue(q, e) != 0)
+            z_condvar_wait(&q->can_push, &q->mtx);
+        __atomic_sub_fetch(&q->prod_waiting, 1, __ATOMIC_SEQ_CST);
+        z_mutex_unlock(&q->mtx);
+    }
+}
+
+void *z_mpsc_try_pop(z_mpsc_t *q)
+{
+    void *e = __z_mpsc_dequeue(q);
+    if (e != NULL)
+        __z_mpsc_notify_producer(q);
+
+    return e;
+}
+
+void z_mpsc_free(z_mpsc_t **q)
+{
+    z_mpsc_t *ptr = *q;
+    z_condvar_free(&ptr->can_push);
+    z_mutex_free(&ptr->mtx);
+    free(ptr->cells);
+    free(ptr);
+    *q = NULL;
+}
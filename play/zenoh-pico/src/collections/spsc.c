@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2017, 2021 ADLINK Technology Inc.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License 2.0 which is available at
+ * http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+ * which is available at https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+ *
+ * Contributors:
+ *     ADLINK zenoh team, <zenoh@adlink-labs.tech>
+ */
+
+#include <stdint.h>
+#include "zenoh-pico/system/collections.h"
+#include "zenoh-pico/system/common.h"
+
+/*-------- spsc --------*/
+// NOTE: the head index is only written by the producer and the tail index only by
+//       the consumer, so that each side publishes its progress with a plain release
+//       store and observes the other side with an acquire load.
+z_spsc_t *z_spsc_make(size_t capacity)
+{
+    size_t cap = 1;
+    while (cap < capacity)
+        cap <<= 1;
+
+    z_spsc_t *q = (z_spsc_t *)malloc(sizeof(z_spsc_t));
+    memset(q, 0, sizeof(z_spsc_t));
+    q->cells = (void **)malloc(cap * sizeof(void *));
+    q->capacity = cap;
+
+    z_mutex_init(&q->mtx);
+    z_condvar_init(&q->can_push);
+    z_condvar_init(&q->can_pop);
+    return q;
+}
+
+size_t z_spsc_capacity(const z_spsc_t *q)
+{
+    return q->capacity;
+}
+
+size_t z_spsc_len(const z_spsc_t *q)
+{
+    size_t tail = __atomic_load_n(&q->tail, __ATOMIC_ACQUIRE);
+    size_t head = __atomic_load_n(&q->head, __ATOMIC_ACQUIRE);
+    return head - tail;
+}
+
+int __z_spsc_enqueue(z_spsc_t *q, void *e)
+{
+    size_t head = __atomic_load_n(&q->head, __ATOMIC_RELAXED);
+    if (head - __atomic_load_n(&q->tail, __ATOMIC_ACQUIRE) == q->capacity)
+        return -1;
+
+    q->cells[head & (q->capacity - 1)] = e;
+    __atomic_store_n(&q->head, head + 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+void *__z_spsc_dequeue(z_spsc_t *q)
+{
+    size_t tail = __atomic_load_n(&q->tail, __ATOMIC_RELAXED);
+    if (tail == __atomic_load_n(&q->head, __ATOMIC_ACQUIRE))
+        return NULL;
+
+    void *e = q->cells[tail & (q->capacity - 1)];
+    __atomic_store_n(&q->tail, tail + 1, __ATOMIC_RELEASE);
+    return e;
+}
+
+void __z_spsc_notify_consumer(z_spsc_t *q)
+{
+    // Pairs with the fence in z_spsc_pop: either the consumer sees the element
+    // or we see that it is parked and wake it up
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&q->cons_waiting, __ATOMIC_RELAXED))
+    {
+        z_mutex_lock(&q->mtx);
+        z_condvar_signal(&q->can_pop);
+        z_mutex_unlock(&q->mtx);
+    }
+}
+
+void __z_spsc_notify_producer(z_spsc_t *q)
+{
+    // Pairs with the fence in z_spsc_push
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&q->prod_waiting, __ATOMIC_RELAXED))
+    {
+        z_mutex_lock(&q->mtx);
+        z_condvar_signal(&q->can_push);
+        z_mutex_unlock(&q->mtx);
+    }
+}
+
+int z_spsc_try_push(z_spsc_t *q, void *e)
+{
+    if (__z_spsc_enqueue(q, e) != 0)
+        return -1;
+
+    __z_spsc_notify_consumer(q);
+    return 0;
+}
+
+void z_spsc_push(z_spsc_t *q, void *e)
+{
+    if (__z_spsc_enqueue(q, e) != 0)
+    {
+        // The queue is full, park until the consumer frees a cell
+        z_mutex_lock(&q->mtx);
+        __atomic_store_n(&q->prod_waiting, 1, __ATOMIC_SEQ_CST);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        while (__z_spsc_enqueue(q, e) != 0)
+            z_condvar_wait(&q->can_push, &q->mtx);
+        __atomic_store_n(&q->prod_waiting, 0, __ATOMIC_SEQ_CST);
+        z_mutex_unlock(&q->mtx);
+    }
+
+    __z_spsc_notify_consumer(q);
+}
+
+void *z_spsc_try_pop(z_spsc_t *q)
+{
+    void *e = __z_spsc_dequeue(q);
+    if (e != NULL)
+        __z_spsc_notify_producer(q);
+
+    return e;
+}
+
+void *z_spsc_pop(z_spsc_t *q)
+{
+    void *e = __z_spsc_dequeue(q);
+    if (e == NULL)
+    {
+        // The queue is empty, park until the producer pushes or a wakeup is requested
+        z_mutex_lock(&q->mtx);
+        __atomic_store_n(&q->cons_waiting, 1, __ATOMIC_SEQ_CST);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        while ((e = __z_spsc_dequeue(q)) == NULL && q->wakeup == 0)
+            z_condvar_wait(&q->can_pop, &q->mtx);
+        __atomic_store_n(&q->cons_waiting, 0, __ATOMIC_SEQ_CST);
+        // A wakeup is only consumed by returning without an element, so that it is not lost
+        if (e == NULL)
+            q->wakeup = 0;
+        z_mutex_unlock(&q->mtx);
+    }
+
+    if (e != NULL)
+        __z_spsc_notify_producer(q);
+
+    return e;
+}
+
+void z_spsc_wakeup(z_spsc_t *q)
+{
+    z_mutex_lock(&q->mtx);
+    q->wakeup = 1;
+    z_condvar_signal(&q->can_pop);
+    z_mutex_unlock(&q->mtx);
+}
+
+void z_spsc_free(z_spsc_t **q)
+{
+    z_spsc_t *ptr = *q;
+    z_condvar_free(&ptr->can_pop);
+    z_condvar_free(&ptr->can_push);
+    z_mutex_free(&ptr->mtx);
+    free(ptr->cells);
+    free(ptr);
+    *q = NULL;
+}
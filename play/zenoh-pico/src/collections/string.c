@@ -79,6 +79,18 @@ z_string_t _z_string_from_bytes(z_bytes_t *bs)
     return s;
 }
 
+size_t _z_string_hash(const z_string_t *str)
+{
+    // FNV-1a
+    size_t h = 2166136261u;
+    for (size_t i = 0; i < str->len; i++)
+    {
+        h ^= (uint8_t)str->val[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
 /*-------- str_array --------*/
 void _z_str_array_init(z_str_array_t *sa, size_t len)
 {
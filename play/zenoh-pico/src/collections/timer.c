@@ -0,0 +1,212 @@
+/*
+ * Copyright (c) 2017, 2021 ADLINK Technology Inc.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License 2.0 which is available at
+ * http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+ * which is available at https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+ *
+ * Contributors:
+ *     ADLINK zenoh team, <zenoh@adlink-labs.tech>
+ */
+
+#include "zenoh-pico/utils/collections.h"
+
+/*-------- timer wheel --------*/
+// NOTE: a timer is kept in the lowest level whose upper bits its expiry shares with
+//       the current tick. Reaching the slot of an upper level cascades its timers
+//       down, until they reach the first level whose slots are one tick wide.
+#define _Z_TIMER_WHEEL_MASK ((uint64_t)_Z_TIMER_WHEEL_SLOTS - 1)
+#define _Z_TIMER_WHEEL_RANGE ((uint64_t)1 << (_Z_TIMER_WHEEL_LEVELS * _Z_TIMER_WHEEL_SLOT_BITS))
+
+void z_timer_init(z_timer_t *timer, z_timer_callback_t callback, void *arg)
+{
+    timer->callback = callback;
+    timer->arg = arg;
+    timer->expiry = 0;
+    timer->slot = NULL;
+    timer->prev = NULL;
+    timer->next = NULL;
+}
+
+int z_timer_is_armed(const z_timer_t *timer)
+{
+    return timer->slot != NULL;
+}
+
+void z_timer_wheel_init(z_timer_wheel_t *tw, uint64_t now)
+{
+    memset(tw, 0, sizeof(z_timer_wheel_t));
+    tw->now = now;
+}
+
+size_t z_timer_wheel_len(const z_timer_wheel_t *tw)
+{
+    return tw->len;
+}
+
+void __z_timer_wheel_link(z_timer_t **slot, z_timer_t *timer)
+{
+    timer->slot = slot;
+    timer->prev = NULL;
+    timer->next = *slot;
+    if (*slot != NULL)
+        (*slot)->prev = timer;
+    *slot = timer;
+}
+
+void __z_timer_wheel_place(z_timer_wheel_t *tw, z_timer_t *timer)
+{
+    // Timers beyond the range of the wheel wait in the last level, they are placed
+    // again with their actual expiry when their slot is reached
+    uint64_t expiry = timer->expiry;
+    if (expiry - tw->now >= _Z_TIMER_WHEEL_RANGE)
+        expiry = tw->now + _Z_TIMER_WHEEL_RANGE - 1;
+
+    size_t level = 0;
+    while (level < _Z_TIMER_WHEEL_LEVELS - 1 && ((expiry ^ tw->now) >> ((level + 1) * _Z_TIMER_WHEEL_SLOT_BITS)) != 0)
+        level++;
+
+    size_t idx = (expiry >> (level * _Z_TIMER_WHEEL_SLOT_BITS)) & _Z_TIMER_WHEEL_MASK;
+    __z_timer_wheel_link(&tw->slots[level][idx], timer);
+    tw->occupied[level] |= (uint64_t)1 << idx;
+}
+
+void z_timer_wheel_add(z_timer_wheel_t *tw, z_timer_t *timer, uint64_t expiry)
+{
+    if (timer->slot != NULL)
+        z_timer_wheel_remove(tw, timer);
+
+    // A timer already due expires at the next tick
+    timer->expiry = expiry > tw->now ? expiry : tw->now + 1;
+    __z_timer_wheel_place(tw, timer);
+    tw->len++;
+}
+
+void z_timer_wheel_remove(z_timer_wheel_t *tw, z_timer_t *timer)
+{
+    if (timer->slot == NULL)
+        return;
+
+    if (timer->prev != NULL)
+        timer->prev->next = timer->next;
+    else
+        *timer->slot = timer->next;
+    if (timer->next != NULL)
+        timer->next->prev = timer->prev;
+
+    if (*timer->slot == NULL && timer->slot != &tw->expired)
+    {
+        size_t idx = (size_t)(timer->slot - &tw->slots[0][0]);
+        tw->occupied[idx / _Z_TIMER_WHEEL_SLOTS] &= ~((uint64_t)1 << (idx % _Z_TIMER_WHEEL_SLOTS));
+    }
+
+    timer->slot = NULL;
+    timer->prev = NULL;
+    timer->next = NULL;
+    tw->len--;
+}
+
+void __z_timer_wheel_cascade(z_timer_wheel_t *tw, size_t level, size_t idx)
+{
+    z_timer_t *timer = tw->slots[level][idx];
+    tw->slots[level][idx] = NULL;
+    tw->occupied[level] &= ~((uint64_t)1 << idx);
+
+    while (timer != NULL)
+    {
+        z_timer_t *next = timer->next;
+        __z_timer_wheel_place(tw, timer);
+        timer = next;
+    }
+}
+
+void __z_timer_wheel_expire(z_timer_wheel_t *tw, size_t idx)
+{
+    z_timer_t *timer = tw->slots[0][idx];
+    tw->slots[0][idx] = NULL;
+    tw->occupied[0] &= ~((uint64_t)1 << idx);
+
+    while (timer != NULL)
+    {
+        z_timer_t *next = timer->next;
+        __z_timer_wheel_link(&tw->expired, timer);
+        timer = next;
+    }
+}
+
+void z_timer_wheel_advance(z_timer_wheel_t *tw, uint64_t now)
+{
+    while (tw->now < now)
+    {
+        int is_empty = 1;
+        for (size_t l = 0; l < _Z_TIMER_WHEEL_LEVELS; l++)
+            is_empty &= tw->occupied[l] == 0;
+        if (is_empty)
+        {
+            tw->now = now;
+            break;
+        }
+
+        // Skip the empty slots of the first level, up to the next cascade
+        uint64_t tick = tw->now + 1;
+        if ((tick & _Z_TIMER_WHEEL_MASK) != 0)
+        {
+            uint64_t idx = tick & _Z_TIMER_WHEEL_MASK;
+            while (idx < _Z_TIMER_WHEEL_SLOTS && (tw->occupied[0] & ((uint64_t)1 << idx)) == 0)
+                idx++;
+            tick = (tick & ~_Z_TIMER_WHEEL_MASK) + idx;
+            if (tick > now)
+            {
+                tw->now = now;
+                break;
+            }
+        }
+        tw->now = tick;
+
+        // Bring down the timers of the upper level slots starting at this tick
+        for (size_t l = 1; l < _Z_TIMER_WHEEL_LEVELS; l++)
+        {
+            size_t shift = l * _Z_TIMER_WHEEL_SLOT_BITS;
+            if ((tick & (((uint64_t)1 << shift) - 1)) != 0)
+                break;
+            __z_timer_wheel_cascade(tw, l, (tick >> shift) & _Z_TIMER_WHEEL_MASK);
+        }
+
+        __z_timer_wheel_expire(tw, tick & _Z_TIMER_WHEEL_MASK);
+    }
+}
+
+z_timer_t *z_timer_wheel_pop_expired(z_timer_wheel_t *tw)
+{
+    z_timer_t *timer = tw->expired;
+    if (timer != NULL)
+        z_timer_wheel_remove(tw, timer);
+    return timer;
+}
+
+uint64_t z_timer_wheel_next(const z_timer_wheel_t *tw)
+{
+    if (tw->expired != NULL)
+        return tw->now;
+
+    // The first occupied slot of the lowest occupied level is reached first. For the
+    // upper levels this is when its timers cascade, not necessarily when they expire.
+    for (size_t l = 0; l < _Z_TIMER_WHEEL_LEVELS; l++)
+    {
+        if (tw->occupied[l] == 0)
+            continue;
+
+        size_t shift = l * _Z_TIMER_WHEEL_SLOT_BITS;
+        uint64_t base = tw->now >> shift;
+        for (uint64_t d = 1; d <= _Z_TIMER_WHEEL_SLOTS; d++)
+        {
+            if (tw->occupied[l] & ((uint64_t)1 << ((base + d) & _Z_TIMER_WHEEL_MASK)))
+                return (base + d) << shift;
+        }
+    }
+
+    return UINT64_MAX;
+}
@@ -12,6 +12,8 @@
  *     ADLINK zenoh team, <zenoh@adlink-labs.tech>
  */
 
+#include <stdlib.h>
+#include <string.h>
 #include "zenoh-pico/system/common.h"
 #include "zenoh-pico/utils/private/logging.h"
 
@@ -24,6 +26,27 @@ int _zn_recv_zbuf(_zn_link_t *link, _z_zbuf_t *zbf)
     return rb;
 }
 
+int _zn_recv_dgrams(_zn_link_t *link, _z_zbuf_t *zbfs, size_t count)
+{
+    if (link->read_batch_f == NULL)
+        return _zn_recv_zbuf(link, &zbfs[0]) < 0 ? -1 : 1;
+
+    z_bytes_t bufs[ZN_MMSG_LEN];
+    if (count > ZN_MMSG_LEN)
+        count = ZN_MMSG_LEN;
+    for (size_t i = 0; i < count; i++)
+    {
+        bufs[i].val = _z_zbuf_get_wptr(&zbfs[i]);
+        bufs[i].len = _z_zbuf_space_left(&zbfs[i]);
+    }
+
+    int n = link->read_batch_f(link, bufs, count);
+    for (int i = 0; i < n; i++)
+        _z_zbuf_set_wpos(&zbfs[i], _z_zbuf_get_wpos(&zbfs[i]) + bufs[i].len);
+
+    return n;
+}
+
 int _zn_recv_exact_zbuf(_zn_link_t *link, _z_zbuf_t *zbf, size_t len)
 {
     int rb = link->read_exact_f(link, _z_zbuf_get_wptr(zbf), len);
@@ -32,27 +55,224 @@ int _zn_recv_exact_zbuf(_zn_link_t *link, _z_zbuf_t *zbf, size_t len)
     return rb;
 }
 
+int _zn_recv_rbuf(_zn_link_t *link, _z_rbuf_t *rbf, size_t len)
+{
+    // The bytes must be contiguous once read
+    if (_z_rbuf_reserve(rbf, len) != 0)
+        return -1;
+
+    // Read as many bytes as available, the ones in excess are kept for the next batches
+    while (_z_rbuf_len(rbf) < len)
+    {
+        int rb = link->read_f(link, _z_rbuf_get_wptr(rbf), _z_rbuf_space_left(rbf));
+        if (rb <= 0)
+            return -1;
+        _z_rbuf_produce(rbf, rb);
+    }
+    return 0;
+}
+
 /*------------------ Socket Send ------------------*/
-int _zn_send_wbuf(_zn_link_t *link, const _z_wbuf_t *wbf)
+int _zn_send_bytes(_zn_link_t *link, const uint8_t *ptr, size_t len)
+{
+    size_t n = len;
+    do
+    {
+        _Z_DEBUG("Sending bytes on socket...");
+        int wb = link->write_f(link, ptr, n);
+        _Z_DEBUG_VA(" sent %d bytes\n", wb);
+        if (wb <= 0)
+        {
+            _Z_DEBUG_VA("Error while sending data over socket [%d]\n", wb);
+            return -1;
+        }
+        n -= wb;
+        ptr += wb;
+    } while (n > 0);
+
+    return 0;
+}
+
+int __zn_send_iov_coalesced(_zn_link_t *link, const z_bytes_t *iov, size_t iovcnt)
+{
+    // Datagram links need the whole message in a single write
+    size_t len = 0;
+    for (size_t i = 0; i < iovcnt; i++)
+        len += iov[i].len;
+
+    uint8_t *buf = (uint8_t *)malloc(len);
+    if (buf == NULL)
+        return -1;
+    size_t pos = 0;
+    for (size_t i = 0; i < iovcnt; i++)
+    {
+        memcpy(buf + pos, iov[i].val, iov[i].len);
+        pos += iov[i].len;
+    }
+
+    int res = _zn_send_bytes(link, buf, len);
+    free(buf);
+
+    return res;
+}
+
+int _zn_send_iov(_zn_link_t *link, z_bytes_t *iov, size_t iovcnt)
+{
+    if (iovcnt == 1)
+        return _zn_send_bytes(link, iov[0].val, iov[0].len);
+
+    if (link->write_vec_f == NULL || (link->is_streamed == 0 && iovcnt > _ZN_IOV_MAX))
+    {
+        if (link->is_streamed == 0)
+            return __zn_send_iov_coalesced(link, iov, iovcnt);
+
+        for (size_t i = 0; i < iovcnt; i++)
+        {
+            if (_zn_send_bytes(link, iov[i].val, iov[i].len) != 0)
+                return -1;
+        }
+        return 0;
+    }
+
+    while (iovcnt > 0)
+    {
+        _Z_DEBUG_VA("Sending %zu buffers on socket...", iovcnt);
+        int wb = link->write_vec_f(link, iov, iovcnt);
+        _Z_DEBUG_VA(" sent %d bytes\n", wb);
+        if (wb <= 0)
+        {
+            _Z_DEBUG_VA("Error while sending data over socket [%d]\n", wb);
+            return -1;
+        }
+
+        // Skip the buffers completely written and move into the partially written one
+        size_t n = wb;
+        while (iovcnt > 0 && n >= iov->len)
+        {
+            n -= iov->len;
+            iov++;
+            iovcnt--;
+        }
+        if (iovcnt > 0)
+        {
+            iov->val += n;
+            iov->len -= n;
+        }
+    }
+
+    return 0;
+}
+
+size_t __zn_wbuf_gather(const _z_wbuf_t *wbf, size_t len, z_bytes_t *iov)
 {
-    for (size_t i = 0; i < _z_wbuf_len_iosli(wbf); i++)
+    // Collect the readable slices, up to len bytes, starting from the read position
+    size_t iovcnt = 0;
+    for (size_t i = wbf->r_idx; i < _z_wbuf_len_iosli(wbf) && len > 0; i++)
     {
         z_bytes_t bs = _z_iosli_to_bytes(_z_wbuf_get_iosli(wbf, i));
-        int n = bs.len;
-        int wb;
-        do
+        if (bs.len == 0)
+            continue;
+
+        if (bs.len > len)
+            bs.len = len;
+        len -= bs.len;
+        iov[iovcnt++] = bs;
+    }
+    return iovcnt;
+}
+
+int __zn_send_wbufs(_zn_link_t *link, const _z_wbuf_t *hdr, const _z_wbuf_t *wbf, size_t len)
+{
+    size_t maxcnt = _z_wbuf_len_iosli(hdr) + (wbf ? _z_wbuf_len_iosli(wbf) : 0);
+
+    z_bytes_t s_iov[_ZN_IOV_MAX];
+    z_bytes_t *iov = maxcnt <= _ZN_IOV_MAX ? s_iov : (z_bytes_t *)malloc(maxcnt * sizeof(z_bytes_t));
+    if (iov == NULL)
+    {
+        _Z_DEBUG("Unable to allocate the buffers of a vectored write\n");
+        return -1;
+    }
+
+    size_t iovcnt = __zn_wbuf_gather(hdr, _z_wbuf_len(hdr), iov);
+    if (wbf)
+        iovcnt += __zn_wbuf_gather(wbf, len, iov + iovcnt);
+
+    int res = iovcnt > 0 ? _zn_send_iov(link, iov, iovcnt) : 0;
+
+    if (iov != s_iov)
+        free(iov);
+
+    return res;
+}
+
+int _zn_send_wbuf(_zn_link_t *link, const _z_wbuf_t *wbf)
+{
+    return __zn_send_wbufs(link, wbf, NULL, 0);
+}
+
+void __zn_wbuf_consume(_z_wbuf_t *wbf, size_t len)
+{
+    while (len > 0)
+    {
+        _z_iosli_t *ios = _z_wbuf_get_iosli(wbf, wbf->r_idx);
+        size_t readable = _z_iosli_readable(ios);
+        size_t n = readable <= len ? readable : len;
+        ios->r_pos += n;
+        len -= n;
+        if (len > 0)
+            wbf->r_idx++;
+    }
+}
+
+int _zn_send_wbuf_range(_zn_link_t *link, const _z_wbuf_t *hdr, _z_wbuf_t *wbf, size_t len)
+{
+    // Send the header and the range in a single vectored write, without copying
+    if (__zn_send_wbufs(link, hdr, wbf, len) != 0)
+        return -1;
+
+    // Consume the range that has been sent
+    __zn_wbuf_consume(wbf, len);
+
+    return 0;
+}
+
+size_t _zn_wbuf_gather_range(_z_wbuf_t *wbf, size_t len, z_bytes_t *iov)
+{
+    // The slices are referenced, they must not be released before being sent
+    size_t iovcnt = __zn_wbuf_gather(wbf, len, iov);
+    __zn_wbuf_consume(wbf, len);
+    return iovcnt;
+}
+
+int _zn_send_dgrams(_zn_link_t *link, const z_bytes_t *iov, const size_t *iovcnts, size_t count)
+{
+    while (count > 0)
+    {
+        int sent;
+        if (link->write_batch_f == NULL)
         {
-            _Z_DEBUG("Sending wbuf on socket...");
-            wb = link->write_f(link, bs.val, n);
-            _Z_DEBUG_VA(" sent %d bytes\n", wb);
-            if (wb <= 0)
+            // Fall back to one write per datagram
+            if (_zn_send_iov(link, (z_bytes_t *)iov, iovcnts[0]) != 0)
+                return -1;
+            sent = 1;
+        }
+        else
+        {
+            _Z_DEBUG_VA("Sending %zu datagrams on socket...", count);
+            sent = link->write_batch_f(link, iov, iovcnts, count);
+            _Z_DEBUG_VA(" sent %d datagrams\n", sent);
+            if (sent <= 0)
             {
-                _Z_DEBUG_VA("Error while sending data over socket [%d]\n", wb);
+                _Z_DEBUG_VA("Error while sending datagrams over socket [%d]\n", sent);
                 return -1;
             }
-            n -= wb;
-            bs.val += bs.len - n;
-        } while (n > 0);
+        }
+
+        // Move past the datagrams sent
+        for (int i = 0; i < sent; i++)
+            iov += iovcnts[i];
+        iovcnts += sent;
+        count -= sent;
     }
 
     return 0;
@@ -13,6 +13,7 @@
  */
 
 #include <netdb.h>
+#include <sys/socket.h>
 
 #include "zenoh-pico/system/common.h"
 #include "zenoh-pico/utils/private/logging.h"
@@ -157,6 +158,25 @@ int _zn_send_tcp(_zn_socket_t sock, const uint8_t *ptr, size_t len)
     return send(sock, ptr, len, 0);
 }
 
+int _zn_send_vec_tcp(_zn_socket_t sock, const z_bytes_t *iov, size_t iovcnt)
+{
+    struct iovec vec[_ZN_IOV_MAX];
+    if (iovcnt > _ZN_IOV_MAX)
+        iovcnt = _ZN_IOV_MAX;
+    for (size_t i = 0; i < iovcnt; i++)
+    {
+        vec[i].iov_base = (void *)iov[i].val;
+        vec[i].iov_len = iov[i].len;
+    }
+
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = vec;
+    msg.msg_iovlen = iovcnt;
+
+    return sendmsg(sock, &msg, 0);
+}
+
 /*------------------ UDP sockets ------------------*/
 _zn_socket_result_t _zn_open_udp(void *arg, const clock_t tout)
 {
@@ -209,3 +229,63 @@ int _zn_send_udp(_zn_socket_t sock, const uint8_t *ptr, size_t len, void *arg)
 
     return sendto(sock, ptr, len, 0, raddr->ai_addr, raddr->ai_addrlen);
 }
+
+int _zn_send_vec_udp(_zn_socket_t sock, const z_bytes_t *iov, size_t iovcnt, void *arg)
+{
+    struct addrinfo *raddr = (struct addrinfo*) arg;
+
+    struct iovec vec[_ZN_IOV_MAX];
+    if (iovcnt > _ZN_IOV_MAX)
+        iovcnt = _ZN_IOV_MAX;
+    for (size_t i = 0; i < iovcnt; i++)
+    {
+        vec[i].iov_base = (void *)iov[i].val;
+        vec[i].iov_len = iov[i].len;
+    }
+
+    // The whole scatter list is sent as a single datagram
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_name = raddr->ai_addr;
+    msg.msg_namelen = raddr->ai_addrlen;
+    msg.msg_iov = vec;
+    msg.msg_iovlen = iovcnt;
+
+    return sendmsg(sock, &msg, 0);
+}
+
+/*------------------ Poll ------------------*/
+int _zn_poll_make(void)
+{
+    // Not supported, the sessions have their own read and lease tasks
+    return -1;
+}
+
+int _zn_poll_add(int poll, _zn_socket_t sock, void *arg)
+{
+    (void)(poll);
+    (void)(sock);
+    (void)(arg);
+    return -1;
+}
+
+int _zn_poll_remove(int poll, _zn_socket_t sock)
+{
+    (void)(poll);
+    (void)(sock);
+    return -1;
+}
+
+int _zn_poll_wait(int poll, void **args, size_t count, unsigned int timeout)
+{
+    (void)(poll);
+    (void)(args);
+    (void)(count);
+    (void)(timeout);
+    return -1;
+}
+
+void _zn_poll_free(int poll)
+{
+    (void)(poll);
+}
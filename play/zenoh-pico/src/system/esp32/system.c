@@ -23,6 +23,11 @@ int z_task_init(pthread_t *task, pthread_attr_t *attr, void *(*fun)(void *), voi
     return pthread_create(task, attr, fun, arg);
 }
 
+int z_task_join(pthread_t *task)
+{
+    return pthread_join(*task, NULL);
+}
+
 /*------------------ Mutex ------------------*/
 int z_mutex_init(pthread_mutex_t *m)
 {
@@ -52,7 +57,13 @@ int z_mutex_unlock(pthread_mutex_t *m)
 /*------------------ Condvar ------------------*/
 int z_condvar_init(pthread_cond_t *cv)
 {
-    return pthread_cond_init(cv, NULL);
+    // Time out on the monotonic clock, not to be affected by the changes of the system time
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    int res = pthread_cond_init(cv, &attr);
+    pthread_condattr_destroy(&attr);
+    return res;
 }
 
 int z_condvar_free(pthread_cond_t *cv)
@@ -70,6 +81,35 @@ int z_condvar_wait(z_condvar_t *cv, z_mutex_t *m)
     return pthread_cond_wait(cv, m);
 }
 
+int z_condvar_timedwait(z_condvar_t *cv, z_mutex_t *m, unsigned int timeout)
+{
+    // The deadline is on the clock the condition variable has been initialized with
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += timeout / 1000;
+    deadline.tv_nsec += (long)(timeout % 1000) * 1000000;
+    if (deadline.tv_nsec >= 1000000000)
+    {
+        deadline.tv_sec += 1;
+        deadline.tv_nsec -= 1000000000;
+    }
+    return pthread_cond_timedwait(cv, m, &deadline);
+}
+
+/*------------------ Memory ------------------*/
+uint8_t *z_mirror_alloc(size_t *capacity)
+{
+    // Mirrored regions require a virtual memory manager
+    (void)(capacity);
+    return NULL;
+}
+
+void z_mirror_free(uint8_t *buf, size_t capacity)
+{
+    (void)(buf);
+    (void)(capacity);
+}
+
 /*------------------ Sleep ------------------*/
 int z_sleep_us(unsigned int time)
 {
@@ -12,9 +12,21 @@
  *   ADLINK zenoh team, <zenoh@adlink-labs.tech>
  */
 
+#if defined(ZENOH_LINUX) && !defined(_GNU_SOURCE)
+// Required for sendmmsg and recvmmsg
+#define _GNU_SOURCE
+#endif
+
 #include <errno.h>
 #include <unistd.h>
 #include <netdb.h>
+#include <sys/uio.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#if defined(ZENOH_LINUX)
+#include <netinet/udp.h>
+#include <sys/epoll.h>
+#endif
 
 #include "zenoh-pico/system/common.h"
 #include "zenoh-pico/utils/private/logging.h"
@@ -164,6 +176,29 @@ int _zn_send_tcp(_zn_socket_t sock, const uint8_t *ptr, size_t len)
 #endif
 }
 
+int _zn_send_vec_tcp(_zn_socket_t sock, const z_bytes_t *iov, size_t iovcnt)
+{
+    struct iovec vec[_ZN_IOV_MAX];
+    if (iovcnt > _ZN_IOV_MAX)
+        iovcnt = _ZN_IOV_MAX;
+    for (size_t i = 0; i < iovcnt; i++)
+    {
+        vec[i].iov_base = (void *)iov[i].val;
+        vec[i].iov_len = iov[i].len;
+    }
+
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = vec;
+    msg.msg_iovlen = iovcnt;
+
+#if defined(ZENOH_LINUX)
+    return sendmsg(sock, &msg, MSG_NOSIGNAL);
+#else
+    return sendmsg(sock, &msg, 0);
+#endif
+}
+
 /*------------------ UDP sockets ------------------*/
 _zn_socket_result_t _zn_open_udp(void *arg, const clock_t tout)
 {
@@ -216,3 +251,226 @@ int _zn_send_udp(_zn_socket_t sock, const uint8_t *ptr, size_t len, void *arg)
 
     return sendto(sock, ptr, len, 0, raddr->ai_addr, raddr->ai_addrlen);
 }
+
+int _zn_send_vec_udp(_zn_socket_t sock, const z_bytes_t *iov, size_t iovcnt, void *arg)
+{
+    struct addrinfo *raddr = (struct addrinfo*) arg;
+
+    struct iovec vec[_ZN_IOV_MAX];
+    if (iovcnt > _ZN_IOV_MAX)
+        iovcnt = _ZN_IOV_MAX;
+    for (size_t i = 0; i < iovcnt; i++)
+    {
+        vec[i].iov_base = (void *)iov[i].val;
+        vec[i].iov_len = iov[i].len;
+    }
+
+    // The whole scatter list is sent as a single datagram
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_name = raddr->ai_addr;
+    msg.msg_namelen = raddr->ai_addrlen;
+    msg.msg_iov = vec;
+    msg.msg_iovlen = iovcnt;
+
+    return sendmsg(sock, &msg, 0);
+}
+
+#if ZN_MMSG_LEN > 1
+#if defined(UDP_SEGMENT)
+// Cleared when the kernel or the interface turns out not to support the UDP segmentation offload.
+// Shared by all the links, hence only accessed atomically.
+static int _zn_udp_gso_enabled = 1;
+
+int __zn_send_gso_udp(_zn_socket_t sock, const z_bytes_t *iov, const size_t *iovcnts, size_t count, struct addrinfo *raddr)
+{
+    // The segmentation offload applies only when all the datagrams but the last one have the
+    // same size, as the fragments of a large message do. The kernel splits them back.
+    size_t iovcnt = 0;
+    size_t seg_len = 0;
+    size_t total = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        size_t len = 0;
+        for (size_t j = 0; j < iovcnts[i]; j++)
+            len += iov[iovcnt + j].len;
+        iovcnt += iovcnts[i];
+        total += len;
+
+        if (i == 0)
+            seg_len = len;
+        else if (len > seg_len || (len < seg_len && i < count - 1))
+            return 0;
+    }
+    if (iovcnt > _ZN_IOV_MAX || total > UINT16_MAX - 64)
+        return 0;
+
+    struct iovec vec[_ZN_IOV_MAX];
+    for (size_t i = 0; i < iovcnt; i++)
+    {
+        vec[i].iov_base = (void *)iov[i].val;
+        vec[i].iov_len = iov[i].len;
+    }
+
+    char control[CMSG_SPACE(sizeof(uint16_t))];
+    memset(control, 0, sizeof(control));
+
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_name = raddr->ai_addr;
+    msg.msg_namelen = raddr->ai_addrlen;
+    msg.msg_iov = vec;
+    msg.msg_iovlen = iovcnt;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    struct cmsghdr *cm = CMSG_FIRSTHDR(&msg);
+    cm->cmsg_level = SOL_UDP;
+    cm->cmsg_type = UDP_SEGMENT;
+    cm->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+    uint16_t gso_size = (uint16_t)seg_len;
+    memcpy(CMSG_DATA(cm), &gso_size, sizeof(gso_size));
+
+    if (sendmsg(sock, &msg, 0) < 0)
+    {
+        // Fall back to one datagram per message, for good if the offload is not supported
+        if (errno == EIO || errno == ENOPROTOOPT || errno == EOPNOTSUPP)
+            __atomic_store_n(&_zn_udp_gso_enabled, 0, __ATOMIC_RELAXED);
+        return 0;
+    }
+
+    return count;
+}
+#endif
+
+int _zn_send_batch_udp(_zn_socket_t sock, const z_bytes_t *iov, const size_t *iovcnts, size_t count, void *arg)
+{
+    struct addrinfo *raddr = (struct addrinfo*) arg;
+
+    if (count > ZN_MMSG_LEN)
+        count = ZN_MMSG_LEN;
+
+#if defined(UDP_SEGMENT)
+    if (count > 1 && __atomic_load_n(&_zn_udp_gso_enabled, __ATOMIC_RELAXED))
+    {
+        int sent = __zn_send_gso_udp(sock, iov, iovcnts, count, raddr);
+        if (sent > 0)
+            return sent;
+    }
+#endif
+
+    // Each datagram keeps its own scatter list
+    struct iovec vec[_ZN_IOV_MAX];
+    struct mmsghdr msgs[ZN_MMSG_LEN];
+    memset(msgs, 0, sizeof(msgs));
+
+    size_t iovcnt = 0;
+    size_t n = 0;
+    for (; n < count && iovcnt + iovcnts[n] <= _ZN_IOV_MAX; n++)
+    {
+        for (size_t j = 0; j < iovcnts[n]; j++)
+        {
+            vec[iovcnt + j].iov_base = (void *)iov[iovcnt + j].val;
+            vec[iovcnt + j].iov_len = iov[iovcnt + j].len;
+        }
+
+        msgs[n].msg_hdr.msg_name = raddr->ai_addr;
+        msgs[n].msg_hdr.msg_namelen = raddr->ai_addrlen;
+        msgs[n].msg_hdr.msg_iov = &vec[iovcnt];
+        msgs[n].msg_hdr.msg_iovlen = iovcnts[n];
+        iovcnt += iovcnts[n];
+    }
+
+    return sendmmsg(sock, msgs, n, 0);
+}
+
+int _zn_read_batch_udp(_zn_socket_t sock, z_bytes_t *bufs, size_t count)
+{
+    if (count > ZN_MMSG_LEN)
+        count = ZN_MMSG_LEN;
+
+    struct iovec vec[ZN_MMSG_LEN];
+    struct mmsghdr msgs[ZN_MMSG_LEN];
+    memset(msgs, 0, sizeof(msgs));
+    for (size_t i = 0; i < count; i++)
+    {
+        vec[i].iov_base = (void *)bufs[i].val;
+        vec[i].iov_len = bufs[i].len;
+        msgs[i].msg_hdr.msg_iov = &vec[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    // Block until the first datagram, then take what is already queued
+    int n = recvmmsg(sock, msgs, count, MSG_WAITFORONE, NULL);
+    for (int i = 0; i < n; i++)
+        bufs[i].len = msgs[i].msg_len;
+
+    return n;
+}
+#endif
+
+/*------------------ Poll ------------------*/
+int _zn_poll_make(void)
+{
+#if defined(ZENOH_LINUX)
+    return epoll_create1(EPOLL_CLOEXEC);
+#else
+    return -1;
+#endif
+}
+
+int _zn_poll_add(int poll, _zn_socket_t sock, void *arg)
+{
+#if defined(ZENOH_LINUX)
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.ptr = arg;
+    return epoll_ctl(poll, EPOLL_CTL_ADD, sock, &ev);
+#else
+    (void)(poll);
+    (void)(sock);
+    (void)(arg);
+    return -1;
+#endif
+}
+
+int _zn_poll_remove(int poll, _zn_socket_t sock)
+{
+#if defined(ZENOH_LINUX)
+    return epoll_ctl(poll, EPOLL_CTL_DEL, sock, NULL);
+#else
+    (void)(poll);
+    (void)(sock);
+    return -1;
+#endif
+}
+
+int _zn_poll_wait(int poll, void **args, size_t count, unsigned int timeout)
+{
+#if defined(ZENOH_LINUX)
+    struct epoll_event evs[_ZN_POLL_EVENTS_MAX];
+    if (count > _ZN_POLL_EVENTS_MAX)
+        count = _ZN_POLL_EVENTS_MAX;
+
+    int n = epoll_wait(poll, evs, (int)count, (int)timeout);
+    if (n < 0)
+        return errno == EINTR ? 0 : -1;
+
+    // Hang ups and errors are reported as readable, the next read fails
+    for (int i = 0; i < n; i++)
+        args[i] = evs[i].data.ptr;
+    return n;
+#else
+    (void)(poll);
+    (void)(args);
+    (void)(count);
+    (void)(timeout);
+    return -1;
+#endif
+}
+
+void _zn_poll_free(int poll)
+{
+    close(poll);
+}
@@ -12,8 +12,16 @@
  *   ADLINK zenoh team, <zenoh@adlink-labs.tech>
  */
 
+#if defined(ZENOH_LINUX) && !defined(_GNU_SOURCE)
+// Required for memfd_create
+#define _GNU_SOURCE
+#endif
+
 #include <sys/time.h>
 #include <unistd.h>
+#if defined(ZENOH_LINUX)
+#include <sys/mman.h>
+#endif
 #include "zenoh-pico/system/common.h"
 
 /*------------------ Task ------------------*/
@@ -24,6 +32,11 @@ int z_task_init(pthread_t *task, pthread_attr_t *attr, void *(*fun)(void *), voi
     return pthread_create(task, attr, fun, arg);
 }
 
+int z_task_join(pthread_t *task)
+{
+    return pthread_join(*task, NULL);
+}
+
 /*------------------ Mutex ------------------*/
 // As defined in "zenoh/private/system.h"
 // typedef pthread_mutex_t z_mutex_t;
@@ -55,9 +68,26 @@ int z_mutex_unlock(pthread_mutex_t *m)
 /*------------------ Condvar ------------------*/
 // As defined in "zenoh/private/system.h"
 // typedef pthread_cond_t z_condvar_t;
+#if defined(ZENOH_MACOS)
+// The condition variables can only wait on the realtime clock
+#define _Z_CONDVAR_CLOCK CLOCK_REALTIME
+#else
+#define _Z_CONDVAR_CLOCK CLOCK_MONOTONIC
+#endif
+
 int z_condvar_init(pthread_cond_t *cv)
 {
+#if defined(ZENOH_MACOS)
     return pthread_cond_init(cv, 0);
+#else
+    // Time out on the monotonic clock, not to be affected by the changes of the system time
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, _Z_CONDVAR_CLOCK);
+    int res = pthread_cond_init(cv, &attr);
+    pthread_condattr_destroy(&attr);
+    return res;
+#endif
 }
 
 int z_condvar_free(pthread_cond_t *cv)
@@ -75,6 +105,71 @@ int z_condvar_wait(z_condvar_t *cv, z_mutex_t *m)
     return pthread_cond_wait(cv, m);
 }
 
+int z_condvar_timedwait(z_condvar_t *cv, z_mutex_t *m, unsigned int timeout)
+{
+    // The deadline is on the clock the condition variable has been initialized with
+    struct timespec deadline;
+    clock_gettime(_Z_CONDVAR_CLOCK, &deadline);
+    deadline.tv_sec += timeout / 1000;
+    deadline.tv_nsec += (long)(timeout % 1000) * 1000000;
+    if (deadline.tv_nsec >= 1000000000)
+    {
+        deadline.tv_sec += 1;
+        deadline.tv_nsec -= 1000000000;
+    }
+    return pthread_cond_timedwait(cv, m, &deadline);
+}
+
+/*------------------ Memory ------------------*/
+uint8_t *z_mirror_alloc(size_t *capacity)
+{
+#if defined(ZENOH_LINUX)
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t len = (*capacity + page - 1) / page * page;
+
+    int fd = memfd_create("zenoh-pico", MFD_CLOEXEC);
+    if (fd < 0)
+        return NULL;
+
+    uint8_t *buf = NULL;
+    if (ftruncate(fd, (off_t)len) == 0)
+    {
+        // Reserve the address space of both mappings, then map the file twice on it
+        uint8_t *addr = (uint8_t *)mmap(NULL, 2 * len, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (addr != MAP_FAILED)
+        {
+            if (mmap(addr, len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED &&
+                mmap(addr + len, len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED)
+            {
+                buf = addr;
+                *capacity = len;
+            }
+            else
+            {
+                munmap(addr, 2 * len);
+            }
+        }
+    }
+
+    // The mappings keep the memory alive
+    close(fd);
+    return buf;
+#else
+    (void)(capacity);
+    return NULL;
+#endif
+}
+
+void z_mirror_free(uint8_t *buf, size_t capacity)
+{
+#if defined(ZENOH_LINUX)
+    munmap(buf, 2 * capacity);
+#else
+    (void)(buf);
+    (void)(capacity);
+#endif
+}
+
 /*------------------ Sleep ------------------*/
 int z_sleep_us(unsigned int time)
 {
@@ -52,6 +52,11 @@ int z_task_init(pthread_t *task, pthread_attr_t *attr, void *(*fun)(void *), voi
     return pthread_create(task, attr, fun, arg);
 }
 
+int z_task_join(pthread_t *task)
+{
+    return pthread_join(*task, NULL);
+}
+
 /*------------------ Mutex ------------------*/
 // As defined in "zenoh/private/system.h"
 typedef pthread_mutex_t z_mutex_t;
@@ -103,6 +108,35 @@ int z_condvar_wait(z_condvar_t *cv, z_mutex_t *m)
     return pthread_cond_wait(cv, m);
 }
 
+int z_condvar_timedwait(z_condvar_t *cv, z_mutex_t *m, unsigned int timeout)
+{
+    // The condition variables wait on the realtime clock by default
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeout / 1000;
+    deadline.tv_nsec += (long)(timeout % 1000) * 1000000;
+    if (deadline.tv_nsec >= 1000000000)
+    {
+        deadline.tv_sec += 1;
+        deadline.tv_nsec -= 1000000000;
+    }
+    return pthread_cond_timedwait(cv, m, &deadline);
+}
+
+/*------------------ Memory ------------------*/
+uint8_t *z_mirror_alloc(size_t *capacity)
+{
+    // Mirrored regions require a virtual memory manager
+    (void)(capacity);
+    return NULL;
+}
+
+void z_mirror_free(uint8_t *buf, size_t capacity)
+{
+    (void)(buf);
+    (void)(capacity);
+}
+
 /*------------------ Sleep ------------------*/
 int z_sleep_us(unsigned int time)
 {
@@ -12,6 +12,8 @@
  *   ADLINK zenoh team, <zenoh@adlink-labs.tech>
  */
 
+#include <stdio.h>
+#include <string.h>
 #include "zenoh-pico/protocol/private/utils.h"
 #include "zenoh-pico/system/common.h"
 #include "zenoh-pico/utils/private/logging.h"
@@ -173,6 +175,24 @@ zn_session_t *zn_open(zn_properties_t *config)
     zn = _zn_session_init();
     zn->link = r_link.value.link;
 
+    // Configure the batching of zenoh messages
+    const char *batching = zn_properties_get(config, ZN_CONFIG_BATCHING_KEY).val;
+    if (batching == NULL)
+        batching = ZN_CONFIG_BATCHING_DEFAULT;
+    zn->batching = strcmp(batching, "true") == 0 || strcmp(batching, "1") == 0;
+
+    const char *linger = zn_properties_get(config, ZN_CONFIG_BATCHING_LINGER_KEY).val;
+    if (linger == NULL)
+        linger = ZN_CONFIG_BATCHING_LINGER_DEFAULT;
+    zn->batch_linger = (unsigned int)strtoul(linger, NULL, 10);
+
+    // Configure the reliable delivery on datagram links, streamed links are already reliable
+    const char *reliability = zn_properties_get(config, ZN_CONFIG_DATAGRAM_RELIABILITY_KEY).val;
+    if (reliability == NULL)
+        reliability = ZN_CONFIG_DATAGRAM_RELIABILITY_DEFAULT;
+    if (zn->link->is_streamed == 0 && (strcmp(reliability, "true") == 0 || strcmp(reliability, "1") == 0))
+        zn->reliable_channel = _zn_reliable_channel_make();
+
     _Z_DEBUG("Sending InitSyn\n");
     // Encode and send the message
     int res = _zn_send_t_msg(zn, &ism);
@@ -388,6 +408,8 @@ void zn_undeclare_resource(zn_session_t *zn, z_zint_t rid)
     if (r)
     {
         _zn_zenoh_message_t z_msg = _zn_zenoh_message_init(_ZN_MID_DECLARE);
+        // The resource has no lane of its own, follow the data written with the default priority
+        z_msg.priority = ZN_PRIORITY_DEFAULT;
 
         // We need to undeclare the resource and the publisher
         unsigned int len = 1;
@@ -412,12 +434,38 @@ void zn_undeclare_resource(zn_session_t *zn, z_zint_t rid)
 }
 
 /*------------------  Publisher Declaration ------------------*/
+void __zn_publisher_encode_header(zn_publisher_t *pub)
+{
+    // Encode once everything that precedes the payload of the published data
+    _zn_zenoh_message_t z_msg = _zn_zenoh_message_init(_ZN_MID_DATA);
+    z_msg.priority = pub->priority;
+    // Eventually mark the message for congestion control
+    if (ZN_CONGESTION_CONTROL_DEFAULT == zn_congestion_control_t_DROP)
+        _ZN_SET_FLAG(z_msg.header, _ZN_FLAG_Z_D);
+    // Set the resource key
+    z_msg.body.data.key = pub->key;
+    _ZN_SET_FLAG(z_msg.header, pub->key.rname ? _ZN_FLAG_Z_K : 0);
+
+    _z_wbuf_t wbf = _z_wbuf_make(ZN_FRAG_BUF_TX_CHUNK, 1);
+    _zn_data_header_encode(&wbf, &z_msg);
+
+    // Keep the encoded header in a contiguous buffer
+    _z_zbuf_t zbf = _z_wbuf_to_zbuf(&wbf);
+    pub->encoded_header = _z_bytes_make(_z_zbuf_len(&zbf));
+    _z_zbuf_read_bytes(&zbf, (uint8_t *)pub->encoded_header.val, 0, pub->encoded_header.len);
+
+    _z_zbuf_free(&zbf);
+    _z_wbuf_free(&wbf);
+}
+
 zn_publisher_t *zn_declare_publisher(zn_session_t *zn, zn_reskey_t reskey)
 {
     zn_publisher_t *pub = (zn_publisher_t *)malloc(sizeof(zn_publisher_t));
     pub->zn = zn;
     pub->key = reskey;
     pub->id = _zn_get_entity_id(zn);
+    pub->priority = ZN_PRIORITY_DEFAULT;
+    __zn_publisher_encode_header(pub);
 
     _zn_zenoh_message_t z_msg = _zn_zenoh_message_init(_ZN_MID_DECLARE);
 
@@ -446,9 +494,33 @@ zn_publisher_t *zn_declare_publisher(zn_session_t *zn, zn_reskey_t reskey)
     return pub;
 }
 
+int zn_publisher_set_priority(zn_publisher_t *pub, zn_priority_t priority)
+{
+    if ((unsigned int)priority >= _ZN_PRIORITIES_NUM)
+    {
+        _Z_DEBUG("Invalid priority for the publisher\n");
+        return -1;
+    }
+
+    pub->priority = priority;
+
+    // The priority decorator is part of the encoded header
+    _z_bytes_free(&pub->encoded_header);
+    __zn_publisher_encode_header(pub);
+
+    return 0;
+}
+
+int zn_publisher_write(zn_publisher_t *pub, const uint8_t *payload, size_t length)
+{
+    return _zn_send_pre_encoded_z_msg(pub->zn, &pub->encoded_header, payload, length, zn_reliability_t_RELIABLE, pub->priority, ZN_CONGESTION_CONTROL_DEFAULT);
+}
+
 void zn_undeclare_publisher(zn_publisher_t *pub)
 {
     _zn_zenoh_message_t z_msg = _zn_zenoh_message_init(_ZN_MID_DECLARE);
+    // Do not overtake the samples of the publisher still queued on its lane
+    z_msg.priority = pub->priority;
 
     // We need to undeclare the publisher
     unsigned int len = 1;
@@ -471,6 +543,7 @@ void zn_undeclare_publisher(zn_publisher_t *pub)
 
     _zn_zenoh_message_free(&z_msg);
 
+    _z_bytes_free(&pub->encoded_header);
     free(pub);
 }
 
@@ -481,6 +554,7 @@ zn_subinfo_t zn_subinfo_default()
     si.reliability = zn_reliability_t_RELIABLE;
     si.mode = zn_submode_t_PUSH;
     si.period = NULL;
+    si.on_full = zn_queue_full_t_BLOCK;
     return si;
 }
 
@@ -568,19 +642,23 @@ void zn_undeclare_subscriber(zn_subscriber_t *sub)
         _zn_zenoh_message_free(&z_msg);
 
         _zn_unregister_subscription(sub->zn, _ZN_IS_LOCAL, s);
+
+        // Wait for the samples already handed over to the dispatcher
+        _zn_dispatch_flush(sub->zn, s->id);
     }
 
     free(sub);
 }
 
 /*------------------ Write ------------------*/
-int zn_write_ext(zn_session_t *zn, zn_reskey_t reskey, const unsigned char *payload, size_t length, uint8_t encoding, uint8_t kind, zn_congestion_control_t cong_ctrl)
+int zn_write_ext(zn_session_t *zn, zn_reskey_t reskey, const unsigned char *payload, size_t length, uint8_t encoding, uint8_t kind, zn_congestion_control_t cong_ctrl, zn_priority_t priority, int express)
 {
     // @TODO: Need to verify that I have declared a publisher with the same resource key.
     //        Then, need to verify there are active subscriptions matching the publisher.
     // @TODO: Need to check subscriptions to determine the right reliability value.
 
     _zn_zenoh_message_t z_msg = _zn_zenoh_message_init(_ZN_MID_DATA);
+    z_msg.priority = priority;
     // Eventually mark the message for congestion control
     if (cong_ctrl == zn_congestion_control_t_DROP)
         _ZN_SET_FLAG(z_msg.header, _ZN_FLAG_Z_D);
@@ -602,7 +680,7 @@ int zn_write_ext(zn_session_t *zn, zn_reskey_t reskey, const unsigned char *payl
     z_msg.body.data.payload.len = length;
     z_msg.body.data.payload.val = (uint8_t *)payload;
 
-    return _zn_send_z_msg(zn, &z_msg, zn_reliability_t_RELIABLE, cong_ctrl);
+    return _zn_send_z_msg_ext(zn, &z_msg, zn_reliability_t_RELIABLE, cong_ctrl, express);
 }
 
 int zn_write(zn_session_t *zn, zn_reskey_t reskey, const uint8_t *payload, size_t length)
@@ -626,6 +704,11 @@ int zn_write(zn_session_t *zn, zn_reskey_t reskey, const uint8_t *payload, size_
     return _zn_send_z_msg(zn, &z_msg, zn_reliability_t_RELIABLE, ZN_CONGESTION_CONTROL_DEFAULT);
 }
 
+int zn_flush(zn_session_t *zn)
+{
+    return _zn_flush_batch(zn);
+}
+
 /*------------------ Query/Queryable ------------------*/
 zn_query_consolidation_t zn_query_consolidation_default(void)
 {
@@ -911,6 +994,87 @@ void zn_send_reply(zn_query_t *query, const char *key, const uint8_t *payload, s
     free(z_msg.reply_context);
 }
 
+/*------------------ Statistics ------------------*/
+zn_stats_t zn_session_stats(zn_session_t *zn)
+{
+    zn_stats_t stats;
+
+    // The counters are concurrently updated by the tasks, load them one by one
+    const z_zint_t *src = (const z_zint_t *)&zn->stats;
+    z_zint_t *dst = (z_zint_t *)&stats;
+    for (size_t i = 0; i < sizeof(zn_stats_t) / sizeof(z_zint_t); i++)
+        dst[i] = __atomic_load_n(&src[i], __ATOMIC_RELAXED);
+
+    return stats;
+}
+
+// The names of the counters, in the same order as the zn_stats_t members
+const char *__zn_stats_names[] = {
+    "tx_bytes",
+    "tx_batches",
+    "tx_msgs",
+    "tx_fragments",
+    "tx_retransmissions",
+    "tx_dropped_congestion",
+    "tx_dropped_errors",
+    "rx_bytes",
+    "rx_batches",
+    "rx_msgs",
+    "rx_fragments",
+    "rx_dropped_out_of_order",
+    "rx_decode_errors",
+    "rx_dropped_oversize",
+    "rx_dropped_dispatch",
+    "reconnects",
+    "tx_lock_contentions",
+    "rtt_samples",
+    "rtt_min",
+    "rtt_avg",
+    "rtt_p99"};
+
+void __zn_stats_query_handler(zn_query_t *query, const void *arg)
+{
+    zn_stats_t stats = zn_session_stats(query->zn);
+    const z_zint_t *counters = (const z_zint_t *)&stats;
+
+    // Reply a JSON object with one member per counter
+    char json[_ZN_STATS_JSON_LEN];
+    size_t len = 0;
+    json[len++] = '{';
+    for (size_t i = 0; i < sizeof(zn_stats_t) / sizeof(z_zint_t); i++)
+    {
+        // Keep room for the closing brace, a truncated member is left out
+        size_t left = _ZN_STATS_JSON_LEN - 1 - len;
+        int n = snprintf(json + len, left, "%s\"%s\":%zu", i == 0 ? "" : ",", __zn_stats_names[i], counters[i]);
+        if (n < 0 || (size_t)n >= left)
+            break;
+        len += (size_t)n;
+    }
+    json[len++] = '}';
+
+    // The key of the queryable is passed as argument
+    zn_send_reply(query, (const char *)arg, (const uint8_t *)json, len);
+}
+
+zn_queryable_t *zn_declare_stats_queryable(zn_session_t *zn)
+{
+    z_string_t pid = _z_string_from_bytes(&zn->local_pid);
+    size_t len = strlen(_ZN_STATS_KEY_PREFIX) + pid.len + strlen(_ZN_STATS_KEY_SUFFIX) + 1;
+    char *rname = (char *)malloc(len);
+    snprintf(rname, len, "%s%s%s", _ZN_STATS_KEY_PREFIX, pid.val, _ZN_STATS_KEY_SUFFIX);
+    _z_string_free(&pid);
+
+    // The queryable owns the resource name, that outlives all the queries it replies to
+    zn_reskey_t reskey;
+    reskey.rid = ZN_RESOURCE_ID_NONE;
+    reskey.rname = rname;
+    zn_queryable_t *qle = zn_declare_queryable(zn, reskey, ZN_QUERYABLE_EVAL, __zn_stats_query_handler, rname);
+    if (qle == NULL)
+        free(rname);
+
+    return qle;
+}
+
 /*------------------ Pull ------------------*/
 int zn_pull(zn_subscriber_t *sub)
 {
@@ -950,19 +1114,70 @@ int zn_pull(zn_subscriber_t *sub)
 /*------------------ Read ------------------*/
 int znp_read(zn_session_t *zn)
 {
-    _zn_transport_message_p_result_t r_s = _zn_recv_t_msg(zn);
-    if (r_s.tag == _z_res_t_OK)
+    z_mutex_lock(&zn->mutex_rx);
+    _z_zbuf_t *zbf = __unsafe_zn_recv_batch(zn);
+    z_mutex_unlock(&zn->mutex_rx);
+
+    if (zbf == NULL)
+        return _z_res_t_ERR;
+
+    // Handle all the session messages of the batch, decoding into the arena released
+    // after the previous batch
+    z_arena_reset(&zn->rx_arena);
+    _z_zbuf_t zbuf = _z_zbuf_view(zbf, _z_zbuf_len(zbf));
+    zbuf.arena = &zn->rx_arena;
+
+    int res = _z_res_t_OK;
+    while (res == _z_res_t_OK && _z_zbuf_len(&zbuf) > 0)
+        res = _zn_handle_transport_zbuf(zn, &zbuf);
+
+    if (res == _z_res_t_OK)
+        _z_zbuf_set_rpos(zbf, _z_zbuf_get_wpos(zbf));
+    else if (res == _z_res_t_CLOSED)
     {
-        int res = _zn_handle_transport_message(zn, r_s.value.transport_message);
-        _zn_transport_message_free(r_s.value.transport_message);
-        _zn_transport_message_p_result_free(&r_s);
-        return res;
+        _zn_session_free(zn);
+        res = _z_res_t_ERR;
     }
-    else
+
+    return res;
+}
+
+/*------------------ Ping ------------------*/
+int zn_ping(zn_session_t *zn, unsigned int timeout)
+{
+    z_mutex_lock(&zn->mutex_inner);
+    // A single ping is outstanding at a time
+    if (zn->ping_hash != 0)
     {
-        _zn_transport_message_p_result_free(&r_s);
-        return _z_res_t_ERR;
+        z_mutex_unlock(&zn->mutex_inner);
+        return -1;
     }
+    zn->ping_count++;
+    if (zn->ping_count == 0)
+        zn->ping_count++;
+    z_zint_t hash = zn->ping_count;
+    zn->ping_hash = hash;
+    zn->ping_rtt = -1;
+    zn->ping_start = z_clock_now();
+    z_clock_t start = zn->ping_start;
+    z_mutex_unlock(&zn->mutex_inner);
+
+    int res = _zn_send_ping_pong(zn, hash, 1);
+
+    z_mutex_lock(&zn->mutex_inner);
+    // The pong is timed when it is handled, by the read task or an event loop
+    while (res == 0 && zn->ping_rtt < 0)
+    {
+        clock_t elapsed = z_clock_elapsed_ms(&start);
+        if (elapsed >= (clock_t)timeout)
+            break;
+        z_condvar_timedwait(&zn->cond_ping, &zn->mutex_inner, timeout - (unsigned int)elapsed);
+    }
+    clock_t rtt = res == 0 ? zn->ping_rtt : -1;
+    zn->ping_hash = 0;
+    z_mutex_unlock(&zn->mutex_inner);
+
+    return rtt < 0 ? -1 : (int)rtt;
 }
 
 /*------------------ Keep Alive ------------------*/
@@ -51,6 +51,13 @@ size_t _zn_f_link_write_all_tcp(void *arg, const uint8_t *ptr, size_t len)
     return _zn_send_tcp(self->sock, ptr, len);
 }
 
+size_t _zn_f_link_write_vec_tcp(void *arg, const z_bytes_t *iov, size_t iovcnt)
+{
+    _zn_link_t *self = (_zn_link_t*)arg;
+
+    return _zn_send_vec_tcp(self->sock, iov, iovcnt);
+}
+
 size_t _zn_f_link_read_tcp(void *arg, uint8_t *ptr, size_t len)
 {
     _zn_link_t *self = (_zn_link_t*)arg;
@@ -86,8 +93,11 @@ _zn_link_t *_zn_new_link_tcp(const char *s_addr, const char *port)
 
     lt->write_f = _zn_f_link_write_tcp;
     lt->write_all_f = _zn_f_link_write_all_tcp;
+    lt->write_vec_f = _zn_f_link_write_vec_tcp;
     lt->read_f = _zn_f_link_read_tcp;
     lt->read_exact_f = _zn_f_link_read_exact_tcp;
+    lt->write_batch_f = NULL;
+    lt->read_batch_f = NULL;
 
     return lt;
 }
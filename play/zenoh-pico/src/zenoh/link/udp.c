@@ -51,6 +51,13 @@ size_t _zn_f_link_write_all_udp(void *arg, const uint8_t *ptr, size_t len)
     return _zn_send_udp(self->sock, ptr, len, self->endpoint);
 }
 
+size_t _zn_f_link_write_vec_udp(void *arg, const z_bytes_t *iov, size_t iovcnt)
+{
+    _zn_link_t *self = (_zn_link_t*)arg;
+
+    return _zn_send_vec_udp(self->sock, iov, iovcnt, self->endpoint);
+}
+
 size_t _zn_f_link_read_udp(void *arg, uint8_t *ptr, size_t len)
 {
     _zn_link_t *self = (_zn_link_t*)arg;
@@ -65,6 +72,22 @@ size_t _zn_f_link_read_exact_udp(void *arg, uint8_t *ptr, size_t len)
     return _zn_read_exact_udp(self->sock, ptr, len);
 }
 
+#if ZN_MMSG_LEN > 1
+size_t _zn_f_link_write_batch_udp(void *arg, const z_bytes_t *iov, const size_t *iovcnts, size_t count)
+{
+    _zn_link_t *self = (_zn_link_t*)arg;
+
+    return _zn_send_batch_udp(self->sock, iov, iovcnts, count, self->endpoint);
+}
+
+size_t _zn_f_link_read_batch_udp(void *arg, z_bytes_t *bufs, size_t count)
+{
+    _zn_link_t *self = (_zn_link_t*)arg;
+
+    return _zn_read_batch_udp(self->sock, bufs, count);
+}
+#endif
+
 size_t _zn_get_link_mtu_udp()
 {
     // TODO
@@ -86,8 +109,16 @@ _zn_link_t *_zn_new_link_udp(const char *s_addr, const char *port)
 
     lt->write_f = _zn_f_link_write_udp;
     lt->write_all_f = _zn_f_link_write_all_udp;
+    lt->write_vec_f = _zn_f_link_write_vec_udp;
     lt->read_f = _zn_f_link_read_udp;
     lt->read_exact_f = _zn_f_link_read_exact_udp;
+#if ZN_MMSG_LEN > 1
+    lt->write_batch_f = _zn_f_link_write_batch_udp;
+    lt->read_batch_f = _zn_f_link_read_batch_udp;
+#else
+    lt->write_batch_f = NULL;
+    lt->read_batch_f = NULL;
+#endif
 
     return lt;
 }
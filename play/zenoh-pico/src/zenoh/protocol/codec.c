@@ -14,6 +14,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "zenoh-pico/protocol/private/codec.h"
 #include "zenoh-pico/utils/private/logging.h"
 #include "zenoh-pico/utils/property.h"
@@ -117,6 +118,21 @@ _z_uint8_result_t _z_uint8_decode(_z_zbuf_t *zbf)
 /*------------------ z_zint ------------------*/
 int _z_zint_encode(_z_wbuf_t *wbf, z_zint_t v)
 {
+    // Encode straight into the buffer when the longest zint fits in its current slice
+    uint8_t *ptr = _z_wbuf_get_wptr(wbf, _Z_ZINT_MAX_LEN);
+    if (ptr != NULL)
+    {
+        size_t len = 0;
+        while (v > 0x7f)
+        {
+            ptr[len++] = (uint8_t)((v & 0x7f) | 0x80);
+            v = v >> 7;
+        }
+        ptr[len++] = (uint8_t)v;
+        _z_wbuf_produce(wbf, len);
+        return 0;
+    }
+
     while (v > 0x7f)
     {
         uint8_t c = (v & 0x7f) | 0x80;
@@ -130,21 +146,36 @@ _z_zint_result_t _z_zint_decode(_z_zbuf_t *zbf)
 {
     _z_zint_result_t r;
     r.tag = _z_res_t_OK;
-    r.value.zint = 0;
 
-    int i = 0;
-    _z_uint8_result_t r_uint8;
-    do
+    // Decode from the raw bytes, bounded by the buffer end or by the longest zint
+    const uint8_t *ptr = _z_zbuf_get_rptr(zbf);
+    size_t len = _z_zbuf_len(zbf);
+    if (len > 0 && ptr[0] <= 0x7f)
     {
-        r_uint8 = _z_uint8_decode(zbf);
-        _ASSURE_RESULT(r_uint8, r, _z_err_t_PARSE_ZINT);
+        // Most zints fit in a single byte
+        r.value.zint = ptr[0];
+        _z_zbuf_set_rpos(zbf, _z_zbuf_get_rpos(zbf) + 1);
+        return r;
+    }
+    if (len > _Z_ZINT_MAX_LEN)
+        len = _Z_ZINT_MAX_LEN;
 
-        _Z_DEBUG_VA("zint c = 0x%x\n", c);
-        r.value.zint = r.value.zint | (((z_zint_t)r_uint8.value.uint8 & 0x7f) << i);
-        _Z_DEBUG_VA("current zint  = %zu\n", r.value.zint);
-        i += 7;
-    } while (r_uint8.value.uint8 > 0x7f);
+    z_zint_t v = 0;
+    for (size_t i = 0; i < len; i++)
+    {
+        v |= ((z_zint_t)ptr[i] & 0x7f) << (7 * i);
+        if (ptr[i] <= 0x7f)
+        {
+            r.value.zint = v;
+            _z_zbuf_set_rpos(zbf, _z_zbuf_get_rpos(zbf) + i + 1);
+            return r;
+        }
+    }
 
+    // The zint is either truncated or longer than a z_zint_t
+    _Z_ERROR("WARNING: Not enough bytes to read\n");
+    r.tag = _z_res_t_ERR;
+    r.value.error = _z_err_t_PARSE_ZINT;
     return r;
 }
 
@@ -157,7 +188,11 @@ int _z_bytes_encode(_z_wbuf_t *wbf, const z_bytes_t *bs)
         // Do not copy, just add a slice to the expandable buffer
         // Only create a new slice if the malloc is cheaper than copying a
         // large amount of data
-        _z_wbuf_add_iosli_from(wbf, bs->val, bs->len);
+        if (wbf->is_zero_copy)
+            // Reference the bytes, they must outlive the buffer
+            _z_wbuf_add_iosli_wrap(wbf, bs->val, bs->len);
+        else
+            _z_wbuf_add_iosli_from(wbf, bs->val, bs->len);
         return 0;
     }
     else
@@ -207,6 +242,35 @@ _z_str_result_t _z_str_decode(_z_zbuf_t *zbf)
 {
     _z_str_result_t r;
     r.tag = _z_res_t_OK;
+    _z_string_result_t r_s = _z_string_decode(zbf);
+    _ASSURE_RESULT(r_s, r, _z_err_t_PARSE_STRING);
+    size_t len = r_s.value.string.len;
+
+    if (zbf->arena != NULL)
+    {
+        // The values decoded from a buffer with an arena live as long as the buffer, borrow
+        // the string from it. Moving it back over the last byte of its length, which has
+        // been read already, makes room for the terminator.
+        z_str_t s = (z_str_t)_z_zbuf_get_rptr(zbf) - len - 1;
+        memmove(s, r_s.value.string.val, len);
+        s[len] = '\0';
+        r.value.str = s;
+        return r;
+    }
+
+    // Allocate space for the string terminator
+    z_str_t s = (z_str_t)malloc(len + 1);
+    memcpy(s, r_s.value.string.val, len);
+    s[len] = '\0';
+    r.value.str = s;
+    return r;
+}
+
+/*------------------ string without null terminator ------------------*/
+_z_string_result_t _z_string_decode(_z_zbuf_t *zbf)
+{
+    _z_string_result_t r;
+    r.tag = _z_res_t_OK;
     _z_zint_result_t vr = _z_zint_decode(zbf);
     _ASSURE_RESULT(vr, r, _z_err_t_PARSE_ZINT);
     size_t len = vr.value.zint;
@@ -218,10 +282,10 @@ _z_str_result_t _z_str_decode(_z_zbuf_t *zbf)
         _Z_ERROR("WARNING: Not enough bytes to read\n");
         return r;
     }
-    // Allocate space for the string terminator
-    z_str_t s = (z_str_t)malloc(len + 1);
-    s[len] = '\0';
-    _z_zbuf_read_bytes(zbf, (uint8_t *)s, 0, len);
-    r.value.str = s;
+
+    // Decode without allocating, the string is a view on the buffer
+    r.value.string.val = (const char *)_z_zbuf_get_rptr(zbf);
+    r.value.string.len = len;
+    _z_zbuf_set_rpos(zbf, _z_zbuf_get_rpos(zbf) + len);
     return r;
 }
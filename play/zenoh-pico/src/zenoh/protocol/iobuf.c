@@ -15,6 +15,7 @@
 #include <assert.h>
 #include <stdlib.h>
 #include "zenoh-pico/protocol/private/iobuf.h"
+#include "zenoh-pico/system/common.h"
 
 /*------------------ IOSli ------------------*/
 _z_iosli_t _z_iosli_wrap(uint8_t *buf, size_t capacity, size_t r_pos, size_t w_pos)
@@ -110,6 +111,7 @@ _z_zbuf_t _z_zbuf_make(size_t capacity)
 {
     _z_zbuf_t zbf;
     zbf.ios = _z_iosli_make(capacity);
+    zbf.arena = NULL;
     return zbf;
 }
 
@@ -118,6 +120,7 @@ _z_zbuf_t _z_zbuf_view(_z_zbuf_t *zbf, size_t length)
     assert(_z_iosli_readable(&zbf->ios) >= length);
     _z_zbuf_t v;
     v.ios = _z_iosli_wrap(_z_zbuf_get_rptr(zbf), length, 0, length);
+    v.arena = zbf->arena;
     return v;
 }
 
@@ -210,6 +213,154 @@ void _z_zbuf_free(_z_zbuf_t *zbf)
     zbf = NULL;
 }
 
+void *_z_zbuf_alloc(_z_zbuf_t *zbf, size_t size)
+{
+    // The values decoded from a buffer with an arena are released all at once by resetting it
+    if (zbf->arena != NULL)
+        return z_arena_alloc(zbf->arena, size);
+    return malloc(size);
+}
+
+int _z_zbuf_append_bytes(_z_zbuf_t *zbf, const uint8_t *bs, size_t length, size_t limit)
+{
+    assert(zbf->ios.is_alloc);
+    size_t w_pos = zbf->ios.w_pos;
+    if (w_pos > limit || length > limit - w_pos)
+        return -1;
+
+    if (length > _z_iosli_writable(&zbf->ios))
+    {
+        // Grow geometrically in a single contiguous allocation, up to the limit
+        size_t capacity = 2 * zbf->ios.capacity;
+        if (capacity < w_pos + length)
+            capacity = w_pos + length;
+        if (capacity > limit)
+            capacity = limit;
+
+        uint8_t *buf = (uint8_t *)realloc(zbf->ios.buf, capacity);
+        if (buf == NULL)
+            return -1;
+        zbf->ios.buf = buf;
+        zbf->ios.capacity = capacity;
+    }
+
+    _z_iosli_write_bytes(&zbf->ios, bs, 0, length);
+    return 0;
+}
+
+/*------------------ RBuf ------------------*/
+_z_rbuf_t _z_rbuf_make(size_t capacity)
+{
+    _z_rbuf_t rbf;
+    rbf.capacity = capacity;
+    rbf.buf = z_mirror_alloc(&rbf.capacity);
+    rbf.is_mirrored = rbf.buf != NULL;
+    if (!rbf.is_mirrored)
+    {
+        rbf.capacity = capacity;
+        rbf.buf = (uint8_t *)malloc(capacity);
+    }
+    rbf.r_pos = 0;
+    rbf.w_pos = 0;
+    return rbf;
+}
+
+size_t _z_rbuf_capacity(const _z_rbuf_t *rbf)
+{
+    return rbf->capacity;
+}
+
+size_t _z_rbuf_len(const _z_rbuf_t *rbf)
+{
+    return rbf->w_pos - rbf->r_pos;
+}
+
+size_t _z_rbuf_space_left(const _z_rbuf_t *rbf)
+{
+    // Only the tail can be written when not mirrored
+    if (rbf->is_mirrored)
+        return rbf->capacity - _z_rbuf_len(rbf);
+    return rbf->capacity - rbf->w_pos;
+}
+
+uint8_t _z_rbuf_read(_z_rbuf_t *rbf)
+{
+    assert(_z_rbuf_len(rbf) > 0);
+    uint8_t b = rbf->buf[rbf->r_pos];
+    _z_rbuf_consume(rbf, 1);
+    return b;
+}
+
+uint8_t _z_rbuf_get(const _z_rbuf_t *rbf, size_t pos)
+{
+    // Peek at the byte pos bytes after the read position without consuming it
+    assert(_z_rbuf_len(rbf) > pos);
+    return rbf->buf[rbf->r_pos + pos];
+}
+
+uint8_t *_z_rbuf_get_wptr(const _z_rbuf_t *rbf)
+{
+    return rbf->buf + rbf->w_pos;
+}
+
+void _z_rbuf_produce(_z_rbuf_t *rbf, size_t len)
+{
+    assert(len <= _z_rbuf_space_left(rbf));
+    rbf->w_pos += len;
+}
+
+void _z_rbuf_consume(_z_rbuf_t *rbf, size_t len)
+{
+    assert(len <= _z_rbuf_len(rbf));
+    rbf->r_pos += len;
+    if (rbf->r_pos == rbf->w_pos)
+    {
+        // Start over from the beginning when empty
+        rbf->r_pos = 0;
+        rbf->w_pos = 0;
+    }
+    else if (rbf->is_mirrored && rbf->r_pos >= rbf->capacity)
+    {
+        // Move back to the first mapping, the bytes are the same
+        rbf->r_pos -= rbf->capacity;
+        rbf->w_pos -= rbf->capacity;
+    }
+}
+
+int _z_rbuf_reserve(_z_rbuf_t *rbf, size_t len)
+{
+    if (len > rbf->capacity)
+        return -1;
+
+    if (!rbf->is_mirrored && rbf->r_pos + len > rbf->capacity)
+    {
+        // Only the bytes of the batch being read are moved, once per lap at most
+        size_t readable = _z_rbuf_len(rbf);
+        memmove(rbf->buf, rbf->buf + rbf->r_pos, readable);
+        rbf->r_pos = 0;
+        rbf->w_pos = readable;
+    }
+    return 0;
+}
+
+_z_zbuf_t _z_rbuf_view(const _z_rbuf_t *rbf, size_t len)
+{
+    assert(_z_rbuf_len(rbf) >= len);
+    _z_zbuf_t v;
+    v.ios = _z_iosli_wrap(rbf->buf + rbf->r_pos, len, 0, len);
+    v.arena = NULL;
+    return v;
+}
+
+void _z_rbuf_free(_z_rbuf_t *rbf)
+{
+    if (rbf->is_mirrored)
+        z_mirror_free(rbf->buf, rbf->capacity);
+    else
+        free(rbf->buf);
+    rbf->buf = NULL;
+}
+
 /*------------------ WBuf ------------------*/
 void _z_wbuf_add_iosli(_z_wbuf_t *wbf, _z_iosli_t *ios)
 {
@@ -236,6 +387,16 @@ void _z_wbuf_add_iosli_from(_z_wbuf_t *wbf, const uint8_t *buf, size_t capacity)
     _z_wbuf_add_iosli(wbf, pios);
 }
 
+void _z_wbuf_add_iosli_wrap(_z_wbuf_t *wbf, const uint8_t *buf, size_t capacity)
+{
+    // NOTE: the slice only references the memory, which must outlive the wbuf
+    _z_iosli_t sios = _z_iosli_wrap((uint8_t *)buf, capacity, 0, capacity);
+    _z_iosli_t *pios = (_z_iosli_t *)malloc(sizeof(_z_iosli_t));
+    memcpy(pios, &sios, sizeof(_z_iosli_t));
+
+    _z_wbuf_add_iosli(wbf, pios);
+}
+
 void _z_wbuf_new_iosli(_z_wbuf_t *wbf, size_t capacity)
 {
     _z_iosli_t sios = _z_iosli_make(capacity);
@@ -271,6 +432,7 @@ _z_wbuf_t _z_wbuf_make(size_t capacity, int is_expandable)
         wbf.ioss = z_vec_make(1);
     }
     wbf.is_expandable = is_expandable;
+    wbf.is_zero_copy = 0;
 
     if (capacity > 0)
     {
@@ -387,6 +549,22 @@ int _z_wbuf_write(_z_wbuf_t *wbf, uint8_t b)
     }
 }
 
+uint8_t *_z_wbuf_get_wptr(const _z_wbuf_t *wbf, size_t len)
+{
+    // Only the current slice is considered, the bytes must be contiguous
+    _z_iosli_t *ios = _z_wbuf_get_iosli(wbf, wbf->w_idx);
+    if (_z_iosli_writable(ios) < len)
+        return NULL;
+    return ios->buf + ios->w_pos;
+}
+
+void _z_wbuf_produce(_z_wbuf_t *wbf, size_t len)
+{
+    _z_iosli_t *ios = _z_wbuf_get_iosli(wbf, wbf->w_idx);
+    assert(len <= _z_iosli_writable(ios));
+    ios->w_pos += len;
+}
+
 int _z_wbuf_write_bytes(_z_wbuf_t *wbf, const uint8_t *bs, size_t offset, size_t length)
 {
     _z_iosli_t *ios = _z_wbuf_get_iosli(wbf, wbf->w_idx);
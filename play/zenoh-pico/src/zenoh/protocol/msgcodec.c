@@ -122,11 +122,12 @@ void _zn_subinfo_decode_na(_z_zbuf_t *zbf, uint8_t header, _zn_subinfo_result_t
 
     uint8_t mode = r_uint8.value.uint8;
     r->value.subinfo.mode = _ZN_MID(mode);
+    r->value.subinfo.on_full = zn_queue_full_t_BLOCK;
     if (_ZN_HAS_FLAG(mode, _ZN_FLAG_Z_P))
     {
         _zn_period_result_t r_tp = _zn_period_decode(zbf);
         _ASSURE_P_RESULT(r_tp, r, _zn_err_t_PARSE_PERIOD)
-        zn_period_t *p_per = (zn_period_t *)malloc(sizeof(zn_period_t));
+        zn_period_t *p_per = (zn_period_t *)_z_zbuf_alloc(zbf, sizeof(zn_period_t));
         memcpy(p_per, &r_tp.value.period, sizeof(zn_period_t));
         r->value.subinfo.period = p_per;
     }
@@ -225,7 +226,8 @@ void _zn_locators_decode_na(_z_zbuf_t *zbf, _zn_locators_result_t *r)
     _ASSURE_P_RESULT(r_n, r, _z_err_t_PARSE_ZINT)
     size_t len = (size_t)r_n.value.zint;
 
-    _z_str_array_init(&r->value.locators, len);
+    r->value.locators.val = (const char *const *)_z_zbuf_alloc(zbf, len * sizeof(z_str_t));
+    r->value.locators.len = len;
 
     // Decode the elements
     for (size_t i = 0; i < len; ++i)
@@ -265,18 +267,18 @@ int _zn_attachment_encode(_z_wbuf_t *wbf, const _zn_attachment_t *msg)
     return _zn_payload_encode(wbf, &msg->payload);
 }
 
-void _zn_attachment_decode_na(_z_zbuf_t *zbf, uint8_t header, _zn_attachment_p_result_t *r)
+void __zn_attachment_decode_na(_z_zbuf_t *zbf, uint8_t header, _zn_attachment_result_t *r)
 {
     _Z_DEBUG("Decoding _ZN_MID_ATTACHMENT\n");
     r->tag = _z_res_t_OK;
 
     // Store the header
-    r->value.attachment->header = header;
+    r->value.attachment.header = header;
 
     // Decode the body
     // WARNING: we do not support sliced content in zenoh-pico.
     //          Return error in case the payload is sliced.
-    if (_ZN_HAS_FLAG(r->value.attachment->header, _ZN_FLAG_T_Z))
+    if (_ZN_HAS_FLAG(r->value.attachment.header, _ZN_FLAG_T_Z))
     {
         r->tag = _z_res_t_ERR;
         r->value.error = _zn_err_t_PARSE_PAYLOAD;
@@ -284,8 +286,18 @@ void _zn_attachment_decode_na(_z_zbuf_t *zbf, uint8_t header, _zn_attachment_p_r
     }
 
     _zn_payload_result_t r_pld = _zn_payload_decode(zbf);
-    _ASSURE_FREE_P_RESULT(r_pld, r, _zn_err_t_PARSE_PAYLOAD, attachment)
-    r->value.attachment->payload = r_pld.value.payload;
+    _ASSURE_P_RESULT(r_pld, r, _zn_err_t_PARSE_PAYLOAD)
+    r->value.attachment.payload = r_pld.value.payload;
+}
+
+void _zn_attachment_decode_na(_z_zbuf_t *zbf, uint8_t header, _zn_attachment_p_result_t *r)
+{
+    r->tag = _z_res_t_OK;
+
+    _zn_attachment_result_t r_at;
+    __zn_attachment_decode_na(zbf, header, &r_at);
+    _ASSURE_FREE_P_RESULT(r_at, r, r_at.value.error, attachment)
+    *r->value.attachment = r_at.value.attachment;
 }
 
 _zn_attachment_p_result_t _zn_attachment_decode(_z_zbuf_t *zbf, uint8_t header)
@@ -320,31 +332,41 @@ int _zn_reply_context_encode(_z_wbuf_t *wbf, const _zn_reply_context_t *msg)
     return 0;
 }
 
-void _zn_reply_context_decode_na(_z_zbuf_t *zbf, uint8_t header, _zn_reply_context_p_result_t *r)
+void __zn_reply_context_decode_na(_z_zbuf_t *zbf, uint8_t header, _zn_reply_context_result_t *r)
 {
     _Z_DEBUG("Decoding _ZN_MID_REPLY_CONTEXT\n");
     r->tag = _z_res_t_OK;
 
     // Store the header
-    r->value.reply_context->header = header;
+    r->value.reply_context.header = header;
 
     // Decode the body
     _z_zint_result_t r_zint = _z_zint_decode(zbf);
-    _ASSURE_FREE_P_RESULT(r_zint, r, _z_err_t_PARSE_ZINT, reply_context);
-    r->value.reply_context->qid = r_zint.value.zint;
+    _ASSURE_P_RESULT(r_zint, r, _z_err_t_PARSE_ZINT);
+    r->value.reply_context.qid = r_zint.value.zint;
 
     if (!_ZN_HAS_FLAG(header, _ZN_FLAG_Z_F))
     {
         r_zint = _z_zint_decode(zbf);
-        _ASSURE_FREE_P_RESULT(r_zint, r, _z_err_t_PARSE_ZINT, reply_context)
-        r->value.reply_context->replier_kind = r_zint.value.zint;
+        _ASSURE_P_RESULT(r_zint, r, _z_err_t_PARSE_ZINT)
+        r->value.reply_context.replier_kind = r_zint.value.zint;
 
         _z_bytes_result_t r_arr = _z_bytes_decode(zbf);
-        _ASSURE_FREE_P_RESULT(r_arr, r, _z_err_t_PARSE_BYTES, reply_context)
-        r->value.reply_context->replier_id = r_arr.value.bytes;
+        _ASSURE_P_RESULT(r_arr, r, _z_err_t_PARSE_BYTES)
+        r->value.reply_context.replier_id = r_arr.value.bytes;
     }
 }
 
+void _zn_reply_context_decode_na(_z_zbuf_t *zbf, uint8_t header, _zn_reply_context_p_result_t *r)
+{
+    r->tag = _z_res_t_OK;
+
+    _zn_reply_context_result_t r_rc;
+    __zn_reply_context_decode_na(zbf, header, &r_rc);
+    _ASSURE_FREE_P_RESULT(r_rc, r, r_rc.value.error, reply_context)
+    *r->value.reply_context = r_rc.value.reply_context;
+}
+
 _zn_reply_context_p_result_t _zn_reply_context_decode(_z_zbuf_t *zbf, uint8_t header)
 {
     _zn_reply_context_p_result_t r;
@@ -828,30 +850,32 @@ void _zn_declare_decode_na(_z_zbuf_t *zbf, _zn_declare_result_t *r)
     _ASSURE_P_RESULT(r_dlen, r, _z_err_t_PARSE_ZINT)
     size_t len = (size_t)r_dlen.value.zint;
 
-    r->value.declare.declarations.val = (_zn_declaration_t *)malloc(len * sizeof(_zn_declaration_t));
+    r->value.declare.declarations.val = (_zn_declaration_t *)_z_zbuf_alloc(zbf, len * sizeof(_zn_declaration_t));
     r->value.declare.declarations.len = len;
 
-    _zn_declaration_result_t *r_decl = (_zn_declaration_result_t *)malloc(sizeof(_zn_declaration_result_t));
+    _zn_declaration_result_t r_decl;
     for (size_t i = 0; i < len; ++i)
     {
-        _zn_declaration_decode_na(zbf, r_decl);
-        if (r_decl->tag == _z_res_t_OK)
+        _zn_declaration_decode_na(zbf, &r_decl);
+        if (r_decl.tag == _z_res_t_OK)
         {
-            r->value.declare.declarations.val[i] = r_decl->value.declaration;
+            r->value.declare.declarations.val[i] = r_decl.value.declaration;
         }
         else
         {
+            // The arena releases the declarations decoded so far when it is reset
+            if (zbf->arena == NULL)
+            {
+                for (size_t j = 0; j < i; ++j)
+                    _zn_declaration_free(&r->value.declare.declarations.val[j]);
+                free(r->value.declare.declarations.val);
+            }
+
             r->tag = _z_res_t_ERR;
             r->value.error = _zn_err_t_PARSE_ZENOH_MESSAGE;
-
-            for (size_t j = 0; j < i; ++j)
-                _zn_declaration_free(&r->value.declare.declarations.val[j]);
-            free(r->value.declare.declarations.val);
-
             break;
         }
     }
-    free(r_decl);
 }
 
 _zn_declare_result_t _zn_declare_decode(_z_zbuf_t *zbf)
@@ -1264,7 +1288,7 @@ void _zn_query_free(_zn_query_t *msg)
 }
 
 /*------------------ Zenoh Message ------------------*/
-int _zn_zenoh_message_encode(_z_wbuf_t *wbf, const _zn_zenoh_message_t *msg)
+int __zn_zenoh_message_header_encode(_z_wbuf_t *wbf, const _zn_zenoh_message_t *msg)
 {
     // Encode the decorators if present
     if (msg->attachment)
@@ -1273,8 +1297,29 @@ int _zn_zenoh_message_encode(_z_wbuf_t *wbf, const _zn_zenoh_message_t *msg)
     if (msg->reply_context)
         _ZN_EC(_zn_reply_context_encode(wbf, msg->reply_context))
 
+    if (msg->priority != ZN_PRIORITY_DEFAULT)
+        _ZN_EC(_z_wbuf_write(wbf, _ZN_MID_PRIORITY | (uint8_t)(msg->priority << 5)))
+
     // Encode the header
-    _ZN_EC(_z_wbuf_write(wbf, msg->header))
+    return _z_wbuf_write(wbf, msg->header);
+}
+
+int _zn_data_header_encode(_z_wbuf_t *wbf, const _zn_zenoh_message_t *msg)
+{
+    _ZN_EC(__zn_zenoh_message_header_encode(wbf, msg))
+
+    // Encode the body up to the payload, its length and bytes follow
+    _ZN_EC(_zn_reskey_encode(wbf, msg->header, &msg->body.data.key))
+
+    if (_ZN_HAS_FLAG(msg->header, _ZN_FLAG_Z_I))
+        _ZN_EC(_zn_data_info_encode(wbf, &msg->body.data.info))
+
+    return 0;
+}
+
+int _zn_zenoh_message_encode(_z_wbuf_t *wbf, const _zn_zenoh_message_t *msg)
+{
+    _ZN_EC(__zn_zenoh_message_header_encode(wbf, msg))
 
     // Encode the body
     uint8_t mid = _ZN_MID(msg->header);
@@ -1297,95 +1342,125 @@ int _zn_zenoh_message_encode(_z_wbuf_t *wbf, const _zn_zenoh_message_t *msg)
     }
 }
 
-void _zn_zenoh_message_decode_na(_z_zbuf_t *zbf, _zn_zenoh_message_p_result_t *r)
+int _zn_zenoh_message_decode_in_place(_z_zbuf_t *zbf, _zn_zenoh_message_t *msg, _zn_reply_context_t *reply_context, _zn_attachment_t *attachment)
 {
-    r->tag = _z_res_t_OK;
-
-    r->value.zenoh_message->attachment = NULL;
-    r->value.zenoh_message->reply_context = NULL;
+    msg->attachment = NULL;
+    msg->reply_context = NULL;
+    msg->priority = ZN_PRIORITY_DEFAULT;
     do
     {
         _z_uint8_result_t r_uint8 = _z_uint8_decode(zbf);
-        _ASSURE_P_RESULT(r_uint8, r, _zn_err_t_PARSE_ZENOH_MESSAGE)
-        r->value.zenoh_message->header = r_uint8.value.uint8;
+        _ZN_EC(r_uint8.tag)
+        msg->header = r_uint8.value.uint8;
 
-        uint8_t mid = _ZN_MID(r->value.zenoh_message->header);
+        uint8_t mid = _ZN_MID(msg->header);
         switch (mid)
         {
         case _ZN_MID_DATA:
         {
-            _zn_data_result_t r_da = _zn_data_decode(zbf, r->value.zenoh_message->header);
-            _ASSURE_P_RESULT(r_da, r, _zn_err_t_PARSE_ZENOH_MESSAGE)
-            r->value.zenoh_message->body.data = r_da.value.data;
-            return;
+            _zn_data_result_t r_da = _zn_data_decode(zbf, msg->header);
+            _ZN_EC(r_da.tag)
+            msg->body.data = r_da.value.data;
+            return 0;
         }
         case _ZN_MID_ATTACHMENT:
         {
-            _zn_attachment_p_result_t r_at = _zn_attachment_decode(zbf, r->value.zenoh_message->header);
-            _ASSURE_P_RESULT(r_at, r, _zn_err_t_PARSE_ZENOH_MESSAGE)
-            r->value.zenoh_message->attachment = r_at.value.attachment;
+            _zn_attachment_result_t r_at;
+            __zn_attachment_decode_na(zbf, msg->header, &r_at);
+            _ZN_EC(r_at.tag)
+            *attachment = r_at.value.attachment;
+            msg->attachment = attachment;
             break;
         }
         case _ZN_MID_REPLY_CONTEXT:
         {
-            _zn_reply_context_p_result_t r_rc = _zn_reply_context_decode(zbf, r->value.zenoh_message->header);
-            _ASSURE_P_RESULT(r_rc, r, _zn_err_t_PARSE_ZENOH_MESSAGE)
-            r->value.zenoh_message->reply_context = r_rc.value.reply_context;
+            _zn_reply_context_result_t r_rc;
+            __zn_reply_context_decode_na(zbf, msg->header, &r_rc);
+            _ZN_EC(r_rc.tag)
+            *reply_context = r_rc.value.reply_context;
+            msg->reply_context = reply_context;
             break;
         }
         case _ZN_MID_DECLARE:
         {
             _zn_declare_result_t r_de = _zn_declare_decode(zbf);
-            _ASSURE_P_RESULT(r_de, r, _zn_err_t_PARSE_ZENOH_MESSAGE)
-            r->value.zenoh_message->body.declare = r_de.value.declare;
-            return;
+            _ZN_EC(r_de.tag)
+            msg->body.declare = r_de.value.declare;
+            return 0;
         }
         case _ZN_MID_QUERY:
         {
-
-            _zn_query_result_t r_qu = _zn_query_decode(zbf, r->value.zenoh_message->header);
-            _ASSURE_P_RESULT(r_qu, r, _zn_err_t_PARSE_ZENOH_MESSAGE)
-            r->value.zenoh_message->body.query = r_qu.value.query;
-            return;
+            _zn_query_result_t r_qu = _zn_query_decode(zbf, msg->header);
+            _ZN_EC(r_qu.tag)
+            msg->body.query = r_qu.value.query;
+            return 0;
         }
         case _ZN_MID_PULL:
         {
-            _zn_pull_result_t r_pu = _zn_pull_decode(zbf, r->value.zenoh_message->header);
-            _ASSURE_P_RESULT(r_pu, r, _zn_err_t_PARSE_ZENOH_MESSAGE)
-            r->value.zenoh_message->body.pull = r_pu.value.pull;
-            return;
+            _zn_pull_result_t r_pu = _zn_pull_decode(zbf, msg->header);
+            _ZN_EC(r_pu.tag)
+            msg->body.pull = r_pu.value.pull;
+            return 0;
         }
         case _ZN_MID_UNIT:
         {
             // Do nothing. Unit messages have no body.
-            return;
+            return 0;
         }
         case _ZN_MID_PRIORITY:
         {
-            // Ignore the priority decorator for the time being since zenoh-pico does not
-            // perform any routing. Hence, priority information does not need to be propagated.
+            // The priority is carried in the flags of the decorator header
+            msg->priority = (zn_priority_t)_ZN_PRIORITY(msg->header);
             continue;
         }
         case _ZN_MID_LINK_STATE_LIST:
         {
-            _zn_zenoh_message_p_result_free(r);
-            r->tag = _z_res_t_ERR;
-            r->value.error = _zn_err_t_PARSE_ZENOH_MESSAGE;
             _Z_ERROR("WARNING: Link state not supported in zenoh-pico\n");
-            return;
+            return -1;
         }
         default:
         {
-            _zn_zenoh_message_p_result_free(r);
-            r->tag = _z_res_t_ERR;
-            r->value.error = _zn_err_t_PARSE_ZENOH_MESSAGE;
             _Z_ERROR("WARNING: Trying to decode zenoh message with unknown ID(%d)\n", mid);
-            return;
+            return -1;
         }
         }
     } while (1);
 }
 
+void __zn_zenoh_message_own_decorators(_z_zbuf_t *zbf, _zn_zenoh_message_t *msg,
+                                       const _zn_reply_context_t *reply_context, const _zn_attachment_t *attachment)
+{
+    // The decoded message owns its decorators
+    if (msg->reply_context)
+    {
+        msg->reply_context = (_zn_reply_context_t *)_z_zbuf_alloc(zbf, sizeof(_zn_reply_context_t));
+        *msg->reply_context = *reply_context;
+    }
+    if (msg->attachment)
+    {
+        msg->attachment = (_zn_attachment_t *)_z_zbuf_alloc(zbf, sizeof(_zn_attachment_t));
+        *msg->attachment = *attachment;
+    }
+}
+
+void _zn_zenoh_message_decode_na(_z_zbuf_t *zbf, _zn_zenoh_message_p_result_t *r)
+{
+    r->tag = _z_res_t_OK;
+
+    _zn_reply_context_t reply_context;
+    _zn_attachment_t attachment;
+    _zn_zenoh_message_t *msg = r->value.zenoh_message;
+    if (_zn_zenoh_message_decode_in_place(zbf, msg, &reply_context, &attachment) != 0)
+    {
+        _zn_zenoh_message_p_result_free(r);
+        r->tag = _z_res_t_ERR;
+        r->value.error = _zn_err_t_PARSE_ZENOH_MESSAGE;
+        return;
+    }
+
+    __zn_zenoh_message_own_decorators(zbf, msg, &reply_context, &attachment);
+}
+
 _zn_zenoh_message_p_result_t _zn_zenoh_message_decode(_z_zbuf_t *zbf)
 {
     _zn_zenoh_message_p_result_t r;
@@ -1407,6 +1482,12 @@ void _zn_zenoh_message_free(_zn_zenoh_message_t *msg)
         free(msg->reply_context);
     }
 
+    _zn_zenoh_message_clear(msg);
+}
+
+void _zn_zenoh_message_clear(_zn_zenoh_message_t *msg)
+{
+    // NOTE: the decorators are not owned by the messages decoded in place
     uint8_t mid = _ZN_MID(msg->header);
     switch (mid)
     {
@@ -2025,6 +2106,57 @@ int _zn_frame_encode(_z_wbuf_t *wbf, uint8_t header, const _zn_frame_t *msg)
     }
 }
 
+void _zn_frame_free(_zn_frame_t *msg, uint8_t header)
+{
+    if (_ZN_HAS_FLAG(header, _ZN_FLAG_T_F))
+    {
+        _zn_payload_free(&msg->payload.fragment);
+    }
+    else
+    {
+        for (size_t i = 0; i < z_vec_len(&msg->payload.messages); ++i)
+            _zn_zenoh_message_free((_zn_zenoh_message_t *)z_vec_get(&msg->payload.messages, i));
+        z_vec_free(&msg->payload.messages);
+    }
+}
+
+void __zn_frame_messages_init(_z_zbuf_t *zbf, z_vec_t *v)
+{
+    if (zbf->arena == NULL)
+    {
+        *v = z_vec_make(_ZENOH_PICO_FRAME_MESSAGES_VEC_SIZE);
+        return;
+    }
+
+    v->_len = 0;
+    v->_val = (void **)z_arena_alloc(zbf->arena, _ZENOH_PICO_FRAME_MESSAGES_VEC_SIZE * sizeof(void *));
+    v->_capacity = v->_val != NULL ? _ZENOH_PICO_FRAME_MESSAGES_VEC_SIZE : 0;
+}
+
+int __zn_frame_messages_append(_z_zbuf_t *zbf, z_vec_t *v, _zn_zenoh_message_t *msg)
+{
+    if (zbf->arena == NULL)
+    {
+        z_vec_append(v, msg);
+        return 0;
+    }
+
+    if (v->_len == v->_capacity)
+    {
+        // The old array is left in the arena, it is released when the arena is reset
+        size_t capacity = v->_capacity > 0 ? 2 * v->_capacity : _ZENOH_PICO_FRAME_MESSAGES_VEC_SIZE;
+        void **val = (void **)z_arena_alloc(zbf->arena, capacity * sizeof(void *));
+        if (val == NULL)
+            return -1;
+        if (v->_len > 0)
+            memcpy(val, v->_val, v->_len * sizeof(void *));
+        v->_val = val;
+        v->_capacity = capacity;
+    }
+    v->_val[v->_len++] = msg;
+    return 0;
+}
+
 void _zn_frame_decode_na(_z_zbuf_t *zbf, uint8_t header, _zn_frame_result_t *r)
 {
     _Z_DEBUG("Decoding _ZN_MID_FRAME\n");
@@ -2047,18 +2179,38 @@ void _zn_frame_decode_na(_z_zbuf_t *zbf, uint8_t header, _zn_frame_result_t *r)
     }
     else
     {
-        r->value.frame.payload.messages = z_vec_make(_ZENOH_PICO_FRAME_MESSAGES_VEC_SIZE);
+        z_vec_t *messages = &r->value.frame.payload.messages;
+        __zn_frame_messages_init(zbf, messages);
         while (_z_zbuf_len(zbf))
         {
+            _zn_reply_context_t reply_context;
+            _zn_attachment_t attachment;
+            _zn_zenoh_message_t *msg = (_zn_zenoh_message_t *)_z_zbuf_alloc(zbf, sizeof(_zn_zenoh_message_t));
+            if (msg == NULL)
+            {
+                if (zbf->arena == NULL)
+                    _zn_frame_free(&r->value.frame, header);
+                r->tag = _z_res_t_ERR;
+                r->value.error = _zn_err_t_IOBUF_NO_SPACE;
+                return;
+            }
+
             // Mark the reading position of the iobfer
             size_t r_pos = _z_zbuf_get_rpos(zbf);
-            _zn_zenoh_message_p_result_t r_zm = _zn_zenoh_message_decode(zbf);
-            if (r_zm.tag == _z_res_t_OK)
+            if (_zn_zenoh_message_decode_in_place(zbf, msg, &reply_context, &attachment) == 0)
             {
-                z_vec_append(&r->value.frame.payload.messages, r_zm.value.zenoh_message);
+                __zn_zenoh_message_own_decorators(zbf, msg, &reply_context, &attachment);
+                if (__zn_frame_messages_append(zbf, messages, msg) != 0)
+                {
+                    r->tag = _z_res_t_ERR;
+                    r->value.error = _zn_err_t_IOBUF_NO_SPACE;
+                    return;
+                }
             }
             else
             {
+                if (zbf->arena == NULL)
+                    free(msg);
                 // Restore the reading position of the iobfer
                 _z_zbuf_set_rpos(zbf, r_pos);
                 return;
@@ -2067,6 +2219,36 @@ void _zn_frame_decode_na(_z_zbuf_t *zbf, uint8_t header, _zn_frame_result_t *r)
     }
 }
 
+int _zn_frame_messages_visit(_z_zbuf_t *zbf, _zn_zenoh_message_visitor_t visitor, void *arg)
+{
+    _Z_DEBUG("Visiting _ZN_MID_FRAME\n");
+
+    while (_z_zbuf_len(zbf))
+    {
+        _zn_zenoh_message_t msg;
+        _zn_reply_context_t reply_context;
+        _zn_attachment_t attachment;
+
+        // Mark the reading position of the iobfer
+        size_t r_pos = _z_zbuf_get_rpos(zbf);
+        if (_zn_zenoh_message_decode_in_place(zbf, &msg, &reply_context, &attachment) != 0)
+        {
+            // Restore the reading position of the iobfer
+            _z_zbuf_set_rpos(zbf, r_pos);
+            return 0;
+        }
+
+        int res = visitor(&msg, arg);
+        // The arena releases the message body when it is reset
+        if (zbf->arena == NULL)
+            _zn_zenoh_message_clear(&msg);
+        if (res != 0)
+            return res;
+    }
+
+    return 0;
+}
+
 _zn_frame_result_t _zn_frame_decode(_z_zbuf_t *zbf, uint8_t header)
 {
     _zn_frame_result_t r;
@@ -2074,20 +2256,6 @@ _zn_frame_result_t _zn_frame_decode(_z_zbuf_t *zbf, uint8_t header)
     return r;
 }
 
-void _zn_frame_free(_zn_frame_t *msg, uint8_t header)
-{
-    if (_ZN_HAS_FLAG(header, _ZN_FLAG_T_F))
-    {
-        _zn_payload_free(&msg->payload.fragment);
-    }
-    else
-    {
-        for (size_t i = 0; i < z_vec_len(&msg->payload.messages); ++i)
-            _zn_zenoh_message_free((_zn_zenoh_message_t *)z_vec_get(&msg->payload.messages, i));
-        z_vec_free(&msg->payload.messages);
-    }
-}
-
 /*------------------ Transport Message ------------------*/
 int _zn_transport_message_encode(_z_wbuf_t *wbf, const _zn_transport_message_t *msg)
 {
@@ -2154,9 +2322,11 @@ void _zn_transport_message_decode_na(_z_zbuf_t *zbf, _zn_transport_message_p_res
         }
         case _ZN_MID_ATTACHMENT:
         {
-            _zn_attachment_p_result_t r_at = _zn_attachment_decode(zbf, r->value.transport_message->header);
+            _zn_attachment_result_t r_at;
+            __zn_attachment_decode_na(zbf, r->value.transport_message->header, &r_at);
             _ASSURE_P_RESULT(r_at, r, _zn_err_t_PARSE_TRANSPORT_MESSAGE)
-            r->value.transport_message->attachment = r_at.value.attachment;
+            r->value.transport_message->attachment = (_zn_attachment_t *)_z_zbuf_alloc(zbf, sizeof(_zn_attachment_t));
+            *r->value.transport_message->attachment = r_at.value.attachment;
             break;
         }
         case _ZN_MID_SCOUT:
@@ -12,55 +12,638 @@
  *   ADLINK zenoh team, <zenoh@adlink-labs.tech>
  */
 
+#include <stdlib.h>
 #include <string.h>
+#include "zenoh-pico/protocol/utils.h"
+#include "zenoh-pico/protocol/private/utils.h"
+#include "zenoh-pico/utils/collections.h"
 
-#define CEND(str) (str[0] == 0 || str[0] == '/')
-#define CWILD(str) (str[0] == '*')
-#define CNEXT(str) str + 1
-#define CEQUAL(str1, str2) str1[0] == str2[0]
-
-#define END(str) (str[0] == 0)
-#define WILD(str) (str[0] == '*' && str[1] == '*' && (str[2] == '/' || str[2] == 0))
-#define NEXT(str) next_chunk(str)
-
-#define DEFINE_INTERSECT(name, end, wild, next, _elemintersect) \
-    int name(const char *c1, const char *c2)                    \
-    {                                                           \
-        if (end(c1) && end(c2))                                 \
-            return 1;                                           \
-        if (wild(c1) && end(c2))                                \
-            return name(next(c1), c2);                          \
-        if (end(c1) && wild(c2))                                \
-            return name(c1, next(c2));                          \
-        if (wild(c1) || wild(c2))                               \
-        {                                                       \
-            if (name(next(c1), c2))                             \
-                return 1;                                       \
-            else                                                \
-                return name(c1, next(c2));                      \
-        }                                                       \
-        if (end(c1) || end(c2))                                 \
-            return 0;                                           \
-        if (_elemintersect(c1, c2))                             \
-            return name(next(c1), next(c2));                    \
-        return 0;                                               \
-    }
-
-DEFINE_INTERSECT(sub_chunk_intersect, CEND, CWILD, CNEXT, CEQUAL)
-
-int chunk_intersect(const char *c1, const char *c2)
-{
-    if ((CEND(c1) && !CEND(c2)) || (!CEND(c1) && CEND(c2)))
+/*------------------ Resource name intersection ------------------*/
+// NOTE: the resource names are split in chunks on '/', the end of the name closing the
+//       chunks, and the chunks are made of characters. At both levels a wildcard matches
+//       any number of tokens: ** any number of chunks, and * any number of characters
+//       within a chunk. The matchers fill the table telling which suffixes of the left
+//       and right tokens intersect, or include one another, from the end of the tokens
+//       backwards. Only two rows of the table are kept, the one of the current left token
+//       and the one of the next. The leading and trailing tokens without wildcards are
+//       compared one to one beforehand, they leave no choice to the table.
+#define _ZN_RNAME_DP_STACK 64
+#define _ZN_RNAME_CHUNKS_STACK 16
+
+#define CWILD(c) ((c) == '*')
+#define CEQUAL(c1, c2) (*(c1) == *(c2))
+
+#define WILD(c) ((c).kind == _ZN_RNAME_CHUNK_ANY)
+
+#define DEFINE_INTERSECT(name, type, wild, _elemintersect)                                                \
+    int name(const type *l, size_t ln, const type *r, size_t rn)                                          \
+    {                                                                                                     \
+        while (ln > 0 && rn > 0 && !wild(l[0]) && !wild(r[0]))                                            \
+        {                                                                                                 \
+            if (!_elemintersect(&l[0], &r[0]))                                                            \
+                return 0;                                                                                 \
+            l++, ln--;                                                                                    \
+            r++, rn--;                                                                                    \
+        }                                                                                                 \
+        while (ln > 0 && rn > 0 && !wild(l[ln - 1]) && !wild(r[rn - 1]))                                  \
+        {                                                                                                 \
+            if (!_elemintersect(&l[ln - 1], &r[rn - 1]))                                                  \
+                return 0;                                                                                 \
+            ln--, rn--;                                                                                   \
+        }                                                                                                 \
+                                                                                                          \
+        uint8_t stack[2 * _ZN_RNAME_DP_STACK];                                                            \
+        uint8_t *rows = rn < _ZN_RNAME_DP_STACK ? stack : (uint8_t *)malloc(2 * (rn + 1));                \
+        uint8_t *next = rows;                                                                             \
+        uint8_t *cur = rows + rn + 1;                                                                     \
+        for (size_t i = ln + 1; i-- > 0;)                                                                 \
+        {                                                                                                 \
+            for (size_t j = rn + 1; j-- > 0;)                                                             \
+            {                                                                                             \
+                int lwild = i < ln && wild(l[i]);                                                         \
+                int rwild = j < rn && wild(r[j]);                                                         \
+                if (i == ln && j == rn)                                                                   \
+                    cur[j] = 1;                                                                           \
+                else if (lwild && j == rn)                                                                \
+                    cur[j] = next[j];                                                                     \
+                else if (i == ln && rwild)                                                                \
+                    cur[j] = cur[j + 1];                                                                  \
+                else if (lwild || rwild)                                                                  \
+                    cur[j] = next[j] | cur[j + 1];                                                        \
+                else if (i == ln || j == rn)                                                              \
+                    cur[j] = 0;                                                                           \
+                else                                                                                      \
+                    cur[j] = next[j + 1] && _elemintersect(&l[i], &r[j]);                                 \
+            }                                                                                             \
+            uint8_t *row = next;                                                                          \
+            next = cur;                                                                                   \
+            cur = row;                                                                                    \
+        }                                                                                                 \
+        int res = next[0];                                                                                \
+        if (rows != stack)                                                                                \
+            free(rows);                                                                                   \
+        return res;                                                                                       \
+    }
+
+#define DEFINE_INCLUDE(name, type, wild, _elemincludes)                                                   \
+    int name(const type *l, size_t ln, const type *r, size_t rn)                                          \
+    {                                                                                                     \
+        while (ln > 0 && !wild(l[0]))                                                                     \
+        {                                                                                                 \
+            if (rn == 0 || wild(r[0]) || !_elemincludes(&l[0], &r[0]))                                    \
+                return 0;                                                                                 \
+            l++, ln--;                                                                                    \
+            r++, rn--;                                                                                    \
+        }                                                                                                 \
+        while (ln > 0 && !wild(l[ln - 1]))                                                                \
+        {                                                                                                 \
+            if (rn == 0 || wild(r[rn - 1]) || !_elemincludes(&l[ln - 1], &r[rn - 1]))                     \
+                return 0;                                                                                 \
+            ln--, rn--;                                                                                   \
+        }                                                                                                 \
+                                                                                                          \
+        uint8_t stack[2 * _ZN_RNAME_DP_STACK];                                                            \
+        uint8_t *rows = rn < _ZN_RNAME_DP_STACK ? stack : (uint8_t *)malloc(2 * (rn + 1));                \
+        uint8_t *next = rows;                                                                             \
+        uint8_t *cur = rows + rn + 1;                                                                     \
+        for (size_t i = ln + 1; i-- > 0;)                                                                 \
+        {                                                                                                 \
+            for (size_t j = rn + 1; j-- > 0;)                                                             \
+            {                                                                                             \
+                if (i == ln && j == rn)                                                                   \
+                    cur[j] = 1;                                                                           \
+                else if (i < ln && wild(l[i]))                                                            \
+                    cur[j] = next[j] | (j < rn && cur[j + 1]);                                            \
+                else if (i == ln || j == rn || wild(r[j]))                                                \
+                    cur[j] = 0;                                                                           \
+                else                                                                                      \
+                    cur[j] = next[j + 1] && _elemincludes(&l[i], &r[j]);                                  \
+            }                                                                                             \
+            uint8_t *row = next;                                                                          \
+            next = cur;                                                                                   \
+            cur = row;                                                                                    \
+        }                                                                                                 \
+        int res = next[0];                                                                                \
+        if (rows != stack)                                                                                \
+            free(rows);                                                                                   \
+        return res;                                                                                       \
+    }
+
+DEFINE_INTERSECT(__zn_rname_pattern_intersect, char, CWILD, CEQUAL)
+DEFINE_INCLUDE(__zn_rname_pattern_include, char, CWILD, CEQUAL)
+
+int __zn_rname_chunk_kind(const char *chunk, size_t len)
+{
+    if (len == 2 && chunk[0] == '*' && chunk[1] == '*')
+        return _ZN_RNAME_CHUNK_ANY;
+    if (memchr(chunk, '*', len) != NULL)
+        return _ZN_RNAME_CHUNK_PATTERN;
+    return _ZN_RNAME_CHUNK_LITERAL;
+}
+
+int __zn_rname_chunk_intersect(const _zn_rname_chunk_t *l, const _zn_rname_chunk_t *r)
+{
+    if (l->kind == _ZN_RNAME_CHUNK_LITERAL && r->kind == _ZN_RNAME_CHUNK_LITERAL)
+        return l->len == r->len && memcmp(l->val, r->val, l->len) == 0;
+
+    // A wildcard does not match an empty chunk
+    if ((l->len == 0) != (r->len == 0))
         return 0;
-    return sub_chunk_intersect(c1, c2);
+    return __zn_rname_pattern_intersect(l->val, l->len, r->val, r->len);
+}
+
+int __zn_rname_chunk_include(const _zn_rname_chunk_t *l, const _zn_rname_chunk_t *r)
+{
+    if (l->kind == _ZN_RNAME_CHUNK_LITERAL)
+        return r->kind == _ZN_RNAME_CHUNK_LITERAL && l->len == r->len && memcmp(l->val, r->val, l->len) == 0;
+
+    if ((l->len == 0) != (r->len == 0))
+        return 0;
+    return __zn_rname_pattern_include(l->val, l->len, r->val, r->len);
+}
+
+DEFINE_INTERSECT(__zn_rname_chunks_intersect, _zn_rname_chunk_t, WILD, __zn_rname_chunk_intersect)
+DEFINE_INCLUDE(__zn_rname_chunks_include, _zn_rname_chunk_t, WILD, __zn_rname_chunk_include)
+
+size_t __zn_rname_split(const char *rname, size_t len, _zn_rname_chunk_t *chunks, size_t capacity)
+{
+    // Only the first chunks fitting in the capacity are stored, all of them are counted
+    const char *end = rname + len;
+    size_t n = 0;
+    while (rname < end)
+    {
+        // Let memchr look for the separator, libc scans a word or a vector at a time
+        const char *sep = (const char *)memchr(rname, '/', (size_t)(end - rname));
+        size_t clen = sep != NULL ? (size_t)(sep - rname) : (size_t)(end - rname);
+        if (n < capacity)
+        {
+            chunks[n].val = rname;
+            chunks[n].len = clen;
+            chunks[n].kind = (uint8_t)__zn_rname_chunk_kind(rname, clen);
+        }
+        n++;
+        rname = sep != NULL ? sep + 1 : end;
+    }
+
+    return n;
+}
+
+_zn_rname_chunk_t *__zn_rname_split_alloc(const char *rname, _zn_rname_chunk_t *stack, size_t *len)
+{
+    size_t rlen = strlen(rname);
+    *len = __zn_rname_split(rname, rlen, stack, _ZN_RNAME_CHUNKS_STACK);
+    if (*len <= _ZN_RNAME_CHUNKS_STACK)
+        return stack;
+
+    _zn_rname_chunk_t *chunks = (_zn_rname_chunk_t *)malloc(*len * sizeof(_zn_rname_chunk_t));
+    __zn_rname_split(rname, rlen, chunks, *len);
+    return chunks;
+}
+
+int zn_rname_intersect(const char *left, const char *right)
+{
+    _zn_rname_chunk_t lstack[_ZN_RNAME_CHUNKS_STACK];
+    _zn_rname_chunk_t rstack[_ZN_RNAME_CHUNKS_STACK];
+    size_t ln, rn;
+    _zn_rname_chunk_t *l = __zn_rname_split_alloc(left, lstack, &ln);
+    _zn_rname_chunk_t *r = __zn_rname_split_alloc(right, rstack, &rn);
+
+    int res = __zn_rname_chunks_intersect(l, ln, r, rn);
+
+    if (l != lstack)
+        free(l);
+    if (r != rstack)
+        free(r);
+    return res;
+}
+
+int zn_rname_includes(const char *left, const char *right)
+{
+    _zn_rname_chunk_t lstack[_ZN_RNAME_CHUNKS_STACK];
+    _zn_rname_chunk_t rstack[_ZN_RNAME_CHUNKS_STACK];
+    size_t ln, rn;
+    _zn_rname_chunk_t *l = __zn_rname_split_alloc(left, lstack, &ln);
+    _zn_rname_chunk_t *r = __zn_rname_split_alloc(right, rstack, &rn);
+
+    int res = __zn_rname_chunks_include(l, ln, r, rn);
+
+    if (l != lstack)
+        free(l);
+    if (r != rstack)
+        free(r);
+    return res;
+}
+
+/*------------------ Key expression ------------------*/
+zn_keyexpr_t zn_keyexpr_compile(const char *rname)
+{
+    zn_keyexpr_t keyexpr;
+    size_t len = strlen(rname);
+    keyexpr.val = (char *)malloc(len + 1);
+    memcpy(keyexpr.val, rname, len + 1);
+
+    keyexpr.len = __zn_rname_split(keyexpr.val, len, NULL, 0);
+    keyexpr.chunks = (_zn_rname_chunk_t *)malloc(keyexpr.len * sizeof(_zn_rname_chunk_t));
+    __zn_rname_split(keyexpr.val, len, keyexpr.chunks, keyexpr.len);
+    return keyexpr;
+}
+
+int zn_keyexpr_intersect(const zn_keyexpr_t *left, const zn_keyexpr_t *right)
+{
+    return __zn_rname_chunks_intersect(left->chunks, left->len, right->chunks, right->len);
+}
+
+int zn_keyexpr_includes(const zn_keyexpr_t *left, const zn_keyexpr_t *right)
+{
+    return __zn_rname_chunks_include(left->chunks, left->len, right->chunks, right->len);
+}
+
+void zn_keyexpr_free(zn_keyexpr_t *keyexpr)
+{
+    free(keyexpr->val);
+    free(keyexpr->chunks);
+    keyexpr->val = NULL;
+    keyexpr->chunks = NULL;
+    keyexpr->len = 0;
+}
+
+/*------------------ Resource name trie ------------------*/
+// NOTE: the lookup walks the chunks of the resource name like the intersection does,
+//       the children of a node without wildcards being found by hash rather than compared
+//       one by one.
+
+size_t __zn_rname_chunk_len(const char *chunk)
+{
+    size_t len = 0;
+    while (chunk[len] != 0 && chunk[len] != '/')
+        len++;
+    return len;
+}
+
+const char *__zn_rname_chunk_next(const char *chunk, size_t len)
+{
+    return chunk[len] == '/' ? chunk + len + 1 : chunk + len;
+}
+
+size_t __zn_rname_chunk_hash(const char *chunk, size_t len)
+{
+    z_string_t str;
+    str.val = chunk;
+    str.len = len;
+    return _z_string_hash(&str);
+}
+
+int __zn_rname_chunk_equal(const _zn_rname_chunk_t *node_chunk, const char *chunk, size_t len)
+{
+    return node_chunk->len == len && memcmp(node_chunk->val, chunk, len) == 0;
+}
+
+int __zn_rname_trie_is_value(void *value, void *arg)
+{
+    return value == arg;
+}
+
+void __zn_rname_trie_node_init(_zn_rname_trie_node_t *node, _zn_rname_trie_node_t *parent)
+{
+    node->chunk.val = NULL;
+    node->chunk.len = 0;
+    node->chunk.kind = _ZN_RNAME_CHUNK_LITERAL;
+    node->hash = 0;
+    node->parent = parent;
+    node->collision = NULL;
+    z_id_map_init(&node->literals);
+    node->patterns = z_list_empty;
+    node->any = NULL;
+    node->values = z_list_empty;
+}
+
+_zn_rname_trie_node_t *__zn_rname_trie_node_make(_zn_rname_trie_node_t *parent, const char *chunk, size_t len, size_t hash)
+{
+    _zn_rname_trie_node_t *node = (_zn_rname_trie_node_t *)malloc(sizeof(_zn_rname_trie_node_t));
+    __zn_rname_trie_node_init(node, parent);
+    char *val = (char *)malloc(len + 1);
+    memcpy(val, chunk, len);
+    val[len] = 0;
+    node->chunk.val = val;
+    node->chunk.len = len;
+    node->chunk.kind = (uint8_t)__zn_rname_chunk_kind(chunk, len);
+    node->hash = hash;
+    return node;
+}
+
+void __zn_rname_trie_node_free(_zn_rname_trie_node_t *node)
+{
+    size_t pos = 0;
+    _zn_rname_trie_node_t *child;
+    while ((child = (_zn_rname_trie_node_t *)z_id_map_next(&node->literals, &pos)) != NULL)
+    {
+        while (child != NULL)
+        {
+            _zn_rname_trie_node_t *collision = child->collision;
+            __zn_rname_trie_node_free(child);
+            free(child);
+            child = collision;
+        }
+    }
+    z_id_map_clear(&node->literals);
+
+    while (node->patterns != z_list_empty)
+    {
+        child = (_zn_rname_trie_node_t *)z_list_head(node->patterns);
+        __zn_rname_trie_node_free(child);
+        free(child);
+        node->patterns = z_list_pop(node->patterns);
+    }
+
+    if (node->any != NULL)
+    {
+        __zn_rname_trie_node_free(node->any);
+        free(node->any);
+        node->any = NULL;
+    }
+
+    z_list_free(node->values);
+    node->values = z_list_empty;
+    free((char *)node->chunk.val);
+    node->chunk.val = NULL;
+}
+
+_zn_rname_trie_node_t *__zn_rname_trie_child(_zn_rname_trie_node_t *node, const char *chunk, size_t len, int create)
+{
+    int kind = __zn_rname_chunk_kind(chunk, len);
+    if (kind == _ZN_RNAME_CHUNK_ANY)
+    {
+        if (node->any == NULL && create)
+            node->any = __zn_rname_trie_node_make(node, chunk, len, 0);
+        return node->any;
+    }
+
+    if (kind == _ZN_RNAME_CHUNK_PATTERN)
+    {
+        z_list_t *xs = node->patterns;
+        while (xs)
+        {
+            _zn_rname_trie_node_t *child = (_zn_rname_trie_node_t *)z_list_head(xs);
+            if (__zn_rname_chunk_equal(&child->chunk, chunk, len))
+                return child;
+            xs = z_list_tail(xs);
+        }
+
+        if (!create)
+            return NULL;
+
+        _zn_rname_trie_node_t *child = __zn_rname_trie_node_make(node, chunk, len, 0);
+        node->patterns = z_list_cons(node->patterns, child);
+        return child;
+    }
+
+    size_t hash = __zn_rname_chunk_hash(chunk, len);
+    _zn_rname_trie_node_t *first = (_zn_rname_trie_node_t *)z_id_map_get(&node->literals, hash);
+    for (_zn_rname_trie_node_t *child = first; child != NULL; child = child->collision)
+    {
+        if (__zn_rname_chunk_equal(&child->chunk, chunk, len))
+            return child;
+    }
+
+    if (!create)
+        return NULL;
+
+    // Chain the new child in front of the ones sharing its hash
+    _zn_rname_trie_node_t *child = __zn_rname_trie_node_make(node, chunk, len, hash);
+    if (first != NULL)
+        z_id_map_remove(&node->literals, hash);
+    child->collision = first;
+    z_id_map_insert(&node->literals, hash, child);
+    return child;
 }
 
-const char *next(const char *str)
+void __zn_rname_trie_unlink(_zn_rname_trie_node_t *parent, _zn_rname_trie_node_t *node)
 {
-    char *res = strchr(str, '/');
-    if (res != NULL)
-        return res + 1;
-    return strchr(str, 0);
+    if (node->chunk.kind == _ZN_RNAME_CHUNK_ANY)
+    {
+        parent->any = NULL;
+    }
+    else if (node->chunk.kind == _ZN_RNAME_CHUNK_PATTERN)
+    {
+        parent->patterns = z_list_remove(parent->patterns, __zn_rname_trie_is_value, node);
+    }
+    else
+    {
+        _zn_rname_trie_node_t *first = (_zn_rname_trie_node_t *)z_id_map_get(&parent->literals, node->hash);
+        if (first == node)
+        {
+            z_id_map_remove(&parent->literals, node->hash);
+            if (node->collision != NULL)
+                z_id_map_insert(&parent->literals, node->hash, node->collision);
+        }
+        else
+        {
+            while (first->collision != node)
+                first = first->collision;
+            first->collision = node->collision;
+        }
+    }
+}
+
+void _zn_rname_trie_init(_zn_rname_trie_t *trie)
+{
+    __zn_rname_trie_node_init(&trie->root, NULL);
+    trie->len = 0;
 }
 
-DEFINE_INTERSECT(zn_rname_intersect, END, WILD, next, chunk_intersect)
+size_t _zn_rname_trie_len(const _zn_rname_trie_t *trie)
+{
+    return trie->len;
+}
+
+void _zn_rname_trie_insert(_zn_rname_trie_t *trie, const char *rname, void *value)
+{
+    _zn_rname_trie_node_t *node = &trie->root;
+    while (*rname != 0)
+    {
+        size_t len = __zn_rname_chunk_len(rname);
+        node = __zn_rname_trie_child(node, rname, len, 1);
+        rname = __zn_rname_chunk_next(rname, len);
+    }
+
+    node->values = z_list_cons(node->values, value);
+    trie->len++;
+}
+
+int _zn_rname_trie_remove(_zn_rname_trie_t *trie, const char *rname, void *value)
+{
+    _zn_rname_trie_node_t *node = &trie->root;
+    while (node != NULL && *rname != 0)
+    {
+        size_t len = __zn_rname_chunk_len(rname);
+        node = __zn_rname_trie_child(node, rname, len, 0);
+        rname = __zn_rname_chunk_next(rname, len);
+    }
+
+    size_t len = node != NULL ? z_list_len(node->values) : 0;
+    if (len == 0)
+        return -1;
+    node->values = z_list_remove(node->values, __zn_rname_trie_is_value, value);
+    if (z_list_len(node->values) == len)
+        return -1;
+    trie->len--;
+
+    // Prune the nodes left without values nor children
+    while (node->parent != NULL && node->values == z_list_empty && z_id_map_len(&node->literals) == 0 && node->patterns == z_list_empty && node->any == NULL)
+    {
+        _zn_rname_trie_node_t *parent = node->parent;
+        __zn_rname_trie_unlink(parent, node);
+        __zn_rname_trie_node_free(node);
+        free(node);
+        node = parent;
+    }
+
+    return 0;
+}
+
+// The nodes matched by a lookup, kept on the stack unless there are many of them
+#define _ZN_RNAME_TRIE_MATCHES 16
+
+typedef struct
+{
+    const _zn_rname_trie_node_t **val;
+    size_t len;
+    size_t capacity;
+    const _zn_rname_trie_node_t *stack[_ZN_RNAME_TRIE_MATCHES];
+} _zn_rname_trie_matches_t;
+
+void __zn_rname_trie_collect(_zn_rname_trie_matches_t *ms, const _zn_rname_trie_node_t *node)
+{
+    if (node->values == z_list_empty)
+        return;
+
+    if (ms->len == ms->capacity)
+    {
+        ms->capacity *= 2;
+        if (ms->val == ms->stack)
+        {
+            ms->val = (const _zn_rname_trie_node_t **)malloc(ms->capacity * sizeof(_zn_rname_trie_node_t *));
+            memcpy(ms->val, ms->stack, ms->len * sizeof(_zn_rname_trie_node_t *));
+        }
+        else
+        {
+            ms->val = (const _zn_rname_trie_node_t **)realloc(ms->val, ms->capacity * sizeof(_zn_rname_trie_node_t *));
+        }
+    }
+    ms->val[ms->len++] = node;
+}
+
+int __zn_rname_trie_node_cmp(const void *a, const void *b)
+{
+    uintptr_t l = (uintptr_t)*(const _zn_rname_trie_node_t *const *)a;
+    uintptr_t r = (uintptr_t)*(const _zn_rname_trie_node_t *const *)b;
+    return (l > r) - (l < r);
+}
+
+void __zn_rname_trie_match(_zn_rname_trie_matches_t *ms, const _zn_rname_trie_node_t *node, const char *rname)
+{
+    // The end of the resource name matches the node, and the ** chunks following it
+    if (*rname == 0)
+    {
+        __zn_rname_trie_collect(ms, node);
+        if (node->any != NULL)
+            __zn_rname_trie_match(ms, node->any, rname);
+        return;
+    }
+
+    _zn_rname_chunk_t chunk;
+    chunk.val = rname;
+    chunk.len = __zn_rname_chunk_len(rname);
+    chunk.kind = (uint8_t)__zn_rname_chunk_kind(rname, chunk.len);
+    const char *next = __zn_rname_chunk_next(rname, chunk.len);
+
+    if (chunk.kind == _ZN_RNAME_CHUNK_ANY)
+    {
+        // A ** chunk of the resource name matches no chunk at all, or any chunk of the trie
+        // as long as it matches the following ones
+        __zn_rname_trie_match(ms, node, next);
+
+        size_t pos = 0;
+        _zn_rname_trie_node_t *child;
+        while ((child = (_zn_rname_trie_node_t *)z_id_map_next(&node->literals, &pos)) != NULL)
+        {
+            for (; child != NULL; child = child->collision)
+                __zn_rname_trie_match(ms, child, rname);
+        }
+        for (z_list_t *xs = node->patterns; xs; xs = z_list_tail(xs))
+            __zn_rname_trie_match(ms, (_zn_rname_trie_node_t *)z_list_head(xs), rname);
+        if (node->any != NULL)
+            __zn_rname_trie_match(ms, node->any, rname);
+        return;
+    }
+
+    if (chunk.kind == _ZN_RNAME_CHUNK_LITERAL)
+    {
+        _zn_rname_trie_node_t *child = __zn_rname_trie_child((_zn_rname_trie_node_t *)node, rname, chunk.len, 0);
+        if (child != NULL)
+            __zn_rname_trie_match(ms, child, next);
+    }
+    else
+    {
+        size_t pos = 0;
+        _zn_rname_trie_node_t *child;
+        while ((child = (_zn_rname_trie_node_t *)z_id_map_next(&node->literals, &pos)) != NULL)
+        {
+            for (; child != NULL; child = child->collision)
+            {
+                if (__zn_rname_chunk_intersect(&child->chunk, &chunk))
+                    __zn_rname_trie_match(ms, child, next);
+            }
+        }
+    }
+
+    for (z_list_t *xs = node->patterns; xs; xs = z_list_tail(xs))
+    {
+        _zn_rname_trie_node_t *child = (_zn_rname_trie_node_t *)z_list_head(xs);
+        if (__zn_rname_chunk_intersect(&child->chunk, &chunk))
+            __zn_rname_trie_match(ms, child, next);
+    }
+
+    // A ** chunk of the trie matches any number of chunks of the resource name
+    if (node->any != NULL)
+    {
+        const char *suffix = rname;
+        while (1)
+        {
+            __zn_rname_trie_match(ms, node->any, suffix);
+            if (*suffix == 0)
+                break;
+            suffix = __zn_rname_chunk_next(suffix, __zn_rname_chunk_len(suffix));
+        }
+    }
+}
+
+void _zn_rname_trie_match(const _zn_rname_trie_t *trie, const char *rname, _zn_rname_trie_visitor_t visitor, void *arg)
+{
+    _zn_rname_trie_matches_t ms;
+    ms.val = ms.stack;
+    ms.len = 0;
+    ms.capacity = _ZN_RNAME_TRIE_MATCHES;
+    __zn_rname_trie_match(&ms, &trie->root, rname);
+
+    // A node might be reached through several wildcards, visit its values only once. The
+    // trie is left untouched, so that concurrent lookups can share it.
+    if (ms.len > 1)
+        qsort(ms.val, ms.len, sizeof(_zn_rname_trie_node_t *), __zn_rname_trie_node_cmp);
+    for (size_t i = 0; i < ms.len; i++)
+    {
+        if (i > 0 && ms.val[i] == ms.val[i - 1])
+            continue;
+        for (z_list_t *xs = ms.val[i]->values; xs; xs = z_list_tail(xs))
+            visitor(z_list_head(xs), arg);
+    }
+
+    if (ms.val != ms.stack)
+        free(ms.val);
+}
+
+void _zn_rname_trie_clear(_zn_rname_trie_t *trie)
+{
+    __zn_rname_trie_node_free(&trie->root);
+    _zn_rname_trie_init(trie);
+}
@@ -28,6 +28,9 @@ _zn_zenoh_message_t _zn_zenoh_message_init(uint8_t header)
 {
     _zn_zenoh_message_t zm;
     memset(&zm, 0, sizeof(_zn_zenoh_message_t));
+    // New declarations must not wait behind the data they refer to, the forgetting ones
+    // follow the data of the entity they retract on its lane when it has one
+    zm.priority = _ZN_MID(header) == _ZN_MID_DECLARE ? zn_priority_t_REAL_TIME : ZN_PRIORITY_DEFAULT;
     zm.header = header;
     return zm;
 }
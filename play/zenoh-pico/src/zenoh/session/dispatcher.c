@@ -0,0 +1,336 @@
+/*
+ * Copyright (c) 2017, 2021 ADLINK Technology Inc.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License 2.0 which is available at
+ * http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+ * which is available at https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+ *
+ * Contributors:
+ *   ADLINK zenoh team, <zenoh@adlink-labs.tech>
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "zenoh-pico/session/api.h"
+#include "zenoh-pico/session/types.h"
+#include "zenoh-pico/session/private/types.h"
+#include "zenoh-pico/session/private/subscription.h"
+#include "zenoh-pico/session/private/utils.h"
+#include "zenoh-pico/system/common.h"
+#include "zenoh-pico/utils/private/logging.h"
+
+// The worker running on the current thread, if any
+static __thread _zn_dispatch_worker_t *_zn_dispatch_current_worker = NULL;
+
+/*------------------ Jobs ------------------*/
+_zn_dispatch_job_t *_zn_dispatch_job_make(const _zn_subscriber_t *sub, const zn_sample_t *sample, size_t hash)
+{
+    // Copy the sample in a single allocation, it outlives the received batch
+    _zn_dispatch_job_t *job = (_zn_dispatch_job_t *)malloc(sizeof(_zn_dispatch_job_t) + sample->key.len + 1 + sample->value.len);
+    if (job == NULL)
+        return NULL;
+
+    char *key = (char *)(job + 1);
+    uint8_t *value = (uint8_t *)(key + sample->key.len + 1);
+
+    memcpy(key, sample->key.val, sample->key.len);
+    key[sample->key.len] = '\0';
+    memcpy(value, sample->value.val, sample->value.len);
+
+    job->sample.key.val = key;
+    job->sample.key.len = sample->key.len;
+    job->sample.value.val = value;
+    job->sample.value.len = sample->value.len;
+    job->hash = hash;
+    job->id = sub->id;
+    job->on_full = sub->info.on_full;
+    job->callback = sub->callback;
+    job->arg = sub->arg;
+    return job;
+}
+
+int __zn_dispatch_evict_oldest(_zn_dispatch_worker_t *w)
+{
+    // Only the samples of the subscriptions accepting to lose them can be evicted
+    for (size_t i = 0; i < w->len; i++)
+    {
+        _zn_dispatch_job_t *job = (_zn_dispatch_job_t *)w->jobs[(w->head + i) % ZN_DISPATCH_QUEUE_SIZE];
+        if (job->on_full != zn_queue_full_t_DROP_OLDEST)
+            continue;
+
+        // Close the gap, keeping the order of the other samples
+        free(job);
+        for (size_t j = i; j > 0; j--)
+            w->jobs[(w->head + j) % ZN_DISPATCH_QUEUE_SIZE] = w->jobs[(w->head + j - 1) % ZN_DISPATCH_QUEUE_SIZE];
+        w->head = (w->head + 1) % ZN_DISPATCH_QUEUE_SIZE;
+        w->len--;
+        return 0;
+    }
+
+    return -1;
+}
+
+void __zn_dispatch_push(zn_session_t *zn, _zn_dispatch_worker_t *w, _zn_dispatch_job_t *job)
+{
+    z_mutex_lock(&w->mutex);
+
+    while (w->is_running && w->len == ZN_DISPATCH_QUEUE_SIZE)
+    {
+        if (job->on_full == zn_queue_full_t_BLOCK)
+        {
+            z_condvar_wait(&w->cond_not_full, &w->mutex);
+            continue;
+        }
+
+        // Make room for the new sample, or drop it if the queue only holds samples that can not be lost
+        _ZN_STATS_INC(zn, rx_dropped_dispatch);
+        if (job->on_full == zn_queue_full_t_DROP_NEWEST || __zn_dispatch_evict_oldest(w) != 0)
+        {
+            free(job);
+            job = NULL;
+            break;
+        }
+    }
+
+    if (job != NULL && !w->is_running)
+    {
+        _Z_DEBUG("Dropping sample because the dispatcher is stopping\n");
+        free(job);
+        job = NULL;
+    }
+
+    if (job != NULL)
+    {
+        w->jobs[(w->head + w->len) % ZN_DISPATCH_QUEUE_SIZE] = job;
+        w->len++;
+        z_condvar_signal(&w->cond_not_empty);
+    }
+
+    z_mutex_unlock(&w->mutex);
+}
+
+_zn_dispatch_worker_t *__zn_dispatch_acquire(zn_session_t *zn, volatile unsigned int *users, unsigned int *num)
+{
+    // The workers are not released while referenced, see znp_stop_dispatcher
+    __atomic_add_fetch(users, 1, __ATOMIC_SEQ_CST);
+    _zn_dispatch_worker_t *workers = __atomic_load_n(&zn->dispatch_workers, __ATOMIC_SEQ_CST);
+    if (workers == NULL)
+    {
+        __atomic_sub_fetch(users, 1, __ATOMIC_SEQ_CST);
+        return NULL;
+    }
+
+    *num = zn->dispatch_workers_num;
+    return workers;
+}
+
+_zn_dispatch_worker_t *_zn_dispatch_acquire(zn_session_t *zn, unsigned int *num)
+{
+    return __zn_dispatch_acquire(zn, &zn->dispatch_pushing, num);
+}
+
+void _zn_dispatch_jobs(zn_session_t *zn, _zn_dispatch_worker_t *workers, unsigned int num, z_list_t *jobs)
+{
+    while (jobs)
+    {
+        // The samples of a same key are always delivered by the same worker
+        _zn_dispatch_job_t *job = (_zn_dispatch_job_t *)z_list_head(jobs);
+        __zn_dispatch_push(zn, &workers[job->hash % num], job);
+        jobs = z_list_pop(jobs);
+    }
+
+    // The jobs acquired along with the workers are all queued
+    __atomic_sub_fetch(&zn->dispatch_pushing, 1, __ATOMIC_SEQ_CST);
+}
+
+void __zn_dispatch_drain_current(zn_session_t *zn, _zn_dispatch_worker_t *w, z_zint_t id)
+{
+    // The worker can not wait for itself, it runs the samples queued behind the current one instead,
+    // which also unblocks the reading thread pushing onto its full queue
+    while (1)
+    {
+        z_mutex_lock(&w->mutex);
+        if (w->len == 0)
+        {
+            z_mutex_unlock(&w->mutex);
+            if (__atomic_load_n(&zn->dispatch_pushing, __ATOMIC_SEQ_CST) == 0)
+                break;
+            z_sleep_us(1);
+            continue;
+        }
+
+        _zn_dispatch_job_t *job = (_zn_dispatch_job_t *)w->jobs[w->head];
+        w->head = (w->head + 1) % ZN_DISPATCH_QUEUE_SIZE;
+        w->len--;
+        z_condvar_signal(&w->cond_not_full);
+        z_mutex_unlock(&w->mutex);
+
+        // The samples of the subscription being undeclared are not delivered anymore
+        if (job->id != id)
+            job->callback(&job->sample, job->arg);
+        free(job);
+    }
+}
+
+void _zn_dispatch_flush(zn_session_t *zn, z_zint_t id)
+{
+    unsigned int num = 0;
+    _zn_dispatch_worker_t *workers = __zn_dispatch_acquire(zn, &zn->dispatch_flushing, &num);
+    if (workers == NULL)
+        return;
+
+    // A subscription callback running on a worker might be undeclaring
+    _zn_dispatch_worker_t *current = NULL;
+    for (unsigned int i = 0; i < num; i++)
+    {
+        if (&workers[i] == _zn_dispatch_current_worker)
+            current = &workers[i];
+    }
+
+    // Wait for the samples being pushed by the reading thread
+    if (current != NULL)
+        __zn_dispatch_drain_current(zn, current, id);
+    while (__atomic_load_n(&zn->dispatch_pushing, __ATOMIC_SEQ_CST) > 0)
+        z_sleep_us(1);
+
+    for (unsigned int i = 0; i < num; i++)
+    {
+        _zn_dispatch_worker_t *w = &workers[i];
+        if (w == current)
+            continue;
+
+        z_mutex_lock(&w->mutex);
+        while (w->len > 0 || w->is_busy)
+            z_condvar_wait(&w->cond_idle, &w->mutex);
+        // Pass the wake up on to the other threads waiting for the worker
+        z_condvar_signal(&w->cond_idle);
+        z_mutex_unlock(&w->mutex);
+    }
+
+    __atomic_sub_fetch(&zn->dispatch_flushing, 1, __ATOMIC_SEQ_CST);
+}
+
+/*------------------ Workers ------------------*/
+void *__zn_dispatch_task(void *arg)
+{
+    _zn_dispatch_worker_t *w = (_zn_dispatch_worker_t *)arg;
+    _zn_dispatch_current_worker = w;
+
+    z_mutex_lock(&w->mutex);
+    while (1)
+    {
+        while (w->len == 0 && w->is_running)
+            z_condvar_wait(&w->cond_not_empty, &w->mutex);
+
+        // The samples still in the queue are delivered before terminating
+        if (w->len == 0)
+            break;
+
+        _zn_dispatch_job_t *job = (_zn_dispatch_job_t *)w->jobs[w->head];
+        w->head = (w->head + 1) % ZN_DISPATCH_QUEUE_SIZE;
+        w->len--;
+        w->is_busy = 1;
+        z_condvar_signal(&w->cond_not_full);
+        z_mutex_unlock(&w->mutex);
+
+        // Run the callback without holding any lock
+        job->callback(&job->sample, job->arg);
+        free(job);
+
+        z_mutex_lock(&w->mutex);
+        w->is_busy = 0;
+        if (w->len == 0)
+            z_condvar_signal(&w->cond_idle);
+    }
+    z_mutex_unlock(&w->mutex);
+
+    return 0;
+}
+
+int znp_start_dispatcher(zn_session_t *zn, unsigned int workers)
+{
+    if (zn->dispatch_workers != NULL || workers == 0)
+        return -1;
+
+    _zn_dispatch_worker_t *ws = (_zn_dispatch_worker_t *)malloc(workers * sizeof(_zn_dispatch_worker_t));
+    for (unsigned int i = 0; i < workers; i++)
+    {
+        _zn_dispatch_worker_t *w = &ws[i];
+        w->jobs = (void **)malloc(ZN_DISPATCH_QUEUE_SIZE * sizeof(void *));
+        w->head = 0;
+        w->len = 0;
+        w->is_busy = 0;
+        w->is_running = 1;
+        z_mutex_init(&w->mutex);
+        z_condvar_init(&w->cond_not_empty);
+        z_condvar_init(&w->cond_not_full);
+        z_condvar_init(&w->cond_idle);
+        if (z_task_init(&w->task, NULL, __zn_dispatch_task, w) != 0)
+        {
+            _Z_DEBUG("Unable to spawn a worker of the dispatcher\n");
+            z_condvar_free(&w->cond_idle);
+            z_condvar_free(&w->cond_not_full);
+            z_condvar_free(&w->cond_not_empty);
+            z_mutex_free(&w->mutex);
+            free(w->jobs);
+
+            // Stop the workers spawned so far
+            zn->dispatch_workers = ws;
+            zn->dispatch_workers_num = i;
+            znp_stop_dispatcher(zn);
+            return -1;
+        }
+    }
+
+    // Publish the workers to the reading thread once they are all running
+    z_mutex_lock(&zn->mutex_inner);
+    zn->dispatch_workers_num = workers;
+    __atomic_store_n(&zn->dispatch_workers, ws, __ATOMIC_SEQ_CST);
+    z_mutex_unlock(&zn->mutex_inner);
+
+    return 0;
+}
+
+int znp_stop_dispatcher(zn_session_t *zn)
+{
+    // The subscription callbacks run on the reading thread from now on
+    z_mutex_lock(&zn->mutex_inner);
+    _zn_dispatch_worker_t *ws = __atomic_exchange_n(&zn->dispatch_workers, NULL, __ATOMIC_SEQ_CST);
+    unsigned int workers = zn->dispatch_workers_num;
+    z_mutex_unlock(&zn->mutex_inner);
+
+    if (ws == NULL)
+        return -1;
+
+    // Let the threads still referencing the workers queue their samples and flush
+    while (__atomic_load_n(&zn->dispatch_pushing, __ATOMIC_SEQ_CST) > 0 ||
+           __atomic_load_n(&zn->dispatch_flushing, __ATOMIC_SEQ_CST) > 0)
+        z_sleep_us(1);
+
+    for (unsigned int i = 0; i < workers; i++)
+    {
+        _zn_dispatch_worker_t *w = &ws[i];
+        z_mutex_lock(&w->mutex);
+        w->is_running = 0;
+        z_condvar_signal(&w->cond_not_empty);
+        z_condvar_signal(&w->cond_not_full);
+        z_mutex_unlock(&w->mutex);
+    }
+
+    for (unsigned int i = 0; i < workers; i++)
+    {
+        _zn_dispatch_worker_t *w = &ws[i];
+        z_task_join(&w->task);
+        z_condvar_free(&w->cond_idle);
+        z_condvar_free(&w->cond_not_full);
+        z_condvar_free(&w->cond_not_empty);
+        z_mutex_free(&w->mutex);
+        free(w->jobs);
+    }
+    free(ws);
+
+    return 0;
+}
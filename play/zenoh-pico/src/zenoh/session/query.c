@@ -35,18 +35,7 @@ z_zint_t _zn_get_query_id(zn_session_t *zn)
  */
 _zn_pending_query_t *__unsafe_zn_get_pending_query_by_id(zn_session_t *zn, z_zint_t id)
 {
-    z_list_t *queries = zn->pending_queries;
-    while (queries)
-    {
-        _zn_pending_query_t *query = (_zn_pending_query_t *)z_list_head(queries);
-
-        if (query->id == id)
-            return query;
-
-        queries = z_list_tail(queries);
-    }
-
-    return NULL;
+    return (_zn_pending_query_t *)z_id_map_get(&zn->pending_queries, id);
 }
 
 int _zn_register_pending_query(zn_session_t *zn, _zn_pending_query_t *pen_qry)
@@ -64,7 +53,7 @@ int _zn_register_pending_query(zn_session_t *zn, _zn_pending_query_t *pen_qry)
     else
     {
         // Register the query
-        zn->pending_queries = z_list_cons(zn->pending_queries, pen_qry);
+        z_id_map_insert(&zn->pending_queries, pen_qry->id, pen_qry);
         res = 0;
     }
 
@@ -115,26 +104,6 @@ void __unsafe_zn_free_pending_query(_zn_pending_query_t *pen_qry)
     }
 }
 
-/**
- * This function is unsafe because it operates in potentially concurrent data.
- * Make sure that the following mutexes are locked before calling this function:
- *  - zn->mutex_inner
- */
-int __unsafe_zn_pending_query_predicate(void *other, void *this)
-{
-    _zn_pending_query_t *o = (_zn_pending_query_t *)other;
-    _zn_pending_query_t *t = (_zn_pending_query_t *)this;
-    if (t->id == o->id)
-    {
-        __unsafe_zn_free_pending_query(t);
-        return 1;
-    }
-    else
-    {
-        return 0;
-    }
-}
-
 /**
  * This function is unsafe because it operates in potentially concurrent data.
  * Make sure that the following mutexes are locked before calling this function:
@@ -142,7 +111,8 @@ int __unsafe_zn_pending_query_predicate(void *other, void *this)
  */
 void __unsafe_zn_unregister_pending_query(zn_session_t *zn, _zn_pending_query_t *pen_qry)
 {
-    zn->pending_queries = z_list_remove(zn->pending_queries, __unsafe_zn_pending_query_predicate, pen_qry);
+    if (z_id_map_remove(&zn->pending_queries, pen_qry->id) != NULL)
+        __unsafe_zn_free_pending_query(pen_qry);
     free(pen_qry);
 }
 
@@ -158,9 +128,10 @@ void _zn_flush_pending_queries(zn_session_t *zn)
     // Lock the resources data struct
     z_mutex_lock(&zn->mutex_inner);
 
-    while (zn->pending_queries)
+    size_t pos = 0;
+    _zn_pending_query_t *pqy;
+    while ((pqy = (_zn_pending_query_t *)z_id_map_next(&zn->pending_queries, &pos)) != NULL)
     {
-        _zn_pending_query_t *pqy = (_zn_pending_query_t *)z_list_head(zn->pending_queries);
         while (pqy->pending_replies)
         {
             _zn_pending_reply_t *pre = (_zn_pending_reply_t *)z_list_head(pqy->pending_replies);
@@ -170,8 +141,8 @@ void _zn_flush_pending_queries(zn_session_t *zn)
         }
         __unsafe_zn_free_pending_query(pqy);
         free(pqy);
-        zn->pending_queries = z_list_pop(zn->pending_queries);
     }
+    z_id_map_clear(&zn->pending_queries);
 
     // Release the lock
     z_mutex_unlock(&zn->mutex_inner);
@@ -24,6 +24,12 @@
 #include "zenoh-pico/utils/private/logging.h"
 
 /*------------------ Queryable ------------------*/
+void __zn_queryable_collect(void *qle, void *arg)
+{
+    z_list_t **xs = (z_list_t **)arg;
+    *xs = z_list_cons(*xs, qle);
+}
+
 /**
  * This function is unsafe because it operates in potentially concurrent data.
  * Make sure that the following mutexes are locked before calling this function:
@@ -31,18 +37,7 @@
  */
 _zn_queryable_t *__unsafe_zn_get_queryable_by_id(zn_session_t *zn, z_zint_t id)
 {
-    z_list_t *queryables = zn->local_queryables;
-    while (queryables)
-    {
-        _zn_queryable_t *queryable = (_zn_queryable_t *)z_list_head(queryables);
-
-        if (queryable->id == id)
-            return queryable;
-
-        queryables = z_list_tail(queryables);
-    }
-
-    return NULL;
+    return (_zn_queryable_t *)z_id_map_get(&zn->local_queryables, id);
 }
 
 /**
@@ -56,7 +51,7 @@ z_list_t *__unsafe_zn_get_queryables_from_remote_key(zn_session_t *zn, const zn_
     // Case 1) -> numerical only reskey
     if (reskey->rname == NULL)
     {
-        z_list_t *qles = (z_list_t *)z_i_map_get(zn->rem_res_loc_qle_map, reskey->rid);
+        z_list_t *qles = (z_list_t *)z_id_map_get(&zn->rem_res_loc_qle_map, reskey->rid);
         while (qles)
         {
             _zn_queryable_t *qle = (_zn_queryable_t *)z_list_head(qles);
@@ -64,85 +59,20 @@ z_list_t *__unsafe_zn_get_queryables_from_remote_key(zn_session_t *zn, const zn_
             qles = z_list_tail(qles);
         }
     }
-    // Case 2) -> string only reskey
-    else if (reskey->rid == ZN_RESOURCE_ID_NONE)
-    {
-        // The complete resource name of the remote key
-        z_str_t rname = reskey->rname;
-
-        z_list_t *qles = zn->local_queryables;
-        while (qles)
-        {
-            _zn_queryable_t *qle = (_zn_queryable_t *)z_list_head(qles);
-
-            // The complete resource name of the subscribed key
-            z_str_t lname;
-            if (qle->key.rid == ZN_RESOURCE_ID_NONE)
-            {
-                // Do not allocate
-                lname = qle->key.rname;
-            }
-            else
-            {
-                // Allocate a computed string
-                lname = __unsafe_zn_get_resource_name_from_key(zn, _ZN_IS_LOCAL, &qle->key);
-                if (lname == NULL)
-                {
-                    z_list_free(xs);
-                    xs = NULL;
-                    return xs;
-                }
-            }
-
-            if (zn_rname_intersect(lname, rname))
-                xs = z_list_cons(xs, qle);
-
-            if (qle->key.rid != ZN_RESOURCE_ID_NONE)
-                free(lname);
-
-            qles = z_list_tail(qles);
-        }
-    }
-    // Case 3) -> numerical reskey with suffix
+    // Case 2) and 3) -> string reskey, with or without a numerical prefix
     else
     {
-        _zn_resource_t *remote = __unsafe_zn_get_resource_by_id(zn, _ZN_IS_REMOTE, reskey->rid);
-        if (remote == NULL)
+        // The complete resource name of the remote key
+        int is_alloc;
+        z_str_t rname = __unsafe_zn_borrow_resource_name_from_key(zn, _ZN_IS_REMOTE, reskey, &is_alloc);
+        if (rname == NULL)
             return xs;
 
-        // Compute the complete remote resource name starting from the key
-        z_str_t rname = __unsafe_zn_get_resource_name_from_key(zn, _ZN_IS_REMOTE, reskey);
-
-        z_list_t *qles = zn->local_queryables;
-        while (qles)
-        {
-            _zn_queryable_t *qle = (_zn_queryable_t *)z_list_head(qles);
-
-            // Get the complete resource name to be passed to the subscription callback
-            z_str_t lname;
-            if (qle->key.rid == ZN_RESOURCE_ID_NONE)
-            {
-                // Do not allocate
-                lname = qle->key.rname;
-            }
-            else
-            {
-                // Allocate a computed string
-                lname = __unsafe_zn_get_resource_name_from_key(zn, _ZN_IS_LOCAL, &qle->key);
-                if (lname == NULL)
-                    continue;
-            }
-
-            if (zn_rname_intersect(lname, rname))
-                xs = z_list_cons(xs, qle);
-
-            if (qle->key.rid != ZN_RESOURCE_ID_NONE)
-                free(lname);
+        // Look the matching queryables up by their resource name
+        _zn_rname_trie_match(&zn->local_queryables_trie, rname, __zn_queryable_collect, &xs);
 
-            qles = z_list_tail(qles);
-        }
-
-        free(rname);
+        if (is_alloc)
+            free(rname);
     }
 
     return xs;
@@ -158,22 +88,16 @@ void __unsafe_zn_add_loc_qle_to_rem_res_map(zn_session_t *zn, _zn_queryable_t *q
     // Need to check if there is a remote resource declaration matching the new subscription
     zn_reskey_t loc_key;
     loc_key.rid = ZN_RESOURCE_ID_NONE;
-    if (qle->key.rid == ZN_RESOURCE_ID_NONE)
-        loc_key.rname = qle->key.rname;
-    else
-        loc_key.rname = __unsafe_zn_get_resource_name_from_key(zn, _ZN_IS_LOCAL, &qle->key);
+    loc_key.rname = qle->rname;
 
     _zn_resource_t *rem_res = __unsafe_zn_get_resource_matching_key(zn, _ZN_IS_REMOTE, &loc_key);
     if (rem_res)
     {
         // Update the list of active subscriptions
-        z_list_t *qles = z_i_map_get(zn->rem_res_loc_qle_map, rem_res->id);
+        z_list_t *qles = (z_list_t *)z_id_map_remove(&zn->rem_res_loc_qle_map, rem_res->id);
         qles = z_list_cons(qles, qle);
-        z_i_map_set(zn->rem_res_loc_qle_map, rem_res->id, qles);
+        z_id_map_insert(&zn->rem_res_loc_qle_map, rem_res->id, qles);
     }
-
-    if (qle->key.rid != ZN_RESOURCE_ID_NONE)
-        free(loc_key.rname);
 }
 
 /**
@@ -187,15 +111,10 @@ void __unsafe_zn_add_rem_res_to_loc_qle_map(zn_session_t *zn, z_zint_t id, zn_re
     z_list_t *qles = __unsafe_zn_get_queryables_from_remote_key(zn, reskey);
     if (qles)
     {
-        // Update the list
-        z_list_t *ql = z_i_map_get(zn->rem_res_loc_qle_map, id);
-        if (ql)
-        {
-            // Free any ancient list
-            z_list_free(ql);
-        }
+        // Free any ancient list
+        z_list_free((z_list_t *)z_id_map_remove(&zn->rem_res_loc_qle_map, id));
         // Update the list of active subscriptions
-        z_i_map_set(zn->rem_res_loc_qle_map, id, qles);
+        z_id_map_insert(&zn->rem_res_loc_qle_map, id, qles);
     }
 }
 
@@ -215,6 +134,7 @@ int _zn_register_queryable(zn_session_t *zn, _zn_queryable_t *qle)
     z_mutex_lock(&zn->mutex_inner);
 
     int res;
+    qle->rname = NULL;
     _zn_queryable_t *q = __unsafe_zn_get_queryable_by_id(zn, qle->id);
     if (q)
     {
@@ -223,10 +143,21 @@ int _zn_register_queryable(zn_session_t *zn, _zn_queryable_t *qle)
     }
     else
     {
-        // Register the queryable
-        __unsafe_zn_add_loc_qle_to_rem_res_map(zn, qle);
-        zn->local_queryables = z_list_cons(zn->local_queryables, qle);
-        res = 0;
+        // Index the queryable by its complete resource name, the resource it builds on
+        // must have been declared
+        qle->rname = __unsafe_zn_get_resource_name_from_key(zn, _ZN_IS_LOCAL, &qle->key);
+        if (qle->rname == NULL)
+        {
+            res = -1;
+        }
+        else
+        {
+            // Register the queryable
+            __unsafe_zn_add_loc_qle_to_rem_res_map(zn, qle);
+            z_id_map_insert(&zn->local_queryables, qle->id, qle);
+            _zn_rname_trie_insert(&zn->local_queryables_trie, qle->rname, qle);
+            res = 0;
+        }
     }
 
     // Release the lock
@@ -243,26 +174,7 @@ int _zn_register_queryable(zn_session_t *zn, _zn_queryable_t *qle)
 void __unsafe_zn_free_queryable(_zn_queryable_t *qle)
 {
     _zn_reskey_free(&qle->key);
-}
-
-/**
- * This function is unsafe because it operates in potentially concurrent data.
- * Make sure that the following mutexes are locked before calling this function:
- *  - zn->mutex_inner
- */
-int __unsafe_zn_queryable_predicate(void *other, void *this)
-{
-    _zn_queryable_t *o = (_zn_queryable_t *)other;
-    _zn_queryable_t *t = (_zn_queryable_t *)this;
-    if (t->id == o->id)
-    {
-        __unsafe_zn_free_queryable(t);
-        return 1;
-    }
-    else
-    {
-        return 0;
-    }
+    free(qle->rname);
 }
 
 void _zn_unregister_queryable(zn_session_t *zn, _zn_queryable_t *qle)
@@ -270,7 +182,11 @@ void _zn_unregister_queryable(zn_session_t *zn, _zn_queryable_t *qle)
     // Acquire the lock on the queryables
     z_mutex_lock(&zn->mutex_inner);
 
-    zn->local_queryables = z_list_remove(zn->local_queryables, __unsafe_zn_queryable_predicate, qle);
+    if (z_id_map_remove(&zn->local_queryables, qle->id) != NULL)
+    {
+        _zn_rname_trie_remove(&zn->local_queryables_trie, qle->rname, qle);
+        __unsafe_zn_free_queryable(qle);
+    }
     free(qle);
 
     // Release the lock
@@ -282,19 +198,45 @@ void _zn_flush_queryables(zn_session_t *zn)
     // Lock the resources data struct
     z_mutex_lock(&zn->mutex_inner);
 
-    while (zn->local_queryables)
+    size_t pos = 0;
+    _zn_queryable_t *qle;
+    while ((qle = (_zn_queryable_t *)z_id_map_next(&zn->local_queryables, &pos)) != NULL)
     {
-        _zn_queryable_t *qle = (_zn_queryable_t *)z_list_head(zn->local_queryables);
         __unsafe_zn_free_queryable(qle);
         free(qle);
-        zn->local_queryables = z_list_pop(zn->local_queryables);
     }
-    z_i_map_free(zn->rem_res_loc_qle_map);
+    z_id_map_clear(&zn->local_queryables);
+
+    pos = 0;
+    z_list_t *xs;
+    while ((xs = (z_list_t *)z_id_map_next(&zn->rem_res_loc_qle_map, &pos)) != NULL)
+        z_list_free(xs);
+    z_id_map_clear(&zn->rem_res_loc_qle_map);
+    _zn_rname_trie_clear(&zn->local_queryables_trie);
 
     // Release the lock
     z_mutex_unlock(&zn->mutex_inner);
 }
 
+typedef struct
+{
+    zn_query_t *query;
+    unsigned int target;
+} _zn_query_delivery_t;
+
+void __zn_deliver_matching_query(void *qle, void *arg)
+{
+    _zn_query_delivery_t *d = (_zn_query_delivery_t *)arg;
+    _zn_queryable_t *q = (_zn_queryable_t *)qle;
+
+    unsigned int target = (d->target & ZN_QUERYABLE_ALL_KINDS) | (d->target & q->kind);
+    if (target != 0)
+    {
+        d->query->kind = q->kind;
+        q->callback(d->query, q->arg);
+    }
+}
+
 void _zn_trigger_queryables(zn_session_t *zn, const _zn_query_t *query)
 {
     // Acquire the lock on the queryables
@@ -308,30 +250,19 @@ void _zn_trigger_queryables(zn_session_t *zn, const _zn_query_t *query)
         if (res == NULL)
             goto EXIT_QLE_TRIG;
 
-        // Get the complete resource name to be passed to the subscription callback
-        z_str_t rname;
-        if (res->key.rid == ZN_RESOURCE_ID_NONE)
-        {
-            // Do not allocate
-            rname = res->key.rname;
-        }
-        else
-        {
-            // Allocate a computed string
-            rname = __unsafe_zn_get_resource_name_from_key(zn, _ZN_IS_LOCAL, &res->key);
-            if (rname == NULL)
-                goto EXIT_QLE_TRIG;
-        }
+        // The complete resource name has been expanded when the resource was declared
+        if (res->name.val == NULL)
+            goto EXIT_QLE_TRIG;
 
         // Build the query
         zn_query_t q;
         q.zn = zn;
         q.qid = query->qid;
-        q.rname = rname;
+        q.rname = res->name.val;
         q.predicate = query->predicate;
 
         // Iterate over the matching queryables
-        z_list_t *qles = (z_list_t *)z_i_map_get(zn->rem_res_loc_qle_map, query->key.rid);
+        z_list_t *qles = (z_list_t *)z_id_map_get(&zn->rem_res_loc_qle_map, query->key.rid);
         while (qles)
         {
             _zn_queryable_t *qle = (_zn_queryable_t *)z_list_head(qles);
@@ -343,62 +274,13 @@ void _zn_trigger_queryables(zn_session_t *zn, const _zn_query_t *query)
             }
             qles = z_list_tail(qles);
         }
-
-        if (res->key.rid != ZN_RESOURCE_ID_NONE)
-            free(rname);
     }
-    // Case 2) -> string only reskey
-    else if (query->key.rid == ZN_RESOURCE_ID_NONE)
-    {
-        // Build the query
-        zn_query_t q;
-        q.zn = zn;
-        q.qid = query->qid;
-        q.rname = query->key.rname;
-        q.predicate = query->predicate;
-
-        // Iterate over the matching queryables
-        z_list_t *qles = zn->local_queryables;
-        while (qles)
-        {
-            _zn_queryable_t *qle = (_zn_queryable_t *)z_list_head(qles);
-
-            unsigned int target = (query->target.kind & ZN_QUERYABLE_ALL_KINDS) | (query->target.kind & qle->kind);
-            if (target != 0)
-            {
-                // Get the complete resource name to be passed to the subscription callback
-                z_str_t rname;
-                if (qle->key.rid == ZN_RESOURCE_ID_NONE)
-                {
-                    // Do not allocate
-                    rname = qle->key.rname;
-                }
-                else
-                {
-                    // Allocate a computed string
-                    rname = __unsafe_zn_get_resource_name_from_key(zn, _ZN_IS_LOCAL, &qle->key);
-                    if (rname == NULL)
-                        continue;
-                }
-
-                if (zn_rname_intersect(rname, query->key.rname))
-                {
-                    q.kind = qle->kind;
-                    qle->callback(&q, qle->arg);
-                }
-
-                if (qle->key.rid != ZN_RESOURCE_ID_NONE)
-                    free(rname);
-            }
-
-            qles = z_list_tail(qles);
-        }
-    }
-    // Case 3) -> numerical reskey with suffix
+    // Case 2) and 3) -> string reskey, with or without a numerical prefix
     else
     {
-        // Compute the complete remote resource name starting from the key
-        z_str_t rname = __unsafe_zn_get_resource_name_from_key(zn, _ZN_IS_REMOTE, &query->key);
+        // The complete resource name of the remote key
+        int is_alloc;
+        z_str_t rname = __unsafe_zn_borrow_resource_name_from_key(zn, _ZN_IS_REMOTE, &query->key, &is_alloc);
         if (rname == NULL)
             goto EXIT_QLE_TRIG;
 
@@ -406,46 +288,17 @@ void _zn_trigger_queryables(zn_session_t *zn, const _zn_query_t *query)
         zn_query_t q;
         q.zn = zn;
         q.qid = query->qid;
-        q.rname = query->key.rname;
+        q.rname = rname;
         q.predicate = query->predicate;
 
-        z_list_t *qles = zn->local_queryables;
-        while (qles)
-        {
-            _zn_queryable_t *qle = (_zn_queryable_t *)z_list_head(qles);
-
-            unsigned int target = (query->target.kind & ZN_QUERYABLE_ALL_KINDS) | (query->target.kind & qle->kind);
-            if (target != 0)
-            {
-                // Get the complete resource name to be passed to the subscription callback
-                z_str_t lname;
-                if (qle->key.rid == ZN_RESOURCE_ID_NONE)
-                {
-                    // Do not allocate
-                    lname = qle->key.rname;
-                }
-                else
-                {
-                    // Allocate a computed string
-                    lname = __unsafe_zn_get_resource_name_from_key(zn, _ZN_IS_LOCAL, &qle->key);
-                    if (lname == NULL)
-                        continue;
-                }
-
-                if (zn_rname_intersect(lname, rname))
-                {
-                    q.kind = qle->kind;
-                    qle->callback(&q, qle->arg);
-                }
-
-                if (qle->key.rid != ZN_RESOURCE_ID_NONE)
-                    free(lname);
-            }
-
-            qles = z_list_tail(qles);
-        }
+        // Deliver it to the queryables whose resource name matches
+        _zn_query_delivery_t d;
+        d.query = &q;
+        d.target = query->target.kind;
+        _zn_rname_trie_match(&zn->local_queryables_trie, rname, __zn_deliver_matching_query, &d);
 
-        free(rname);
+        if (is_alloc)
+            free(rname);
     }
 
     // Send the final reply
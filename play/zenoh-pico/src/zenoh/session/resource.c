@@ -38,18 +38,8 @@ z_zint_t _zn_get_entity_id(zn_session_t *zn)
  */
 _zn_resource_t *__unsafe_zn_get_resource_by_id(zn_session_t *zn, int is_local, z_zint_t id)
 {
-    z_list_t *decls = is_local ? zn->local_resources : zn->remote_resources;
-    while (decls)
-    {
-        _zn_resource_t *decl = (_zn_resource_t *)z_list_head(decls);
-
-        if (decl->id == id)
-            return decl;
-
-        decls = z_list_tail(decls);
-    }
-
-    return NULL;
+    z_id_map_t *decls = is_local ? &zn->local_resources : &zn->remote_resources;
+    return (_zn_resource_t *)z_id_map_get(decls, id);
 }
 
 /**
@@ -59,79 +49,138 @@ _zn_resource_t *__unsafe_zn_get_resource_by_id(zn_session_t *zn, int is_local, z
  */
 _zn_resource_t *__unsafe_zn_get_resource_by_key(zn_session_t *zn, int is_local, const zn_reskey_t *reskey)
 {
-    z_list_t *decls = is_local ? zn->local_resources : zn->remote_resources;
-    while (decls)
+    z_id_map_t *decls = is_local ? &zn->local_resources : &zn->remote_resources;
+    size_t pos = 0;
+    _zn_resource_t *decl;
+    while ((decl = (_zn_resource_t *)z_id_map_next(decls, &pos)) != NULL)
     {
-        _zn_resource_t *decl = (_zn_resource_t *)z_list_head(decls);
-
         if (decl->key.rid == reskey->rid && strcmp(decl->key.rname, reskey->rname) == 0)
             return decl;
-
-        decls = z_list_tail(decls);
     }
 
     return NULL;
 }
 
+z_str_t __zn_resource_name_concat(const z_string_t *prefix, const char *suffix, size_t *len)
+{
+    size_t plen = prefix != NULL ? prefix->len : 0;
+    size_t slen = suffix != NULL ? strlen(suffix) : 0;
+
+    z_str_t rname = (z_str_t)malloc(plen + slen + 1);
+    if (plen > 0)
+        memcpy(rname, prefix->val, plen);
+    if (slen > 0)
+        memcpy(rname + plen, suffix, slen);
+    rname[plen + slen] = '\0';
+
+    *len = plen + slen;
+    return rname;
+}
+
 /**
+ * Expand the complete name of a resource, appending its suffix to the name of the resource
+ * its key builds on.
+ *
  * This function is unsafe because it operates in potentially concurrent data.
  * Make sure that the following mutexes are locked before calling this function:
  *  - zn->mutex_inner
  */
-z_str_t __unsafe_zn_get_resource_name_from_key(zn_session_t *zn, int is_local, const zn_reskey_t *reskey)
+void __unsafe_zn_expand_resource_name(zn_session_t *zn, int is_local, _zn_resource_t *res)
 {
-    z_str_t rname = NULL;
+    _z_string_reset(&res->name);
+    res->name_hash = 0;
 
-    // Case 2) -> string only reskey, duplicate the rname
-    if (reskey->rid == ZN_RESOURCE_ID_NONE)
+    const z_string_t *prefix = NULL;
+    if (res->key.rid != ZN_RESOURCE_ID_NONE)
     {
-        rname = strdup(reskey->rname);
-        return rname;
+        _zn_resource_t *base = __unsafe_zn_get_resource_by_id(zn, is_local, res->key.rid);
+        if (base == NULL || base->name.val == NULL)
+            return;
+        prefix = &base->name;
     }
 
-    // Need to build the complete resource name
-    z_list_t *strs = NULL;
-    size_t len = 0;
+    res->name.val = __zn_resource_name_concat(prefix, res->key.rname, &res->name.len);
+    res->name_hash = _z_string_hash(&res->name);
+}
 
-    if (reskey->rname)
+/**
+ * Expand again the names of the resources built on a (re)declared one, directly or not.
+ *
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->mutex_inner
+ */
+void __unsafe_zn_expand_dependent_resource_names(zn_session_t *zn, int is_local, z_zint_t id)
+{
+    z_id_map_t *children = is_local ? &zn->local_resource_children : &zn->remote_resource_children;
+    for (z_list_t *xs = (z_list_t *)z_id_map_get(children, id); xs != NULL; xs = z_list_tail(xs))
     {
-        // Case 3) -> numerical reskey with suffix, same as Case 1) but we first append the suffix
-        len += strlen(reskey->rname);
-        strs = z_list_cons(strs, (void *)reskey->rname);
-    }
+        _zn_resource_t *decl = (_zn_resource_t *)z_list_head(xs);
+        if (decl->id == id)
+            continue;
 
-    // Case 1) -> numerical only reskey
-    z_zint_t id = reskey->rid;
-    do
-    {
-        _zn_resource_t *res = __unsafe_zn_get_resource_by_id(zn, is_local, id);
-        if (res == NULL)
+        _z_string_free(&decl->name);
+        __unsafe_zn_expand_resource_name(zn, is_local, decl);
+        // A name that cannot be expanded leaves nothing to expand below it
+        if (decl->name.val == NULL)
+            continue;
+
+        if (!is_local)
         {
-            z_list_free(strs);
-            return rname;
+            __unsafe_zn_add_rem_res_to_loc_qle_map(zn, decl->id, &decl->key);
+            __unsafe_zn_update_subscription_route(zn, decl->id);
         }
+        __unsafe_zn_expand_dependent_resource_names(zn, is_local, decl->id);
+    }
+}
 
-        if (res->key.rname)
+/**
+ * Forget the names of the resources built on a forgotten one, directly or not.
+ *
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->mutex_inner
+ */
+void __unsafe_zn_invalidate_resource_names(zn_session_t *zn, int is_local, z_zint_t id)
+{
+    z_id_map_t *children = is_local ? &zn->local_resource_children : &zn->remote_resource_children;
+    for (z_list_t *xs = (z_list_t *)z_id_map_get(children, id); xs != NULL; xs = z_list_tail(xs))
+    {
+        _zn_resource_t *decl = (_zn_resource_t *)z_list_head(xs);
+        if (decl->name.val == NULL)
+            continue;
+
+        _z_string_free(&decl->name);
+        _z_string_reset(&decl->name);
+        if (!is_local)
         {
-            len += strlen(res->key.rname);
-            strs = z_list_cons(strs, (void *)res->key.rname);
+            z_list_free((z_list_t *)z_id_map_remove(&zn->rem_res_loc_qle_map, decl->id));
+            __unsafe_zn_update_subscription_route(zn, decl->id);
         }
+        __unsafe_zn_invalidate_resource_names(zn, is_local, decl->id);
+    }
+}
 
-        id = res->key.rid;
-    } while (id != ZN_RESOURCE_ID_NONE);
+/**
+ * Track a resource in the children of the resource its key builds on.
+ *
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->mutex_inner
+ */
+void __unsafe_zn_add_resource_child(zn_session_t *zn, int is_local, _zn_resource_t *res)
+{
+    if (res->key.rid == ZN_RESOURCE_ID_NONE)
+        return;
 
-    // Concatenate all the partial resource names
-    rname = (z_str_t)malloc(len + 1);
-    // Start with a zero-length string to concatenate upon
-    rname[0] = '\0';
-    while (strs)
-    {
-        z_str_t s = (z_str_t)z_list_head(strs);
-        strcat(rname, s);
-        strs = z_list_pop(strs);
-    }
+    z_id_map_t *children = is_local ? &zn->local_resource_children : &zn->remote_resource_children;
+    z_list_t *xs = (z_list_t *)z_id_map_remove(children, res->key.rid);
+    z_id_map_insert(children, res->key.rid, z_list_cons(xs, res));
+}
 
-    return rname;
+int __zn_resource_is_value(void *value, void *arg)
+{
+    return value == arg;
 }
 
 /**
@@ -139,48 +188,91 @@ z_str_t __unsafe_zn_get_resource_name_from_key(zn_session_t *zn, int is_local, c
  * Make sure that the following mutexes are locked before calling this function:
  *  - zn->mutex_inner
  */
-_zn_resource_t *__unsafe_zn_get_resource_matching_key(zn_session_t *zn, int is_local, const zn_reskey_t *reskey)
+void __unsafe_zn_remove_resource_child(zn_session_t *zn, int is_local, _zn_resource_t *res)
+{
+    if (res->key.rid == ZN_RESOURCE_ID_NONE)
+        return;
+
+    z_id_map_t *children = is_local ? &zn->local_resource_children : &zn->remote_resource_children;
+    z_list_t *xs = (z_list_t *)z_id_map_remove(children, res->key.rid);
+    xs = z_list_remove(xs, __zn_resource_is_value, res);
+    if (xs != NULL)
+        z_id_map_insert(children, res->key.rid, xs);
+}
+
+/**
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->mutex_inner
+ */
+z_str_t __unsafe_zn_get_resource_name_from_key(zn_session_t *zn, int is_local, const zn_reskey_t *reskey)
 {
-    z_list_t *decls = is_local ? zn->local_resources : zn->remote_resources;
+    size_t len;
 
-    z_str_t rname;
+    // Case 2) -> string only reskey, duplicate the rname
     if (reskey->rid == ZN_RESOURCE_ID_NONE)
-        rname = reskey->rname;
-    else
-        rname = __unsafe_zn_get_resource_name_from_key(zn, is_local, reskey);
+        return __zn_resource_name_concat(NULL, reskey->rname, &len);
 
-    while (decls)
-    {
-        _zn_resource_t *decl = (_zn_resource_t *)z_list_head(decls);
+    // Case 1) and 3) -> numerical reskey, with or without suffix, appended to the resource name
+    _zn_resource_t *res = __unsafe_zn_get_resource_by_id(zn, is_local, reskey->rid);
+    if (res == NULL || res->name.val == NULL)
+        return NULL;
 
-        z_str_t lname;
-        if (decl->key.rid == ZN_RESOURCE_ID_NONE)
-            lname = decl->key.rname;
-        else
-            lname = __unsafe_zn_get_resource_name_from_key(zn, is_local, &decl->key);
+    return __zn_resource_name_concat(&res->name, reskey->rname, &len);
+}
 
-        // Verify if it intersects
-        int res = zn_rname_intersect(lname, rname);
+/**
+ * Get the complete resource name of a key, borrowing it from the key or from the resource
+ * it refers to when it has no suffix. Otherwise the name is allocated and is_alloc is set,
+ * the caller has to free it.
+ *
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->mutex_inner
+ */
+z_str_t __unsafe_zn_borrow_resource_name_from_key(zn_session_t *zn, int is_local, const zn_reskey_t *reskey, int *is_alloc)
+{
+    *is_alloc = 0;
+    if (reskey->rid == ZN_RESOURCE_ID_NONE)
+        return reskey->rname;
 
-        // Free the resource key if allocated
-        if (decl->key.rid != ZN_RESOURCE_ID_NONE)
-            free(lname);
+    if (reskey->rname == NULL)
+    {
+        _zn_resource_t *res = __unsafe_zn_get_resource_by_id(zn, is_local, reskey->rid);
+        return res != NULL ? (z_str_t)res->name.val : NULL;
+    }
 
-        // Exit if it inersects
-        if (res)
-        {
-            if (reskey->rid != ZN_RESOURCE_ID_NONE)
-                free(rname);
-            return decl;
-        }
+    *is_alloc = 1;
+    return __unsafe_zn_get_resource_name_from_key(zn, is_local, reskey);
+}
 
-        decls = z_list_tail(decls);
+/**
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->mutex_inner
+ */
+_zn_resource_t *__unsafe_zn_get_resource_matching_key(zn_session_t *zn, int is_local, const zn_reskey_t *reskey)
+{
+    z_id_map_t *decls = is_local ? &zn->local_resources : &zn->remote_resources;
+
+    int is_alloc;
+    z_str_t rname = __unsafe_zn_borrow_resource_name_from_key(zn, is_local, reskey, &is_alloc);
+    if (rname == NULL)
+        return NULL;
+
+    size_t pos = 0;
+    _zn_resource_t *decl;
+    while ((decl = (_zn_resource_t *)z_id_map_next(decls, &pos)) != NULL)
+    {
+        // Verify if it intersects
+        if (decl->name.val != NULL && zn_rname_intersect((z_str_t)decl->name.val, rname))
+            break;
     }
 
-    if (reskey->rid != ZN_RESOURCE_ID_NONE)
+    if (is_alloc)
         free(rname);
 
-    return NULL;
+    return decl;
 }
 
 z_zint_t _zn_get_resource_id(zn_session_t *zn)
@@ -242,15 +334,20 @@ int _zn_register_resource(zn_session_t *zn, int is_local, _zn_resource_t *res)
     else
     {
         // No resource declaration has been found, add the new one
+        __unsafe_zn_expand_resource_name(zn, is_local, res);
+        __unsafe_zn_add_resource_child(zn, is_local, res);
         if (is_local)
         {
-            zn->local_resources = z_list_cons(zn->local_resources, res);
+            z_id_map_insert(&zn->local_resources, res->id, res);
+            __unsafe_zn_expand_dependent_resource_names(zn, is_local, res->id);
         }
         else
         {
-            __unsafe_zn_add_rem_res_to_loc_sub_map(zn, res->id, &res->key);
             __unsafe_zn_add_rem_res_to_loc_qle_map(zn, res->id, &res->key);
-            zn->remote_resources = z_list_cons(zn->remote_resources, res);
+            z_id_map_insert(&zn->remote_resources, res->id, res);
+            __unsafe_zn_update_subscription_route(zn, res->id);
+            // Resources declared before their base, or on a forgotten one, can be expanded now
+            __unsafe_zn_expand_dependent_resource_names(zn, is_local, res->id);
         }
 
         r = 0;
@@ -270,26 +367,7 @@ int _zn_register_resource(zn_session_t *zn, int is_local, _zn_resource_t *res)
 void __unsafe_zn_free_resource(_zn_resource_t *res)
 {
     _zn_reskey_free(&res->key);
-}
-
-/**
- * This function is unsafe because it operates in potentially concurrent data.
- * Make sure that the following mutexes are locked before calling this function:
- *  - zn->mutex_inner
- */
-int __unsafe_zn_resource_predicate(void *other, void *this)
-{
-    _zn_resource_t *o = (_zn_resource_t *)other;
-    _zn_resource_t *t = (_zn_resource_t *)this;
-    if (t->id == o->id)
-    {
-        __unsafe_zn_free_resource(t);
-        return 1;
-    }
-    else
-    {
-        return 0;
-    }
+    _z_string_free(&res->name);
 }
 
 void _zn_unregister_resource(zn_session_t *zn, int is_local, _zn_resource_t *res)
@@ -297,10 +375,19 @@ void _zn_unregister_resource(zn_session_t *zn, int is_local, _zn_resource_t *res
     // Lock the resources data struct
     z_mutex_lock(&zn->mutex_inner);
 
-    if (is_local)
-        zn->local_resources = z_list_remove(zn->local_resources, __unsafe_zn_resource_predicate, res);
-    else
-        zn->remote_resources = z_list_remove(zn->remote_resources, __unsafe_zn_resource_predicate, res);
+    z_id_map_t *decls = is_local ? &zn->local_resources : &zn->remote_resources;
+    if (z_id_map_remove(decls, res->id) != NULL)
+    {
+        __unsafe_zn_remove_resource_child(zn, is_local, res);
+        __unsafe_zn_free_resource(res);
+        __unsafe_zn_invalidate_resource_names(zn, is_local, res->id);
+    }
+    if (!is_local)
+    {
+        // Forget the local entities matching the remote resource
+        z_list_free((z_list_t *)z_id_map_remove(&zn->rem_res_loc_qle_map, res->id));
+        __unsafe_zn_update_subscription_route(zn, res->id);
+    }
     free(res);
 
     // Release the lock
@@ -312,21 +399,29 @@ void _zn_flush_resources(zn_session_t *zn)
     // Lock the resources data struct
     z_mutex_lock(&zn->mutex_inner);
 
-    while (zn->local_resources)
+    z_id_map_t *decls[] = {&zn->local_resources, &zn->remote_resources};
+    for (size_t i = 0; i < 2; i++)
     {
-        _zn_resource_t *res = (_zn_resource_t *)z_list_head(zn->local_resources);
-        __unsafe_zn_free_resource(res);
-        free(res);
-        zn->local_resources = z_list_pop(zn->local_resources);
+        size_t pos = 0;
+        _zn_resource_t *res;
+        while ((res = (_zn_resource_t *)z_id_map_next(decls[i], &pos)) != NULL)
+        {
+            __unsafe_zn_free_resource(res);
+            free(res);
+        }
+        z_id_map_clear(decls[i]);
     }
 
-    while (zn->remote_resources)
+    z_id_map_t *children[] = {&zn->local_resource_children, &zn->remote_resource_children};
+    for (size_t i = 0; i < 2; i++)
     {
-        _zn_resource_t *res = (_zn_resource_t *)z_list_head(zn->remote_resources);
-        __unsafe_zn_free_resource(res);
-        free(res);
-        zn->remote_resources = z_list_pop(zn->remote_resources);
+        size_t pos = 0;
+        z_list_t *xs;
+        while ((xs = (z_list_t *)z_id_map_next(children[i], &pos)) != NULL)
+            z_list_free(xs);
+        z_id_map_clear(children[i]);
     }
+    __unsafe_zn_publish_subscription_snapshot(zn);
 
     // Release the lock
     z_mutex_unlock(&zn->mutex_inner);
@@ -15,9 +15,12 @@
 #include "zenoh-pico/protocol/utils.h"
 #include "zenoh-pico/protocol/private/msg.h"
 #include "zenoh-pico/protocol/private/msgcodec.h"
+#include "zenoh-pico/protocol/private/utils.h"
 #include "zenoh-pico/session/types.h"
 #include "zenoh-pico/session/private/types.h"
 #include "zenoh-pico/session/private/resource.h"
+#include "zenoh-pico/session/private/subscription.h"
+#include "zenoh-pico/session/private/utils.h"
 #include "zenoh-pico/system/common.h"
 #include "zenoh-pico/utils/private/logging.h"
 #include "zenoh-pico/utils/collections.h"
@@ -30,6 +33,12 @@ z_zint_t _zn_get_pull_id(zn_session_t *zn)
 }
 
 /*------------------ Subscription ------------------*/
+void __zn_subscription_collect(void *sub, void *arg)
+{
+    z_list_t **xs = (z_list_t **)arg;
+    *xs = z_list_cons(*xs, sub);
+}
+
 /**
  * This function is unsafe because it operates in potentially concurrent data.
  * Make sure that the following mutexes are locked before calling this function:
@@ -39,124 +48,21 @@ z_list_t *__unsafe_zn_get_subscriptions_from_remote_key(zn_session_t *zn, const
 {
     z_list_t *xs = z_list_empty;
 
-    // Case 1) -> numerical only reskey
-    if (reskey->rname == NULL)
-    {
-        z_list_t *subs = (z_list_t *)z_i_map_get(zn->rem_res_loc_sub_map, reskey->rid);
-        while (subs)
-        {
-            _zn_subscriber_t *sub = (_zn_subscriber_t *)z_list_head(subs);
-            xs = z_list_cons(xs, sub);
-            subs = z_list_tail(subs);
-        }
-    }
-    // Case 2) -> string only reskey
-    else if (reskey->rid == ZN_RESOURCE_ID_NONE)
-    {
-        // The complete resource name of the remote key
-        z_str_t rname = reskey->rname;
-
-        z_list_t *subs = zn->local_subscriptions;
-        while (subs)
-        {
-            _zn_subscriber_t *sub = (_zn_subscriber_t *)z_list_head(subs);
-
-            // The complete resource name of the subscribed key
-            z_str_t lname;
-            if (sub->key.rid == ZN_RESOURCE_ID_NONE)
-            {
-                // Do not allocate
-                lname = sub->key.rname;
-            }
-            else
-            {
-                // Allocate a computed string
-                lname = __unsafe_zn_get_resource_name_from_key(zn, _ZN_IS_LOCAL, &sub->key);
-                if (lname == NULL)
-                {
-                    z_list_free(xs);
-                    xs = NULL;
-                    return xs;
-                }
-            }
-
-            if (zn_rname_intersect(lname, rname))
-                xs = z_list_cons(xs, sub);
-
-            if (sub->key.rid != ZN_RESOURCE_ID_NONE)
-                free(lname);
-
-            subs = z_list_tail(subs);
-        }
-    }
-    // Case 3) -> numerical reskey with suffix
-    else
-    {
-        _zn_resource_t *remote = __unsafe_zn_get_resource_by_id(zn, _ZN_IS_REMOTE, reskey->rid);
-        if (remote == NULL)
-            return xs;
-
-        // Compute the complete remote resource name starting from the key
-        z_str_t rname = __unsafe_zn_get_resource_name_from_key(zn, _ZN_IS_REMOTE, reskey);
+    // The complete resource name of the remote key, whether numerical or not
+    int is_alloc;
+    z_str_t rname = __unsafe_zn_borrow_resource_name_from_key(zn, _ZN_IS_REMOTE, reskey, &is_alloc);
+    if (rname == NULL)
+        return xs;
 
-        z_list_t *subs = zn->local_subscriptions;
-        while (subs)
-        {
-            _zn_subscriber_t *sub = (_zn_subscriber_t *)z_list_head(subs);
-
-            // Get the complete resource name to be passed to the subscription callback
-            z_str_t lname;
-            if (sub->key.rid == ZN_RESOURCE_ID_NONE)
-            {
-                // Do not allocate
-                lname = sub->key.rname;
-            }
-            else
-            {
-                // Allocate a computed string
-                lname = __unsafe_zn_get_resource_name_from_key(zn, _ZN_IS_LOCAL, &sub->key);
-                if (lname == NULL)
-                    continue;
-            }
-
-            if (zn_rname_intersect(lname, rname))
-                xs = z_list_cons(xs, sub);
-
-            if (sub->key.rid != ZN_RESOURCE_ID_NONE)
-                free(lname);
-
-            subs = z_list_tail(subs);
-        }
+    // Look the matching subscriptions up by their resource name
+    _zn_rname_trie_match(&zn->local_subscriptions_trie, rname, __zn_subscription_collect, &xs);
 
+    if (is_alloc)
         free(rname);
-    }
 
     return xs;
 }
 
-/**
- * This function is unsafe because it operates in potentially concurrent data.
- * Make sure that the following mutexes are locked before calling this function:
- *  - zn->mutex_inner
- */
-void __unsafe_zn_add_rem_res_to_loc_sub_map(zn_session_t *zn, z_zint_t id, zn_reskey_t *reskey)
-{
-    // Check if there is a matching local subscription
-    z_list_t *subs = __unsafe_zn_get_subscriptions_from_remote_key(zn, reskey);
-    if (subs)
-    {
-        // Update the list
-        z_list_t *sl = z_i_map_get(zn->rem_res_loc_sub_map, id);
-        if (sl)
-        {
-            // Free any ancient list
-            z_list_free(sl);
-        }
-        // Update the list of active subscriptions
-        z_i_map_set(zn->rem_res_loc_sub_map, id, subs);
-    }
-}
-
 /**
  * This function is unsafe because it operates in potentially concurrent data.
  * Make sure that the following mutexes are locked before calling this function:
@@ -164,18 +70,8 @@ void __unsafe_zn_add_rem_res_to_loc_sub_map(zn_session_t *zn, z_zint_t id, zn_re
  */
 _zn_subscriber_t *__unsafe_zn_get_subscription_by_id(zn_session_t *zn, int is_local, z_zint_t id)
 {
-    z_list_t *subs = is_local ? zn->local_subscriptions : zn->remote_subscriptions;
-    while (subs)
-    {
-        _zn_subscriber_t *sub = (_zn_subscriber_t *)z_list_head(subs);
-
-        if (sub->id == id)
-            return sub;
-
-        subs = z_list_tail(subs);
-    }
-
-    return NULL;
+    z_id_map_t *subs = is_local ? &zn->local_subscriptions : &zn->remote_subscriptions;
+    return (_zn_subscriber_t *)z_id_map_get(subs, id);
 }
 
 /**
@@ -185,15 +81,13 @@ _zn_subscriber_t *__unsafe_zn_get_subscription_by_id(zn_session_t *zn, int is_lo
  */
 _zn_subscriber_t *__unsafe_zn_get_subscription_by_key(zn_session_t *zn, int is_local, const zn_reskey_t *reskey)
 {
-    z_list_t *subs = is_local ? zn->local_subscriptions : zn->remote_subscriptions;
-    while (subs)
+    z_id_map_t *subs = is_local ? &zn->local_subscriptions : &zn->remote_subscriptions;
+    size_t pos = 0;
+    _zn_subscriber_t *sub;
+    while ((sub = (_zn_subscriber_t *)z_id_map_next(subs, &pos)) != NULL)
     {
-        _zn_subscriber_t *sub = (_zn_subscriber_t *)z_list_head(subs);
-
         if (sub->key.rid == reskey->rid && strcmp(sub->key.rname, reskey->rname) == 0)
             return sub;
-
-        subs = z_list_tail(subs);
     }
 
     return NULL;
@@ -219,34 +113,6 @@ _zn_subscriber_t *_zn_get_subscription_by_key(zn_session_t *zn, int is_local, co
     return sub;
 }
 
-/**
- * This function is unsafe because it operates in potentially concurrent data.
- * Make sure that the following mutexes are locked before calling this function:
- *  - zn->mutex_inner
- */
-void __unsafe_zn_add_loc_sub_to_rem_res_map(zn_session_t *zn, _zn_subscriber_t *sub)
-{
-    // Need to check if there is a remote resource declaration matching the new subscription
-    zn_reskey_t loc_key;
-    loc_key.rid = ZN_RESOURCE_ID_NONE;
-    if (sub->key.rid == ZN_RESOURCE_ID_NONE)
-        loc_key.rname = sub->key.rname;
-    else
-        loc_key.rname = __unsafe_zn_get_resource_name_from_key(zn, _ZN_IS_LOCAL, &sub->key);
-
-    _zn_resource_t *rem_res = __unsafe_zn_get_resource_matching_key(zn, _ZN_IS_REMOTE, &loc_key);
-    if (rem_res)
-    {
-        // Update the list of active subscriptions
-        z_list_t *subs = z_i_map_get(zn->rem_res_loc_sub_map, rem_res->id);
-        subs = z_list_cons(subs, sub);
-        z_i_map_set(zn->rem_res_loc_sub_map, rem_res->id, subs);
-    }
-
-    if (sub->key.rid != ZN_RESOURCE_ID_NONE)
-        free(loc_key.rname);
-}
-
 z_list_t *_zn_get_subscriptions_from_remote_key(zn_session_t *zn, const zn_reskey_t *reskey)
 {
     // Acquire the lock on the subscriptions data struct
@@ -265,24 +131,34 @@ int _zn_register_subscription(zn_session_t *zn, int is_local, _zn_subscriber_t *
     z_mutex_lock(&zn->mutex_inner);
 
     int res;
+    sub->rname = NULL;
     _zn_subscriber_t *s = __unsafe_zn_get_subscription_by_key(zn, is_local, &sub->key);
-    if (s)
+    if (s || __unsafe_zn_get_subscription_by_id(zn, is_local, sub->id))
     {
         // A subscription for this key already exists, return error
         res = -1;
     }
-    else
+    else if (is_local)
     {
-        // Register the new subscription
-        if (is_local)
+        // Index the new subscription by its complete resource name, the resource it builds
+        // on must have been declared
+        sub->rname = __unsafe_zn_get_resource_name_from_key(zn, _ZN_IS_LOCAL, &sub->key);
+        if (sub->rname == NULL)
         {
-            __unsafe_zn_add_loc_sub_to_rem_res_map(zn, sub);
-            zn->local_subscriptions = z_list_cons(zn->local_subscriptions, sub);
+            res = -1;
         }
         else
         {
-            zn->remote_subscriptions = z_list_cons(zn->remote_subscriptions, sub);
+            z_id_map_insert(&zn->local_subscriptions, sub->id, sub);
+            _zn_rname_trie_insert(&zn->local_subscriptions_trie, sub->rname, sub);
+            __unsafe_zn_publish_subscription_snapshot(zn);
+            res = 0;
         }
+    }
+    else
+    {
+        // Register the new subscription
+        z_id_map_insert(&zn->remote_subscriptions, sub->id, sub);
         res = 0;
     }
 
@@ -300,202 +176,364 @@ int _zn_register_subscription(zn_session_t *zn, int is_local, _zn_subscriber_t *
 void __unsafe_zn_free_subscription(_zn_subscriber_t *sub)
 {
     _zn_reskey_free(&sub->key);
+    free(sub->rname);
     if (sub->info.period)
         free(sub->info.period);
 }
 
+void _zn_unregister_subscription(zn_session_t *zn, int is_local, _zn_subscriber_t *s)
+{
+    // Acquire the lock on the subscription list
+    z_mutex_lock(&zn->mutex_inner);
+
+    z_id_map_t *subs = is_local ? &zn->local_subscriptions : &zn->remote_subscriptions;
+    if (z_id_map_remove(subs, s->id) != NULL)
+    {
+        if (is_local)
+        {
+            _zn_rname_trie_remove(&zn->local_subscriptions_trie, s->rname, s);
+            __unsafe_zn_publish_subscription_snapshot(zn);
+        }
+        __unsafe_zn_free_subscription(s);
+    }
+    free(s);
+
+    // Release the lock
+    z_mutex_unlock(&zn->mutex_inner);
+
+    // The read task might still be delivering a sample to the subscription
+    if (is_local)
+        _zn_subscription_snapshot_synchronize(zn);
+}
+
+void _zn_flush_subscriptions(zn_session_t *zn)
+{
+    // Lock the resources data struct
+    z_mutex_lock(&zn->mutex_inner);
+
+    z_id_map_t *subs[] = {&zn->local_subscriptions, &zn->remote_subscriptions};
+    for (size_t i = 0; i < 2; i++)
+    {
+        size_t pos = 0;
+        _zn_subscriber_t *sub;
+        while ((sub = (_zn_subscriber_t *)z_id_map_next(subs[i], &pos)) != NULL)
+        {
+            __unsafe_zn_free_subscription(sub);
+            free(sub);
+        }
+        z_id_map_clear(subs[i]);
+    }
+
+    _zn_rname_trie_clear(&zn->local_subscriptions_trie);
+    __unsafe_zn_drop_subscription_snapshot(zn);
+
+    // Release the lock
+    z_mutex_unlock(&zn->mutex_inner);
+}
+
+/*------------------ Snapshot ------------------*/
+// NOTE: the reading thread matches the samples against a snapshot of the subscriptions
+//       rather than against the session tables, so that it takes no lock and runs the
+//       callbacks while the application declares or undeclares entities. A change of the
+//       local subscriptions builds a new snapshot and publishes it in place of the previous one.
+//       The readers announce themselves in subscription_snapshot_readers while they take
+//       a reference on the snapshot, so that the writer dropping it never frees it under them.
+//       The remote resources are declared and forgotten by the reading thread, which is the
+//       only one matching the samples, hence it patches the routes of the snapshot in place.
+
+// The session whose samples are being delivered by the current thread, if any
+static __thread zn_session_t *_zn_delivering_session = NULL;
+
+void __zn_subscription_route_free(_zn_subscription_route_t *route)
+{
+    _z_string_free(&route->name);
+    free(route->subs);
+    free(route);
+}
+
+_zn_subscription_route_t *__zn_subscription_route_make(_zn_subscription_snapshot_t *snap, const _zn_resource_t *res)
+{
+    z_list_t *xs = z_list_empty;
+    _zn_rname_trie_match(&snap->trie, res->name.val, __zn_subscription_collect, &xs);
+
+    _zn_subscription_route_t *route = (_zn_subscription_route_t *)malloc(sizeof(_zn_subscription_route_t));
+    _z_string_copy(&route->name, &res->name);
+    route->hash = res->name_hash;
+    route->len = z_list_len(xs);
+    route->subs = (_zn_subscriber_t **)malloc((route->len > 0 ? route->len : 1) * sizeof(_zn_subscriber_t *));
+    for (size_t i = 0; xs; i++)
+    {
+        route->subs[i] = (_zn_subscriber_t *)z_list_head(xs);
+        xs = z_list_pop(xs);
+    }
+
+    return route;
+}
+
+void _zn_subscription_snapshot_release(zn_session_t *zn, _zn_subscription_snapshot_t *snap)
+{
+    if (__atomic_sub_fetch(&snap->refcount, 1, __ATOMIC_ACQ_REL) > 0)
+        return;
+
+    size_t pos = 0;
+    _zn_subscription_route_t *route;
+    while ((route = (_zn_subscription_route_t *)z_id_map_next(&snap->routes, &pos)) != NULL)
+        __zn_subscription_route_free(route);
+    z_id_map_clear(&snap->routes);
+    _zn_rname_trie_clear(&snap->trie);
+    free(snap->subs);
+    free(snap);
+
+    // Only the snapshots dropped by the session are ever freed
+    z_mutex_lock(&zn->mutex_snapshot);
+    zn->subscription_snapshots_dropped--;
+    if (zn->subscription_snapshots_dropped == 0)
+        z_condvar_signal(&zn->cond_snapshot);
+    z_mutex_unlock(&zn->mutex_snapshot);
+}
+
 /**
  * This function is unsafe because it operates in potentially concurrent data.
  * Make sure that the following mutexes are locked before calling this function:
  *  - zn->mutex_inner
  */
-int __unsafe_zn_subscription_predicate(void *other, void *this)
+_zn_subscription_snapshot_t *__unsafe_zn_subscription_snapshot_make(zn_session_t *zn)
 {
-    _zn_subscriber_t *o = (_zn_subscriber_t *)other;
-    _zn_subscriber_t *t = (_zn_subscriber_t *)this;
-    if (t->id == o->id)
+    _zn_subscription_snapshot_t *snap = (_zn_subscription_snapshot_t *)malloc(sizeof(_zn_subscription_snapshot_t));
+    snap->refcount = 1;
+    snap->len = z_id_map_len(&zn->local_subscriptions);
+    snap->subs = (_zn_subscriber_t *)malloc((snap->len > 0 ? snap->len : 1) * sizeof(_zn_subscriber_t));
+    _zn_rname_trie_init(&snap->trie);
+    z_id_map_init(&snap->routes);
+
+    // Copy what the delivery needs, the names are only used to index the copies
+    size_t pos = 0;
+    size_t i = 0;
+    _zn_subscriber_t *sub;
+    while ((sub = (_zn_subscriber_t *)z_id_map_next(&zn->local_subscriptions, &pos)) != NULL)
     {
-        __unsafe_zn_free_subscription(t);
-        return 1;
+        _zn_subscriber_t *copy = &snap->subs[i++];
+        *copy = *sub;
+        copy->key.rname = NULL;
+        copy->rname = NULL;
+        copy->info.period = NULL;
+        _zn_rname_trie_insert(&snap->trie, sub->rname, copy);
     }
-    else
+
+    // Resolve once the subscriptions matching each remote resource
+    pos = 0;
+    _zn_resource_t *res;
+    while ((res = (_zn_resource_t *)z_id_map_next(&zn->remote_resources, &pos)) != NULL)
     {
-        return 0;
+        if (res->name.val != NULL)
+            z_id_map_insert(&snap->routes, res->id, __zn_subscription_route_make(snap, res));
     }
+
+    return snap;
 }
 
-void _zn_unregister_subscription(zn_session_t *zn, int is_local, _zn_subscriber_t *s)
+/**
+ * Resolve again the subscriptions matching a remote resource of the published snapshot,
+ * after the resource has been declared, forgotten or renamed.
+ *
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->mutex_inner
+ */
+void __unsafe_zn_update_subscription_route(zn_session_t *zn, z_zint_t id)
 {
-    // Acquire the lock on the subscription list
-    z_mutex_lock(&zn->mutex_inner);
+    _zn_subscription_snapshot_t *snap = zn->subscription_snapshot;
+    if (snap == NULL)
+        return;
 
-    if (is_local)
-        zn->local_subscriptions = z_list_remove(zn->local_subscriptions, __unsafe_zn_subscription_predicate, s);
-    else
-        zn->remote_subscriptions = z_list_remove(zn->remote_subscriptions, __unsafe_zn_subscription_predicate, s);
-    free(s);
+    _zn_subscription_route_t *route = (_zn_subscription_route_t *)z_id_map_remove(&snap->routes, id);
+    if (route != NULL)
+        __zn_subscription_route_free(route);
 
-    // Release the lock
-    z_mutex_unlock(&zn->mutex_inner);
+    _zn_resource_t *res = __unsafe_zn_get_resource_by_id(zn, _ZN_IS_REMOTE, id);
+    if (res != NULL && res->name.val != NULL)
+        z_id_map_insert(&snap->routes, id, __zn_subscription_route_make(snap, res));
 }
 
-void _zn_flush_subscriptions(zn_session_t *zn)
+/**
+ * Publish a snapshot in place of the previous one, which is freed once released by the readers
+ * still holding it.
+ *
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->mutex_inner
+ */
+void __unsafe_zn_replace_subscription_snapshot(zn_session_t *zn, _zn_subscription_snapshot_t *snap)
 {
-    // Lock the resources data struct
-    z_mutex_lock(&zn->mutex_inner);
+    snap = __atomic_exchange_n(&zn->subscription_snapshot, snap, __ATOMIC_SEQ_CST);
+    if (snap == NULL)
+        return;
+
+    // Wait for the readers which might have loaded the previous snapshot to take their reference,
+    // which only takes a few instructions
+    while (__atomic_load_n(&zn->subscription_snapshot_readers, __ATOMIC_SEQ_CST) > 0)
+        z_sleep_us(1);
+
+    z_mutex_lock(&zn->mutex_snapshot);
+    zn->subscription_snapshots_dropped++;
+    z_mutex_unlock(&zn->mutex_snapshot);
+    _zn_subscription_snapshot_release(zn, snap);
+}
+
+/**
+ * Publish a snapshot of the local subscriptions after they have changed.
+ *
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->mutex_inner
+ */
+void __unsafe_zn_publish_subscription_snapshot(zn_session_t *zn)
+{
+    __unsafe_zn_replace_subscription_snapshot(zn, __unsafe_zn_subscription_snapshot_make(zn));
+}
+
+/**
+ * Drop the published snapshot when the session is freed.
+ *
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->mutex_inner
+ */
+void __unsafe_zn_drop_subscription_snapshot(zn_session_t *zn)
+{
+    __unsafe_zn_replace_subscription_snapshot(zn, NULL);
+}
 
-    while (zn->local_subscriptions)
+/**
+ * Wait for the readers to release the snapshots dropped so far, so that none of them still
+ * runs a callback copied in those. The thread delivering the samples of the session holds one
+ * of them, it does not wait for itself.
+ */
+void _zn_subscription_snapshot_synchronize(zn_session_t *zn)
+{
+    if (_zn_delivering_session == zn)
+        return;
+
+    z_mutex_lock(&zn->mutex_snapshot);
+    while (zn->subscription_snapshots_dropped > 0)
+        z_condvar_wait(&zn->cond_snapshot, &zn->mutex_snapshot);
+    // Pass the wake up on to the other threads synchronizing
+    z_condvar_signal(&zn->cond_snapshot);
+    z_mutex_unlock(&zn->mutex_snapshot);
+}
+
+_zn_subscription_snapshot_t *_zn_subscription_snapshot_acquire(zn_session_t *zn)
+{
+    __atomic_add_fetch(&zn->subscription_snapshot_readers, 1, __ATOMIC_SEQ_CST);
+    _zn_subscription_snapshot_t *snap = __atomic_load_n(&zn->subscription_snapshot, __ATOMIC_SEQ_CST);
+    __atomic_add_fetch(&snap->refcount, 1, __ATOMIC_RELAXED);
+    __atomic_sub_fetch(&zn->subscription_snapshot_readers, 1, __ATOMIC_SEQ_CST);
+    return snap;
+}
+
+/*------------------ Trigger ------------------*/
+void __zn_deliver_sample(zn_session_t *zn, _zn_subscriber_t *sub, const zn_sample_t *s, size_t hash, z_list_t **jobs)
+{
+    if (jobs == NULL)
     {
-        _zn_subscriber_t *sub = (_zn_subscriber_t *)z_list_head(zn->local_subscriptions);
-        __unsafe_zn_free_subscription(sub);
-        free(sub);
-        zn->local_subscriptions = z_list_pop(zn->local_subscriptions);
+        sub->callback(s, sub->arg);
+        return;
     }
 
-    while (zn->remote_subscriptions)
+    // The samples are handed over to the dispatcher once all of them are matched
+    _zn_dispatch_job_t *job = _zn_dispatch_job_make(sub, s, hash);
+    if (job == NULL)
     {
-        _zn_subscriber_t *sub = (_zn_subscriber_t *)z_list_head(zn->remote_subscriptions);
-        __unsafe_zn_free_subscription(sub);
-        free(sub);
-        zn->remote_subscriptions = z_list_pop(zn->remote_subscriptions);
+        _Z_DEBUG("Dropping sample because it can not be copied for the dispatcher\n");
+        _ZN_STATS_INC(zn, rx_dropped_dispatch);
+        return;
     }
-    z_i_map_free(zn->rem_res_loc_sub_map);
+    *jobs = z_list_cons(*jobs, job);
+}
 
-    // Release the lock
-    z_mutex_unlock(&zn->mutex_inner);
+typedef struct
+{
+    zn_session_t *zn;
+    const zn_sample_t *sample;
+    size_t hash;
+    z_list_t **jobs;
+} _zn_sample_delivery_t;
+
+void __zn_deliver_matching_sample(void *sub, void *arg)
+{
+    _zn_sample_delivery_t *d = (_zn_sample_delivery_t *)arg;
+    __zn_deliver_sample(d->zn, (_zn_subscriber_t *)sub, d->sample, d->hash, d->jobs);
 }
 
 void _zn_trigger_subscriptions(zn_session_t *zn, const zn_reskey_t reskey, const z_bytes_t payload)
 {
-    // Acquire the lock on the subscription list
-    z_mutex_lock(&zn->mutex_inner);
+    z_list_t *jobs = z_list_empty;
+    // The dispatcher can not be stopped before the samples are queued
+    unsigned int workers_num = 0;
+    _zn_dispatch_worker_t *workers = _zn_dispatch_acquire(zn, &workers_num);
+    z_list_t **p_jobs = workers != NULL ? &jobs : NULL;
+
+    // No lock is held while matching the sample and running the callbacks, which may
+    // declare or undeclare entities
+    _zn_subscription_snapshot_t *snap = _zn_subscription_snapshot_acquire(zn);
+    zn_session_t *delivering = _zn_delivering_session;
+    _zn_delivering_session = zn;
+
+    // The remote resource the key builds on, its complete name expanded when it was declared
+    _zn_subscription_route_t *route = NULL;
+    if (reskey.rid != ZN_RESOURCE_ID_NONE)
+    {
+        route = (_zn_subscription_route_t *)z_id_map_get(&snap->routes, reskey.rid);
+        if (route == NULL)
+            goto EXIT_SUB_TRIG;
+    }
 
     // Case 1) -> numeric only reskey
     if (reskey.rname == NULL)
     {
-        // Get the declared resource
-        _zn_resource_t *res = __unsafe_zn_get_resource_by_id(zn, _ZN_IS_REMOTE, reskey.rid);
-        if (res == NULL)
-            goto EXIT_SUB_TRIG;
-
-        // Get the complete resource name to be passed to the subscription callback
-        z_str_t rname;
-        if (res->key.rid == ZN_RESOURCE_ID_NONE)
-        {
-            // Do not allocate
-            rname = res->key.rname;
-        }
-        else
-        {
-            // Allocate a computed string
-            rname = __unsafe_zn_get_resource_name_from_key(zn, _ZN_IS_LOCAL, &res->key);
-            if (rname == NULL)
-                goto EXIT_SUB_TRIG;
-        }
-
         // Build the sample
         zn_sample_t s;
-        s.key.val = rname;
-        s.key.len = strlen(s.key.val);
+        s.key = route->name;
         s.value = payload;
 
         // Iterate over the matching subscriptions
-        z_list_t *subs = (z_list_t *)z_i_map_get(zn->rem_res_loc_sub_map, reskey.rid);
-        while (subs)
-        {
-            _zn_subscriber_t *sub = (_zn_subscriber_t *)z_list_head(subs);
-            sub->callback(&s, sub->arg);
-            subs = z_list_tail(subs);
-        }
-
-        if (res->key.rid != ZN_RESOURCE_ID_NONE)
-            free(rname);
+        for (size_t i = 0; i < route->len; i++)
+            __zn_deliver_sample(zn, route->subs[i], &s, route->hash, p_jobs);
     }
-    // Case 2) -> string only reskey
-    else if (reskey.rid == ZN_RESOURCE_ID_NONE)
+    // Case 2) and 3) -> string reskey, with or without a numerical prefix
+    else
     {
-        // Build the sample
+        // The complete resource name of the remote key
         zn_sample_t s;
-        s.key.val = reskey.rname;
-        s.key.len = strlen(s.key.val);
-        s.value = payload;
-
-        z_list_t *subs = zn->local_subscriptions;
-        while (subs)
+        z_str_t rname = NULL;
+        if (route == NULL)
         {
-            _zn_subscriber_t *sub = (_zn_subscriber_t *)z_list_head(subs);
-
-            // Get the complete resource name to be passed to the subscription callback
-            z_str_t rname;
-            if (sub->key.rid == ZN_RESOURCE_ID_NONE)
-            {
-                // Do not allocate
-                rname = sub->key.rname;
-            }
-            else
-            {
-                // Allocate a computed string
-                rname = __unsafe_zn_get_resource_name_from_key(zn, _ZN_IS_LOCAL, &sub->key);
-                if (rname == NULL)
-                    continue;
-            }
-
-            if (zn_rname_intersect(rname, reskey.rname))
-                sub->callback(&s, sub->arg);
-
-            if (sub->key.rid != ZN_RESOURCE_ID_NONE)
-                free(rname);
-
-            subs = z_list_tail(subs);
+            s.key.val = reskey.rname;
+            s.key.len = strlen(reskey.rname);
         }
-    }
-    // Case 3) -> numerical reskey with suffix
-    else
-    {
-        // Compute the complete remote resource name starting from the key
-        z_str_t rname = __unsafe_zn_get_resource_name_from_key(zn, _ZN_IS_REMOTE, &reskey);
-        if (rname == NULL)
-            goto EXIT_SUB_TRIG;
-
-        // Build the sample
-        zn_sample_t s;
-        s.key.val = rname;
-        s.key.len = strlen(s.key.val);
-        s.value = payload;
-
-        z_list_t *subs = zn->local_subscriptions;
-        while (subs)
+        else
         {
-            _zn_subscriber_t *sub = (_zn_subscriber_t *)z_list_head(subs);
-
-            // Get the complete resource name to be passed to the subscription callback
-            z_str_t lname;
-            if (sub->key.rid == ZN_RESOURCE_ID_NONE)
-            {
-                // Do not allocate
-                lname = sub->key.rname;
-            }
-            else
-            {
-                // Allocate a computed string
-                lname = __unsafe_zn_get_resource_name_from_key(zn, _ZN_IS_LOCAL, &sub->key);
-                if (lname == NULL)
-                    continue;
-            }
-
-            if (zn_rname_intersect(lname, rname))
-                sub->callback(&s, sub->arg);
-
-            if (sub->key.rid != ZN_RESOURCE_ID_NONE)
-                free(lname);
-
-            subs = z_list_tail(subs);
+            rname = __zn_resource_name_concat(&route->name, reskey.rname, &s.key.len);
+            s.key.val = rname;
         }
+        s.value = payload;
+
+        // Deliver the sample to the subscriptions whose resource name matches
+        _zn_sample_delivery_t d;
+        d.zn = zn;
+        d.sample = &s;
+        d.hash = workers != NULL ? _z_string_hash(&s.key) : 0;
+        d.jobs = p_jobs;
+        _zn_rname_trie_match(&snap->trie, s.key.val, __zn_deliver_matching_sample, &d);
 
         free(rname);
     }
 
 EXIT_SUB_TRIG:
-    // Release the lock
-    z_mutex_unlock(&zn->mutex_inner);
+    _zn_delivering_session = delivering;
+    _zn_subscription_snapshot_release(zn, snap);
+
+    // Queue the samples once all of them are matched, the queues might be full
+    if (workers != NULL)
+        _zn_dispatch_jobs(zn, workers, workers_num, jobs);
 }
@@ -19,11 +19,14 @@
 #include "zenoh-pico/protocol/utils.h"
 #include "zenoh-pico/utils/private/logging.h"
 #include "zenoh-pico/system/common.h"
+#include "zenoh-pico/system/collections.h"
+#include "zenoh-pico/session/api.h"
 #include "zenoh-pico/session/types.h"
 #include "zenoh-pico/session/private/resource.h"
 #include "zenoh-pico/session/private/subscription.h"
 #include "zenoh-pico/session/private/queryable.h"
 #include "zenoh-pico/session/private/query.h"
+#include "zenoh-pico/session/private/utils.h"
 #include "zenoh-pico/transport/private/utils.h"
 #include "zenoh-pico/link/private/manager.h"
 #include "zenoh-pico/utils/types.h"
@@ -63,7 +66,10 @@ void _zn_default_on_disconnect(void *vz)
         _Z_DEBUG("Tring to reconnect...\n");
         _zn_socket_result_t r_sock = zn->link->open_f(zn->link, 0);
         if (r_sock.tag == _z_res_t_OK)
+        {
+            _ZN_STATS_INC(zn, reconnects);
             break;
+        }
     }
 }
 
@@ -75,15 +81,35 @@ zn_session_t *_zn_session_init()
     zn->wbuf = _z_wbuf_make(ZN_WRITE_BUF_LEN, 0);
     zn->zbuf = _z_zbuf_make(ZN_READ_BUF_LEN);
 
+    // The ring buffer is allocated on the first read of a stream link
+    zn->rbuf.buf = NULL;
+
+    // The datagram buffers are allocated on the first batched read
+    zn->dgrams = NULL;
+    zn->dgrams_len = 0;
+    zn->dgrams_idx = 0;
+
+    zn->rx_arena = z_arena_make(ZN_RX_ARENA_SIZE);
+
     // Initialize the defragmentation buffers
-    zn->dbuf_reliable = _z_wbuf_make(0, 1);
-    zn->dbuf_best_effort = _z_wbuf_make(0, 1);
+    zn->dbuf_reliable.buf = _z_zbuf_make(0);
+    zn->dbuf_reliable.is_discarding = 0;
+    zn->dbuf_best_effort.buf = _z_zbuf_make(0);
+    zn->dbuf_best_effort.is_discarding = 0;
 
     // Initialize the mutexes
     z_mutex_init(&zn->mutex_rx);
     z_mutex_init(&zn->mutex_tx);
     z_mutex_init(&zn->mutex_inner);
 
+    // Initialize the round trip time measurement
+    z_condvar_init(&zn->cond_ping);
+    zn->ping_hash = 0;
+    zn->ping_count = 0;
+    zn->ping_rtt = -1;
+    zn->rtt_len = 0;
+    zn->rtt_head = 0;
+
     // The initial SN at RX side
     zn->lease = 0;
     zn->sn_resolution = 0;
@@ -96,6 +122,20 @@ zn_session_t *_zn_session_init()
     zn->sn_tx_reliable = 0;
     zn->sn_tx_best_effort = 0;
 
+    // Batching is disabled by default
+    zn->batching = 0;
+    zn->batch_linger = 0;
+    zn->batch_open = 0;
+    zn->batch_reliability = zn_reliability_t_RELIABLE;
+    zn->batch_priority = ZN_PRIORITY_DEFAULT;
+    zn->batch_sn = 0;
+
+    // The reliability on datagram links is disabled by default
+    zn->reliable_channel = NULL;
+
+    // Reset the statistics
+    memset(&zn->stats, 0, sizeof(zn_stats_t));
+
     // Initialize the counters to 1
     zn->entity_id = 1;
     zn->resource_id = 1;
@@ -103,25 +143,53 @@ zn_session_t *_zn_session_init()
     zn->pull_id = 1;
 
     // Initialize the data structs
-    zn->local_resources = z_list_empty;
-    zn->remote_resources = z_list_empty;
+    z_id_map_init(&zn->local_resources);
+    z_id_map_init(&zn->remote_resources);
+    z_id_map_init(&zn->local_resource_children);
+    z_id_map_init(&zn->remote_resource_children);
 
-    zn->local_subscriptions = z_list_empty;
-    zn->remote_subscriptions = z_list_empty;
-    zn->rem_res_loc_sub_map = z_i_map_make(_Z_DEFAULT_I_MAP_CAPACITY);
+    z_id_map_init(&zn->local_subscriptions);
+    z_id_map_init(&zn->remote_subscriptions);
 
-    zn->local_queryables = z_list_empty;
-    zn->rem_res_loc_qle_map = z_i_map_make(_Z_DEFAULT_I_MAP_CAPACITY);
+    z_id_map_init(&zn->local_queryables);
+    z_id_map_init(&zn->rem_res_loc_qle_map);
 
-    zn->pending_queries = z_list_empty;
+    z_id_map_init(&zn->pending_queries);
+
+    _zn_rname_trie_init(&zn->local_subscriptions_trie);
+    _zn_rname_trie_init(&zn->local_queryables_trie);
+    zn->subscription_snapshot = __unsafe_zn_subscription_snapshot_make(zn);
+    zn->subscription_snapshot_readers = 0;
+    zn->subscription_snapshots_dropped = 0;
+    z_mutex_init(&zn->mutex_snapshot);
+    z_condvar_init(&zn->cond_snapshot);
 
     zn->read_task_running = 0;
     zn->read_task = NULL;
+    zn->read_pipeline = NULL;
+
+    zn->tx_task_running = 0;
+    for (int i = 0; i < _ZN_PRIORITIES_NUM; i++)
+        zn->tx_queue[i] = NULL;
+    z_mutex_init(&zn->mutex_tx_queue);
+    z_condvar_init(&zn->cond_tx_queue);
+    zn->tx_queue_waiting = 0;
+    zn->tx_queue_wakeup = 0;
+    zn->tx_task = NULL;
+    zn->tx_work = 0;
 
     zn->received = 0;
-    zn->transmitted = 0;
+    zn->last_tx = z_clock_now();
+    zn->dispatch_workers = NULL;
+    zn->dispatch_workers_num = 0;
+    zn->dispatch_pushing = 0;
+    zn->dispatch_flushing = 0;
+
     zn->lease_task_running = 0;
-    zn->lease_task = NULL;
+    z_timer_init(&zn->lease_timer, NULL, zn);
+    z_timer_init(&zn->keep_alive_timer, _zn_keep_alive_timer, zn);
+    z_timer_init(&zn->flush_timer, _zn_flush_timer, zn);
+    z_timer_init(&zn->sync_timer, _zn_sync_timer, zn);
 
     zn->on_disconnect = &_zn_default_on_disconnect;
 
@@ -130,6 +198,18 @@ zn_session_t *_zn_session_init()
 
 void _zn_session_free(zn_session_t *zn)
 {
+    // Stop the timers before anything they use is released
+    if (zn->lease_task_running)
+        znp_stop_lease_task(zn);
+
+    // Send the queued messages before releasing the queues
+    if (zn->tx_task_running)
+        znp_stop_tx_task(zn);
+
+    // Deliver the pending samples before releasing the subscriptions
+    if (zn->dispatch_workers)
+        znp_stop_dispatcher(zn);
+
     // Clean up link
     zn->link->release_f(zn->link);
     free(zn->link);
@@ -140,7 +220,28 @@ void _zn_session_free(zn_session_t *zn)
     _zn_flush_queryables(zn);
     _zn_flush_pending_queries(zn);
 
+    // Clean up the transmission queues
+    for (int i = 0; i < _ZN_PRIORITIES_NUM; i++)
+    {
+        if (zn->tx_queue[i] == NULL)
+            continue;
+
+        _zn_tx_entry_t *entry;
+        while ((entry = (_zn_tx_entry_t *)z_mpsc_try_pop(zn->tx_queue[i])) != NULL)
+            _zn_tx_entry_free(&entry);
+        z_mpsc_free(&zn->tx_queue[i]);
+    }
+    z_condvar_free(&zn->cond_tx_queue);
+    z_mutex_free(&zn->mutex_tx_queue);
+    z_condvar_free(&zn->cond_snapshot);
+    z_mutex_free(&zn->mutex_snapshot);
+
+    // Clean up the reliable channel
+    if (zn->reliable_channel)
+        _zn_reliable_channel_free(&zn->reliable_channel);
+
     // Clean up the mutexes
+    z_condvar_free(&zn->cond_ping);
     z_mutex_free(&zn->mutex_inner);
     z_mutex_free(&zn->mutex_tx);
     z_mutex_free(&zn->mutex_rx);
@@ -148,9 +249,18 @@ void _zn_session_free(zn_session_t *zn)
     // Clean up the buffers
     _z_wbuf_free(&zn->wbuf);
     _z_zbuf_free(&zn->zbuf);
+    if (zn->rbuf.buf)
+        _z_rbuf_free(&zn->rbuf);
+    if (zn->dgrams)
+    {
+        for (size_t i = 0; i < ZN_MMSG_LEN; i++)
+            _z_zbuf_free(&zn->dgrams[i]);
+        free(zn->dgrams);
+    }
+    z_arena_free(&zn->rx_arena);
 
-    _z_wbuf_free(&zn->dbuf_reliable);
-    _z_wbuf_free(&zn->dbuf_best_effort);
+    _z_zbuf_free(&zn->dbuf_reliable.buf);
+    _z_zbuf_free(&zn->dbuf_best_effort.buf);
 
     // Clean up the PIDs
     _z_bytes_free(&zn->local_pid);
@@ -161,14 +271,14 @@ void _zn_session_free(zn_session_t *zn)
 
     // Clean up the tasks
     free(zn->read_task);
-    free(zn->lease_task);
+    free(zn->tx_task);
 
     free(zn);
 
     zn = NULL;
 }
 
-int _zn_send_close(zn_session_t *zn, uint8_t reason, int link_only)
+_zn_transport_message_t __zn_close_message(zn_session_t *zn, uint8_t reason, int link_only)
 {
     _zn_transport_message_t cm = _zn_transport_message_init(_ZN_MID_CLOSE);
     cm.body.close.pid = zn->local_pid;
@@ -176,6 +286,12 @@ int _zn_send_close(zn_session_t *zn, uint8_t reason, int link_only)
     _ZN_SET_FLAG(cm.header, _ZN_FLAG_T_I);
     if (link_only)
         _ZN_SET_FLAG(cm.header, _ZN_FLAG_T_K);
+    return cm;
+}
+
+int _zn_send_close(zn_session_t *zn, uint8_t reason, int link_only)
+{
+    _zn_transport_message_t cm = __zn_close_message(zn, reason, link_only);
 
     int res = _zn_send_t_msg(zn, &cm);
 
@@ -185,6 +301,18 @@ int _zn_send_close(zn_session_t *zn, uint8_t reason, int link_only)
     return res;
 }
 
+int _zn_try_send_close(zn_session_t *zn, uint8_t reason, int link_only)
+{
+    _zn_transport_message_t cm = __zn_close_message(zn, reason, link_only);
+
+    int res = _zn_try_send_t_msg(zn, &cm);
+
+    // Free the message
+    _zn_transport_message_free(&cm);
+
+    return res;
+}
+
 int _zn_session_close(zn_session_t *zn, uint8_t reason)
 {
     int res = _zn_send_close(zn, reason, 0);
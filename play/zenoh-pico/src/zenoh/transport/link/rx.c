@@ -13,74 +13,198 @@
  */
 
 #include "zenoh-pico/utils/private/logging.h"
+#include "zenoh-pico/session/private/utils.h"
 #include "zenoh-pico/system/common.h"
 #include "zenoh-pico/transport/private/utils.h"
 
 /*------------------ Reception helper ------------------*/
-void _zn_recv_t_msg_na(zn_session_t *zn, _zn_transport_message_p_result_t *r)
+/**
+ * Return the next datagram read on a link supporting batched reads, reading as many
+ * datagrams as available at once when all the previous ones have been decoded.
+ *
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->mutex_rx
+ */
+_z_zbuf_t *__unsafe_zn_recv_dgram(zn_session_t *zn)
 {
-    _Z_DEBUG(">> recv session msg\n");
-    r->tag = _z_res_t_OK;
+    if (zn->dgrams == NULL)
+    {
+        zn->dgrams = (_z_zbuf_t *)malloc(ZN_MMSG_LEN * sizeof(_z_zbuf_t));
+        for (size_t i = 0; i < ZN_MMSG_LEN; i++)
+            zn->dgrams[i] = _z_zbuf_make(ZN_READ_BUF_LEN);
+    }
 
-    // Acquire the lock
-    z_mutex_lock(&zn->mutex_rx);
+    if (zn->dgrams_idx == zn->dgrams_len)
+    {
+        // The messages decoded from the previous datagrams have been handled already
+        for (size_t i = 0; i < ZN_MMSG_LEN; i++)
+            _z_zbuf_clear(&zn->dgrams[i]);
+        zn->dgrams_idx = 0;
+        zn->dgrams_len = 0;
+
+        int n = _zn_recv_dgrams(zn->link, zn->dgrams, ZN_MMSG_LEN);
+        if (n <= 0)
+            return NULL;
+        zn->dgrams_len = n;
+    }
+
+    return &zn->dgrams[zn->dgrams_idx++];
+}
+
+/**
+ * Read a batch of session messages from a stream link, returning a view of the ring buffer
+ * holding it or null in case of failure. The view is valid until the next read.
+ *
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->mutex_rx
+ */
+_z_zbuf_t *__unsafe_zn_recv_stream(zn_session_t *zn)
+{
+    // NOTE: 16 bits (2 bytes) may be prepended to the serialized message indicating the total length
+    //       in bytes of the message, resulting in the maximum length of a message being 65_535 bytes.
+    //       This is necessary in those stream-oriented transports (e.g., TCP) that do not preserve
+    //       the boundary of the serialized messages. The length is encoded as little-endian.
+    //       In any case, the length of a message must not exceed 65_535 bytes.
+    _z_rbuf_t *rbf = &zn->rbuf;
+    if (rbf->buf == NULL)
+        *rbf = _z_rbuf_make(ZN_READ_BUF_LEN);
+
+    // Read the message length
+    if (_zn_recv_rbuf(zn->link, rbf, _ZN_MSG_LEN_ENC_SIZE) != 0)
+        return NULL;
+
+    size_t len = (size_t)((uint16_t)_z_rbuf_read(rbf) | ((uint16_t)_z_rbuf_read(rbf) << 8));
+    _Z_DEBUG_VA(">> \t msg len = %zu\n", len);
+
+    // Read enough bytes to decode the message, the batch is not moved even if it wraps around
+    if (_zn_recv_rbuf(zn->link, rbf, len) != 0)
+        return NULL;
+
+    // The bytes of the batch are overwritten by the next read only
+    zn->rbatch = _z_rbuf_view(rbf, len);
+    _z_rbuf_consume(rbf, len);
+
+    return &zn->rbatch;
+}
+
+/**
+ * Read the bytes available on a stream link with a single read, which does not block
+ * once the link is known to be readable. The complete batches are then returned one by
+ * one by __unsafe_zn_next_stream_batch. Return -1 if the link failed or has been closed.
+ *
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->mutex_rx
+ */
+int __unsafe_zn_fill_stream(zn_session_t *zn)
+{
+    _z_rbuf_t *rbf = &zn->rbuf;
+    if (rbf->buf == NULL)
+        *rbf = _z_rbuf_make(ZN_READ_BUF_LEN);
+
+    // Keep the batch being received contiguous
+    size_t len = _ZN_MSG_LEN_ENC_SIZE;
+    if (_z_rbuf_len(rbf) >= _ZN_MSG_LEN_ENC_SIZE)
+        len += (size_t)((uint16_t)_z_rbuf_get(rbf, 0) | ((uint16_t)_z_rbuf_get(rbf, 1) << 8));
+    if (_z_rbuf_reserve(rbf, len) != 0)
+        return -1;
 
+    int rb = zn->link->read_f(zn->link, _z_rbuf_get_wptr(rbf), _z_rbuf_space_left(rbf));
+    if (rb <= 0)
+        return -1;
+    _z_rbuf_produce(rbf, rb);
+
+    return 0;
+}
+
+/**
+ * Return a view of the next complete batch buffered by __unsafe_zn_fill_stream or null if
+ * none. The view is valid until the next read.
+ *
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->mutex_rx
+ */
+_z_zbuf_t *__unsafe_zn_next_stream_batch(zn_session_t *zn)
+{
+    _z_rbuf_t *rbf = &zn->rbuf;
+    if (rbf->buf == NULL || _z_rbuf_len(rbf) < _ZN_MSG_LEN_ENC_SIZE)
+        return NULL;
+
+    size_t len = (size_t)((uint16_t)_z_rbuf_get(rbf, 0) | ((uint16_t)_z_rbuf_get(rbf, 1) << 8));
+    if (_z_rbuf_len(rbf) < _ZN_MSG_LEN_ENC_SIZE + len)
+        return NULL;
+
+    _z_rbuf_consume(rbf, _ZN_MSG_LEN_ENC_SIZE);
+    zn->rbatch = _z_rbuf_view(rbf, len);
+    _z_rbuf_consume(rbf, len);
+
+    return &zn->rbatch;
+}
+
+/**
+ * Read a batch of session messages from the link, returning the buffer holding it or
+ * null in case of failure.
+ *
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->mutex_rx
+ */
+_z_zbuf_t *__unsafe_zn_recv_batch(zn_session_t *zn)
+{
     // Prepare the buffer
-    _z_zbuf_clear(&zn->zbuf);
+    _z_zbuf_t *zbf = &zn->zbuf;
+    _z_zbuf_clear(zbf);
 
     if(zn->link->is_streamed == 1)
     {
-        // NOTE: 16 bits (2 bytes) may be prepended to the serialized message indicating the total length
-        //       in bytes of the message, resulting in the maximum length of a message being 65_535 bytes.
-        //       This is necessary in those stream-oriented transports (e.g., TCP) that do not preserve
-        //       the boundary of the serialized messages. The length is encoded as little-endian.
-        //       In any case, the length of a message must not exceed 65_535 bytes.
-
-        // Read the message length
-        if (_zn_recv_exact_zbuf(zn->link, &zn->zbuf, _ZN_MSG_LEN_ENC_SIZE) != _ZN_MSG_LEN_ENC_SIZE)
-        {
-            _zn_transport_message_p_result_free(r);
-            r->tag = _z_res_t_ERR;
-            r->value.error = _zn_err_t_IO_GENERIC;
-            goto EXIT_SRCV_PROC;
-        }
-
-        uint16_t len = _z_zbuf_read(&zn->zbuf) | (_z_zbuf_read(&zn->zbuf) << 8);
-        _Z_DEBUG_VA(">> \t msg len = %hu\n", len);
-        size_t writable = _z_zbuf_capacity(&zn->zbuf) - _z_zbuf_len(&zn->zbuf);
-        if (writable < len)
-        {
-            _zn_transport_message_p_result_free(r);
-            r->tag = _z_res_t_ERR;
-            r->value.error = _zn_err_t_IOBUF_NO_SPACE;
-            goto EXIT_SRCV_PROC;
-        }
-
-        // Read enough bytes to decode the message
-        if (_zn_recv_exact_zbuf(zn->link, &zn->zbuf, len) != len)
-        {
-            _zn_transport_message_p_result_free(r);
-            r->tag = _z_res_t_ERR;
-            r->value.error = _zn_err_t_IO_GENERIC;
-            goto EXIT_SRCV_PROC;
-        }
+        zbf = __unsafe_zn_recv_stream(zn);
+        if (zbf == NULL)
+            return NULL;
+    }
+    else if (zn->link->read_batch_f != NULL)
+    {
+        zbf = __unsafe_zn_recv_dgram(zn);
+        if (zbf == NULL)
+            return NULL;
     }
     else
     {
         if (_zn_recv_zbuf(zn->link, &zn->zbuf) < 0)
-        {
-            _zn_transport_message_p_result_free(r);
-            r->tag = _z_res_t_ERR;
-            r->value.error = _zn_err_t_IO_GENERIC;
-            goto EXIT_SRCV_PROC;
-        }
+            return NULL;
     }
 
     // Mark the session that we have received data
     zn->received = 1;
+    _ZN_STATS_INC(zn, rx_batches);
+    _ZN_STATS_ADD(zn, rx_bytes, _z_zbuf_len(zbf));
+
+    return zbf;
+}
+
+void _zn_recv_t_msg_na(zn_session_t *zn, _zn_transport_message_p_result_t *r)
+{
+    _Z_DEBUG(">> recv session msg\n");
+    r->tag = _z_res_t_OK;
+
+    // Acquire the lock
+    z_mutex_lock(&zn->mutex_rx);
+
+    _z_zbuf_t *zbf = __unsafe_zn_recv_batch(zn);
+    if (zbf == NULL)
+    {
+        _zn_transport_message_p_result_free(r);
+        r->tag = _z_res_t_ERR;
+        r->value.error = _zn_err_t_IO_GENERIC;
+        goto EXIT_SRCV_PROC;
+    }
 
     _Z_DEBUG(">> \t transport_message_decode\n");
-    _zn_transport_message_decode_na(&zn->zbuf, r);
+    _zn_transport_message_decode_na(zbf, r);
+    if (r->tag != _z_res_t_OK)
+        _ZN_STATS_INC(zn, rx_decode_errors);
 
 EXIT_SRCV_PROC:
     // Release the lock
@@ -15,87 +15,254 @@
 #include "zenoh-pico/session/api.h"
 #include "zenoh-pico/session/types.h"
 #include "zenoh-pico/session/private/utils.h"
+#include "zenoh-pico/link/private/manager.h"
 #include "zenoh-pico/protocol/private/msg.h"
+#include "zenoh-pico/protocol/private/utils.h"
+#include "zenoh-pico/utils/collections.h"
 #include "zenoh-pico/utils/private/logging.h"
 #include "zenoh-pico/system/common.h"
+#include "zenoh-pico/transport/private/utils.h"
 
-void *_znp_lease_task(void *arg)
+/*------------------ Session timers ------------------*/
+int _zn_lease_renew(zn_session_t *zn)
 {
-    zn_session_t *zn = (zn_session_t *)arg;
-    zn->lease_task_running = 1;
+    // Check if received data
+    if (zn->received == 0)
+        return -1;
 
     zn->received = 0;
-    zn->transmitted = 0;
+    return 0;
+}
+
+// The timers of many sessions share a task, a stalled link must not delay them: the transmit
+// task of the session, if running, sends on their behalf. Otherwise the timers only send when
+// no other writer holds the link, and try again later.
+int _zn_tx_work_post(zn_session_t *zn, int work)
+{
+    if (zn->tx_task_running == 0)
+        return -1;
+
+    __atomic_or_fetch(&zn->tx_work, work, __ATOMIC_SEQ_CST);
+    _zn_tx_queue_wakeup(zn);
+    return 0;
+}
+
+void _zn_tx_work_run(zn_session_t *zn)
+{
+    int work = __atomic_exchange_n(&zn->tx_work, 0, __ATOMIC_SEQ_CST);
+    if (work & _ZN_TX_WORK_KEEP_ALIVE)
+        znp_send_keep_alive(zn);
+    if (work & _ZN_TX_WORK_FLUSH)
+        _zn_flush_expired_batch(zn);
+    if (work & _ZN_TX_WORK_SYNC)
+        _zn_send_sync(zn);
+}
+
+uint64_t _zn_keep_alive_timer(void *arg)
+{
+    zn_session_t *zn = (zn_session_t *)arg;
+
+    // A session busy transmitting is not idle, do not wait for it
+    if (z_mutex_trylock(&zn->mutex_tx) != 0)
+        return ZN_KEEP_ALIVE_INTERVAL;
 
-    unsigned int next_lease = zn->lease;
-    unsigned int next_keep_alive = ZN_KEEP_ALIVE_INTERVAL;
-    while (zn->lease_task_running)
+    // A keep alive is due only once the session has not transmitted for a whole interval
+    clock_t idle = z_clock_elapsed_ms(&zn->last_tx);
+    if (idle >= 0 && idle < ZN_KEEP_ALIVE_INTERVAL)
     {
-        // Compute the target interval
-        unsigned int interval;
-        if (zn->lease > 0)
-        {
-            if (next_lease < next_keep_alive)
-                interval = next_lease;
-            else if (next_keep_alive < ZN_KEEP_ALIVE_INTERVAL)
-                interval = next_keep_alive;
-            else
-                interval = ZN_KEEP_ALIVE_INTERVAL;
-        }
-        else
-        {
-            interval = ZN_KEEP_ALIVE_INTERVAL;
-        }
+        z_mutex_unlock(&zn->mutex_tx);
+        return ZN_KEEP_ALIVE_INTERVAL - idle;
+    }
+
+    if (_zn_tx_work_post(zn, _ZN_TX_WORK_KEEP_ALIVE) != 0)
+    {
+        _zn_transport_message_t t_msg = _zn_transport_message_init(_ZN_MID_KEEP_ALIVE);
+        __unsafe_zn_send_t_msg(zn, &t_msg);
+    }
+    z_mutex_unlock(&zn->mutex_tx);
+    return ZN_KEEP_ALIVE_INTERVAL;
+}
+
+uint64_t _zn_flush_timer(void *arg)
+{
+    zn_session_t *zn = (zn_session_t *)arg;
 
-        // The keep alive and lease intervals are expressed in milliseconds
-        z_sleep_ms(interval);
+    // Send the pending batch if its linger time has expired
+    if (_zn_tx_work_post(zn, _ZN_TX_WORK_FLUSH) != 0)
+        _zn_flush_expired_batch(zn);
+    return zn->batch_linger;
+}
+
+uint64_t _zn_sync_timer(void *arg)
+{
+    zn_session_t *zn = (zn_session_t *)arg;
+
+    // Announce the unacknowledged frames to trigger their retransmission
+    if (_zn_tx_work_post(zn, _ZN_TX_WORK_SYNC) != 0 && _zn_try_send_sync(zn) == _z_res_t_BUSY)
+        return ZN_TIMER_RETRY_INTERVAL;
+    return ZN_RELIABILITY_SYNC_INTERVAL;
+}
+
+/*------------------ Timer service ------------------*/
+// A single task runs the timers of all the sessions of the process. It is started
+// with the first timer and sleeps until the next expiry, for as long as needed.
+typedef struct
+{
+    z_mutex_t mutex;
+    z_condvar_t cond_wakeup;
+    z_condvar_t cond_done;
+    z_timer_wheel_t timers;
+    z_clock_t start;
+    z_timer_t *running;
+    int running_cancelled;
+    int is_started;
+    z_task_t task;
+} _zn_timer_service_t;
 
-        // Decrement the interval
-        if (zn->lease > 0)
+static _zn_timer_service_t _zn_timer_service = {
+    .mutex = Z_MUTEX_INITIALIZER,
+    .running = NULL,
+    .running_cancelled = 0,
+    .is_started = 0};
+
+uint64_t __zn_timer_service_now(_zn_timer_service_t *ts)
+{
+    clock_t now = z_clock_elapsed_ms(&ts->start);
+    return now > 0 ? (uint64_t)now : 0;
+}
+
+void *__zn_timer_service_task(void *arg)
+{
+    _zn_timer_service_t *ts = (_zn_timer_service_t *)arg;
+
+    z_mutex_lock(&ts->mutex);
+    while (1)
+    {
+        z_timer_wheel_advance(&ts->timers, __zn_timer_service_now(ts));
+
+        z_timer_t *timer;
+        while ((timer = z_timer_wheel_pop_expired(&ts->timers)) != NULL)
         {
-            next_lease -= interval;
+            // The callback runs unlocked, cancelling its timer waits for it to return
+            ts->running = timer;
+            ts->running_cancelled = 0;
+            z_mutex_unlock(&ts->mutex);
+
+            uint64_t delay = timer->callback(timer->arg);
+
+            z_mutex_lock(&ts->mutex);
+            if (delay > 0 && ts->running_cancelled == 0)
+                z_timer_wheel_add(&ts->timers, timer, __zn_timer_service_now(ts) + delay);
+            ts->running = NULL;
+            z_condvar_signal(&ts->cond_done);
         }
-        next_keep_alive -= interval;
 
-        if (zn->lease > 0 && next_lease == 0)
+        // Sleep until the next expiry, or until an earlier timer is armed
+        uint64_t next = z_timer_wheel_next(&ts->timers);
+        uint64_t now = __zn_timer_service_now(ts);
+        if (next == UINT64_MAX)
+            z_condvar_wait(&ts->cond_wakeup, &ts->mutex);
+        else if (next > now)
+            z_condvar_timedwait(&ts->cond_wakeup, &ts->mutex, (unsigned int)(next - now));
+    }
+
+    return 0;
+}
+
+int _zn_timer_schedule(z_timer_t *timer, uint64_t delay)
+{
+    _zn_timer_service_t *ts = &_zn_timer_service;
+
+    z_mutex_lock(&ts->mutex);
+    if (ts->is_started == 0)
+    {
+        ts->start = z_clock_now();
+        z_timer_wheel_init(&ts->timers, 0);
+        // Initialized at runtime to time out on the monotonic clock
+        z_condvar_init(&ts->cond_wakeup);
+        z_condvar_init(&ts->cond_done);
+        if (z_task_init(&ts->task, NULL, __zn_timer_service_task, ts) != 0)
         {
-            // Check if received data
-            if (zn->received == 0)
-            {
-                _Z_DEBUG_VA("Closing session because it has expired after %zums", zn->lease);
-                _zn_session_close(zn, _ZN_CLOSE_EXPIRED);
-                return 0;
-            }
-
-            // Reset the lease parameters
-            zn->received = 0;
-            next_lease = zn->lease;
+            z_condvar_free(&ts->cond_done);
+            z_condvar_free(&ts->cond_wakeup);
+            z_mutex_unlock(&ts->mutex);
+            return -1;
         }
+        ts->is_started = 1;
+    }
+
+    z_timer_wheel_add(&ts->timers, timer, __zn_timer_service_now(ts) + delay);
+    z_condvar_signal(&ts->cond_wakeup);
+    z_mutex_unlock(&ts->mutex);
+    return 0;
+}
 
-        if (next_keep_alive == 0)
+void _zn_timer_cancel(z_timer_t *timer)
+{
+    _zn_timer_service_t *ts = &_zn_timer_service;
+
+    z_mutex_lock(&ts->mutex);
+    if (ts->is_started)
+    {
+        z_timer_wheel_remove(&ts->timers, timer);
+
+        // Do not let the callback run past the cancellation, nor arm the timer again
+        if (ts->running == timer)
         {
-            // Check if need to send a keep alive
-            if (zn->transmitted == 0)
-            {
-                znp_send_keep_alive(zn);
-            }
-
-            // Reset the keep alive parameters
-            zn->transmitted = 0;
-            next_keep_alive = ZN_KEEP_ALIVE_INTERVAL;
+            ts->running_cancelled = 1;
+            while (ts->running == timer)
+                z_condvar_wait(&ts->cond_done, &ts->mutex);
         }
     }
+    z_mutex_unlock(&ts->mutex);
+}
+
+/*------------------ Lease task ------------------*/
+uint64_t __zn_lease_timer(void *arg)
+{
+    zn_session_t *zn = (zn_session_t *)arg;
+
+    if (_zn_lease_renew(zn) == 0)
+        return zn->lease;
+
+    // Do not wait for a writer stalled on the link, it might never release it
+    if (_zn_try_send_close(zn, _ZN_CLOSE_EXPIRED, 0) == _z_res_t_BUSY)
+        return ZN_TIMER_RETRY_INTERVAL;
 
+    _Z_DEBUG_VA("Closing session because it has expired after %zums", zn->lease);
+
+    // This timer is running and is not armed again, stop the other ones
+    _zn_timer_cancel(&zn->keep_alive_timer);
+    _zn_timer_cancel(&zn->flush_timer);
+    _zn_timer_cancel(&zn->sync_timer);
+    zn->lease_task_running = 0;
+
+    _zn_close_link(zn->link);
+    _zn_session_free(zn);
     return 0;
 }
 
 int znp_start_lease_task(zn_session_t *zn)
 {
-    z_task_t *task = (z_task_t *)malloc(sizeof(z_task_t));
-    memset(task, 0, sizeof(pthread_t));
-    zn->lease_task = task;
-    if (z_task_init(task, NULL, _znp_lease_task, zn) != 0)
+    // The timers of the session must not be served by an event loop already
+    if (zn->lease_task_running || z_timer_is_armed(&zn->keep_alive_timer))
+        return -1;
+
+    zn->received = 0;
+    zn->lease_task_running = 1;
+    z_timer_init(&zn->lease_timer, __zn_lease_timer, zn);
+
+    int res = _zn_timer_schedule(&zn->keep_alive_timer, ZN_KEEP_ALIVE_INTERVAL);
+    if (res == 0 && zn->lease > 0)
+        res = _zn_timer_schedule(&zn->lease_timer, zn->lease);
+    if (res == 0 && zn->batching == 1 && zn->batch_linger > 0)
+        res = _zn_timer_schedule(&zn->flush_timer, zn->batch_linger);
+    if (res == 0 && zn->reliable_channel != NULL)
+        res = _zn_timer_schedule(&zn->sync_timer, ZN_RELIABILITY_SYNC_INTERVAL);
+
+    if (res != 0)
     {
+        znp_stop_lease_task(zn);
         return -1;
     }
     return 0;
@@ -103,6 +270,10 @@ int znp_start_lease_task(zn_session_t *zn)
 
 int znp_stop_lease_task(zn_session_t *zn)
 {
+    _zn_timer_cancel(&zn->lease_timer);
+    _zn_timer_cancel(&zn->keep_alive_timer);
+    _zn_timer_cancel(&zn->flush_timer);
+    _zn_timer_cancel(&zn->sync_timer);
     zn->lease_task_running = 0;
     return 0;
 }
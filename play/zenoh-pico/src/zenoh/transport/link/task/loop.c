@@ -0,0 +1,271 @@
+/*
+ * Copyright (c) 2017, 2021 ADLINK Technology Inc.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License 2.0 which is available at
+ * http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+ * which is available at https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+ *
+ * Contributors:
+ *   ADLINK zenoh team, <zenoh@adlink-labs.tech>
+ */
+
+#include "zenoh-pico/session/api.h"
+#include "zenoh-pico/session/types.h"
+#include "zenoh-pico/session/private/types.h"
+#include "zenoh-pico/session/private/utils.h"
+#include "zenoh-pico/system/common.h"
+#include "zenoh-pico/transport/private/utils.h"
+#include "zenoh-pico/utils/collections.h"
+#include "zenoh-pico/utils/private/logging.h"
+
+/*------------------ Entries ------------------*/
+uint64_t __zn_loop_now(zn_loop_t *loop)
+{
+    clock_t now = z_clock_elapsed_ms(&loop->start);
+    return now > 0 ? (uint64_t)now : 0;
+}
+
+_zn_loop_entry_t *__zn_loop_get_entry(zn_loop_t *loop, zn_session_t *zn)
+{
+    z_list_t *xs = loop->entries;
+    while (xs)
+    {
+        _zn_loop_entry_t *e = (_zn_loop_entry_t *)z_list_head(xs);
+        if (e->zn == zn && !e->is_removed)
+            return e;
+        xs = z_list_tail(xs);
+    }
+    return NULL;
+}
+
+void __zn_loop_remove_entry(zn_loop_t *loop, _zn_loop_entry_t *e)
+{
+    // The entry is released after the events already returned by the poller
+    _zn_poll_remove(loop->poll, e->zn->link->sock);
+    z_timer_wheel_remove(&loop->timers, &e->zn->lease_timer);
+    z_timer_wheel_remove(&loop->timers, &e->zn->keep_alive_timer);
+    z_timer_wheel_remove(&loop->timers, &e->zn->flush_timer);
+    z_timer_wheel_remove(&loop->timers, &e->zn->sync_timer);
+    e->is_removed = 1;
+}
+
+void __zn_loop_release_removed(zn_loop_t *loop)
+{
+    z_list_t **xs = &loop->entries;
+    while (*xs)
+    {
+        z_list_t *x = *xs;
+        _zn_loop_entry_t *e = (_zn_loop_entry_t *)x->val;
+        if (e->is_removed)
+        {
+            *xs = x->tail;
+            free(e);
+            free(x);
+        }
+        else
+        {
+            xs = &x->tail;
+        }
+    }
+}
+
+/*------------------ Events ------------------*/
+/**
+ * Read and handle what is available on the link of a session, without blocking.
+ * Return -1 if the link failed or a message can not be handled, and _z_res_t_CLOSED
+ * if the session has been closed by the remote peer.
+ *
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->mutex_rx
+ */
+int __unsafe_zn_loop_read(zn_session_t *zn)
+{
+    if (zn->link->is_streamed == 1)
+    {
+        if (__unsafe_zn_fill_stream(zn) != 0)
+            return -1;
+
+        _z_zbuf_t *zbf;
+        while ((zbf = __unsafe_zn_next_stream_batch(zn)) != NULL)
+        {
+            int res = __unsafe_znp_handle_batch(zn, zbf, _z_zbuf_len(zbf));
+            if (res != 0)
+                return res;
+        }
+    }
+    else
+    {
+        // A single read returns the datagrams already queued, handle all of them
+        do
+        {
+            _z_zbuf_t *zbf = __unsafe_zn_recv_dgram(zn);
+            if (zbf == NULL)
+                return -1;
+
+            int res = __unsafe_znp_handle_batch(zn, zbf, _z_zbuf_len(zbf));
+            if (res != 0)
+                return res;
+        } while (zn->dgrams_idx < zn->dgrams_len);
+    }
+
+    return 0;
+}
+
+uint64_t __zn_loop_lease_timer(void *arg)
+{
+    _zn_loop_entry_t *e = (_zn_loop_entry_t *)arg;
+    zn_session_t *zn = e->zn;
+
+    if (_zn_lease_renew(zn) == 0)
+        return zn->lease;
+
+    _Z_DEBUG_VA("Closing session because it has expired after %zums", zn->lease);
+    __zn_loop_remove_entry(e->loop, e);
+    _zn_session_close(zn, _ZN_CLOSE_EXPIRED);
+    return 0;
+}
+
+/*------------------ Loop ------------------*/
+zn_loop_t *zn_loop_make(void)
+{
+    int poll = _zn_poll_make();
+    if (poll < 0)
+        return NULL;
+
+    zn_loop_t *loop = (zn_loop_t *)malloc(sizeof(zn_loop_t));
+    loop->poll = poll;
+    loop->entries = z_list_empty;
+    z_timer_wheel_init(&loop->timers, 0);
+    loop->start = z_clock_now();
+    loop->is_running = 0;
+    return loop;
+}
+
+int zn_loop_add_session(zn_loop_t *loop, zn_session_t *zn)
+{
+    // The session must not be served by its own tasks or by a loop already
+    if (zn->read_task_running || zn->lease_task_running || z_timer_is_armed(&zn->keep_alive_timer))
+        return -1;
+
+    _zn_loop_entry_t *e = (_zn_loop_entry_t *)malloc(sizeof(_zn_loop_entry_t));
+    e->loop = loop;
+    e->zn = zn;
+    e->is_removed = 0;
+    if (_zn_poll_add(loop->poll, zn->link->sock, e) != 0)
+    {
+        free(e);
+        return -1;
+    }
+
+    zn->received = 0;
+    z_timer_init(&zn->lease_timer, __zn_loop_lease_timer, e);
+
+    uint64_t now = __zn_loop_now(loop);
+    z_timer_wheel_add(&loop->timers, &zn->keep_alive_timer, now + ZN_KEEP_ALIVE_INTERVAL);
+    if (zn->lease > 0)
+        z_timer_wheel_add(&loop->timers, &zn->lease_timer, now + zn->lease);
+    if (zn->batching == 1 && zn->batch_linger > 0)
+        z_timer_wheel_add(&loop->timers, &zn->flush_timer, now + zn->batch_linger);
+    if (zn->reliable_channel != NULL)
+        z_timer_wheel_add(&loop->timers, &zn->sync_timer, now + ZN_RELIABILITY_SYNC_INTERVAL);
+
+    loop->entries = z_list_cons(loop->entries, e);
+    return 0;
+}
+
+int zn_loop_remove_session(zn_loop_t *loop, zn_session_t *zn)
+{
+    _zn_loop_entry_t *e = __zn_loop_get_entry(loop, zn);
+    if (e == NULL)
+        return -1;
+
+    __zn_loop_remove_entry(loop, e);
+    return 0;
+}
+
+int zn_loop_run(zn_loop_t *loop)
+{
+    void *ready[_ZN_POLL_EVENTS_MAX];
+
+    loop->is_running = 1;
+    while (loop->is_running)
+    {
+        // Sleep until the next timer expiry, waking up at least once per keep alive
+        // interval to notice a stop request
+        uint64_t now = __zn_loop_now(loop);
+        uint64_t next = z_timer_wheel_next(&loop->timers);
+        unsigned int timeout = ZN_KEEP_ALIVE_INTERVAL;
+        if (next <= now)
+            timeout = 0;
+        else if (next - now < timeout)
+            timeout = (unsigned int)(next - now);
+
+        int n = _zn_poll_wait(loop->poll, ready, _ZN_POLL_EVENTS_MAX, timeout);
+        if (n < 0)
+        {
+            _Z_DEBUG("Unable to wait for the readiness of the sessions\n");
+            loop->is_running = 0;
+            return -1;
+        }
+
+        // Read from the links that are ready
+        for (int i = 0; i < n; i++)
+        {
+            _zn_loop_entry_t *e = (_zn_loop_entry_t *)ready[i];
+            if (e->is_removed)
+                continue;
+
+            zn_session_t *zn = e->zn;
+            z_mutex_lock(&zn->mutex_rx);
+            int res = __unsafe_zn_loop_read(zn);
+            z_mutex_unlock(&zn->mutex_rx);
+            if (res != 0)
+            {
+                _Z_DEBUG("Removing a session whose link has been closed or that can not be handled\n");
+                __zn_loop_remove_entry(loop, e);
+                // The session closed by the remote peer is freed once the loop no longer serves it
+                if (res == _z_res_t_CLOSED)
+                    _zn_session_free(zn);
+            }
+        }
+
+        // Run the timers that expired, a callback returning 0 may have released its timer
+        z_timer_wheel_advance(&loop->timers, __zn_loop_now(loop));
+        z_timer_t *timer;
+        while ((timer = z_timer_wheel_pop_expired(&loop->timers)) != NULL)
+        {
+            uint64_t delay = timer->callback(timer->arg);
+            if (delay > 0)
+                z_timer_wheel_add(&loop->timers, timer, __zn_loop_now(loop) + delay);
+        }
+
+        // Release the entries of the sessions removed meanwhile
+        __zn_loop_release_removed(loop);
+    }
+
+    return 0;
+}
+
+void zn_loop_stop(zn_loop_t *loop)
+{
+    loop->is_running = 0;
+}
+
+void zn_loop_free(zn_loop_t *loop)
+{
+    while (loop->entries)
+    {
+        // The sessions still served can be served by their own tasks afterwards
+        _zn_loop_entry_t *e = (_zn_loop_entry_t *)z_list_head(loop->entries);
+        if (!e->is_removed)
+            __zn_loop_remove_entry(loop, e);
+        free(e);
+        loop->entries = z_list_pop(loop->entries);
+    }
+    _zn_poll_free(loop->poll);
+    free(loop);
+}
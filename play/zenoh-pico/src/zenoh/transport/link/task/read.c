@@ -12,57 +12,254 @@
  *   ADLINK zenoh team, <zenoh@adlink-labs.tech>
  */
 
+#include <string.h>
+#include "zenoh-pico/session/private/utils.h"
+#include "zenoh-pico/system/collections.h"
 #include "zenoh-pico/system/common.h"
 #include "zenoh-pico/transport/private/utils.h"
 #include "zenoh-pico/utils/collections.h"
 #include "zenoh-pico/utils/private/logging.h"
 
+/**
+ * Decode and handle the session messages of a batch of to_read bytes read in src.
+ *
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - z->mutex_rx
+ */
+int __unsafe_znp_handle_batch(zn_session_t *z, _z_zbuf_t *src, size_t to_read)
+{
+    _ZN_STATS_INC(z, rx_batches);
+    _ZN_STATS_ADD(z, rx_bytes, to_read);
+
+    // Wrap the main buffer for to_read bytes, decoding into the arena released after the
+    // previous batch
+    z_arena_reset(&z->rx_arena);
+    _z_zbuf_t zbuf = _z_zbuf_view(src, to_read);
+    zbuf.arena = &z->rx_arena;
+
+    while (_z_zbuf_len(&zbuf) > 0)
+    {
+        // Mark the session that we have received data
+        z->received = 1;
+
+        // Decode and handle one session message
+        int res = _zn_handle_transport_zbuf(z, &zbuf);
+        if (res != _z_res_t_OK)
+        {
+            _Z_DEBUG("Connection closed due to a session message that can not be handled");
+            return res;
+        }
+    }
+
+    // Move the read position of the read buffer
+    _z_zbuf_set_rpos(src, _z_zbuf_get_rpos(src) + to_read);
+    return 0;
+}
+
+#if ZN_RX_PIPELINE_SIZE > 0
+/*------------------ Read pipeline ------------------*/
+typedef struct _zn_rx_pipeline_t
+{
+    zn_session_t *z;
+    _z_zbuf_t batches[ZN_RX_PIPELINE_SIZE];
+    // The batches read from the link, from the recv task to the read task
+    z_spsc_t *ready;
+    // The batches handled already, from the read task to the recv task
+    z_spsc_t *done;
+    volatile int is_running;
+    z_task_t task;
+} _zn_rx_pipeline_t;
+
+void *__znp_recv_task(void *arg)
+{
+    _zn_rx_pipeline_t *p = (_zn_rx_pipeline_t *)arg;
+    zn_session_t *z = p->z;
+
+    // The free buffers taken from the pool and not filled yet
+    _z_zbuf_t *bufs[ZN_MMSG_LEN];
+    size_t held = 0;
+
+    // NOTE: the link and the ring buffer of the session are owned by this task while
+    //       the pipeline runs, the read task holds the rx mutex on behalf of both
+    while (p->is_running && z->read_task_running)
+    {
+        // Wait for at least one free buffer, then take as many as a single read can fill
+        if (held == 0)
+        {
+            bufs[0] = (_z_zbuf_t *)z_spsc_pop(p->done);
+            if (bufs[0] == NULL)
+                break;
+            held = 1;
+        }
+        while (held < ZN_MMSG_LEN && (bufs[held] = (_z_zbuf_t *)z_spsc_try_pop(p->done)) != NULL)
+            held++;
+
+        size_t n = 0;
+        if (z->link->is_streamed == 1)
+        {
+            _z_zbuf_t *src = __unsafe_zn_recv_stream(z);
+            if (src == NULL)
+                break;
+
+            // The ring buffer is reused by the next read, while the batch may wait in the pipeline
+            size_t len = _z_zbuf_len(src);
+            _z_zbuf_clear(bufs[0]);
+            memcpy(_z_zbuf_get_wptr(bufs[0]), _z_zbuf_get_rptr(src), len);
+            _z_zbuf_set_wpos(bufs[0], len);
+            n = 1;
+        }
+        else
+        {
+            // Read the datagrams straight into the buffers of the pool
+            _z_zbuf_t zbfs[ZN_MMSG_LEN];
+            for (size_t i = 0; i < held; i++)
+            {
+                _z_zbuf_clear(bufs[i]);
+                zbfs[i] = *bufs[i];
+            }
+
+            int res = _zn_recv_dgrams(z->link, zbfs, held);
+            if (res < 0)
+                break;
+            if (res == 0)
+                continue;
+
+            n = (size_t)res;
+            for (size_t i = 0; i < n; i++)
+                *bufs[i] = zbfs[i];
+        }
+
+        for (size_t i = 0; i < n; i++)
+            z_spsc_push(p->ready, bufs[i]);
+
+        held -= n;
+        memmove(bufs, bufs + n, held * sizeof(_z_zbuf_t *));
+    }
+
+    // Let the read task know that no more batches will be read
+    p->is_running = 0;
+    z_spsc_wakeup(p->ready);
+
+    return 0;
+}
+
+/**
+ * Run the read task as the decoding stage of a pipeline, whose reading stage is a
+ * separate task. Return the result of the last batch handled, or -1 if the reading
+ * stage can not be started.
+ *
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - z->mutex_rx
+ */
+int __unsafe_znp_read_pipelined(zn_session_t *z)
+{
+    _zn_rx_pipeline_t *p = (_zn_rx_pipeline_t *)malloc(sizeof(_zn_rx_pipeline_t));
+    p->z = z;
+    p->ready = z_spsc_make(ZN_RX_PIPELINE_SIZE);
+    p->done = z_spsc_make(ZN_RX_PIPELINE_SIZE);
+    for (size_t i = 0; i < ZN_RX_PIPELINE_SIZE; i++)
+    {
+        p->batches[i] = _z_zbuf_make(ZN_READ_BUF_LEN);
+        z_spsc_push(p->done, &p->batches[i]);
+    }
+    p->is_running = 1;
+
+    int res = z_task_init(&p->task, NULL, __znp_recv_task, p);
+    int status = _z_res_t_OK;
+    if (res == 0)
+    {
+        // Let znp_stop_read_task wake the stages up, it is checked right after
+        z_mutex_lock(&z->mutex_inner);
+        z->read_pipeline = p;
+        z_mutex_unlock(&z->mutex_inner);
+
+        while (z->read_task_running)
+        {
+            _z_zbuf_t *zbf = (_z_zbuf_t *)z_spsc_pop(p->ready);
+            if (zbf == NULL)
+                break;
+
+            status = __unsafe_znp_handle_batch(z, zbf, _z_zbuf_len(zbf));
+            if (status != 0)
+            {
+                // The recv task may be blocked reading the stream, shut it down to join the task
+                if (z->link->is_streamed == 1 && z->link->close_f != NULL)
+                    z->link->close_f(z->link);
+                break;
+            }
+
+            // Give the buffer back to the recv task
+            z_spsc_push(p->done, zbf);
+        }
+
+        // Stop the recv task, it terminates once its current read returns
+        z->read_task_running = 0;
+        p->is_running = 0;
+        z_spsc_wakeup(p->done);
+        z_task_join(&p->task);
+
+        z_mutex_lock(&z->mutex_inner);
+        z->read_pipeline = NULL;
+        z_mutex_unlock(&z->mutex_inner);
+    }
+    else
+    {
+        _Z_DEBUG("Unable to spawn the recv task of the read pipeline\n");
+    }
+
+    for (size_t i = 0; i < ZN_RX_PIPELINE_SIZE; i++)
+        _z_zbuf_free(&p->batches[i]);
+    z_spsc_free(&p->done);
+    z_spsc_free(&p->ready);
+    free(p);
+
+    return res == 0 ? status : -1;
+}
+#endif
+
 void *_znp_read_task(void *arg)
 {
     zn_session_t *z = (zn_session_t *)arg;
     z->read_task_running = 1;
 
-    _zn_transport_message_p_result_t r;
-    _zn_transport_message_p_result_init(&r);
-
     // Acquire and keep the lock
     z_mutex_lock(&z->mutex_rx);
+
+    int res = _z_res_t_OK;
+#if ZN_RX_PIPELINE_SIZE > 0
+    // Fall back on reading in this task if the pipeline can not be started
+    res = __unsafe_znp_read_pipelined(z);
+    if (res != -1)
+        goto EXIT_RECV_LOOP;
+    res = _z_res_t_OK;
+#endif
+
     // Prepare the buffer
     _z_zbuf_clear(&z->zbuf);
     while (z->read_task_running)
     {
         size_t to_read = 0;
+        _z_zbuf_t *src = &z->zbuf;
         if (z->link->is_streamed == 1)
         {
-            // NOTE: 16 bits (2 bytes) may be prepended to the serialized message indicating the total length
-            //       in bytes of the message, resulting in the maximum length of a message being 65_535 bytes.
-            //       This is necessary in those stream-oriented transports (e.g., TCP) that do not preserve
-            //       the boundary of the serialized messages. The length is encoded as little-endian.
-            //       In any case, the length of a message must not exceed 65_535 bytes.
-            if (_z_zbuf_len(&z->zbuf) < _ZN_MSG_LEN_ENC_SIZE)
-            {
-                _z_zbuf_compact(&z->zbuf);
-                // Read number of bytes to read
-                while (_z_zbuf_len(&z->zbuf) < _ZN_MSG_LEN_ENC_SIZE)
-                {
-                    if (_zn_recv_zbuf(z->link, &z->zbuf) <= 0)
-                        goto EXIT_RECV_LOOP;
-                }
-            }
+            // Read the next length-prefixed batch from the ring buffer, without moving the
+            // bytes read ahead
+            src = __unsafe_zn_recv_stream(z);
+            if (src == NULL)
+                goto EXIT_RECV_LOOP;
 
-            // Decode the message length
-            to_read = (size_t)((uint16_t)_z_zbuf_read(&z->zbuf) | ((uint16_t)_z_zbuf_read(&z->zbuf) << 8));
+            to_read = _z_zbuf_len(src);
+        }
+        else if (z->link->read_batch_f != NULL)
+        {
+            // Read as many datagrams as available at once, then decode them one by one
+            src = __unsafe_zn_recv_dgram(z);
+            if (src == NULL)
+                continue;
 
-            if (_z_zbuf_len(&z->zbuf) < to_read)
-            {
-                _z_zbuf_compact(&z->zbuf);
-                // Read the rest of bytes to decode one or more session messages
-                while (_z_zbuf_len(&z->zbuf) < to_read)
-                {
-                    if (_zn_recv_zbuf(z->link, &z->zbuf) <= 0)
-                        goto EXIT_RECV_LOOP;
-                }
-            }
+            to_read = _z_zbuf_len(src);
         }
         else
         {
@@ -74,46 +271,19 @@ void *_znp_read_task(void *arg)
                 continue;
         }
 
-        // Wrap the main buffer for to_read bytes
-        _z_zbuf_t zbuf = _z_zbuf_view(&z->zbuf, to_read);
-
-        while (_z_zbuf_len(&zbuf) > 0)
-        {
-            // Mark the session that we have received data
-            z->received = 1;
-
-            // Decode one session message
-            _zn_transport_message_decode_na(&zbuf, &r);
-
-            if (r.tag == _z_res_t_OK)
-            {
-                int res = _zn_handle_transport_message(z, r.value.transport_message);
-                if (res == _z_res_t_OK)
-                    _zn_transport_message_free(r.value.transport_message);
-                else
-                    goto EXIT_RECV_LOOP;
-            }
-            else
-            {
-                _Z_DEBUG("Connection closed due to malformed message");
-                goto EXIT_RECV_LOOP;
-            }
-        }
-
-        // Move the read position of the read buffer
-        _z_zbuf_set_rpos(&z->zbuf, _z_zbuf_get_rpos(&z->zbuf) + to_read);
+        res = __unsafe_znp_handle_batch(z, src, to_read);
+        if (res != 0)
+            goto EXIT_RECV_LOOP;
     }
 
 EXIT_RECV_LOOP:
-    if (z)
-    {
-        z->read_task_running = 0;
-        // Release the lock
-        z_mutex_unlock(&z->mutex_rx);
-    }
+    z->read_task_running = 0;
+    // Release the lock
+    z_mutex_unlock(&z->mutex_rx);
 
-    // Free the result
-    _zn_transport_message_p_result_free(&r);
+    // The session closed by the remote peer is freed once nothing reads from it anymore
+    if (res == _z_res_t_CLOSED)
+        _zn_session_free(z);
 
     return 0;
 }
@@ -133,5 +303,17 @@ int znp_start_read_task(zn_session_t *z)
 int znp_stop_read_task(zn_session_t *z)
 {
     z->read_task_running = 0;
+
+#if ZN_RX_PIPELINE_SIZE > 0
+    // Wake the stages up if they wait for each other
+    z_mutex_lock(&z->mutex_inner);
+    if (z->read_pipeline != NULL)
+    {
+        z_spsc_wakeup(z->read_pipeline->ready);
+        z_spsc_wakeup(z->read_pipeline->done);
+    }
+    z_mutex_unlock(&z->mutex_inner);
+#endif
+
     return 0;
 }
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2017, 2021 ADLINK Technology Inc.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License 2.0 which is available at
+ * http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+ * which is available at https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+ *
+ * Contributors:
+ *   ADLINK zenoh team, <zenoh@adlink-labs.tech>
+ */
+
+#include "zenoh-pico/session/api.h"
+#include "zenoh-pico/session/types.h"
+#include "zenoh-pico/system/collections.h"
+#include "zenoh-pico/system/common.h"
+#include "zenoh-pico/transport/private/utils.h"
+#include "zenoh-pico/utils/private/logging.h"
+
+void *_znp_tx_task(void *arg)
+{
+    zn_session_t *zn = (zn_session_t *)arg;
+
+    _zn_tx_entry_t *entry;
+    while (zn->tx_task_running)
+    {
+        // Wait for the next encoded message, most urgent first
+        entry = _zn_tx_queue_pop(zn);
+
+        // Send what the timers of the session have requested meanwhile
+        if (zn->tx_work != 0)
+            _zn_tx_work_run(zn);
+
+        if (entry == NULL)
+            continue;
+
+        if (_zn_send_tx_entry(zn, entry) != 0)
+            _Z_DEBUG("Dropping zenoh message because it can not be sent\n");
+
+        _zn_tx_entry_free(&entry);
+    }
+
+    // Send the messages still in the queue before terminating
+    while ((entry = _zn_tx_queue_try_pop(zn)) != NULL)
+    {
+        _zn_send_tx_entry(zn, entry);
+        _zn_tx_entry_free(&entry);
+    }
+
+    return 0;
+}
+
+int znp_start_tx_task(zn_session_t *zn)
+{
+    for (int i = 0; i < _ZN_PRIORITIES_NUM; i++)
+    {
+        if (zn->tx_queue[i] == NULL)
+            zn->tx_queue[i] = z_mpsc_make(ZN_TX_QUEUE_SIZE);
+        if (zn->tx_queue[i] == NULL)
+            return -1;
+    }
+
+    z_task_t *task = (z_task_t *)malloc(sizeof(z_task_t));
+    if (task == NULL)
+        return -1;
+    memset(task, 0, sizeof(pthread_t));
+    free(zn->tx_task);
+    zn->tx_task = task;
+    // Mark the task as running before spawning it, so that no message
+    // bypasses the queue while the task is starting
+    zn->tx_task_running = 1;
+    if (z_task_init(task, NULL, _znp_tx_task, zn) != 0)
+    {
+        zn->tx_task_running = 0;
+        return -1;
+    }
+    return 0;
+}
+
+int znp_stop_tx_task(zn_session_t *zn)
+{
+    if (zn->tx_task_running == 0)
+        return -1;
+
+    zn->tx_task_running = 0;
+    // Wake up the task in case it is waiting on empty queues
+    _zn_tx_queue_wakeup(zn);
+
+    // Wait for the messages still in the queues to be sent, so that they are neither
+    // overtaken by the direct sends nor released while the task is draining them
+    z_task_join(zn->tx_task);
+    return 0;
+}
@@ -13,10 +13,15 @@
  */
 
 #include "zenoh-pico/protocol/private/utils.h"
+#include "zenoh-pico/session/private/utils.h"
 #include "zenoh-pico/utils/private/logging.h"
 #include "zenoh-pico/system/common.h"
+#include "zenoh-pico/system/collections.h"
 #include "zenoh-pico/transport/private/utils.h"
 
+// The frame header of a fragment is made of its header byte and of its SN
+#define _ZN_FRAG_HDR_MAX 16
+
 /*------------------ SN helper ------------------*/
 /**
  * This function is unsafe because it operates in potentially concurrent data.
@@ -76,7 +81,7 @@ void __unsafe_zn_prepare_wbuf(_z_wbuf_t *buf, int is_streamed)
  * Make sure that the following mutexes are locked before calling this function:
  *  - zn->mutex_tx
  */
-void __unsafe_zn_finalize_wbuf(_z_wbuf_t *buf, int is_streamed)
+void __unsafe_zn_finalize_wbuf_ext(_z_wbuf_t *buf, int is_streamed, size_t extra_len)
 {
     if (is_streamed == 1)
     {
@@ -85,18 +90,117 @@ void __unsafe_zn_finalize_wbuf(_z_wbuf_t *buf, int is_streamed)
         //       This is necessary in those stream-oriented transports (e.g., TCP) that do not preserve
         //       the boundary of the serialized messages. The length is encoded as little-endian.
         //       In any case, the length of a message must not exceed 65_535 bytes.
-        size_t len = _z_wbuf_len(buf) - _ZN_MSG_LEN_ENC_SIZE;
+        size_t len = _z_wbuf_len(buf) - _ZN_MSG_LEN_ENC_SIZE + extra_len;
         for (size_t i = 0; i < _ZN_MSG_LEN_ENC_SIZE; ++i)
             _z_wbuf_put(buf, (uint8_t)((len >> 8 * i) & 0xFF), i);
     }
 }
 
-int _zn_send_t_msg(zn_session_t *zn, _zn_transport_message_t *t_msg)
+/**
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->mutex_tx
+ */
+void __unsafe_zn_finalize_wbuf(_z_wbuf_t *buf, int is_streamed)
 {
-    _Z_DEBUG(">> send session message\n");
+    __unsafe_zn_finalize_wbuf_ext(buf, is_streamed, 0);
+}
 
-    // Acquire the lock
+/**
+ * Send the frame serialized in the wbuf, keeping a copy of it if it has to be retransmitted.
+ *
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->mutex_tx
+ */
+int __unsafe_zn_send_frame(zn_session_t *zn, zn_reliability_t reliability, z_zint_t sn)
+{
+    // Write the message length in the reserved space if needed
+    __unsafe_zn_finalize_wbuf(&zn->wbuf, zn->link->is_streamed);
+
+    __unsafe_zn_retx_store(zn, reliability, sn, &zn->wbuf, NULL, 0);
+
+    // Send the wbuf on the socket
+    size_t len = _z_wbuf_len(&zn->wbuf);
+    int res = _zn_send_wbuf(zn->link, &zn->wbuf);
+    if (res == 0)
+    {
+        // Mark the session that we have transmitted data
+        zn->last_tx = z_clock_now();
+        _ZN_STATS_INC(zn, tx_batches);
+        _ZN_STATS_ADD(zn, tx_bytes, len);
+    }
+
+    return res;
+}
+
+/*------------------ Batching helpers ------------------*/
+/**
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->mutex_tx
+ */
+int __unsafe_zn_flush_batch(zn_session_t *zn)
+{
+    if (zn->batch_open == 0)
+        return 0;
+
+    // Close the batch before sending, the wbuf is reused afterwards in any case
+    zn->batch_open = 0;
+
+    return __unsafe_zn_send_frame(zn, zn->batch_reliability, zn->batch_sn);
+}
+
+int _zn_flush_batch(zn_session_t *zn)
+{
     z_mutex_lock(&zn->mutex_tx);
+    int res = __unsafe_zn_flush_batch(zn);
+    z_mutex_unlock(&zn->mutex_tx);
+
+    return res;
+}
+
+/**
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->mutex_tx
+ */
+int __unsafe_zn_flush_expired_batch(zn_session_t *zn)
+{
+    // A linger time of 0 means that the batch is sent only when full or explicitly flushed
+    if (zn->batch_open == 0 || zn->batch_linger == 0)
+        return 0;
+
+    if (z_clock_elapsed_ms(&zn->batch_start) < (clock_t)zn->batch_linger)
+        return 0;
+
+    return __unsafe_zn_flush_batch(zn);
+}
+
+int _zn_flush_expired_batch(zn_session_t *zn)
+{
+    // Do not contend with a writer, it will check the linger time on its own
+    if (z_mutex_trylock(&zn->mutex_tx) != 0)
+        return 0;
+
+    int res = __unsafe_zn_flush_expired_batch(zn);
+
+    z_mutex_unlock(&zn->mutex_tx);
+
+    return res;
+}
+
+/**
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->mutex_tx
+ */
+int __unsafe_zn_send_t_msg(zn_session_t *zn, _zn_transport_message_t *t_msg)
+{
+    _Z_DEBUG(">> send session message\n");
+
+    // Send any pending batch first, the wbuf is going to be overwritten
+    __unsafe_zn_flush_batch(zn);
 
     // Prepare the buffer eventually reserving space for the message length
     __unsafe_zn_prepare_wbuf(&zn->wbuf, zn->link->is_streamed);
@@ -108,21 +212,50 @@ int _zn_send_t_msg(zn_session_t *zn, _zn_transport_message_t *t_msg)
         // Write the message legnth in the reserved space if needed
         __unsafe_zn_finalize_wbuf(&zn->wbuf, zn->link->is_streamed);
         // Send the wbuf on the socket
+        size_t len = _z_wbuf_len(&zn->wbuf);
         res = _zn_send_wbuf(zn->link, &zn->wbuf);
         // Mark the session that we have transmitted data
-        zn->transmitted = 1;
+        zn->last_tx = z_clock_now();
+        if (res == 0)
+        {
+            _ZN_STATS_INC(zn, tx_batches);
+            _ZN_STATS_ADD(zn, tx_bytes, len);
+        }
     }
     else
     {
         _Z_DEBUG("Dropping session message because it is too large");
     }
 
+    return res;
+}
+
+int _zn_send_t_msg(zn_session_t *zn, _zn_transport_message_t *t_msg)
+{
+    // Acquire the lock
+    z_mutex_lock(&zn->mutex_tx);
+
+    int res = __unsafe_zn_send_t_msg(zn, t_msg);
+
     // Release the lock
     z_mutex_unlock(&zn->mutex_tx);
 
     return res;
 }
 
+int _zn_try_send_t_msg(zn_session_t *zn, _zn_transport_message_t *t_msg)
+{
+    // Do not wait for a writer stalled on the link, the caller tries again later
+    if (z_mutex_trylock(&zn->mutex_tx) != 0)
+        return _z_res_t_BUSY;
+
+    int res = __unsafe_zn_send_t_msg(zn, t_msg);
+
+    z_mutex_unlock(&zn->mutex_tx);
+
+    return res;
+}
+
 _zn_transport_message_t __zn_frame_header(zn_reliability_t reliability, int is_fragment, int is_final, z_zint_t sn)
 {
     // Create the frame session message that carries the zenoh message
@@ -159,59 +292,150 @@ _zn_transport_message_t __zn_frame_header(zn_reliability_t reliability, int is_f
  * Make sure that the following mutexes are locked before calling this function:
  *  - zn->mutex_tx
  */
-int __unsafe_zn_serialize_zenoh_fragment(_z_wbuf_t *dst, _z_wbuf_t *src, zn_reliability_t reliability, size_t sn)
+int __unsafe_zn_send_fragmented(zn_session_t *zn, _z_wbuf_t *fbf, zn_reliability_t reliability, z_zint_t sn)
 {
-    // Assume first that this is not the final fragment
-    int is_final = 0;
-    do
+    // NOTE: the serialized message is never copied, each fragment is sent as the frame header
+    //       followed by a range of the slices of fbf, which may reference the caller's payload.
+    //       On datagram links moving many datagrams per system call, the fragments are gathered
+    //       and sent ZN_MMSG_LEN at a time.
+    int is_gathered = zn->link->is_streamed == 0 && zn->link->write_batch_f != NULL;
+    uint8_t hdrs[ZN_MMSG_LEN][_ZN_FRAG_HDR_MAX];
+    z_bytes_t iov[_ZN_IOV_MAX];
+    size_t iovcnts[ZN_MMSG_LEN];
+    size_t dgrams = 0;
+    size_t iovlen = 0;
+
+    int is_first = 1;
+    size_t bytes_left = _z_wbuf_len(fbf);
+    while (bytes_left > 0)
     {
-        // Mark the buffer for the writing operation
-        size_t w_pos = _z_wbuf_get_wpos(dst);
-        // Get the frame header
-        _zn_transport_message_t f_hdr = __zn_frame_header(reliability, 1, is_final, sn);
-        // Encode the frame header
-        int res = _zn_transport_message_encode(dst, &f_hdr);
-        if (res == 0)
+        // Get the fragment sequence number
+        if (!is_first)
+            sn = __unsafe_zn_get_sn(zn, reliability);
+        is_first = 0;
+
+        // Clear the buffer for serialization
+        __unsafe_zn_prepare_wbuf(&zn->wbuf, zn->link->is_streamed);
+
+        // Assume first that this is not the final fragment
+        size_t w_pos = _z_wbuf_get_wpos(&zn->wbuf);
+        _zn_transport_message_t f_hdr = __zn_frame_header(reliability, 1, 0, sn);
+        int res = _zn_transport_message_encode(&zn->wbuf, &f_hdr);
+        if (res == 0 && bytes_left <= _z_wbuf_space_left(&zn->wbuf))
         {
-            size_t space_left = _z_wbuf_space_left(dst);
-            size_t bytes_left = _z_wbuf_len(src);
-            // Check if it is really the final fragment
-            if (!is_final && (bytes_left <= space_left))
+            // It is really the final fragment, reserialize the header
+            _z_wbuf_set_wpos(&zn->wbuf, w_pos);
+            f_hdr = __zn_frame_header(reliability, 1, 1, sn);
+            res = _zn_transport_message_encode(&zn->wbuf, &f_hdr);
+        }
+        if (res != 0)
+        {
+            _Z_DEBUG("Dropping zenoh message because it can not be fragmented\n");
+            return res;
+        }
+
+        // The fragment takes the room left in the batch
+        size_t space_left = _z_wbuf_space_left(&zn->wbuf);
+        size_t to_send = bytes_left <= space_left ? bytes_left : space_left;
+
+        // Write the message length in the reserved space if needed
+        __unsafe_zn_finalize_wbuf_ext(&zn->wbuf, zn->link->is_streamed, to_send);
+
+        __unsafe_zn_retx_store(zn, reliability, sn, &zn->wbuf, fbf, to_send);
+
+        // The fragment spans at most all the remaining slices of fbf
+        size_t hdr_len = _z_wbuf_len(&zn->wbuf);
+        size_t max_iovcnt = 1 + _z_wbuf_len_iosli(fbf) - fbf->r_idx;
+        if (is_gathered && hdr_len <= _ZN_FRAG_HDR_MAX && max_iovcnt <= _ZN_IOV_MAX)
+        {
+            if (dgrams == ZN_MMSG_LEN || iovlen + max_iovcnt > _ZN_IOV_MAX)
             {
-                // Revert the buffer
-                _z_wbuf_set_wpos(dst, w_pos);
-                // It is really the finally fragment, reserialize the header
-                is_final = 1;
-                continue;
+                res = _zn_send_dgrams(zn->link, iov, iovcnts, dgrams);
+                dgrams = 0;
+                iovlen = 0;
             }
-            // Write the fragment
-            size_t to_copy = bytes_left <= space_left ? bytes_left : space_left;
-            return _z_wbuf_copy_into(dst, src, to_copy);
+
+            // Keep a copy of the frame header, the wbuf is reused by the next fragment
+            z_bytes_t hdr = _z_iosli_to_bytes(_z_wbuf_get_iosli(&zn->wbuf, 0));
+            memcpy(hdrs[dgrams], hdr.val, hdr_len);
+            iov[iovlen].val = hdrs[dgrams];
+            iov[iovlen].len = hdr_len;
+            iovcnts[dgrams] = 1 + _zn_wbuf_gather_range(fbf, to_send, &iov[iovlen + 1]);
+            iovlen += iovcnts[dgrams];
+            dgrams++;
         }
         else
         {
-            return 0;
+            // Send the frame header followed by the fragment
+            if (dgrams > 0)
+            {
+                res = _zn_send_dgrams(zn->link, iov, iovcnts, dgrams);
+                dgrams = 0;
+                iovlen = 0;
+            }
+            if (res == 0)
+                res = _zn_send_wbuf_range(zn->link, &zn->wbuf, fbf, to_send);
         }
-    } while (1);
-}
+        if (res != 0)
+        {
+            _Z_DEBUG("Dropping zenoh message because it can not sent\n");
+            return res;
+        }
+        bytes_left -= to_send;
 
-int _zn_send_z_msg(zn_session_t *zn, _zn_zenoh_message_t *z_msg, zn_reliability_t reliability, zn_congestion_control_t cong_ctrl)
-{
-    _Z_DEBUG(">> send zenoh message\n");
+        // Mark the session that we have transmitted data
+        zn->last_tx = z_clock_now();
+        _ZN_STATS_INC(zn, tx_fragments);
+        _ZN_STATS_INC(zn, tx_batches);
+        _ZN_STATS_ADD(zn, tx_bytes, hdr_len + to_send);
+    }
 
-    // Acquire the lock and drop the message if needed
-    if (cong_ctrl == zn_congestion_control_t_BLOCK)
+    // Send the last gathered fragments
+    if (dgrams > 0 && _zn_send_dgrams(zn->link, iov, iovcnts, dgrams) != 0)
     {
-        z_mutex_lock(&zn->mutex_tx);
+        _Z_DEBUG("Dropping zenoh message because it can not sent\n");
+        return -1;
     }
-    else
+
+    return 0;
+}
+
+// Write a zenoh message on a buffer, failing if it does not fit
+typedef int (*_zn_z_msg_writer_t)(_z_wbuf_t *wbf, const void *msg);
+
+/**
+ * Append a zenoh message to the open batch if it fits, otherwise send the open batch and
+ * start a new frame with the message, fragmenting it if it does not fit in a batch on its own.
+ * The message is written on the given buffer by write_f, which may be called more than once.
+ *
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->mutex_tx
+ */
+int __unsafe_zn_append_z_msg(zn_session_t *zn, _zn_z_msg_writer_t write_f, const void *msg, zn_reliability_t reliability, zn_priority_t priority, int is_batched)
+{
+    int res = 0;
+
+    if (zn->batch_open == 1)
     {
-        int locked = z_mutex_trylock(&zn->mutex_tx);
-        if (locked != 0)
+        if (is_batched && zn->batch_reliability == reliability && zn->batch_priority == priority)
         {
-            _Z_DEBUG("Dropping zenoh message because of congestion control\n");
-            // We failed to acquire the lock, drop the message
-            return 0;
+            // Try to append the zenoh message to the open frame
+            size_t w_pos = _z_wbuf_get_wpos(&zn->wbuf);
+            if (write_f(&zn->wbuf, msg) == 0)
+                // Send the batch if its linger time has expired
+                return __unsafe_zn_flush_expired_batch(zn);
+
+            // The message does not fit in the open frame, revert the buffer
+            _z_wbuf_set_wpos(&zn->wbuf, w_pos);
+        }
+
+        // Send the open frame before the new message to preserve the ordering
+        res = __unsafe_zn_flush_batch(zn);
+        if (res != 0)
+        {
+            _Z_DEBUG("Dropping zenoh message because the pending batch can not be sent\n");
+            return res;
         }
     }
 
@@ -224,83 +448,337 @@ int _zn_send_z_msg(zn_session_t *zn, _zn_zenoh_message_t *z_msg, zn_reliability_
     _zn_transport_message_t t_msg = __zn_frame_header(reliability, 0, 0, sn);
 
     // Encode the frame header
-    int res = _zn_transport_message_encode(&zn->wbuf, &t_msg);
+    res = _zn_transport_message_encode(&zn->wbuf, &t_msg);
     if (res != 0)
     {
         _Z_DEBUG("Dropping zenoh message because the session frame can not be encoded\n");
-        goto EXIT_ZSND_PROC;
+        return res;
     }
 
-    // Encode the zenoh message
-    res = _zn_zenoh_message_encode(&zn->wbuf, z_msg);
+    if (write_f(&zn->wbuf, msg) == 0)
+    {
+        if (!is_batched)
+            return __unsafe_zn_send_frame(zn, reliability, sn);
+
+        // Keep the frame open for the following messages
+        zn->batch_open = 1;
+        zn->batch_reliability = reliability;
+        zn->batch_priority = priority;
+        zn->batch_sn = sn;
+        zn->batch_start = z_clock_now();
+        return 0;
+    }
+
+    // The message does not fit in the current batch, let's fragment it
+    // Create an expandable wbuf for fragmentation. The message is sent before
+    // returning, hence the large bytes can be referenced instead of copied.
+    _z_wbuf_t fbf = _z_wbuf_make(ZN_FRAG_BUF_TX_CHUNK, 1);
+    fbf.is_zero_copy = 1;
+
+    res = write_f(&fbf, msg);
     if (res == 0)
+        res = __unsafe_zn_send_fragmented(zn, &fbf, reliability, sn);
+    else
+        _Z_DEBUG("Dropping zenoh message because it can not be fragmented\n");
+
+    // Free the fragmentation buffer memory
+    _z_wbuf_free(&fbf);
+
+    return res;
+}
+
+int __zn_write_z_msg(_z_wbuf_t *wbf, const void *msg)
+{
+    return _zn_zenoh_message_encode(wbf, (_zn_zenoh_message_t *)msg);
+}
+
+int __zn_write_serialized_z_msg(_z_wbuf_t *wbf, const void *msg)
+{
+    // Append the readable bytes of the serialized message without consuming them
+    const _z_wbuf_t *src = (const _z_wbuf_t *)msg;
+    for (size_t i = src->r_idx; i < _z_wbuf_len_iosli(src); i++)
     {
-        // Write the message legnth in the reserved space if needed
-        __unsafe_zn_finalize_wbuf(&zn->wbuf, zn->link->is_streamed);
+        z_bytes_t bs = _z_iosli_to_bytes(_z_wbuf_get_iosli(src, i));
+        if (bs.len == 0)
+            continue;
 
-        // Send the wbuf on the socket
-        res = _zn_send_wbuf(zn->link, &zn->wbuf);
-        if (res == 0)
-            // Mark the session that we have transmitted data
-            zn->transmitted = 1;
+        if (wbf->is_zero_copy && wbf->is_expandable)
+            _z_wbuf_add_iosli_wrap(wbf, bs.val, bs.len);
+        else
+            _ZN_EC(_z_wbuf_write_bytes(wbf, bs.val, 0, bs.len))
     }
+    return 0;
+}
+
+/**
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->mutex_tx
+ */
+int __unsafe_zn_send_serialized_z_msg(zn_session_t *zn, _z_wbuf_t *src, zn_reliability_t reliability, zn_priority_t priority, int is_batched)
+{
+    return __unsafe_zn_append_z_msg(zn, __zn_write_serialized_z_msg, src, reliability, priority, is_batched);
+}
+
+/*------------------ Transmission queue ------------------*/
+void _zn_tx_entry_free(_zn_tx_entry_t **entry)
+{
+    _zn_tx_entry_t *ptr = *entry;
+    _z_wbuf_free(&ptr->wbf);
+    free(ptr);
+    *entry = NULL;
+}
+
+int _zn_send_tx_entry(zn_session_t *zn, _zn_tx_entry_t *entry)
+{
+    z_mutex_lock(&zn->mutex_tx);
+    int res = __unsafe_zn_send_serialized_z_msg(zn, &entry->wbf, entry->reliability, entry->priority, zn->batching == 1 && entry->is_express == 0);
+    z_mutex_unlock(&zn->mutex_tx);
+
+    if (res == 0)
+        _ZN_STATS_INC(zn, tx_msgs);
     else
+        _ZN_STATS_INC(zn, tx_dropped_errors);
+
+    return res;
+}
+
+void __zn_tx_queue_notify(zn_session_t *zn)
+{
+    // Pairs with the fence in _zn_tx_queue_pop: either the transmit task sees
+    // the entry or we see that it is parked and wake it up
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&zn->tx_queue_waiting, __ATOMIC_RELAXED))
     {
-        // The message does not fit in the current batch, let's fragment it
-        // Create an expandable wbuf for fragmentation
-        _z_wbuf_t fbf = _z_wbuf_make(ZN_FRAG_BUF_TX_CHUNK, 1);
+        z_mutex_lock(&zn->mutex_tx_queue);
+        z_condvar_signal(&zn->cond_tx_queue);
+        z_mutex_unlock(&zn->mutex_tx_queue);
+    }
+}
 
-        // Encode the message on the expandable wbuf
-        res = _zn_zenoh_message_encode(&fbf, z_msg);
-        if (res != 0)
-        {
-            _Z_DEBUG("Dropping zenoh message because it can not be fragmented");
-            goto EXIT_FRAG_PROC;
-        }
+_zn_tx_entry_t *_zn_tx_queue_try_pop(zn_session_t *zn)
+{
+    // Strict priority: a queue is served only when all the more urgent ones are empty
+    for (int i = 0; i < _ZN_PRIORITIES_NUM; i++)
+    {
+        if (zn->tx_queue[i] == NULL)
+            continue;
 
-        // Fragment and send the message
-        int is_first = 1;
-        while (_z_wbuf_len(&fbf) > 0)
-        {
-            // Get the fragment sequence number
-            if (!is_first)
-                sn = __unsafe_zn_get_sn(zn, reliability);
-            is_first = 0;
+        _zn_tx_entry_t *entry = (_zn_tx_entry_t *)z_mpsc_try_pop(zn->tx_queue[i]);
+        if (entry != NULL)
+            return entry;
+    }
 
-            // Clear the buffer for serialization
-            __unsafe_zn_prepare_wbuf(&zn->wbuf, zn->link->is_streamed);
+    return NULL;
+}
 
-            // Serialize one fragment
-            res = __unsafe_zn_serialize_zenoh_fragment(&zn->wbuf, &fbf, reliability, sn);
-            if (res != 0)
-            {
-                _Z_DEBUG("Dropping zenoh message because it can not be fragmented\n");
-                goto EXIT_FRAG_PROC;
-            }
+_zn_tx_entry_t *_zn_tx_queue_pop(zn_session_t *zn)
+{
+    _zn_tx_entry_t *entry = _zn_tx_queue_try_pop(zn);
+    if (entry == NULL)
+    {
+        // All the queues are empty, park until a producer pushes or a wakeup is requested
+        z_mutex_lock(&zn->mutex_tx_queue);
+        __atomic_store_n(&zn->tx_queue_waiting, 1, __ATOMIC_SEQ_CST);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        while ((entry = _zn_tx_queue_try_pop(zn)) == NULL && zn->tx_queue_wakeup == 0)
+            z_condvar_wait(&zn->cond_tx_queue, &zn->mutex_tx_queue);
+        __atomic_store_n(&zn->tx_queue_waiting, 0, __ATOMIC_SEQ_CST);
+        // A wakeup is only consumed by returning without an entry, so that it is not lost
+        if (entry == NULL)
+            zn->tx_queue_wakeup = 0;
+        z_mutex_unlock(&zn->mutex_tx_queue);
+    }
 
-            // Write the message length in the reserved space if needed
-            __unsafe_zn_finalize_wbuf(&zn->wbuf, zn->link->is_streamed);
+    return entry;
+}
 
-            // Send the wbuf on the socket
-            res = _zn_send_wbuf(zn->link, &zn->wbuf);
-            if (res != 0)
-            {
-                _Z_DEBUG("Dropping zenoh message because it can not sent\n");
-                goto EXIT_FRAG_PROC;
-            }
+void _zn_tx_queue_wakeup(zn_session_t *zn)
+{
+    z_mutex_lock(&zn->mutex_tx_queue);
+    zn->tx_queue_wakeup = 1;
+    z_condvar_signal(&zn->cond_tx_queue);
+    z_mutex_unlock(&zn->mutex_tx_queue);
+}
+
+_zn_tx_entry_t *__zn_tx_entry_make(zn_reliability_t reliability, zn_priority_t priority, int is_express)
+{
+    _zn_tx_entry_t *entry = (_zn_tx_entry_t *)malloc(sizeof(_zn_tx_entry_t));
+    entry->wbf = _z_wbuf_make(ZN_FRAG_BUF_TX_CHUNK, 1);
+    entry->reliability = reliability;
+    entry->priority = priority;
+    entry->is_express = is_express;
+    return entry;
+}
+
+int __zn_enqueue_tx_entry(zn_session_t *zn, _zn_tx_entry_t *entry, zn_congestion_control_t cong_ctrl)
+{
+    // Congestion control applies to the occupancy of the queue of the given priority
+    z_mpsc_t *queue = zn->tx_queue[entry->priority];
+    if (cong_ctrl == zn_congestion_control_t_BLOCK)
+    {
+        z_mpsc_push(queue, entry);
+    }
+    else if (z_mpsc_try_push(queue, entry) != 0)
+    {
+        _Z_DEBUG("Dropping zenoh message because of congestion control\n");
+        // The queue is full, drop the message
+        _zn_tx_entry_free(&entry);
+        _ZN_STATS_INC(zn, tx_dropped_congestion);
+        return 0;
+    }
+
+    __zn_tx_queue_notify(zn);
+
+    return 0;
+}
+
+int __zn_enqueue_z_msg(zn_session_t *zn, _zn_zenoh_message_t *z_msg, zn_reliability_t reliability, zn_congestion_control_t cong_ctrl, int is_express)
+{
+    // Encode the message in its own buffer, producers do not need any lock for this
+    _zn_tx_entry_t *entry = __zn_tx_entry_make(reliability, z_msg->priority, is_express);
+
+    int res = _zn_zenoh_message_encode(&entry->wbf, z_msg);
+    if (res != 0)
+    {
+        _Z_DEBUG("Dropping zenoh message because it can not be encoded\n");
+        _zn_tx_entry_free(&entry);
+        _ZN_STATS_INC(zn, tx_dropped_errors);
+        return res;
+    }
+
+    return __zn_enqueue_tx_entry(zn, entry, cong_ctrl);
+}
+
+int __zn_lock_tx(zn_session_t *zn, zn_congestion_control_t cong_ctrl)
+{
+    // Acquire the lock, fail instead of waiting if the message can be dropped
+    if (z_mutex_trylock(&zn->mutex_tx) == 0)
+        return 0;
+
+    // The lock is held by another thread
+    _ZN_STATS_INC(zn, tx_lock_contentions);
+    if (cong_ctrl == zn_congestion_control_t_BLOCK)
+        return z_mutex_lock(&zn->mutex_tx);
+
+    _ZN_STATS_INC(zn, tx_dropped_congestion);
+    return -1;
+}
+
+int _zn_send_z_msg(zn_session_t *zn, _zn_zenoh_message_t *z_msg, zn_reliability_t reliability, zn_congestion_control_t cong_ctrl)
+{
+    return _zn_send_z_msg_ext(zn, z_msg, reliability, cong_ctrl, 0);
+}
+
+int __zn_check_priority(zn_session_t *zn, zn_priority_t priority)
+{
+    // The priority indexes the transmission queues and is encoded in 3 bits
+    if ((unsigned int)priority < _ZN_PRIORITIES_NUM)
+        return 0;
+
+    _Z_DEBUG("Dropping zenoh message because of an invalid priority\n");
+    _ZN_STATS_INC(zn, tx_dropped_errors);
+    return -1;
+}
+
+int _zn_send_z_msg_ext(zn_session_t *zn, _zn_zenoh_message_t *z_msg, zn_reliability_t reliability, zn_congestion_control_t cong_ctrl, int is_express)
+{
+    _Z_DEBUG(">> send zenoh message\n");
+
+    if (__zn_check_priority(zn, z_msg->priority) != 0)
+        return -1;
+
+    // Hand the message over to the transmit task if running
+    if (zn->tx_task_running == 1)
+        return __zn_enqueue_z_msg(zn, z_msg, reliability, cong_ctrl, is_express);
+
+    // Acquire the lock and drop the message if needed
+    if (__zn_lock_tx(zn, cong_ctrl) != 0)
+    {
+        _Z_DEBUG("Dropping zenoh message because of congestion control\n");
+        // We failed to acquire the lock, drop the message
+        return 0;
+    }
+
+    // Express messages always bypass the batching
+    int is_batched = zn->batching == 1 && is_express == 0;
+    int res = __unsafe_zn_append_z_msg(zn, __zn_write_z_msg, z_msg, reliability, z_msg->priority, is_batched);
+
+    // Release the lock
+    z_mutex_unlock(&zn->mutex_tx);
+
+    if (res == 0)
+        _ZN_STATS_INC(zn, tx_msgs);
+    else
+        _ZN_STATS_INC(zn, tx_dropped_errors);
+
+    return res;
+}
+
+/*------------------ Pre-encoded messages ------------------*/
+int __zn_write_pre_encoded(_z_wbuf_t *wbf, const z_bytes_t *header, const z_bytes_t *payload)
+{
+    _ZN_EC(_z_wbuf_write_bytes(wbf, header->val, 0, header->len))
+    return _z_bytes_encode(wbf, payload);
+}
+
+typedef struct
+{
+    const z_bytes_t *header;
+    const z_bytes_t *payload;
+} _zn_pre_encoded_z_msg_t;
+
+int __zn_write_pre_encoded_z_msg(_z_wbuf_t *wbf, const void *msg)
+{
+    const _zn_pre_encoded_z_msg_t *pre = (const _zn_pre_encoded_z_msg_t *)msg;
+    return __zn_write_pre_encoded(wbf, pre->header, pre->payload);
+}
+
+int _zn_send_pre_encoded_z_msg(zn_session_t *zn, const z_bytes_t *header, const uint8_t *payload, size_t length, zn_reliability_t reliability, zn_priority_t priority, zn_congestion_control_t cong_ctrl)
+{
+    _Z_DEBUG(">> send pre-encoded zenoh message\n");
+
+    if (__zn_check_priority(zn, priority) != 0)
+        return -1;
 
-            // Mark the session that we have transmitted data
-            zn->transmitted = 1;
+    z_bytes_t pld;
+    pld.val = payload;
+    pld.len = length;
+
+    // Hand the message over to the transmit task if running
+    if (zn->tx_task_running == 1)
+    {
+        _zn_tx_entry_t *entry = __zn_tx_entry_make(reliability, priority, 0);
+        int res = __zn_write_pre_encoded(&entry->wbf, header, &pld);
+        if (res != 0)
+        {
+            _Z_DEBUG("Dropping zenoh message because it can not be encoded\n");
+            _zn_tx_entry_free(&entry);
+            _ZN_STATS_INC(zn, tx_dropped_errors);
+            return res;
         }
 
-    EXIT_FRAG_PROC:
-        // Free the fragmentation buffer memory
-        _z_wbuf_free(&fbf);
+        return __zn_enqueue_tx_entry(zn, entry, cong_ctrl);
     }
 
-EXIT_ZSND_PROC:
+    // Acquire the lock and drop the message if needed
+    if (__zn_lock_tx(zn, cong_ctrl) != 0)
+    {
+        _Z_DEBUG("Dropping zenoh message because of congestion control\n");
+        // We failed to acquire the lock, drop the message
+        return 0;
+    }
+
+    _zn_pre_encoded_z_msg_t pre = {header, &pld};
+    int res = __unsafe_zn_append_z_msg(zn, __zn_write_pre_encoded_z_msg, &pre, reliability, priority, zn->batching == 1);
+
     // Release the lock
     z_mutex_unlock(&zn->mutex_tx);
 
+    if (res == 0)
+        _ZN_STATS_INC(zn, tx_msgs);
+    else
+        _ZN_STATS_INC(zn, tx_dropped_errors);
+
     return res;
 }
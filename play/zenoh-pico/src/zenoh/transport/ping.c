@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2017, 2021 ADLINK Technology Inc.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License 2.0 which is available at
+ * http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+ * which is available at https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+ *
+ * Contributors:
+ *   ADLINK zenoh team, <zenoh@adlink-labs.tech>
+ */
+
+#include "zenoh-pico/protocol/private/utils.h"
+#include "zenoh-pico/session/private/utils.h"
+#include "zenoh-pico/system/common.h"
+#include "zenoh-pico/transport/private/utils.h"
+#include "zenoh-pico/utils/private/logging.h"
+
+/*------------------ Round trip time ------------------*/
+/**
+ * Add a round trip time to the window of the most recent ones, and publish its
+ * minimum, average and 99th percentile in the statistics.
+ *
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->mutex_inner
+ */
+void __unsafe_zn_rtt_update(zn_session_t *zn, clock_t rtt)
+{
+    zn->rtt_window[zn->rtt_head] = rtt;
+    zn->rtt_head = (zn->rtt_head + 1) % ZN_RTT_WINDOW;
+    if (zn->rtt_len < ZN_RTT_WINDOW)
+        zn->rtt_len++;
+
+    // The window is small, sort a copy of it to find the percentile
+    clock_t sorted[ZN_RTT_WINDOW];
+    clock_t sum = 0;
+    for (size_t i = 0; i < zn->rtt_len; i++)
+    {
+        clock_t v = zn->rtt_window[i];
+        size_t j = i;
+        while (j > 0 && sorted[j - 1] > v)
+        {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = v;
+        sum += v;
+    }
+
+    // Nearest rank percentile
+    size_t p99 = (99 * zn->rtt_len + 99) / 100 - 1;
+
+    _ZN_STATS_INC(zn, rtt_samples);
+    __atomic_store_n(&zn->stats.rtt_min, (z_zint_t)sorted[0], __ATOMIC_RELAXED);
+    __atomic_store_n(&zn->stats.rtt_avg, (z_zint_t)(sum / (clock_t)zn->rtt_len), __ATOMIC_RELAXED);
+    __atomic_store_n(&zn->stats.rtt_p99, (z_zint_t)sorted[p99], __ATOMIC_RELAXED);
+}
+
+int _zn_send_ping_pong(zn_session_t *zn, z_zint_t hash, int is_ping)
+{
+    _zn_transport_message_t t_msg = _zn_transport_message_init(_ZN_MID_PING_PONG);
+    if (is_ping)
+        _ZN_SET_FLAG(t_msg.header, _ZN_FLAG_T_P);
+    t_msg.body.ping_pong.hash = hash;
+
+    return _zn_send_t_msg(zn, &t_msg);
+}
+
+int _zn_handle_ping_pong(zn_session_t *zn, uint8_t header, const _zn_ping_pong_t *msg)
+{
+    if (_ZN_HAS_FLAG(header, _ZN_FLAG_T_P))
+    {
+        // Answer right away, failing to do so does not prevent reading
+        if (_zn_send_ping_pong(zn, msg->hash, 0) != 0)
+            _Z_DEBUG("Unable to answer a ping\n");
+        return _z_res_t_OK;
+    }
+
+    z_mutex_lock(&zn->mutex_inner);
+    // Pongs arriving after the timeout, or not answering our ping, are ignored
+    if (zn->ping_hash != 0 && msg->hash == zn->ping_hash && zn->ping_rtt < 0)
+    {
+        clock_t rtt = z_clock_elapsed_us(&zn->ping_start);
+        zn->ping_rtt = rtt > 0 ? rtt : 0;
+        __unsafe_zn_rtt_update(zn, zn->ping_rtt);
+        z_condvar_signal(&zn->cond_ping);
+    }
+    z_mutex_unlock(&zn->mutex_inner);
+
+    return _z_res_t_OK;
+}
@@ -0,0 +1,424 @@
+/*
+ * Copyright (c) 2017, 2021 ADLINK Technology Inc.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License 2.0 which is available at
+ * http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+ * which is available at https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+ *
+ * Contributors:
+ *   ADLINK zenoh team, <zenoh@adlink-labs.tech>
+ */
+
+#include "zenoh-pico/protocol/private/iobuf.h"
+#include "zenoh-pico/protocol/private/utils.h"
+#include "zenoh-pico/session/private/utils.h"
+#include "zenoh-pico/system/common.h"
+#include "zenoh-pico/transport/private/utils.h"
+#include "zenoh-pico/utils/private/logging.h"
+
+// NOTE: the reliable channel on datagram links works as follows:
+//       - every reliable frame is kept by the sender until acknowledged, at most
+//         ZN_RELIABILITY_WINDOW of them, the oldest being given up when the window is full;
+//       - the sender periodically sends a SYNC with the SN of its next frame while
+//         frames are waiting for an acknowledgement;
+//       - the receiver answers a SYNC with an ACK_NACK carrying the next SN it expects,
+//         acknowledging all the previous ones, and a mask where the bit i is set if the
+//         frame with SN sn + i is missing. The ACK_NACK is also sent right away when a
+//         frame is received out of order;
+//       - the sender retransmits the frames whose bit is set in the mask.
+
+/*------------------ Reliable channel ------------------*/
+_zn_reliable_channel_t *_zn_reliable_channel_make(void)
+{
+    _zn_reliable_channel_t *rc = (_zn_reliable_channel_t *)malloc(sizeof(_zn_reliable_channel_t));
+
+    rc->tx_frames = (z_bytes_t *)malloc(ZN_RELIABILITY_WINDOW * sizeof(z_bytes_t));
+    for (size_t i = 0; i < ZN_RELIABILITY_WINDOW; i++)
+        _z_bytes_reset(&rc->tx_frames[i]);
+    rc->tx_head = 0;
+    rc->tx_len = 0;
+    rc->tx_sn = 0;
+    rc->sync_start = z_clock_now();
+
+    rc->rx_frames = (_z_zbuf_t **)malloc(ZN_RELIABILITY_WINDOW * sizeof(_z_zbuf_t *));
+    for (size_t i = 0; i < ZN_RELIABILITY_WINDOW; i++)
+        rc->rx_frames[i] = NULL;
+    rc->rx_head = 0;
+
+    return rc;
+}
+
+void __zn_rx_frame_free(_z_zbuf_t **zbf)
+{
+    _z_zbuf_t *ptr = *zbf;
+    _z_zbuf_free(ptr);
+    free(ptr);
+    *zbf = NULL;
+}
+
+void _zn_reliable_channel_free(_zn_reliable_channel_t **rc)
+{
+    _zn_reliable_channel_t *ptr = *rc;
+
+    for (size_t i = 0; i < ZN_RELIABILITY_WINDOW; i++)
+    {
+        _z_bytes_free(&ptr->tx_frames[i]);
+        if (ptr->rx_frames[i])
+            __zn_rx_frame_free(&ptr->rx_frames[i]);
+    }
+    free(ptr->tx_frames);
+    free(ptr->rx_frames);
+
+    free(ptr);
+    *rc = NULL;
+}
+
+/*------------------ Transmission side ------------------*/
+size_t __zn_wbuf_copy_readable(const _z_wbuf_t *wbf, uint8_t *dst, size_t len)
+{
+    // Copy up to len bytes from the read position, without consuming them
+    size_t copied = 0;
+    for (size_t i = wbf->r_idx; i < _z_wbuf_len_iosli(wbf) && copied < len; i++)
+    {
+        z_bytes_t bs = _z_iosli_to_bytes(_z_wbuf_get_iosli(wbf, i));
+        size_t n = bs.len <= len - copied ? bs.len : len - copied;
+        memcpy(dst + copied, bs.val, n);
+        copied += n;
+    }
+    return copied;
+}
+
+void __unsafe_zn_retx_release_oldest(zn_session_t *zn)
+{
+    _zn_reliable_channel_t *rc = zn->reliable_channel;
+    _z_bytes_free(&rc->tx_frames[rc->tx_head]);
+    _z_bytes_reset(&rc->tx_frames[rc->tx_head]);
+    rc->tx_head = (rc->tx_head + 1) % ZN_RELIABILITY_WINDOW;
+    rc->tx_sn = (rc->tx_sn + 1) % zn->sn_resolution;
+    rc->tx_len--;
+}
+
+/**
+ * Keep a copy of a reliable frame, made of the readable bytes of hdr followed by
+ * len bytes of wbf, until it is acknowledged. Must be called before sending the frame.
+ *
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->mutex_tx
+ */
+void __unsafe_zn_retx_store(zn_session_t *zn, zn_reliability_t reliability, z_zint_t sn, const _z_wbuf_t *hdr, const _z_wbuf_t *wbf, size_t len)
+{
+    _zn_reliable_channel_t *rc = zn->reliable_channel;
+    if (rc == NULL || reliability != zn_reliability_t_RELIABLE)
+        return;
+
+    if (rc->tx_len == ZN_RELIABILITY_WINDOW)
+    {
+        _Z_DEBUG_VA("Giving up the retransmission of frame %zu because the window is full\n", rc->tx_sn);
+        __unsafe_zn_retx_release_oldest(zn);
+    }
+    if (rc->tx_len == 0)
+        rc->tx_sn = sn;
+
+    size_t hdr_len = _z_wbuf_len(hdr);
+    z_bytes_t *frame = &rc->tx_frames[(rc->tx_head + rc->tx_len) % ZN_RELIABILITY_WINDOW];
+    *frame = _z_bytes_make(hdr_len + len);
+    __zn_wbuf_copy_readable(hdr, (uint8_t *)frame->val, hdr_len);
+    if (wbf)
+        __zn_wbuf_copy_readable(wbf, (uint8_t *)frame->val + hdr_len, len);
+    rc->tx_len++;
+}
+
+/**
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->mutex_tx
+ */
+int __unsafe_zn_send_sync(zn_session_t *zn)
+{
+    _zn_reliable_channel_t *rc = zn->reliable_channel;
+
+    // Solicit an acknowledgement only if some frames are waiting for it
+    size_t count = rc->tx_len;
+    if (count == 0 || z_clock_elapsed_ms(&rc->sync_start) < ZN_RELIABILITY_SYNC_INTERVAL)
+        return 0;
+    rc->sync_start = z_clock_now();
+
+    _zn_transport_message_t t_msg = _zn_transport_message_init(_ZN_MID_SYNC);
+    _ZN_SET_FLAG(t_msg.header, _ZN_FLAG_T_R);
+    _ZN_SET_FLAG(t_msg.header, _ZN_FLAG_T_C);
+    t_msg.body.sync.sn = zn->sn_tx_reliable;
+    t_msg.body.sync.count = count;
+
+    return __unsafe_zn_send_t_msg(zn, &t_msg);
+}
+
+int _zn_send_sync(zn_session_t *zn)
+{
+    if (zn->reliable_channel == NULL)
+        return 0;
+
+    z_mutex_lock(&zn->mutex_tx);
+    int res = __unsafe_zn_send_sync(zn);
+    z_mutex_unlock(&zn->mutex_tx);
+    return res;
+}
+
+int _zn_try_send_sync(zn_session_t *zn)
+{
+    if (zn->reliable_channel == NULL)
+        return 0;
+
+    // Do not wait for a writer stalled on the link, the caller tries again later
+    if (z_mutex_trylock(&zn->mutex_tx) != 0)
+        return _z_res_t_BUSY;
+    int res = __unsafe_zn_send_sync(zn);
+    z_mutex_unlock(&zn->mutex_tx);
+    return res;
+}
+
+int _zn_handle_ack_nack(zn_session_t *zn, uint8_t header, const _zn_ack_nack_t *msg)
+{
+    _zn_reliable_channel_t *rc = zn->reliable_channel;
+    if (rc == NULL)
+        return _z_res_t_OK;
+
+    int res = _z_res_t_OK;
+    z_mutex_lock(&zn->mutex_tx);
+
+    // All the frames preceding the SN have been received
+    while (rc->tx_len > 0 && _zn_sn_precedes(zn->sn_resolution_half, rc->tx_sn, msg->sn))
+        __unsafe_zn_retx_release_oldest(zn);
+
+    if (_ZN_HAS_FLAG(header, _ZN_FLAG_T_M) && rc->tx_len > 0 && rc->tx_sn == msg->sn)
+    {
+        // Retransmit the missing frames
+        for (size_t i = 0; i < rc->tx_len && i < sizeof(z_zint_t) * 8; i++)
+        {
+            if ((msg->mask & ((z_zint_t)1 << i)) == 0)
+                continue;
+
+            z_bytes_t *frame = &rc->tx_frames[(rc->tx_head + i) % ZN_RELIABILITY_WINDOW];
+            _Z_DEBUG_VA("Retransmitting frame %zu\n", (msg->sn + i) % zn->sn_resolution);
+            res = _zn_send_bytes(zn->link, frame->val, frame->len);
+            if (res != 0)
+                break;
+            _ZN_STATS_INC(zn, tx_retransmissions);
+            _ZN_STATS_ADD(zn, tx_bytes, frame->len);
+        }
+        zn->last_tx = z_clock_now();
+    }
+
+    z_mutex_unlock(&zn->mutex_tx);
+
+    return res;
+}
+
+/*------------------ Reception side ------------------*/
+int __zn_send_ack_nack(zn_session_t *zn, size_t missing)
+{
+    // Mark the missing frames among the first ones after the next expected SN
+    _zn_reliable_channel_t *rc = zn->reliable_channel;
+    z_zint_t mask = 0;
+    for (size_t i = 0; i < missing && i < sizeof(z_zint_t) * 8; i++)
+    {
+        if (i >= ZN_RELIABILITY_WINDOW || rc->rx_frames[(rc->rx_head + i) % ZN_RELIABILITY_WINDOW] == NULL)
+            mask |= (z_zint_t)1 << i;
+    }
+
+    _zn_transport_message_t t_msg = _zn_transport_message_init(_ZN_MID_ACK_NACK);
+    t_msg.body.ack_nack.sn = (zn->sn_rx_reliable + 1) % zn->sn_resolution;
+    if (mask != 0)
+    {
+        _ZN_SET_FLAG(t_msg.header, _ZN_FLAG_T_M);
+        t_msg.body.ack_nack.mask = mask;
+    }
+
+    return _zn_send_t_msg(zn, &t_msg);
+}
+
+size_t __zn_rx_highest_buffered(_zn_reliable_channel_t *rc)
+{
+    // The distance after the farthest frame received ahead
+    for (size_t i = ZN_RELIABILITY_WINDOW; i > 0; i--)
+    {
+        if (rc->rx_frames[(rc->rx_head + i - 1) % ZN_RELIABILITY_WINDOW] != NULL)
+            return i;
+    }
+    return 0;
+}
+
+int __zn_rx_deliver(zn_session_t *zn, _z_zbuf_t *zbf)
+{
+    _zn_transport_message_p_result_t r;
+    _zn_transport_message_p_result_init(&r);
+
+    int res = _z_res_t_ERR;
+    _zn_transport_message_decode_na(zbf, &r);
+    if (r.tag == _z_res_t_OK)
+    {
+        res = _zn_handle_frame(zn, r.value.transport_message);
+        _zn_transport_message_free(r.value.transport_message);
+    }
+
+    _zn_transport_message_p_result_free(&r);
+
+    return res;
+}
+
+int __zn_rx_advance(zn_session_t *zn)
+{
+    // Move to the next expected SN, delivering the frame buffered for it if any
+    _zn_reliable_channel_t *rc = zn->reliable_channel;
+    _z_zbuf_t **slot = &rc->rx_frames[rc->rx_head];
+    rc->rx_head = (rc->rx_head + 1) % ZN_RELIABILITY_WINDOW;
+    zn->sn_rx_reliable = (zn->sn_rx_reliable + 1) % zn->sn_resolution;
+
+    if (*slot == NULL)
+    {
+        // The frame has been given up, a fragmented message can not be completed
+        _zn_dbuf_reset(&zn->dbuf_reliable);
+        return _z_res_t_OK;
+    }
+
+    int res = __zn_rx_deliver(zn, *slot);
+    __zn_rx_frame_free(slot);
+
+    return res;
+}
+
+int __zn_rx_give_up(zn_session_t *zn, z_zint_t oldest, z_zint_t given_up)
+{
+    // Deliver what has been buffered in the window, then jump straight to the oldest frame
+    // still expected
+    _Z_DEBUG_VA("Giving up reliable frames up to %zu\n", oldest);
+    for (z_zint_t i = 0; i < given_up && i < ZN_RELIABILITY_WINDOW; i++)
+    {
+        int res = __zn_rx_advance(zn);
+        if (res != _z_res_t_OK)
+            return res;
+    }
+    // The frames past the window were never buffered, a fragmented message can not be completed
+    if (given_up > ZN_RELIABILITY_WINDOW)
+        _zn_dbuf_reset(&zn->dbuf_reliable);
+    zn->sn_rx_reliable = (oldest + zn->sn_resolution - 1) % zn->sn_resolution;
+
+    return _z_res_t_OK;
+}
+
+int _zn_handle_reliable_frame(zn_session_t *zn, _zn_transport_message_t *msg)
+{
+    _zn_reliable_channel_t *rc = zn->reliable_channel;
+    z_zint_t expected = (zn->sn_rx_reliable + 1) % zn->sn_resolution;
+    z_zint_t distance = (msg->body.frame.sn + zn->sn_resolution - expected) % zn->sn_resolution;
+
+    if (distance >= zn->sn_resolution_half)
+    {
+        _Z_DEBUG("Reliable message dropped because it has already been received");
+        _ZN_STATS_INC(zn, rx_dropped_out_of_order);
+        return _z_res_t_OK;
+    }
+
+    if (distance >= ZN_RELIABILITY_WINDOW)
+    {
+        // Too far ahead: give up the missing frames to catch up with the sender
+        int res = __zn_rx_give_up(zn, msg->body.frame.sn, distance);
+        if (res != _z_res_t_OK)
+            return res;
+        distance = 0;
+    }
+
+    if (distance > 0)
+    {
+        // Keep the frame until the missing ones have been received
+        _z_zbuf_t **slot = &rc->rx_frames[(rc->rx_head + distance) % ZN_RELIABILITY_WINDOW];
+        if (*slot != NULL)
+            return _z_res_t_OK;
+
+        _z_wbuf_t wbf = _z_wbuf_make(ZN_FRAG_BUF_TX_CHUNK, 1);
+        if (_zn_transport_message_encode(&wbf, msg) == 0)
+        {
+            *slot = (_z_zbuf_t *)malloc(sizeof(_z_zbuf_t));
+            **slot = _z_wbuf_to_zbuf(&wbf);
+        }
+        _z_wbuf_free(&wbf);
+
+        // Ask for the missing frames as soon as a new gap is detected
+        if (rc->rx_frames[(rc->rx_head + distance - 1) % ZN_RELIABILITY_WINDOW] == NULL)
+            return __zn_send_ack_nack(zn, distance);
+        return _z_res_t_OK;
+    }
+
+    // This is the next expected frame
+    if (!_zn_reliable_frame_accept(zn, msg->body.frame.sn))
+        return _z_res_t_ERR;
+    int res = _zn_handle_frame(zn, msg);
+    if (res == _z_res_t_OK)
+        res = _zn_reliable_channel_deliver(zn);
+
+    return res;
+}
+
+int _zn_reliable_frame_accept(zn_session_t *zn, z_zint_t sn)
+{
+    if (sn != (zn->sn_rx_reliable + 1) % zn->sn_resolution)
+        return 0;
+
+    // Move the reception window past the frame
+    _zn_reliable_channel_t *rc = zn->reliable_channel;
+    rc->rx_head = (rc->rx_head + 1) % ZN_RELIABILITY_WINDOW;
+    zn->sn_rx_reliable = sn;
+
+    return 1;
+}
+
+int _zn_reliable_channel_deliver(zn_session_t *zn)
+{
+    // Deliver the frames that are now in order
+    _zn_reliable_channel_t *rc = zn->reliable_channel;
+    int res = _z_res_t_OK;
+    while (res == _z_res_t_OK && rc->rx_frames[rc->rx_head] != NULL)
+        res = __zn_rx_advance(zn);
+
+    return res;
+}
+
+int _zn_handle_sync(zn_session_t *zn, uint8_t header, const _zn_sync_t *msg)
+{
+    _zn_reliable_channel_t *rc = zn->reliable_channel;
+    if (rc == NULL || !_ZN_HAS_FLAG(header, _ZN_FLAG_T_R))
+        return _z_res_t_OK;
+
+    z_zint_t expected = (zn->sn_rx_reliable + 1) % zn->sn_resolution;
+
+    if (_ZN_HAS_FLAG(header, _ZN_FLAG_T_C))
+    {
+        // The sender only keeps the last count frames, the ones preceding them
+        // have been given up and will never be retransmitted
+        z_zint_t oldest = (msg->sn + zn->sn_resolution - msg->count % zn->sn_resolution) % zn->sn_resolution;
+        z_zint_t given_up = (oldest + zn->sn_resolution - expected) % zn->sn_resolution;
+        if (given_up > 0 && given_up < zn->sn_resolution_half)
+        {
+            int res = __zn_rx_give_up(zn, oldest, given_up);
+            if (res == _z_res_t_OK)
+                res = _zn_reliable_channel_deliver(zn);
+            if (res != _z_res_t_OK)
+                return res;
+            expected = (zn->sn_rx_reliable + 1) % zn->sn_resolution;
+        }
+    }
+
+    // The frames up to the SN announced by the sender may be missing
+    z_zint_t announced = (msg->sn + zn->sn_resolution - expected) % zn->sn_resolution;
+    if (announced >= zn->sn_resolution_half)
+        announced = 0;
+
+    size_t missing = __zn_rx_highest_buffered(rc);
+    if (announced > missing)
+        missing = announced;
+
+    return __zn_send_ack_nack(zn, missing);
+}
@@ -13,9 +13,83 @@
  */
 
 #include "zenoh-pico/utils/private/logging.h"
+#include "zenoh-pico/protocol/private/codec.h"
 #include "zenoh-pico/transport/private/utils.h"
 #include "zenoh-pico/session/private/utils.h"
 
+int __zn_handle_visited_z_msg(_zn_zenoh_message_t *z_msg, void *arg)
+{
+    zn_session_t *zn = (zn_session_t *)arg;
+    _ZN_STATS_INC(zn, rx_msgs);
+    return _zn_handle_zenoh_message(zn, z_msg);
+}
+
+int __zn_accept_frame(zn_session_t *zn, uint8_t header, z_zint_t sn)
+{
+    if (_ZN_HAS_FLAG(header, _ZN_FLAG_T_R))
+    {
+        // Only the next expected frame can be handled right away on a reliable channel
+        if (zn->reliable_channel != NULL)
+            return _zn_reliable_frame_accept(zn, sn);
+
+        if (_zn_sn_precedes(zn->sn_resolution_half, zn->sn_rx_reliable, sn))
+        {
+            zn->sn_rx_reliable = sn;
+            return 1;
+        }
+    }
+    else if (_zn_sn_precedes(zn->sn_resolution_half, zn->sn_rx_best_effort, sn))
+    {
+        zn->sn_rx_best_effort = sn;
+        return 1;
+    }
+
+    return 0;
+}
+
+int _zn_handle_transport_zbuf(zn_session_t *zn, _z_zbuf_t *zbf)
+{
+    size_t r_pos = _z_zbuf_get_rpos(zbf);
+
+    // The zenoh messages of the frames received in order are handled as soon as they are
+    // decoded, without allocating the frame or the messages
+    _z_uint8_result_t r_hdr = _z_uint8_decode(zbf);
+    if (r_hdr.tag == _z_res_t_OK && _ZN_MID(r_hdr.value.uint8) == _ZN_MID_FRAME && !_ZN_HAS_FLAG(r_hdr.value.uint8, _ZN_FLAG_T_F))
+    {
+        uint8_t header = r_hdr.value.uint8;
+        _z_zint_result_t r_sn = _z_zint_decode(zbf);
+        if (r_sn.tag == _z_res_t_OK && __zn_accept_frame(zn, header, r_sn.value.zint))
+        {
+            int res = _zn_frame_messages_visit(zbf, __zn_handle_visited_z_msg, zn);
+            // Deliver the frames buffered while waiting for this one
+            if (res == _z_res_t_OK && _ZN_HAS_FLAG(header, _ZN_FLAG_T_R) && zn->reliable_channel != NULL)
+                res = _zn_reliable_channel_deliver(zn);
+            return res;
+        }
+    }
+
+    // Decode the whole transport message otherwise, out of order frames included
+    _z_zbuf_set_rpos(zbf, r_pos);
+
+    _zn_transport_message_t t_msg;
+    _zn_transport_message_p_result_t r;
+    r.value.transport_message = &t_msg;
+    _zn_transport_message_decode_na(zbf, &r);
+    if (r.tag != _z_res_t_OK)
+    {
+        _Z_DEBUG("Dropping malformed transport message");
+        _ZN_STATS_INC(zn, rx_decode_errors);
+        return _z_res_t_ERR;
+    }
+
+    int res = _zn_handle_transport_message(zn, &t_msg);
+    // The arena releases the message when it is reset
+    if (zbf->arena == NULL)
+        _zn_transport_message_free(&t_msg);
+
+    return res;
+}
+
 int _zn_handle_transport_message(zn_session_t *zn, _zn_transport_message_t *msg)
 {
     switch (_ZN_MID(msg->header))
@@ -65,20 +139,18 @@ int _zn_handle_transport_message(zn_session_t *zn, _zn_transport_message_t *msg)
     case _ZN_MID_CLOSE:
     {
         _Z_DEBUG("Closing session as requested by the remote peer");
-        _zn_session_free(zn);
-        return _z_res_t_ERR;
+        // The reader frees the session once it no longer uses it
+        return _z_res_t_CLOSED;
     }
 
     case _ZN_MID_SYNC:
     {
-        _Z_DEBUG("Handling of Sync messages not implemented");
-        return _z_res_t_OK;
+        return _zn_handle_sync(zn, msg->header, &msg->body.sync);
     }
 
     case _ZN_MID_ACK_NACK:
     {
-        _Z_DEBUG("Handling of AckNack messages not implemented");
-        return _z_res_t_OK;
+        return _zn_handle_ack_nack(zn, msg->header, &msg->body.ack_nack);
     }
 
     case _ZN_MID_KEEP_ALIVE:
@@ -88,8 +160,7 @@ int _zn_handle_transport_message(zn_session_t *zn, _zn_transport_message_t *msg)
 
     case _ZN_MID_PING_PONG:
     {
-        _Z_DEBUG("Handling of PingPong messages not implemented");
-        return _z_res_t_OK;
+        return _zn_handle_ping_pong(zn, msg->header, &msg->body.ping_pong);
     }
 
     case _ZN_MID_FRAME:
@@ -97,16 +168,20 @@ int _zn_handle_transport_message(zn_session_t *zn, _zn_transport_message_t *msg)
         // Check if the SN is correct
         if (_ZN_HAS_FLAG(msg->header, _ZN_FLAG_T_R))
         {
-            // @TODO: amend once reliability is in place. For the time being only
-            //        monothonic SNs are ensured
+            // Reliable frames are delivered in order when the datagram reliability is active
+            if (zn->reliable_channel != NULL)
+                return _zn_handle_reliable_frame(zn, msg);
+
+            // Only monothonic SNs are ensured otherwise
             if (_zn_sn_precedes(zn->sn_resolution_half, zn->sn_rx_reliable, msg->body.frame.sn))
             {
                 zn->sn_rx_reliable = msg->body.frame.sn;
             }
             else
             {
-                _z_wbuf_reset(&zn->dbuf_reliable);
+                _zn_dbuf_reset(&zn->dbuf_reliable);
                 _Z_DEBUG("Reliable message dropped because it is out of order");
+                _ZN_STATS_INC(zn, rx_dropped_out_of_order);
                 return _z_res_t_OK;
             }
         }
@@ -118,69 +193,89 @@ int _zn_handle_transport_message(zn_session_t *zn, _zn_transport_message_t *msg)
             }
             else
             {
-                _z_wbuf_reset(&zn->dbuf_best_effort);
+                _zn_dbuf_reset(&zn->dbuf_best_effort);
                 _Z_DEBUG("Best effort message dropped because it is out of order");
+                _ZN_STATS_INC(zn, rx_dropped_out_of_order);
                 return _z_res_t_OK;
             }
         }
 
-        if (_ZN_HAS_FLAG(msg->header, _ZN_FLAG_T_F))
-        {
-            int res = _z_res_t_OK;
+        return _zn_handle_frame(zn, msg);
+    }
 
-            // Select the right defragmentation buffer
-            _z_wbuf_t *dbuf = _ZN_HAS_FLAG(msg->header, _ZN_FLAG_T_R) ? &zn->dbuf_reliable : &zn->dbuf_best_effort;
-            // Add the fragment to the defragmentation buffer
-            _z_wbuf_add_iosli_from(dbuf, msg->body.frame.payload.fragment.val, msg->body.frame.payload.fragment.len);
+    default:
+    {
+        _Z_DEBUG("Unknown session message ID");
+        return _z_res_t_ERR;
+    }
+    }
+}
 
-            // Check if this is the last fragment
-            if (_ZN_HAS_FLAG(msg->header, _ZN_FLAG_T_E))
-            {
-                // Convert the defragmentation buffer into a decoding buffer
-                _z_zbuf_t zbf = _z_wbuf_to_zbuf(dbuf);
+void _zn_dbuf_reset(_zn_dbuf_t *dbuf)
+{
+    // The buffer keeps its capacity for the next fragmented messages
+    _z_zbuf_clear(&dbuf->buf);
+    dbuf->is_discarding = 0;
+}
+
+int _zn_handle_frame(zn_session_t *zn, _zn_transport_message_t *msg)
+{
+    if (_ZN_HAS_FLAG(msg->header, _ZN_FLAG_T_F))
+    {
+        int res = _z_res_t_OK;
+        _ZN_STATS_INC(zn, rx_fragments);
 
-                // Decode the zenoh message
-                _zn_zenoh_message_p_result_t r_zm = _zn_zenoh_message_decode(&zbf);
-                if (r_zm.tag == _z_res_t_OK)
+        // Select the right defragmentation buffer
+        _zn_dbuf_t *dbuf = _ZN_HAS_FLAG(msg->header, _ZN_FLAG_T_R) ? &zn->dbuf_reliable : &zn->dbuf_best_effort;
+        // Append the fragment to the defragmentation buffer, unless the message is too large
+        if (!dbuf->is_discarding &&
+            _z_zbuf_append_bytes(&dbuf->buf, msg->body.frame.payload.fragment.val, msg->body.frame.payload.fragment.len, ZN_FRAG_BUF_RX_LIMIT) != 0)
+        {
+            _Z_DEBUG("Dropping fragmented message because it exceeds ZN_FRAG_BUF_RX_LIMIT");
+            _ZN_STATS_INC(zn, rx_dropped_oversize);
+            _z_zbuf_clear(&dbuf->buf);
+            dbuf->is_discarding = 1;
+        }
+
+        // Check if this is the last fragment
+        if (_ZN_HAS_FLAG(msg->header, _ZN_FLAG_T_E))
+        {
+            if (!dbuf->is_discarding)
+            {
+                // Decode the zenoh message in place, straight from the defragmentation buffer
+                _zn_zenoh_message_t d_zm;
+                _zn_reply_context_t reply_context;
+                _zn_attachment_t attachment;
+                if (_zn_zenoh_message_decode_in_place(&dbuf->buf, &d_zm, &reply_context, &attachment) == 0)
                 {
-                    _zn_zenoh_message_t *d_zm = r_zm.value.zenoh_message;
-                    res = _zn_handle_zenoh_message(zn, d_zm);
+                    _ZN_STATS_INC(zn, rx_msgs);
+                    res = _zn_handle_zenoh_message(zn, &d_zm);
                     // Free the decoded message
-                    _zn_zenoh_message_free(d_zm);
+                    _zn_zenoh_message_clear(&d_zm);
                 }
                 else
                 {
+                    _ZN_STATS_INC(zn, rx_decode_errors);
                     res = _z_res_t_ERR;
                 }
-
-                // Free the result
-                _zn_zenoh_message_p_result_free(&r_zm);
-                // Free the decoding buffer
-                _z_zbuf_free(&zbf);
-                // Reset the defragmentation buffer
-                _z_wbuf_reset(dbuf);
-            }
-
-            return res;
-        }
-        else
-        {
-            // Handle all the zenoh message, one by one
-            unsigned int len = z_vec_len(&msg->body.frame.payload.messages);
-            for (unsigned int i = 0; i < len; ++i)
-            {
-                int res = _zn_handle_zenoh_message(zn, (_zn_zenoh_message_t *)z_vec_get(&msg->body.frame.payload.messages, i));
-                if (res != _z_res_t_OK)
-                    return res;
             }
-            return _z_res_t_OK;
+            // Reset the defragmentation buffer
+            _zn_dbuf_reset(dbuf);
         }
-    }
 
-    default:
-    {
-        _Z_DEBUG("Unknown session message ID");
-        return _z_res_t_ERR;
+        return res;
     }
+    else
+    {
+        // Handle all the zenoh message, one by one
+        unsigned int len = z_vec_len(&msg->body.frame.payload.messages);
+        _ZN_STATS_ADD(zn, rx_msgs, len);
+        for (unsigned int i = 0; i < len; ++i)
+        {
+            int res = _zn_handle_zenoh_message(zn, (_zn_zenoh_message_t *)z_vec_get(&msg->body.frame.payload.messages, i));
+            if (res != _z_res_t_OK)
+                return res;
+        }
+        return _z_res_t_OK;
     }
 }
@@ -14,6 +14,7 @@
 
 #include <assert.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include "zenoh-pico/utils/collections.h"
 #include "zenoh-pico/utils/types.h"
 
@@ -59,5 +60,61 @@ int main(void)
     z_i_map_remove(map, 0);
     assert(0 == z_i_map_get(map, 0));
     printf("get(5) = %s\n", (char *)z_i_map_get(map, 5));
+
+    z_id_map_t ids;
+    z_id_map_init(&ids);
+    assert(z_id_map_get(&ids, 0) == NULL);
+    assert(z_id_map_remove(&ids, 0) == NULL);
+    // Mirror the map in an array, with sequential and scattered keys
+    static char present[4096];
+    for (size_t i = 0; i < 20000; i++)
+    {
+        size_t k = i % 2 ? (size_t)rand() % 4096 : (i / 2) % 4096;
+        if (present[k])
+        {
+            assert(z_id_map_insert(&ids, k, &present[k]) == -1);
+            assert(z_id_map_remove(&ids, k) == &present[k]);
+            present[k] = 0;
+        }
+        else
+        {
+            assert(z_id_map_insert(&ids, k, &present[k]) == 0);
+            present[k] = 1;
+        }
+    }
+    size_t ids_len = 0;
+    for (size_t k = 0; k < 4096; k++)
+    {
+        assert(z_id_map_get(&ids, k) == (present[k] ? &present[k] : NULL));
+        ids_len += present[k];
+    }
+    assert(z_id_map_len(&ids) == ids_len);
+    size_t pos = 0;
+    char *v;
+    while ((v = (char *)z_id_map_next(&ids, &pos)) != NULL)
+        ids_len--;
+    assert(ids_len == 0);
+    printf("id map len = %zu\n", z_id_map_len(&ids));
+    z_id_map_clear(&ids);
+    assert(z_id_map_len(&ids) == 0);
+
+    z_arena_t arena = z_arena_make(64);
+    uint8_t *a = (uint8_t *)z_arena_alloc(&arena, 3);
+    uint8_t *b = (uint8_t *)z_arena_alloc(&arena, 8);
+    // Allocations are served in order and aligned
+    assert(a == arena.buf);
+    assert((size_t)(b - a) == 8);
+    assert(arena.overflow == NULL);
+    // Allocations not fitting in the arena are served by the heap
+    uint8_t *c = (uint8_t *)z_arena_alloc(&arena, 128);
+    assert(c != NULL && (c < arena.buf || c >= arena.buf + arena.capacity));
+    assert(z_list_len(arena.overflow) == 1);
+    printf("arena len = %zu\n", arena.len);
+    z_arena_reset(&arena);
+    assert(arena.len == 0);
+    assert(arena.overflow == NULL);
+    assert(z_arena_alloc(&arena, 64) == arena.buf);
+    z_arena_free(&arena);
+
     return 0;
 }
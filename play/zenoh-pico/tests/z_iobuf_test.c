@@ -435,6 +435,131 @@ void wbuf_add_iosli(void)
     _z_wbuf_free(&wbf);
 }
 
+void wbuf_add_iosli_wrap(void)
+{
+    uint8_t len = 16;
+    _z_wbuf_t wbf = _z_wbuf_make(len, 1);
+    printf("\n>>> WBuf => Add IOSli wrap\n");
+
+    uint8_t payload[255];
+    for (size_t i = 0; i < sizeof(payload); i++)
+        payload[i] = (uint8_t)i;
+
+    _z_wbuf_write(&wbf, 0xAA);
+    _z_wbuf_add_iosli_wrap(&wbf, payload, sizeof(payload));
+    _z_wbuf_write(&wbf, 0xBB);
+    assert(_z_wbuf_len(&wbf) == sizeof(payload) + 2);
+
+    // The slice references the payload memory without copying it
+    _z_iosli_t *ios = _z_wbuf_get_iosli(&wbf, 1);
+    assert(ios->buf == payload);
+    assert(ios->is_alloc == 0);
+
+    _z_zbuf_t zbf = _z_wbuf_to_zbuf(&wbf);
+    assert(_z_zbuf_read(&zbf) == 0xAA);
+    for (size_t i = 0; i < sizeof(payload); i++)
+        assert(_z_zbuf_read(&zbf) == payload[i]);
+    assert(_z_zbuf_read(&zbf) == 0xBB);
+
+    _z_zbuf_free(&zbf);
+    _z_wbuf_free(&wbf);
+}
+
+void zbuf_append_bytes(void)
+{
+    size_t limit = 1024;
+    _z_zbuf_t zbf = _z_zbuf_make(0);
+    printf("\n>>> ZBuf => Append bytes\n");
+
+    uint8_t bs[64];
+    uint8_t counter = 0;
+    size_t len = 0;
+    while (1)
+    {
+        size_t n = 1 + gen_size_t() % sizeof(bs);
+        for (size_t i = 0; i < n; i++)
+            bs[i] = (uint8_t)(counter + i);
+
+        int res = _z_zbuf_append_bytes(&zbf, bs, n, limit);
+        if (len + n > limit)
+        {
+            // The buffer never grows beyond the limit
+            assert(res == -1);
+            assert(_z_zbuf_len(&zbf) == len);
+            break;
+        }
+        assert(res == 0);
+        counter = (uint8_t)(counter + n);
+        len += n;
+        assert(_z_zbuf_len(&zbf) == len);
+        assert(_z_zbuf_capacity(&zbf) <= limit);
+    }
+    printf("    Appended %zu bytes, Capacity: %zu\n", len, _z_zbuf_capacity(&zbf));
+
+    // The fragments are contiguous
+    for (size_t i = 0; i < len; i++)
+        assert(_z_zbuf_read(&zbf) == (uint8_t)i);
+
+    _z_zbuf_free(&zbf);
+}
+
+void rbuf_batches(_z_rbuf_t *rbf)
+{
+    size_t capacity = _z_rbuf_capacity(rbf);
+    uint8_t w_counter = 0;
+    uint8_t r_counter = 0;
+
+    // Go around the ring buffer a few times with batches of random lengths
+    for (size_t read = 0; read < 4 * capacity;)
+    {
+        size_t len = 1 + gen_size_t() % (capacity / 3);
+        int res = _z_rbuf_reserve(rbf, len);
+        assert(res == 0);
+
+        // Write the bytes of the batch, and some more ahead of it when there is space
+        while (_z_rbuf_len(rbf) < len)
+        {
+            size_t n = _z_rbuf_space_left(rbf);
+            n = n > len ? 1 + gen_size_t() % n : n;
+            uint8_t *ptr = _z_rbuf_get_wptr(rbf);
+            for (size_t i = 0; i < n; i++)
+                ptr[i] = w_counter++;
+            _z_rbuf_produce(rbf, n);
+        }
+
+        // The batch is contiguous even if it wraps around
+        _z_zbuf_t v = _z_rbuf_view(rbf, len);
+        assert(_z_zbuf_len(&v) == len);
+        for (size_t i = 0; i < len; i++)
+            assert(_z_zbuf_read(&v) == r_counter++);
+        _z_rbuf_consume(rbf, len);
+        read += len;
+    }
+    int res = _z_rbuf_reserve(rbf, capacity + 1);
+    assert(res == -1);
+}
+
+void rbuf_wrap_around(void)
+{
+    size_t capacity = 4096;
+    printf("\n>>> RBuf => Wrap around\n");
+
+    _z_rbuf_t rbf = _z_rbuf_make(capacity);
+    printf("    RBuf => Capacity: %zu, Mirrored: %d\n", _z_rbuf_capacity(&rbf), rbf.is_mirrored);
+    assert(_z_rbuf_capacity(&rbf) >= capacity);
+    rbuf_batches(&rbf);
+    _z_rbuf_free(&rbf);
+
+    // The readable bytes are moved when the memory is not mirrored
+    rbf.buf = (uint8_t *)malloc(capacity);
+    rbf.capacity = capacity;
+    rbf.r_pos = 0;
+    rbf.w_pos = 0;
+    rbf.is_mirrored = 0;
+    rbuf_batches(&rbf);
+    _z_rbuf_free(&rbf);
+}
+
 /*=============================*/
 /*            Main             */
 /*=============================*/
@@ -447,10 +572,14 @@ int main(void)
         zbuf_writable_readable();
         zbuf_comapct();
         zbuf_view();
+        zbuf_append_bytes();
+        // RBuf
+        rbuf_wrap_around();
         // WBuf
         wbuf_writable_readable();
         wbuf_set_pos_wbuf_get_pos();
         wbuf_add_iosli();
+        wbuf_add_iosli_wrap();
         // WBuf and ZBuf
         wbuf_write_zbuf_read();
         wbuf_write_zbuf_read_bytes();
@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2017, 2021 ADLINK Technology Inc.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License 2.0 which is available at
+ * http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+ * which is available at https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+ *
+ * Contributors:
+ *   ADLINK zenoh team, <zenoh@adlink-labs.tech>
+ */
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "zenoh-pico/system/collections.h"
+#include "zenoh-pico/system/common.h"
+#include "zenoh-pico/system/types.h"
+
+#define PRODUCERS 4
+#define RUN 100000
+#define CAPACITY 16
+
+typedef struct
+{
+    z_mpsc_t *q;
+    uintptr_t id;
+} producer_arg_t;
+
+void *produce(void *a)
+{
+    producer_arg_t *arg = (producer_arg_t *)a;
+    for (uintptr_t i = 1; i <= RUN; i++)
+    {
+        // Encode the producer id in the high bits, the counter in the low bits
+        uintptr_t e = (arg->id << 24) | i;
+        if (i % 2 == 0)
+            z_mpsc_push(arg->q, (void *)e);
+        else
+            while (z_mpsc_try_push(arg->q, (void *)e) != 0)
+                ;
+    }
+    return 0;
+}
+
+void test_single_thread(void)
+{
+    printf("\n>> Single thread\n");
+    z_mpsc_t *q = z_mpsc_make(5);
+    assert(z_mpsc_capacity(q) == 8);
+    assert(z_mpsc_len(q) == 0);
+    assert(z_mpsc_try_pop(q) == NULL);
+
+    for (uintptr_t i = 1; i <= 8; i++)
+        assert(z_mpsc_try_push(q, (void *)i) == 0);
+    assert(z_mpsc_len(q) == 8);
+    assert(z_mpsc_try_push(q, (void *)9) == -1);
+
+    for (uintptr_t i = 1; i <= 8; i++)
+        assert((uintptr_t)z_mpsc_try_pop(q) == i);
+    assert(z_mpsc_try_pop(q) == NULL);
+    assert(z_mpsc_len(q) == 0);
+
+    z_mpsc_free(&q);
+    assert(q == NULL);
+}
+
+void test_multi_producers(void)
+{
+    printf("\n>> Multiple producers\n");
+    z_mpsc_t *q = z_mpsc_make(CAPACITY);
+
+    z_task_t producers[PRODUCERS];
+    producer_arg_t args[PRODUCERS];
+    for (uintptr_t i = 0; i < PRODUCERS; i++)
+    {
+        args[i].q = q;
+        args[i].id = i;
+        z_task_init(&producers[i], NULL, produce, &args[i]);
+    }
+
+    // Every producer must be seen in order and without losses
+    uintptr_t last[PRODUCERS] = {0};
+    for (size_t n = 0; n < PRODUCERS * RUN; n++)
+    {
+        uintptr_t e = (uintptr_t)z_mpsc_try_pop(q);
+        if (e == 0)
+        {
+            // Let the producers run, the consumer does not park on the queue
+            z_sleep_us(1);
+            n--;
+            continue;
+        }
+        uintptr_t id = e >> 24;
+        uintptr_t cnt = e & 0xFFFFFF;
+        assert(id < PRODUCERS);
+        assert(cnt == last[id] + 1);
+        last[id] = cnt;
+    }
+
+    for (size_t i = 0; i < PRODUCERS; i++)
+    {
+        pthread_join(producers[i], NULL);
+        assert(last[i] == RUN);
+    }
+    assert(z_mpsc_len(q) == 0);
+
+    z_mpsc_free(&q);
+}
+
+int main(void)
+{
+    test_single_thread();
+    test_multi_producers();
+
+    return 0;
+}
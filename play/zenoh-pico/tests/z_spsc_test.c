@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2017, 2021 ADLINK Technology Inc.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License 2.0 which is available at
+ * http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+ * which is available at https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+ *
+ * Contributors:
+ *   ADLINK zenoh team, <zenoh@adlink-labs.tech>
+ */
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "zenoh-pico/system/collections.h"
+#include "zenoh-pico/system/common.h"
+#include "zenoh-pico/system/types.h"
+
+#define RUN 1000000
+#define CAPACITY 16
+
+void *produce(void *a)
+{
+    z_spsc_t *q = (z_spsc_t *)a;
+    for (uintptr_t i = 1; i <= RUN; i++)
+    {
+        // Park only when the queue is full
+        if (z_spsc_try_push(q, (void *)i) != 0)
+            z_spsc_push(q, (void *)i);
+    }
+    return 0;
+}
+
+void test_single_thread(void)
+{
+    printf("\n>> Single thread\n");
+    z_spsc_t *q = z_spsc_make(5);
+    assert(z_spsc_capacity(q) == 8);
+    assert(z_spsc_len(q) == 0);
+    assert(z_spsc_try_pop(q) == NULL);
+
+    // Go around the ring a few times
+    for (uintptr_t round = 0; round < 3; round++)
+    {
+        for (uintptr_t i = 1; i <= 8; i++)
+            assert(z_spsc_try_push(q, (void *)i) == 0);
+        assert(z_spsc_len(q) == 8);
+        assert(z_spsc_try_push(q, (void *)9) == -1);
+
+        for (uintptr_t i = 1; i <= 8; i++)
+            assert((uintptr_t)z_spsc_try_pop(q) == i);
+        assert(z_spsc_try_pop(q) == NULL);
+        assert(z_spsc_len(q) == 0);
+    }
+
+    // A wakeup makes a blocking pop return on an empty queue
+    z_spsc_wakeup(q);
+    assert(z_spsc_pop(q) == NULL);
+
+    // A wakeup is not lost when an element is popped meanwhile
+    assert(z_spsc_try_push(q, (void *)1) == 0);
+    z_spsc_wakeup(q);
+    assert((uintptr_t)z_spsc_pop(q) == 1);
+    assert(z_spsc_pop(q) == NULL);
+
+    z_spsc_free(&q);
+    assert(q == NULL);
+}
+
+void test_two_threads(void)
+{
+    printf("\n>> Producer and consumer threads\n");
+    z_spsc_t *q = z_spsc_make(CAPACITY);
+
+    z_task_t producer;
+    z_task_init(&producer, NULL, produce, q);
+
+    // The elements must be seen in order and without losses
+    uintptr_t last = 0;
+    while (last < RUN)
+    {
+        // Park only when the queue is empty
+        uintptr_t e = (uintptr_t)z_spsc_try_pop(q);
+        if (e == 0)
+            e = (uintptr_t)z_spsc_pop(q);
+        assert(e == last + 1);
+        last = e;
+    }
+
+    z_task_join(&producer);
+    assert(z_spsc_len(q) == 0);
+
+    z_spsc_free(&q);
+}
+
+int main(void)
+{
+    test_single_thread();
+    test_two_threads();
+
+    return 0;
+}
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2017, 2021 ADLINK Technology Inc.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License 2.0 which is available at
+ * http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+ * which is available at https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+ *
+ * Contributors:
+ *   ADLINK zenoh team, <zenoh@adlink-labs.tech>
+ */
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "zenoh-pico/utils/collections.h"
+
+#define TIMERS 1000
+#define STEPS 20000
+
+uint64_t rearm(void *arg)
+{
+    return (uint64_t)(uintptr_t)arg;
+}
+
+void test_single_timer(void)
+{
+    printf("\n>> Single timer\n");
+    z_timer_wheel_t tw;
+    z_timer_wheel_init(&tw, 100);
+    assert(z_timer_wheel_next(&tw) == UINT64_MAX);
+
+    z_timer_t t;
+    z_timer_init(&t, rearm, NULL);
+    assert(!z_timer_is_armed(&t));
+
+    // Expiries on each level of the wheel, and beyond its range
+    uint64_t delays[] = {1, 63, 64, 65, 4095, 4096, 300000, 16777216, 100000000};
+    for (size_t i = 0; i < sizeof(delays) / sizeof(delays[0]); i++)
+    {
+        uint64_t expiry = tw.now + delays[i];
+        z_timer_wheel_add(&tw, &t, expiry);
+        assert(z_timer_is_armed(&t));
+        assert(z_timer_wheel_len(&tw) == 1);
+
+        // Wake up when told to, never past the expiry
+        while (z_timer_wheel_pop_expired(&tw) == NULL)
+        {
+            uint64_t next = z_timer_wheel_next(&tw);
+            assert(next > tw.now && next <= expiry);
+            z_timer_wheel_advance(&tw, next);
+        }
+        assert(tw.now == expiry);
+        assert(!z_timer_is_armed(&t));
+        assert(z_timer_wheel_len(&tw) == 0);
+    }
+
+    // A timer already due expires at the next tick
+    z_timer_wheel_add(&tw, &t, 0);
+    z_timer_wheel_advance(&tw, tw.now + 1);
+    assert(z_timer_wheel_pop_expired(&tw) == &t);
+
+    // A removed timer never expires
+    z_timer_wheel_add(&tw, &t, tw.now + 10);
+    z_timer_wheel_remove(&tw, &t);
+    assert(!z_timer_is_armed(&t));
+    z_timer_wheel_advance(&tw, tw.now + 100);
+    assert(z_timer_wheel_pop_expired(&tw) == NULL);
+    assert(z_timer_wheel_next(&tw) == UINT64_MAX);
+}
+
+void test_many_timers(void)
+{
+    printf("\n>> Many timers\n");
+    z_timer_wheel_t tw;
+    z_timer_wheel_init(&tw, 12345);
+
+    z_timer_t *timers = (z_timer_t *)malloc(TIMERS * sizeof(z_timer_t));
+    for (size_t i = 0; i < TIMERS; i++)
+    {
+        // Periods from one tick up to the third level of the wheel
+        uint64_t period = 1 + (uint64_t)rand() % (i % 2 ? 100 : 300000);
+        z_timer_init(&timers[i], rearm, (void *)(uintptr_t)period);
+        z_timer_wheel_add(&tw, &timers[i], tw.now + period);
+    }
+
+    size_t expired = 0;
+    for (size_t s = 0; s < STEPS; s++)
+    {
+        uint64_t prev = tw.now;
+        z_timer_wheel_advance(&tw, tw.now + 1 + (uint64_t)rand() % 200);
+
+        z_timer_t *t;
+        while ((t = z_timer_wheel_pop_expired(&tw)) != NULL)
+        {
+            // Expired in the step covering the expiry
+            assert(t->expiry > prev && t->expiry <= tw.now);
+            expired++;
+
+            // Cancel some timers from time to time
+            if (rand() % 10 == 0)
+                continue;
+            z_timer_wheel_add(&tw, t, t->expiry + t->callback(t->arg));
+        }
+
+        // Remove a random timer from time to time
+        if (rand() % 100 == 0)
+            z_timer_wheel_remove(&tw, &timers[(size_t)rand() % TIMERS]);
+
+        // No timer expiry is missed by the next wake up
+        uint64_t next = z_timer_wheel_next(&tw);
+        for (size_t i = 0; i < TIMERS; i++)
+        {
+            if (z_timer_is_armed(&timers[i]))
+                assert(next <= timers[i].expiry);
+        }
+    }
+    printf("Expired %zu timers\n", expired);
+    assert(expired > 0);
+
+    free(timers);
+}
+
+int main(void)
+{
+    test_single_timer();
+    test_many_timers();
+
+    return 0;
+}
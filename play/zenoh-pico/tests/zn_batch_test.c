@@ -0,0 +1,279 @@
+/*
+ * Copyright (c) 2017, 2021 ADLINK Technology Inc.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License 2.0 which is available at
+ * http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+ * which is available at https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+ *
+ * Contributors:
+ *   ADLINK zenoh team, <zenoh@adlink-labs.tech>
+ */
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "zenoh-pico.h"
+#include "zenoh-pico/protocol/private/msgcodec.h"
+#include "zenoh-pico/protocol/private/utils.h"
+#include "zenoh-pico/session/private/utils.h"
+#include "zenoh-pico/system/common.h"
+#include "zenoh-pico/transport/private/utils.h"
+
+#define CAPTURE_SIZE 16
+#define PAYLOAD_LEN 1024
+#define LINGER_MS 50
+
+/*=============================*/
+/*    Capture in-memory link   */
+/*=============================*/
+typedef struct
+{
+    // Must be the first member, the session frees the link as a whole
+    _zn_link_t link;
+    z_bytes_t datagrams[CAPTURE_SIZE];
+    size_t len;
+} capture_link_t;
+
+size_t capture_write(void *arg, const uint8_t *ptr, size_t len)
+{
+    capture_link_t *l = (capture_link_t *)arg;
+
+    assert(l->len < CAPTURE_SIZE);
+    z_bytes_t *d = &l->datagrams[l->len];
+    *d = _z_bytes_make(len);
+    memcpy((uint8_t *)d->val, ptr, len);
+    l->len++;
+
+    return len;
+}
+
+size_t capture_read(void *arg, uint8_t *ptr, size_t len)
+{
+    (void)(arg);
+    (void)(ptr);
+    (void)(len);
+    return 0;
+}
+
+void capture_release(void *arg)
+{
+    (void)(arg);
+}
+
+_zn_link_t *capture_link_make(void)
+{
+    capture_link_t *l = (capture_link_t *)calloc(1, sizeof(capture_link_t));
+    // A reliable link, no copy of the frames is kept for retransmission
+    l->link.is_reliable = 1;
+    l->link.is_streamed = 0;
+    l->link.mtu = ZN_BATCH_SIZE;
+    l->link.write_f = capture_write;
+    l->link.read_f = capture_read;
+    l->link.release_f = capture_release;
+    return &l->link;
+}
+
+void capture_clear(capture_link_t *l)
+{
+    for (size_t i = 0; i < l->len; i++)
+        _z_bytes_free(&l->datagrams[i]);
+    l->len = 0;
+}
+
+/*=============================*/
+/*           Helpers           */
+/*=============================*/
+zn_session_t *session_make(unsigned int linger)
+{
+    zn_session_t *zn = _zn_session_init();
+    zn->link = capture_link_make();
+    zn->locator = NULL;
+    _z_bytes_reset(&zn->local_pid);
+    _z_bytes_reset(&zn->remote_pid);
+    zn->sn_resolution = ZN_SN_RESOLUTION;
+    zn->sn_resolution_half = zn->sn_resolution / 2;
+    zn->batching = 1;
+    zn->batch_linger = linger;
+    return zn;
+}
+
+// Decode a captured frame, check its reliability and return how many zenoh messages it carries
+size_t frame_len(const z_bytes_t *d, zn_reliability_t reliability)
+{
+    _z_zbuf_t zbf = _z_zbuf_make(d->len);
+    memcpy(_z_zbuf_get_wptr(&zbf), d->val, d->len);
+    _z_zbuf_set_wpos(&zbf, d->len);
+
+    _zn_transport_message_p_result_t r = _zn_transport_message_decode(&zbf);
+    assert(r.tag == _z_res_t_OK);
+    _zn_transport_message_t *t_msg = r.value.transport_message;
+    assert(_ZN_MID(t_msg->header) == _ZN_MID_FRAME);
+    assert(_ZN_HAS_FLAG(t_msg->header, _ZN_FLAG_T_R) == (reliability == zn_reliability_t_RELIABLE));
+    size_t len = z_vec_len(&t_msg->body.frame.payload.messages);
+
+    _zn_transport_message_free(t_msg);
+    _zn_transport_message_p_result_free(&r);
+    _z_zbuf_free(&zbf);
+
+    return len;
+}
+
+int write_data(zn_session_t *zn, zn_reskey_t reskey, const uint8_t *payload, zn_reliability_t reliability, int express)
+{
+    _zn_zenoh_message_t z_msg = _zn_zenoh_message_init(_ZN_MID_DATA);
+    z_msg.priority = ZN_PRIORITY_DEFAULT;
+    z_msg.body.data.key = reskey;
+    _ZN_SET_FLAG(z_msg.header, _ZN_FLAG_Z_K);
+    z_msg.body.data.payload.len = PAYLOAD_LEN;
+    z_msg.body.data.payload.val = (uint8_t *)payload;
+
+    return _zn_send_z_msg_ext(zn, &z_msg, reliability, zn_congestion_control_t_BLOCK, express);
+}
+
+int write_ext(zn_session_t *zn, zn_reskey_t reskey, const uint8_t *payload, int express)
+{
+    return zn_write_ext(zn, reskey, payload, PAYLOAD_LEN, 0, 0, zn_congestion_control_t_BLOCK, ZN_PRIORITY_DEFAULT, express);
+}
+
+/*=============================*/
+/*            Main             */
+/*=============================*/
+int main(void)
+{
+    setbuf(stdout, NULL);
+
+    zn_reskey_t reskey = zn_rname("/test");
+    uint8_t *payload = (uint8_t *)malloc(PAYLOAD_LEN);
+    memset(payload, 0xAB, PAYLOAD_LEN);
+
+    zn_session_t *zn = session_make(0);
+    capture_link_t *l = (capture_link_t *)zn->link;
+
+    printf(">>> Append the messages to the open batch\n");
+    for (unsigned int i = 0; i < 3; i++)
+    {
+        int res = write_ext(zn, reskey, payload, 0);
+        assert(res == 0);
+    }
+    assert(l->len == 0);
+    assert(zn->batch_open == 1);
+    assert(zn_session_stats(zn).tx_msgs == 3);
+
+    int res = zn_flush(zn);
+    assert(res == 0);
+    assert(zn->batch_open == 0);
+    assert(l->len == 1);
+    assert(frame_len(&l->datagrams[0], zn_reliability_t_RELIABLE) == 3);
+    assert(zn_session_stats(zn).tx_batches == 1);
+
+    // Nothing left to flush
+    res = zn_flush(zn);
+    assert(res == 0);
+    assert(l->len == 1);
+    capture_clear(l);
+
+    printf(">>> Send the batch when full\n");
+    unsigned int written = 0;
+    while (l->len == 0)
+    {
+        res = write_ext(zn, reskey, payload, 0);
+        assert(res == 0);
+        written++;
+    }
+    // The message not fitting in the full batch opens the next one
+    assert(written > 1);
+    assert(zn->batch_open == 1);
+    assert(l->datagrams[0].len <= ZN_BATCH_SIZE);
+    assert(l->datagrams[0].len + PAYLOAD_LEN > ZN_BATCH_SIZE);
+    assert(frame_len(&l->datagrams[0], zn_reliability_t_RELIABLE) == written - 1);
+
+    res = zn_flush(zn);
+    assert(res == 0);
+    assert(l->len == 2);
+    assert(frame_len(&l->datagrams[1], zn_reliability_t_RELIABLE) == 1);
+    capture_clear(l);
+
+    printf(">>> Send the batch when the reliability changes\n");
+    res = write_data(zn, reskey, payload, zn_reliability_t_RELIABLE, 0);
+    assert(res == 0);
+    res = write_data(zn, reskey, payload, zn_reliability_t_RELIABLE, 0);
+    assert(res == 0);
+    assert(l->len == 0);
+
+    // The reliable frame is sent before the best effort one is opened
+    res = write_data(zn, reskey, payload, zn_reliability_t_BEST_EFFORT, 0);
+    assert(res == 0);
+    assert(l->len == 1);
+    assert(frame_len(&l->datagrams[0], zn_reliability_t_RELIABLE) == 2);
+    assert(zn->batch_open == 1);
+    assert(zn->batch_reliability == zn_reliability_t_BEST_EFFORT);
+
+    res = zn_flush(zn);
+    assert(res == 0);
+    assert(l->len == 2);
+    assert(frame_len(&l->datagrams[1], zn_reliability_t_BEST_EFFORT) == 1);
+    capture_clear(l);
+
+    printf(">>> Express messages bypass the batching\n");
+    res = write_ext(zn, reskey, payload, 0);
+    assert(res == 0);
+    assert(l->len == 0);
+
+    // The open batch is sent first to preserve the ordering
+    res = write_ext(zn, reskey, payload, 1);
+    assert(res == 0);
+    assert(l->len == 2);
+    assert(zn->batch_open == 0);
+    assert(frame_len(&l->datagrams[0], zn_reliability_t_RELIABLE) == 1);
+    assert(frame_len(&l->datagrams[1], zn_reliability_t_RELIABLE) == 1);
+
+    // An express message is sent right away also without an open batch
+    res = write_ext(zn, reskey, payload, 1);
+    assert(res == 0);
+    assert(l->len == 3);
+    assert(zn->batch_open == 0);
+    capture_clear(l);
+
+    _zn_session_free(zn);
+
+    printf(">>> Send the batch when its linger time expires\n");
+    zn = session_make(LINGER_MS);
+    l = (capture_link_t *)zn->link;
+
+    res = write_ext(zn, reskey, payload, 0);
+    assert(res == 0);
+    res = _zn_flush_expired_batch(zn);
+    assert(res == 0);
+    assert(l->len == 0);
+    assert(zn->batch_open == 1);
+
+    z_sleep_ms(2 * LINGER_MS);
+    res = _zn_flush_expired_batch(zn);
+    assert(res == 0);
+    assert(l->len == 1);
+    assert(zn->batch_open == 0);
+    assert(frame_len(&l->datagrams[0], zn_reliability_t_RELIABLE) == 1);
+    capture_clear(l);
+
+    // A message appended after the linger time sends the batch on its own
+    res = write_ext(zn, reskey, payload, 0);
+    assert(res == 0);
+    z_sleep_ms(2 * LINGER_MS);
+    res = write_ext(zn, reskey, payload, 0);
+    assert(res == 0);
+    assert(l->len == 1);
+    assert(zn->batch_open == 0);
+    assert(frame_len(&l->datagrams[0], zn_reliability_t_RELIABLE) == 2);
+    capture_clear(l);
+
+    _zn_session_free(zn);
+    free(payload);
+    free(reskey.rname);
+
+    return 0;
+}
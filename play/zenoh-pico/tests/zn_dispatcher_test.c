@@ -0,0 +1,457 @@
+/*
+ * Copyright (c) 2017, 2021 ADLINK Technology Inc.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License 2.0 which is available at
+ * http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+ * which is available at https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+ *
+ * Contributors:
+ *   ADLINK zenoh team, <zenoh@adlink-labs.tech>
+ */
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "zenoh-pico.h"
+#include "zenoh-pico/session/private/subscription.h"
+#include "zenoh-pico/session/private/utils.h"
+#include "zenoh-pico/system/common.h"
+#include "zn_test_session.h"
+
+#define WORKERS 4
+#define KEYS 8
+#define SAMPLES 1000
+// The samples are not flushed on behalf of an undeclared subscription
+#define NO_SUBSCRIPTION ((z_zint_t)-1)
+
+/*=============================*/
+/*        Subscribers          */
+/*=============================*/
+typedef struct
+{
+    unsigned int next;
+    unsigned int received;
+    unsigned int out_of_order;
+    int is_blocked;
+} counter_t;
+
+void on_sample(const zn_sample_t *sample, const void *arg)
+{
+    counter_t *c = (counter_t *)arg;
+
+    unsigned int n;
+    assert(sample->value.len == sizeof(n));
+    memcpy(&n, sample->value.val, sizeof(n));
+
+    // Samples of a same key must be delivered in order
+    if (n != c->next)
+        c->out_of_order++;
+    c->next = n + 1;
+    c->received++;
+
+    while (__atomic_load_n(&c->is_blocked, __ATOMIC_ACQUIRE))
+        z_sleep_ms(1);
+}
+
+_zn_subscriber_t *subscriber_make_with(zn_session_t *zn, z_zint_t id, const char *rname, zn_queue_full_t on_full, zn_data_handler_t callback, void *arg)
+{
+    _zn_subscriber_t *sub = (_zn_subscriber_t *)malloc(sizeof(_zn_subscriber_t));
+    sub->id = id;
+    sub->key = zn_rname(rname);
+    sub->info = zn_subinfo_default();
+    sub->info.on_full = on_full;
+    sub->callback = callback;
+    sub->arg = arg;
+
+    int res = _zn_register_subscription(zn, _ZN_IS_LOCAL, sub);
+    assert(res == 0);
+    (void)(res);
+    return sub;
+}
+
+_zn_subscriber_t *subscriber_make(zn_session_t *zn, z_zint_t id, const char *rname, zn_queue_full_t on_full, counter_t *c)
+{
+    return subscriber_make_with(zn, id, rname, on_full, on_sample, c);
+}
+
+void trigger(zn_session_t *zn, const char *rname, unsigned int n)
+{
+    z_bytes_t payload;
+    payload.val = (const uint8_t *)&n;
+    payload.len = sizeof(n);
+    zn_reskey_t reskey = zn_rname(rname);
+    _zn_trigger_subscriptions(zn, reskey, payload);
+    free(reskey.rname);
+}
+
+/*=============================*/
+/*           Tests             */
+/*=============================*/
+void per_key_ordering(void)
+{
+    printf(">>> Per key ordering\n");
+    zn_session_t *zn = null_session_make();
+
+    char rnames[KEYS][16];
+    counter_t counters[KEYS];
+    memset(counters, 0, sizeof(counters));
+    for (unsigned int i = 0; i < KEYS; i++)
+    {
+        snprintf(rnames[i], sizeof(rnames[i]), "/demo/%u", i);
+        subscriber_make(zn, i, rnames[i], zn_queue_full_t_BLOCK, &counters[i]);
+    }
+
+    int res = znp_start_dispatcher(zn, WORKERS);
+    assert(res == 0);
+    // The dispatcher is already running
+    res = znp_start_dispatcher(zn, WORKERS);
+    assert(res == -1);
+
+    for (unsigned int n = 0; n < SAMPLES; n++)
+        for (unsigned int i = 0; i < KEYS; i++)
+            trigger(zn, rnames[i], n);
+
+    _zn_dispatch_flush(zn, NO_SUBSCRIPTION);
+    for (unsigned int i = 0; i < KEYS; i++)
+    {
+        assert(counters[i].received == SAMPLES);
+        assert(counters[i].out_of_order == 0);
+    }
+    assert(zn->stats.rx_dropped_dispatch == 0);
+
+    res = znp_stop_dispatcher(zn);
+    assert(res == 0);
+    res = znp_stop_dispatcher(zn);
+    assert(res == -1);
+
+    // The callbacks are run inline once the dispatcher is stopped
+    trigger(zn, rnames[0], SAMPLES);
+    assert(counters[0].received == SAMPLES + 1);
+    assert(counters[0].out_of_order == 0);
+
+    _zn_session_free(zn);
+}
+
+void drop_on_full(zn_queue_full_t on_full)
+{
+    printf(">>> Drop on full queue: %s\n", on_full == zn_queue_full_t_DROP_NEWEST ? "newest" : "oldest");
+    zn_session_t *zn = null_session_make();
+
+    counter_t c;
+    memset(&c, 0, sizeof(c));
+    subscriber_make(zn, 0, "/demo/slow", on_full, &c);
+
+    int res = znp_start_dispatcher(zn, 1);
+    assert(res == 0);
+
+    // Hold the worker in the first callback while the queue fills up
+    __atomic_store_n(&c.is_blocked, 1, __ATOMIC_RELEASE);
+    unsigned int total = 2 * ZN_DISPATCH_QUEUE_SIZE;
+    for (unsigned int n = 0; n < total; n++)
+        trigger(zn, "/demo/slow", n);
+    __atomic_store_n(&c.is_blocked, 0, __ATOMIC_RELEASE);
+
+    _zn_dispatch_flush(zn, NO_SUBSCRIPTION);
+    assert(zn->stats.rx_dropped_dispatch > 0);
+    assert(c.received + zn->stats.rx_dropped_dispatch == total);
+    if (on_full == zn_queue_full_t_DROP_NEWEST)
+        assert(c.next < total);
+    else
+        assert(c.next == total);
+
+    // The pending samples are delivered when stopping
+    trigger(zn, "/demo/slow", total);
+    res = znp_stop_dispatcher(zn);
+    assert(res == 0);
+    assert(c.next == total + 1);
+
+    _zn_session_free(zn);
+}
+
+void drop_oldest_keeps_blocking(void)
+{
+    printf(">>> Drop oldest along with a blocking subscription\n");
+    zn_session_t *zn = null_session_make();
+
+    counter_t lossy;
+    counter_t lossless;
+    memset(&lossy, 0, sizeof(lossy));
+    memset(&lossless, 0, sizeof(lossless));
+    subscriber_make(zn, 0, "/demo/lossy", zn_queue_full_t_DROP_OLDEST, &lossy);
+    subscriber_make(zn, 1, "/demo/lossless", zn_queue_full_t_BLOCK, &lossless);
+
+    int res = znp_start_dispatcher(zn, 1);
+    assert(res == 0);
+
+    // Hold the worker in a callback, then fill its queue with samples that can not be lost
+    __atomic_store_n(&lossy.is_blocked, 1, __ATOMIC_RELEASE);
+    trigger(zn, "/demo/lossy", 0);
+    while (__atomic_load_n(&lossy.received, __ATOMIC_ACQUIRE) == 0)
+        z_sleep_ms(1);
+    for (unsigned int n = 0; n < ZN_DISPATCH_QUEUE_SIZE; n++)
+        trigger(zn, "/demo/lossless", n);
+
+    // Nothing can be evicted to make room for the new sample, it is dropped
+    trigger(zn, "/demo/lossy", 1);
+    assert(zn->stats.rx_dropped_dispatch == 1);
+    __atomic_store_n(&lossy.is_blocked, 0, __ATOMIC_RELEASE);
+
+    _zn_dispatch_flush(zn, NO_SUBSCRIPTION);
+    assert(lossless.received == ZN_DISPATCH_QUEUE_SIZE);
+    assert(lossless.out_of_order == 0);
+    assert(lossy.received == 1);
+
+    res = znp_stop_dispatcher(zn);
+    assert(res == 0);
+    _zn_session_free(zn);
+}
+
+typedef struct
+{
+    zn_session_t *zn;
+    _zn_subscriber_t *self;
+    counter_t *c;
+    unsigned int calls;
+} redeclare_t;
+
+void on_sample_redeclare(const zn_sample_t *sample, const void *arg)
+{
+    (void)(sample);
+    redeclare_t *r = (redeclare_t *)arg;
+    r->calls++;
+
+    // Replace this subscription by a wildcard one, no lock of the session is held
+    subscriber_make(r->zn, 1, "/demo/**", zn_queue_full_t_BLOCK, r->c);
+    _zn_unregister_subscription(r->zn, _ZN_IS_LOCAL, r->self);
+}
+
+void declare_from_callback(void)
+{
+    printf(">>> Declare from a callback\n");
+    zn_session_t *zn = null_session_make();
+
+    counter_t c;
+    memset(&c, 0, sizeof(c));
+    redeclare_t r;
+    r.zn = zn;
+    r.c = &c;
+    r.calls = 0;
+    r.self = subscriber_make_with(zn, 0, "/demo/redeclare", zn_queue_full_t_BLOCK, on_sample_redeclare, &r);
+
+    // The sample being delivered is matched against the subscriptions it was received with
+    trigger(zn, "/demo/redeclare", 0);
+    assert(r.calls == 1);
+    assert(c.received == 0);
+
+    trigger(zn, "/demo/redeclare", 0);
+    assert(r.calls == 1);
+    assert(c.received == 1);
+
+    _zn_session_free(zn);
+}
+
+typedef struct
+{
+    zn_session_t *zn;
+    int is_running;
+    unsigned int declared;
+} declarer_t;
+
+void *declare_task(void *arg)
+{
+    declarer_t *d = (declarer_t *)arg;
+    counter_t c;
+    memset(&c, 0, sizeof(c));
+    while (__atomic_load_n(&d->is_running, __ATOMIC_ACQUIRE))
+    {
+        _zn_subscriber_t *sub = subscriber_make(d->zn, 1, "/demo/*", zn_queue_full_t_BLOCK, &c);
+        z_sleep_us(10);
+        _zn_unregister_subscription(d->zn, _ZN_IS_LOCAL, sub);
+        __atomic_add_fetch(&d->declared, 1, __ATOMIC_RELEASE);
+    }
+    return 0;
+}
+
+void concurrent_declarations(void)
+{
+    printf(">>> Concurrent declarations\n");
+    zn_session_t *zn = null_session_make();
+
+    counter_t c;
+    memset(&c, 0, sizeof(c));
+    subscriber_make(zn, 0, "/demo/stable", zn_queue_full_t_BLOCK, &c);
+
+    // The samples keep being delivered while the subscriptions change
+    declarer_t d;
+    d.zn = zn;
+    d.is_running = 1;
+    d.declared = 0;
+    z_task_t task;
+    int res = z_task_init(&task, NULL, declare_task, &d);
+    assert(res == 0);
+    (void)(res);
+
+    unsigned int n = 0;
+    while (n < SAMPLES || __atomic_load_n(&d.declared, __ATOMIC_ACQUIRE) < KEYS)
+        trigger(zn, "/demo/stable", n++);
+
+    __atomic_store_n(&d.is_running, 0, __ATOMIC_RELEASE);
+    z_task_join(&task);
+    printf("Declared %u subscriptions\n", d.declared);
+    assert(c.received == n);
+    assert(c.out_of_order == 0);
+
+    _zn_session_free(zn);
+}
+
+typedef struct
+{
+    zn_session_t *zn;
+    _zn_subscriber_t *sub;
+    int is_done;
+} undeclarer_t;
+
+void *trigger_task(void *arg)
+{
+    trigger((zn_session_t *)arg, "/demo/grace", 0);
+    return 0;
+}
+
+void *undeclare_task(void *arg)
+{
+    undeclarer_t *u = (undeclarer_t *)arg;
+    _zn_unregister_subscription(u->zn, _ZN_IS_LOCAL, u->sub);
+    __atomic_store_n(&u->is_done, 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+void undeclare_waits_for_callback(void)
+{
+    printf(">>> Undeclare waits for the callback\n");
+    zn_session_t *zn = null_session_make();
+
+    counter_t c;
+    memset(&c, 0, sizeof(c));
+    c.is_blocked = 1;
+    undeclarer_t u;
+    u.zn = zn;
+    u.sub = subscriber_make(zn, 0, "/demo/grace", zn_queue_full_t_BLOCK, &c);
+    u.is_done = 0;
+
+    z_task_t trigger_t;
+    int res = z_task_init(&trigger_t, NULL, trigger_task, zn);
+    assert(res == 0);
+    while (__atomic_load_n(&c.received, __ATOMIC_ACQUIRE) == 0)
+        z_sleep_ms(1);
+
+    // The callback is still running, the subscription is not undeclared yet
+    z_task_t undeclare_t;
+    res = z_task_init(&undeclare_t, NULL, undeclare_task, &u);
+    assert(res == 0);
+    (void)(res);
+    z_sleep_ms(50);
+    assert(__atomic_load_n(&u.is_done, __ATOMIC_ACQUIRE) == 0);
+
+    __atomic_store_n(&c.is_blocked, 0, __ATOMIC_RELEASE);
+    z_task_join(&undeclare_t);
+    z_task_join(&trigger_t);
+    assert(u.is_done == 1);
+    assert(c.received == 1);
+
+    _zn_session_free(zn);
+}
+
+typedef struct
+{
+    zn_session_t *zn;
+    _zn_subscriber_t *self;
+    unsigned int calls;
+    int is_blocked;
+} self_undeclarer_t;
+
+void on_sample_undeclare(const zn_sample_t *sample, const void *arg)
+{
+    (void)(sample);
+    self_undeclarer_t *u = (self_undeclarer_t *)arg;
+    __atomic_add_fetch(&u->calls, 1, __ATOMIC_RELEASE);
+    while (__atomic_load_n(&u->is_blocked, __ATOMIC_ACQUIRE))
+        z_sleep_ms(1);
+
+    // Undeclare the subscription the way zn_undeclare_subscriber does, from its own worker
+    z_zint_t id = u->self->id;
+    _zn_unregister_subscription(u->zn, _ZN_IS_LOCAL, u->self);
+    _zn_dispatch_flush(u->zn, id);
+}
+
+void *trigger_mixed_task(void *arg)
+{
+    // Fill the queue of the worker beyond its capacity, the last samples wait for room
+    zn_session_t *zn = (zn_session_t *)arg;
+    for (unsigned int n = 0; n < 2 * ZN_DISPATCH_QUEUE_SIZE; n++)
+    {
+        trigger(zn, "/demo/self", n);
+        trigger(zn, "/demo/other", n);
+    }
+    return 0;
+}
+
+void undeclare_from_worker(void)
+{
+    printf(">>> Undeclare from a dispatched callback\n");
+    zn_session_t *zn = null_session_make();
+
+    counter_t other;
+    memset(&other, 0, sizeof(other));
+    subscriber_make(zn, 1, "/demo/other", zn_queue_full_t_BLOCK, &other);
+
+    self_undeclarer_t u;
+    u.zn = zn;
+    u.calls = 0;
+    u.is_blocked = 1;
+    u.self = subscriber_make_with(zn, 0, "/demo/self", zn_queue_full_t_BLOCK, on_sample_undeclare, &u);
+
+    int res = znp_start_dispatcher(zn, 1);
+    assert(res == 0);
+
+    // Hold the worker in the callback of the subscription while the reading thread blocks on its full queue
+    z_task_t task;
+    res = z_task_init(&task, NULL, trigger_mixed_task, zn);
+    assert(res == 0);
+    while (__atomic_load_n(&u.calls, __ATOMIC_ACQUIRE) == 0)
+        z_sleep_ms(1);
+    z_sleep_ms(50);
+    __atomic_store_n(&u.is_blocked, 0, __ATOMIC_RELEASE);
+
+    // The worker runs the other samples queued behind it and drops the ones of the undeclared subscription
+    z_task_join(&task);
+    _zn_dispatch_flush(zn, NO_SUBSCRIPTION);
+    assert(u.calls == 1);
+    assert(other.received == 2 * ZN_DISPATCH_QUEUE_SIZE);
+    assert(other.out_of_order == 0);
+
+    res = znp_stop_dispatcher(zn);
+    assert(res == 0);
+    (void)(res);
+    _zn_session_free(zn);
+}
+
+int main(void)
+{
+    setbuf(stdout, NULL);
+
+    per_key_ordering();
+    drop_on_full(zn_queue_full_t_DROP_NEWEST);
+    drop_on_full(zn_queue_full_t_DROP_OLDEST);
+    drop_oldest_keeps_blocking();
+    declare_from_callback();
+    concurrent_declarations();
+    undeclare_waits_for_callback();
+    undeclare_from_worker();
+
+    return 0;
+}
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2017, 2021 ADLINK Technology Inc.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License 2.0 which is available at
+ * http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+ * which is available at https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+ *
+ * Contributors:
+ *   ADLINK zenoh team, <zenoh@adlink-labs.tech>
+ */
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "zenoh-pico.h"
+#include "zenoh-pico/protocol/private/utils.h"
+#include "zenoh-pico/session/private/subscription.h"
+#include "zenoh-pico/session/private/utils.h"
+#include "zenoh-pico/transport/private/utils.h"
+#include "zn_test_session.h"
+
+#define FRAGMENT_LEN (1024 * 1024)
+#define PAYLOAD_LEN 4096
+
+/*=============================*/
+/*           Helpers           */
+/*=============================*/
+unsigned int received = 0;
+
+void on_sample(const zn_sample_t *sample, const void *arg)
+{
+    (void)(arg);
+    assert(sample->value.len == PAYLOAD_LEN);
+    for (size_t i = 0; i < PAYLOAD_LEN; i++)
+        assert(sample->value.val[i] == (uint8_t)i);
+    received++;
+}
+
+int handle_fragment(zn_session_t *zn, const uint8_t *val, size_t len, int is_final)
+{
+    _zn_transport_message_t t_msg = _zn_transport_message_init(_ZN_MID_FRAME);
+    _ZN_SET_FLAG(t_msg.header, _ZN_FLAG_T_F);
+    if (is_final)
+        _ZN_SET_FLAG(t_msg.header, _ZN_FLAG_T_E);
+    t_msg.body.frame.sn = 0;
+    t_msg.body.frame.payload.fragment.val = val;
+    t_msg.body.frame.payload.fragment.len = len;
+    return _zn_handle_frame(zn, &t_msg);
+}
+
+/*=============================*/
+/*            Main             */
+/*=============================*/
+int main(void)
+{
+    setbuf(stdout, NULL);
+
+    zn_session_t *zn = null_session_make();
+
+    _zn_subscriber_t *sub = (_zn_subscriber_t *)malloc(sizeof(_zn_subscriber_t));
+    sub->id = 0;
+    sub->key = zn_rname("/test/fragment");
+    sub->info = zn_subinfo_default();
+    sub->callback = on_sample;
+    sub->arg = NULL;
+    int res = _zn_register_subscription(zn, _ZN_IS_LOCAL, sub);
+    assert(res == 0);
+
+    // Encode a data message and split it in two fragments
+    uint8_t *payload = (uint8_t *)malloc(PAYLOAD_LEN);
+    for (size_t i = 0; i < PAYLOAD_LEN; i++)
+        payload[i] = (uint8_t)i;
+    _zn_zenoh_message_t z_msg = _zn_zenoh_message_init(_ZN_MID_DATA);
+    z_msg.body.data.key = zn_rname("/test/fragment");
+    _ZN_SET_FLAG(z_msg.header, _ZN_FLAG_Z_K);
+    z_msg.body.data.payload.val = payload;
+    z_msg.body.data.payload.len = PAYLOAD_LEN;
+    _z_wbuf_t wbf = _z_wbuf_make(ZN_FRAG_BUF_TX_CHUNK, 1);
+    res = _zn_zenoh_message_encode(&wbf, &z_msg);
+    assert(res == 0);
+    _z_zbuf_t zbf = _z_wbuf_to_zbuf(&wbf);
+    const uint8_t *msg = _z_zbuf_get_rptr(&zbf);
+    size_t msg_len = _z_zbuf_len(&zbf);
+
+    printf(">>> Fragmented message within the bound\n");
+    assert(handle_fragment(zn, msg, msg_len / 2, 0) == _z_res_t_OK);
+    assert(handle_fragment(zn, msg + msg_len / 2, msg_len - msg_len / 2, 1) == _z_res_t_OK);
+    assert(received == 1);
+    assert(zn->stats.rx_msgs == 1);
+
+    printf(">>> Fragmented message over the bound\n");
+    // The fragments exceeding ZN_FRAG_BUF_RX_LIMIT are discarded up to the final one
+    uint8_t *large = (uint8_t *)calloc(1, FRAGMENT_LEN);
+    size_t fragments = ZN_FRAG_BUF_RX_LIMIT / FRAGMENT_LEN + 2;
+    for (size_t i = 0; i < fragments; i++)
+    {
+        assert(handle_fragment(zn, large, FRAGMENT_LEN, 0) == _z_res_t_OK);
+        if ((i + 1) * FRAGMENT_LEN > ZN_FRAG_BUF_RX_LIMIT)
+        {
+            assert(zn->dbuf_best_effort.is_discarding);
+            assert(_z_zbuf_len(&zn->dbuf_best_effort.buf) == 0);
+        }
+    }
+    assert(handle_fragment(zn, large, FRAGMENT_LEN, 1) == _z_res_t_OK);
+    assert(received == 1);
+    assert(zn->stats.rx_msgs == 1);
+    assert(zn->stats.rx_decode_errors == 0);
+    assert(zn->stats.rx_dropped_oversize == 1);
+    assert(!zn->dbuf_best_effort.is_discarding);
+
+    printf(">>> Recovery on the next fragmented message\n");
+    assert(handle_fragment(zn, msg, msg_len / 2, 0) == _z_res_t_OK);
+    assert(handle_fragment(zn, msg + msg_len / 2, msg_len - msg_len / 2, 1) == _z_res_t_OK);
+    assert(received == 2);
+    assert(zn->stats.rx_msgs == 2);
+    assert(zn->stats.rx_dropped_oversize == 1);
+
+    free(large);
+    _z_zbuf_free(&zbf);
+    _z_wbuf_free(&wbf);
+    free(z_msg.body.data.key.rname);
+    free(payload);
+    _zn_session_free(zn);
+
+    return 0;
+}
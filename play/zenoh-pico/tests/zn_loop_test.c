@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) 2017, 2021 ADLINK Technology Inc.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License 2.0 which is available at
+ * http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+ * which is available at https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+ *
+ * Contributors:
+ *   ADLINK zenoh team, <zenoh@adlink-labs.tech>
+ */
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include "zenoh-pico.h"
+#include "zenoh-pico/session/private/utils.h"
+#include "zenoh-pico/system/common.h"
+#include "zenoh-pico/transport/private/utils.h"
+#include "zn_test_session.h"
+
+#define RUNS 1000
+#define LARGE_PAYLOAD (3 * ZN_BATCH_SIZE)
+#define MAX_WAIT_MS 5000
+
+/*=============================*/
+/*        Subscribers          */
+/*=============================*/
+volatile unsigned int received[2] = {0, 0};
+
+void data_handler(const zn_sample_t *sample, const void *arg)
+{
+    volatile unsigned int *count = (volatile unsigned int *)arg;
+    assert(sample->value.len >= sizeof(unsigned int));
+
+    unsigned int idx;
+    memcpy(&idx, sample->value.val, sizeof(unsigned int));
+    // Samples must be delivered exactly once and in order
+    assert(idx == *count);
+    (*count)++;
+}
+
+void *run(void *arg)
+{
+    int res = zn_loop_run((zn_loop_t *)arg);
+    assert(res == 0);
+    (void)(res);
+    return 0;
+}
+
+int wait_received(unsigned int expected)
+{
+    for (unsigned int i = 0; i < MAX_WAIT_MS / 10; i++)
+    {
+        if (received[0] == expected && received[1] == expected)
+            return 1;
+        z_sleep_ms(10);
+    }
+    return 0;
+}
+
+/*=============================*/
+/*            Main             */
+/*=============================*/
+int main(void)
+{
+    setbuf(stdout, NULL);
+    // The sessions keep writing on the link closed by the peer
+    signal(SIGPIPE, SIG_IGN);
+
+    zn_loop_t *loop = zn_loop_make();
+    assert(loop != NULL);
+
+    // A session over a stream link and a session over a datagram link
+    int streams[2];
+    int dgrams[2];
+    int res = socketpair(AF_UNIX, SOCK_STREAM, 0, streams);
+    assert(res == 0);
+    res = socketpair(AF_UNIX, SOCK_DGRAM, 0, dgrams);
+    assert(res == 0);
+    zn_session_t *pubs[2] = {pair_session_make(streams[0], 1), pair_session_make(dgrams[0], 0)};
+    zn_session_t *subs[2] = {pair_session_make(streams[1], 1), pair_session_make(dgrams[1], 0)};
+
+    // A session to be closed by its peer
+    int closing[2];
+    res = socketpair(AF_UNIX, SOCK_STREAM, 0, closing);
+    assert(res == 0);
+    zn_session_t *closer = pair_session_make(closing[0], 1);
+    zn_session_t *closed = pair_session_make(closing[1], 1);
+    res = zn_loop_add_session(loop, closed);
+    assert(res == 0);
+
+    zn_reskey_t reskey = zn_rname("/test");
+    zn_subscriber_t *sub[2];
+    for (unsigned int i = 0; i < 2; i++)
+    {
+        sub[i] = zn_declare_subscriber(subs[i], zn_rname("/test"), zn_subinfo_default(), data_handler, (void *)&received[i]);
+        assert(sub[i] != NULL);
+
+        res = zn_loop_add_session(loop, subs[i]);
+        assert(res == 0);
+    }
+    // A session is served once
+    res = zn_loop_add_session(loop, subs[0]);
+    assert(res == -1);
+
+    z_task_t task;
+    res = z_task_init(&task, NULL, run, loop);
+    assert(res == 0);
+
+    printf(">>> Multiplexing the reception of %d sessions\n", 2);
+    uint8_t *payload = (uint8_t *)malloc(LARGE_PAYLOAD);
+    memset(payload, 0, LARGE_PAYLOAD);
+    for (unsigned int i = 0; i < RUNS; i++)
+    {
+        // Every hundredth message is fragmented
+        size_t len = i % 100 == 0 ? LARGE_PAYLOAD : 64;
+        memcpy(payload, &i, sizeof(unsigned int));
+        for (unsigned int j = 0; j < 2; j++)
+        {
+            res = zn_write(pubs[j], reskey, payload, len);
+            assert(res == 0);
+        }
+
+        // Do not overflow the datagram socket buffer
+        if (i % 50 == 0)
+            wait_received(i + 1);
+    }
+    res = wait_received(RUNS);
+    assert(res == 1);
+    printf("Received %u and %u samples\n", received[0], received[1]);
+
+    printf(">>> Sending keep alives on idle sessions\n");
+    z_sleep_ms(ZN_KEEP_ALIVE_INTERVAL + ZN_KEEP_ALIVE_INTERVAL / 2);
+    uint8_t byte;
+    assert(recv(streams[0], &byte, 1, MSG_DONTWAIT | MSG_PEEK) == 1);
+    assert(recv(dgrams[0], &byte, 1, MSG_DONTWAIT | MSG_PEEK) == 1);
+
+    printf(">>> Removing the session whose link is closed\n");
+    shutdown(streams[0], SHUT_RDWR);
+    z_sleep_ms(100);
+
+    printf(">>> Freeing the session closed by the peer\n");
+    res = _zn_send_close(closer, _ZN_CLOSE_GENERIC, 0);
+    assert(res == 0);
+    z_sleep_ms(100);
+
+    zn_loop_stop(loop);
+    z_task_join(&task);
+
+    // The loop has removed the first session and freed the closed one already
+    res = zn_loop_remove_session(loop, subs[0]);
+    assert(res == -1);
+    res = zn_loop_remove_session(loop, closed);
+    assert(res == -1);
+    res = zn_loop_remove_session(loop, subs[1]);
+    assert(res == 0);
+    res = zn_loop_remove_session(loop, subs[1]);
+    assert(res == -1);
+    zn_loop_free(loop);
+
+    free(payload);
+    free(reskey.rname);
+    for (unsigned int i = 0; i < 2; i++)
+    {
+        free(sub[i]);
+        _zn_session_free(subs[i]);
+        _zn_session_free(pubs[i]);
+    }
+    close(streams[0]);
+    close(streams[1]);
+    close(dgrams[0]);
+    close(dgrams[1]);
+    _zn_session_free(closer);
+    close(closing[0]);
+    close(closing[1]);
+
+    return 0;
+}
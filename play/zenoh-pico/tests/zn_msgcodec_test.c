@@ -67,6 +67,9 @@ void print_transport_message_type(uint8_t header)
 {
     switch (_ZN_MID(header))
     {
+    case _ZN_MID_JOIN:
+        printf("Join message");
+        break;
     case _ZN_MID_SCOUT:
         printf("Scout message");
         break;
@@ -259,6 +262,61 @@ void assert_eq_payload(_zn_payload_t *left, _zn_payload_t *right)
     assert_eq_uint8_array(left, right);
 }
 
+void zint_field(void)
+{
+    printf("\n>> ZInt field\n");
+    z_zint_t values[] = {0, 0x7f, 0x80, 0x3fff, 0x4000, (z_zint_t)gen_zint() << 3, (z_zint_t)-1};
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++)
+    {
+        // Encode in a large buffer and in a buffer exactly fitting the zint
+        _z_wbuf_t wbf = _z_wbuf_make(128, 0);
+        int res = _z_zint_encode(&wbf, values[i]);
+        assert(res == 0);
+        size_t len = _z_wbuf_len(&wbf);
+        assert(len >= 1 && len <= _Z_ZINT_MAX_LEN);
+
+        _z_wbuf_t wbf_exact = _z_wbuf_make(len, 0);
+        res = _z_zint_encode(&wbf_exact, values[i]);
+        assert(res == 0);
+        assert(_z_wbuf_len(&wbf_exact) == len);
+        for (size_t j = 0; j < len; j++)
+            assert(_z_wbuf_get_iosli(&wbf, 0)->buf[j] == _z_wbuf_get_iosli(&wbf_exact, 0)->buf[j]);
+
+        // One byte less does not fit
+        _z_wbuf_t wbf_short = _z_wbuf_make(len - 1, 0);
+        if (len > 1)
+            assert(_z_zint_encode(&wbf_short, values[i]) != 0);
+
+        // Decode from a buffer ending right after the zint
+        _z_zbuf_t zbf = _z_wbuf_to_zbuf(&wbf_exact);
+        _z_zint_result_t r_zint = _z_zint_decode(&zbf);
+        assert(r_zint.tag == _z_res_t_OK);
+        assert(r_zint.value.zint == values[i]);
+        assert(_z_zbuf_len(&zbf) == 0);
+        printf("   %zu: %zu bytes\n", values[i], len);
+
+        // Truncated
+        _z_zbuf_set_rpos(&zbf, 0);
+        _z_zbuf_set_wpos(&zbf, len - 1);
+        r_zint = _z_zint_decode(&zbf);
+        assert(r_zint.tag == _z_res_t_ERR);
+
+        _z_zbuf_free(&zbf);
+        _z_wbuf_free(&wbf);
+        _z_wbuf_free(&wbf_exact);
+        _z_wbuf_free(&wbf_short);
+    }
+
+    // Longer than a z_zint_t
+    _z_zbuf_t zbf = _z_zbuf_make(2 * _Z_ZINT_MAX_LEN);
+    for (size_t i = 0; i < 2 * _Z_ZINT_MAX_LEN - 1; i++)
+        _z_iosli_write(&zbf.ios, 0x80);
+    _z_iosli_write(&zbf.ios, 0x01);
+    _z_zint_result_t r_zint = _z_zint_decode(&zbf);
+    assert(r_zint.tag == _z_res_t_ERR);
+    _z_zbuf_free(&zbf);
+}
+
 void payload_field(void)
 {
     printf("\n>> Payload field\n");
@@ -471,6 +529,22 @@ void res_key_field(void)
     assert_eq_res_key(&e_rk, &d_rk, header);
     printf("\n");
 
+    // Decode borrowing the resource name from the buffer
+    z_arena_t arena = z_arena_make(64);
+    _z_zbuf_set_rpos(&zbf, 0);
+    zbf.arena = &arena;
+    r_rk = _zn_reskey_decode(&zbf, header);
+    assert(r_rk.tag == _z_res_t_OK);
+    assert(arena.len == 0);
+    if (e_rk.rname)
+    {
+        uint8_t *rname = (uint8_t *)r_rk.value.reskey.rname;
+        assert(rname >= zbf.ios.buf && rname < _z_zbuf_get_rptr(&zbf));
+        assert(!strcmp(e_rk.rname, r_rk.value.reskey.rname));
+    }
+    z_arena_free(&arena);
+    zbf.arena = NULL;
+
     // Free
     _zn_reskey_free(&d_rk);
     _z_zbuf_free(&zbf);
@@ -618,7 +692,8 @@ _zn_attachment_t *gen_attachment(void)
     _zn_attachment_t *p_at = (_zn_attachment_t *)malloc(sizeof(_zn_attachment_t));
 
     p_at->header = _ZN_MID_ATTACHMENT;
-    _ZN_SET_FLAG(p_at->header, _ZN_FLAGS(gen_uint8()));
+    // Sliced payloads are not supported, the encoder always clears the flag
+    _ZN_SET_FLAG(p_at->header, _ZN_FLAGS(gen_uint8()) & ~_ZN_FLAG_T_Z);
     p_at->payload = gen_payload(64);
 
     return p_at;
@@ -1510,6 +1585,7 @@ _zn_zenoh_message_t *gen_zenoh_message(void)
         p_zm->reply_context = gen_reply_context();
     else
         p_zm->reply_context = NULL;
+    p_zm->priority = (zn_priority_t)(gen_uint8() % _ZN_PRIORITIES_NUM);
 
     uint8_t mids[] = {
         _ZN_MID_DECLARE,
@@ -1576,6 +1652,9 @@ void assert_eq_zenoh_message(_zn_zenoh_message_t *left, _zn_zenoh_message_t *rig
         assert(left->reply_context == right->reply_context);
     }
 
+    printf("   Priority (%d:%d)\n", left->priority, right->priority);
+    assert(left->priority == right->priority);
+
     // Test message
     printf("   Header (%x:%x)", left->header, right->header);
     assert(left->header == right->header);
@@ -1668,6 +1747,40 @@ void zenoh_message(void)
     _z_wbuf_free(&wbf);
 }
 
+void data_header(void)
+{
+    printf("\n>> Pre-encoded data header\n");
+    _z_wbuf_t wbf = gen_wbuf(1024);
+
+    // Initialize
+    _zn_zenoh_message_t e_zm;
+    e_zm.attachment = NULL;
+    e_zm.reply_context = NULL;
+    e_zm.priority = (zn_priority_t)(gen_uint8() % _ZN_PRIORITIES_NUM);
+    e_zm.header = _ZN_MID_DATA;
+    e_zm.body.data = gen_data_message(&e_zm.header);
+
+    // Encode the header and the payload separately, as publishers do
+    int res = _zn_data_header_encode(&wbf, &e_zm);
+    assert(res == 0);
+    res = _z_bytes_encode(&wbf, &e_zm.body.data.payload);
+    assert(res == 0);
+
+    // Decode as a whole zenoh message
+    _z_zbuf_t zbf = _z_wbuf_to_zbuf(&wbf);
+    _zn_zenoh_message_p_result_t r_zm = _zn_zenoh_message_decode(&zbf);
+    assert(r_zm.tag == _z_res_t_OK);
+
+    _zn_zenoh_message_t *d_zm = r_zm.value.zenoh_message;
+    assert_eq_zenoh_message(&e_zm, d_zm);
+
+    // Free
+    _zn_zenoh_message_free(d_zm);
+    _zn_zenoh_message_p_result_free(&r_zm);
+    _z_zbuf_free(&zbf);
+    _z_wbuf_free(&wbf);
+}
+
 /*=============================*/
 /*       Transport Messages      */
 /*=============================*/
@@ -1818,6 +1931,11 @@ _zn_join_t gen_join_message(uint8_t *header)
         _ZN_SET_FLAG(*header, _ZN_FLAG_T_S);
     }
 
+    // A lease expressed in seconds must be a multiple of 1000 ms.
+    // NOTE: the T1 and S flags share the same bit.
+    if (_ZN_HAS_FLAG(*header, _ZN_FLAG_T_T1))
+        e_jn.lease = (e_jn.lease / 1000) * 1000;
+
     if (gen_bool())
     {
         e_jn.next_sns.is_qos = 1;
@@ -1924,7 +2042,10 @@ _zn_init_t gen_init_message(uint8_t *header)
 
     e_it.options = 0;
     if (gen_bool())
+    {
         _ZN_SET_FLAG(e_it.options, _ZN_OPT_INIT_QOS);
+        _ZN_SET_FLAG(*header, _ZN_FLAG_T_O);
+    }
 
     e_it.whatami = gen_zint();
     e_it.pid = gen_bytes(16);
@@ -2830,6 +2951,7 @@ int main(void)
     {
         printf("\n\n== RUN %u", i);
         // Message fields
+        zint_field();
         payload_field();
         timestamp_field();
         subinfo_field();
@@ -2853,6 +2975,7 @@ int main(void)
         pull_message();
         query_message();
         zenoh_message();
+        data_header();
         // Session messages
         scout_message();
         hello_message();
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2017, 2021 ADLINK Technology Inc.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License 2.0 which is available at
+ * http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+ * which is available at https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+ *
+ * Contributors:
+ *   ADLINK zenoh team, <zenoh@adlink-labs.tech>
+ */
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include "zenoh-pico.h"
+#include "zenoh-pico/session/private/utils.h"
+#include "zenoh-pico/system/common.h"
+#include "zenoh-pico/transport/private/utils.h"
+#include "zn_test_session.h"
+
+#define PINGS 100
+
+/*=============================*/
+/*           Helpers           */
+/*=============================*/
+void *run(void *arg)
+{
+    int res = zn_loop_run((zn_loop_t *)arg);
+    assert(res == 0);
+    (void)(res);
+    return 0;
+}
+
+/*=============================*/
+/*            Main             */
+/*=============================*/
+int main(void)
+{
+    setbuf(stdout, NULL);
+
+    int socks[2];
+    int res = socketpair(AF_UNIX, SOCK_STREAM, 0, socks);
+    assert(res == 0);
+    zn_session_t *a = pair_session_make(socks[0], 1);
+    zn_session_t *b = pair_session_make(socks[1], 1);
+
+    printf(">>> Timing out without anyone reading the pong\n");
+    res = zn_ping(a, 100);
+    assert(res == -1);
+    zn_stats_t stats = zn_session_stats(a);
+    assert(stats.rtt_samples == 0);
+
+    // Both sessions are served by an event loop, b answering the pings of a
+    zn_loop_t *loop = zn_loop_make();
+    assert(loop != NULL);
+    res = zn_loop_add_session(loop, a);
+    assert(res == 0);
+    res = zn_loop_add_session(loop, b);
+    assert(res == 0);
+    z_task_t task;
+    res = z_task_init(&task, NULL, run, loop);
+    assert(res == 0);
+
+    printf(">>> Measuring %d round trips\n", PINGS);
+    for (int i = 0; i < PINGS; i++)
+    {
+        res = zn_ping(a, 1000);
+        assert(res >= 0);
+    }
+
+    // The stale pong of the first ping has been ignored
+    stats = zn_session_stats(a);
+    printf("RTT: min %zuus, avg %zuus, p99 %zuus\n", stats.rtt_min, stats.rtt_avg, stats.rtt_p99);
+    assert(stats.rtt_samples == PINGS);
+    assert(stats.rtt_min <= stats.rtt_avg && stats.rtt_avg <= stats.rtt_p99);
+    assert(zn_session_stats(b).rtt_samples == 0);
+
+    zn_loop_stop(loop);
+    z_task_join(&task);
+    zn_loop_free(loop);
+
+    _zn_session_free(a);
+    _zn_session_free(b);
+    close(socks[0]);
+    close(socks[1]);
+
+    return 0;
+}
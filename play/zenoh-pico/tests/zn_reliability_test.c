@@ -0,0 +1,405 @@
+/*
+ * Copyright (c) 2017, 2021 ADLINK Technology Inc.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License 2.0 which is available at
+ * http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+ * which is available at https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+ *
+ * Contributors:
+ *   ADLINK zenoh team, <zenoh@adlink-labs.tech>
+ */
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "zenoh-pico.h"
+#include "zenoh-pico/session/private/utils.h"
+#include "zenoh-pico/system/common.h"
+#include "zenoh-pico/transport/private/utils.h"
+
+#define RUNS 200
+#define INBOX_SIZE 256
+#define LARGE_PAYLOAD (3 * ZN_BATCH_SIZE)
+#define MAX_ROUNDS 100
+#define GIVEN_UP 10
+
+/*=============================*/
+/*    Lossy in-memory link     */
+/*=============================*/
+typedef struct
+{
+    z_bytes_t datagrams[INBOX_SIZE];
+    size_t head;
+    size_t len;
+} inbox_t;
+
+typedef struct
+{
+    // Must be the first member, the session frees the link as a whole
+    _zn_link_t link;
+    inbox_t *tx;
+    inbox_t *rx;
+    unsigned int drop_every;
+    unsigned int written;
+    unsigned int dropped;
+} lossy_link_t;
+
+size_t lossy_write(void *arg, const uint8_t *ptr, size_t len)
+{
+    lossy_link_t *l = (lossy_link_t *)arg;
+
+    // Drop one datagram every drop_every ones
+    l->written++;
+    if (l->drop_every > 0 && l->written % l->drop_every == 0)
+    {
+        l->dropped++;
+        return len;
+    }
+
+    assert(l->tx->len < INBOX_SIZE);
+    z_bytes_t *d = &l->tx->datagrams[(l->tx->head + l->tx->len) % INBOX_SIZE];
+    *d = _z_bytes_make(len);
+    memcpy((uint8_t *)d->val, ptr, len);
+    l->tx->len++;
+
+    return len;
+}
+
+size_t lossy_read(void *arg, uint8_t *ptr, size_t len)
+{
+    lossy_link_t *l = (lossy_link_t *)arg;
+    if (l->rx->len == 0)
+        return 0;
+
+    z_bytes_t *d = &l->rx->datagrams[l->rx->head];
+    assert(d->len <= len);
+    size_t n = d->len;
+    memcpy(ptr, d->val, n);
+    _z_bytes_free(d);
+    l->rx->head = (l->rx->head + 1) % INBOX_SIZE;
+    l->rx->len--;
+
+    return n;
+}
+
+size_t lossy_write_batch(void *arg, const z_bytes_t *iov, const size_t *iovcnts, size_t count)
+{
+    // Write at most two datagrams at once to exercise the partial batches
+    size_t n = count < 2 ? count : 2;
+    for (size_t i = 0; i < n; i++)
+    {
+        uint8_t buf[ZN_READ_BUF_LEN];
+        size_t len = 0;
+        for (size_t j = 0; j < iovcnts[i]; j++)
+        {
+            memcpy(buf + len, iov[j].val, iov[j].len);
+            len += iov[j].len;
+        }
+        lossy_write(arg, buf, len);
+        iov += iovcnts[i];
+    }
+    return n;
+}
+
+size_t lossy_read_batch(void *arg, z_bytes_t *bufs, size_t count)
+{
+    size_t n = 0;
+    for (; n < count; n++)
+    {
+        size_t len = lossy_read(arg, (uint8_t *)bufs[n].val, bufs[n].len);
+        if (len == 0)
+            break;
+        bufs[n].len = len;
+    }
+    return n;
+}
+
+void lossy_release(void *arg)
+{
+    (void)(arg);
+}
+
+_zn_link_t *lossy_link_make(inbox_t *tx, inbox_t *rx, unsigned int drop_every, int is_batched)
+{
+    lossy_link_t *l = (lossy_link_t *)calloc(1, sizeof(lossy_link_t));
+    l->link.is_reliable = 0;
+    l->link.is_streamed = 0;
+    l->link.mtu = ZN_BATCH_SIZE;
+    l->link.write_f = lossy_write;
+    l->link.read_f = lossy_read;
+    l->link.release_f = lossy_release;
+    if (is_batched)
+    {
+        l->link.write_batch_f = lossy_write_batch;
+        l->link.read_batch_f = lossy_read_batch;
+    }
+    l->tx = tx;
+    l->rx = rx;
+    l->drop_every = drop_every;
+    return &l->link;
+}
+
+/*=============================*/
+/*           Helpers           */
+/*=============================*/
+zn_session_t *session_make(_zn_link_t *link, z_zint_t initial_sn_tx, z_zint_t initial_sn_rx)
+{
+    zn_session_t *zn = _zn_session_init();
+    zn->link = link;
+    zn->locator = NULL;
+    _z_bytes_reset(&zn->local_pid);
+    _z_bytes_reset(&zn->remote_pid);
+    zn->sn_resolution = ZN_SN_RESOLUTION;
+    zn->sn_resolution_half = zn->sn_resolution / 2;
+    zn->sn_tx_reliable = initial_sn_tx;
+    zn->sn_tx_best_effort = initial_sn_tx;
+    zn->sn_rx_reliable = initial_sn_rx;
+    zn->sn_rx_best_effort = initial_sn_rx;
+    zn->reliable_channel = _zn_reliable_channel_make();
+    return zn;
+}
+
+// Process all the datagrams received by a session, return how many they are
+unsigned int pump(zn_session_t *zn)
+{
+    unsigned int n = 0;
+    lossy_link_t *l = (lossy_link_t *)zn->link;
+    while (l->rx->len > 0 || zn->dgrams_idx < zn->dgrams_len)
+    {
+        int res = znp_read(zn);
+        assert(res == _z_res_t_OK);
+        n++;
+    }
+    return n;
+}
+
+unsigned int received = 0;
+
+void data_handler(const zn_sample_t *sample, const void *arg)
+{
+    (void)(arg);
+    assert(sample->value.len >= sizeof(unsigned int));
+
+    unsigned int idx;
+    memcpy(&idx, sample->value.val, sizeof(unsigned int));
+    // Samples must be delivered exactly once and in order despite the losses
+    assert(idx == received);
+    received++;
+}
+
+unsigned int stats_replies = 0;
+
+void stats_handler(const zn_reply_t reply, const void *arg)
+{
+    (void)(arg);
+    if (reply.tag != zn_reply_t_Tag_DATA)
+        return;
+
+    // The statistics are replied as a JSON object under the admin key
+    assert(strcmp(reply.data.data.key.val, "/@/pico/0A/stats") == 0);
+    char *json = (char *)malloc(reply.data.data.value.len + 1);
+    memcpy(json, reply.data.data.value.val, reply.data.data.value.len);
+    json[reply.data.data.value.len] = '\0';
+    assert(json[0] == '{' && json[reply.data.data.value.len - 1] == '}');
+    assert(strstr(json, "\"tx_retransmissions\":") != NULL);
+    free(json);
+    stats_replies++;
+}
+
+/*=============================*/
+/*            Main             */
+/*=============================*/
+int main(void)
+{
+    setbuf(stdout, NULL);
+
+    inbox_t a_to_b;
+    inbox_t b_to_a;
+    memset(&a_to_b, 0, sizeof(inbox_t));
+    memset(&b_to_a, 0, sizeof(inbox_t));
+
+    // Start close to the SN resolution to cross the wrap around
+    z_zint_t initial_sn = ZN_SN_RESOLUTION - RUNS / 2;
+    // The sender gathers the fragments, the receiver reads many datagrams at once
+    zn_session_t *a = session_make(lossy_link_make(&a_to_b, &b_to_a, 7, 1), initial_sn, initial_sn - 1);
+    zn_session_t *b = session_make(lossy_link_make(&b_to_a, &a_to_b, 5, 1), initial_sn, initial_sn - 1);
+
+    // Give a PID to the publisher to build its statistics key
+    a->local_pid = _z_bytes_make(1);
+    ((uint8_t *)a->local_pid.val)[0] = 0x0A;
+
+    zn_subscriber_t *sub = zn_declare_subscriber(b, zn_rname("/test"), zn_subinfo_default(), data_handler, NULL);
+    assert(sub != NULL);
+
+    zn_reskey_t reskey = zn_rname("/test");
+    zn_publisher_t *pub = zn_declare_publisher(a, reskey);
+    assert(pub != NULL);
+    uint8_t *payload = (uint8_t *)malloc(LARGE_PAYLOAD);
+    memset(payload, 0, LARGE_PAYLOAD);
+    for (unsigned int i = 0; i < RUNS; i++)
+    {
+        // Every tenth message is fragmented
+        size_t len = i % 10 == 0 ? LARGE_PAYLOAD : 64;
+        memcpy(payload, &i, sizeof(unsigned int));
+        // Alternate the generic and the pre-encoded write paths
+        int res = i % 2 == 0 ? zn_write(a, reskey, payload, len) : zn_publisher_write(pub, payload, len);
+        assert(res == 0);
+
+        // Exchange the datagrams, the out of order frames trigger immediate NACKs
+        while (pump(b) + pump(a) > 0)
+            ;
+    }
+
+    // Recover the tail losses through the periodic SYNC messages
+    _zn_reliable_channel_t *rc = a->reliable_channel;
+    for (unsigned int i = 0; i < MAX_ROUNDS && (received < RUNS || rc->tx_len > 0); i++)
+    {
+        z_sleep_ms(ZN_RELIABILITY_SYNC_INTERVAL);
+        _zn_send_sync(a);
+        _zn_send_sync(b);
+        while (pump(b) + pump(a) > 0)
+            ;
+    }
+
+    printf("Received %u/%u samples, dropped %u + %u datagrams\n", received, RUNS,
+           ((lossy_link_t *)a->link)->dropped, ((lossy_link_t *)b->link)->dropped);
+    assert(((lossy_link_t *)a->link)->dropped > 0);
+    assert(received == RUNS);
+    assert(rc->tx_len == 0);
+
+    // The statistics account for the losses and their recovery
+    zn_stats_t sa = zn_session_stats(a);
+    zn_stats_t sb = zn_session_stats(b);
+    printf("Sent %zu batches (%zu fragments, %zu retransmissions), received %zu messages\n",
+           sa.tx_batches, sa.tx_fragments, sa.tx_retransmissions, sb.rx_msgs);
+    assert(sa.tx_msgs >= RUNS);
+    assert(sa.tx_fragments > 0);
+    assert(sa.tx_retransmissions > 0);
+    assert(sa.tx_dropped_errors == 0);
+    assert(sb.rx_msgs >= RUNS);
+    assert(sb.rx_fragments > 0);
+    assert(sb.rx_decode_errors == 0);
+    assert(sb.rx_dropped_oversize == 0);
+    assert(sa.tx_bytes > sb.rx_bytes);
+
+    // Lose more frames than the sender can keep, the oldest ones are given up
+    ((lossy_link_t *)a->link)->drop_every = 1;
+    for (unsigned int i = RUNS; i < RUNS + GIVEN_UP + ZN_RELIABILITY_WINDOW; i++)
+    {
+        memcpy(payload, &i, sizeof(unsigned int));
+        assert(zn_write(a, reskey, payload, 64) == 0);
+    }
+    assert(rc->tx_len == ZN_RELIABILITY_WINDOW);
+    ((lossy_link_t *)a->link)->drop_every = 0;
+
+    // The SYNC tells the receiver to skip them and recover the frames still kept
+    received += GIVEN_UP;
+    for (unsigned int i = 0; i < MAX_ROUNDS && (received < RUNS + GIVEN_UP + ZN_RELIABILITY_WINDOW || rc->tx_len > 0); i++)
+    {
+        z_sleep_ms(ZN_RELIABILITY_SYNC_INTERVAL);
+        _zn_send_sync(a);
+        while (pump(b) + pump(a) > 0)
+            ;
+    }
+    assert(received == RUNS + GIVEN_UP + ZN_RELIABILITY_WINDOW);
+    assert(rc->tx_len == 0);
+
+    // Lose more consecutive frames than the window, the receiver catches up on the next one
+    ((lossy_link_t *)a->link)->drop_every = 1;
+    unsigned int sent = RUNS + GIVEN_UP + ZN_RELIABILITY_WINDOW;
+    for (unsigned int i = sent; i < sent + GIVEN_UP + ZN_RELIABILITY_WINDOW; i++)
+    {
+        memcpy(payload, &i, sizeof(unsigned int));
+        assert(zn_write(a, reskey, payload, 64) == 0);
+    }
+    ((lossy_link_t *)a->link)->drop_every = 0;
+    sent += GIVEN_UP + ZN_RELIABILITY_WINDOW;
+    received = sent;
+    for (unsigned int i = sent; i < sent + 2; i++)
+    {
+        memcpy(payload, &i, sizeof(unsigned int));
+        assert(zn_write(a, reskey, payload, 64) == 0);
+        while (pump(b) + pump(a) > 0)
+            ;
+        assert(received == i + 1);
+    }
+    sent += 2;
+
+    // The frames still kept by the sender are not delivered again
+    for (unsigned int i = 0; i < MAX_ROUNDS && rc->tx_len > 0; i++)
+    {
+        z_sleep_ms(ZN_RELIABILITY_SYNC_INTERVAL);
+        _zn_send_sync(a);
+        while (pump(b) + pump(a) > 0)
+            ;
+    }
+    assert(received == sent);
+    assert(rc->tx_len == 0);
+
+    // The timers do not wait for a writer holding the link, they try again shortly
+    ((lossy_link_t *)a->link)->drop_every = 1;
+    memcpy(payload, &sent, sizeof(unsigned int));
+    assert(zn_write(a, reskey, payload, 64) == 0);
+    ((lossy_link_t *)a->link)->drop_every = 0;
+    sent++;
+    z_sleep_ms(ZN_RELIABILITY_SYNC_INTERVAL);
+    unsigned int written = ((lossy_link_t *)a->link)->written;
+    z_mutex_lock(&a->mutex_tx);
+    assert(_zn_sync_timer(a) == ZN_TIMER_RETRY_INTERVAL);
+    assert(_zn_keep_alive_timer(a) == ZN_KEEP_ALIVE_INTERVAL);
+    z_mutex_unlock(&a->mutex_tx);
+    assert(((lossy_link_t *)a->link)->written == written);
+    assert(_zn_sync_timer(a) == ZN_RELIABILITY_SYNC_INTERVAL);
+    assert(((lossy_link_t *)a->link)->written == written + 1);
+    for (unsigned int i = 0; i < MAX_ROUNDS && rc->tx_len > 0; i++)
+    {
+        while (pump(b) + pump(a) > 0)
+            ;
+        z_sleep_ms(ZN_RELIABILITY_SYNC_INTERVAL);
+        _zn_send_sync(a);
+    }
+    assert(received == sent);
+    assert(rc->tx_len == 0);
+
+    // A priority out of range is refused rather than indexing past the lanes
+    int res = zn_write_ext(a, reskey, payload, 64, 0, 0, zn_congestion_control_t_BLOCK, (zn_priority_t)_ZN_PRIORITIES_NUM, 0);
+    assert(res == -1);
+    (void)(res);
+    assert(zn_session_stats(a).tx_dropped_errors == 1);
+    res = zn_publisher_set_priority(pub, (zn_priority_t)_ZN_PRIORITIES_NUM);
+    assert(res == -1);
+    assert(pub->priority == ZN_PRIORITY_DEFAULT);
+
+    // Query the statistics through the admin queryable
+    zn_queryable_t *qle = zn_declare_stats_queryable(a);
+    assert(qle != NULL);
+    while (pump(b) + pump(a) > 0)
+        ;
+    zn_query(b, zn_rname("/@/pico/*/stats"), "", zn_query_target_default(), zn_query_consolidation_none(), stats_handler, NULL);
+    for (unsigned int i = 0; i < MAX_ROUNDS && stats_replies == 0; i++)
+    {
+        z_sleep_ms(ZN_RELIABILITY_SYNC_INTERVAL);
+        _zn_send_sync(a);
+        _zn_send_sync(b);
+        while (pump(b) + pump(a) > 0)
+            ;
+    }
+    assert(stats_replies == 1);
+
+    free(payload);
+    zn_undeclare_publisher(pub);
+    zn_undeclare_subscriber(sub);
+    zn_undeclare_queryable(qle);
+    pump(b);
+    pump(a);
+    free(reskey.rname);
+    _zn_session_free(b);
+    _zn_session_free(a);
+
+    return 0;
+}
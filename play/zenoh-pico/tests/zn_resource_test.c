@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2017, 2021 ADLINK Technology Inc.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License 2.0 which is available at
+ * http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+ * which is available at https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+ *
+ * Contributors:
+ *   ADLINK zenoh team, <zenoh@adlink-labs.tech>
+ */
+
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "zenoh-pico.h"
+#include "zenoh-pico/session/private/resource.h"
+#include "zenoh-pico/session/private/subscription.h"
+#include "zenoh-pico/session/private/utils.h"
+#include "zn_test_session.h"
+
+/*=============================*/
+/*           Helpers           */
+/*=============================*/
+void on_sample(const zn_sample_t *sample, const void *arg)
+{
+    (void)(sample);
+    (void)(arg);
+}
+
+_zn_resource_t *declare(zn_session_t *zn, z_zint_t id, zn_reskey_t key)
+{
+    _zn_resource_t *res = (_zn_resource_t *)malloc(sizeof(_zn_resource_t));
+    res->id = id;
+    res->key = key;
+    int r = _zn_register_resource(zn, _ZN_IS_REMOTE, res);
+    assert(r == 0);
+    return res;
+}
+
+void assert_name(zn_session_t *zn, z_zint_t id, const char *name)
+{
+    _zn_resource_t *res = _zn_get_resource_by_id(zn, _ZN_IS_REMOTE, id);
+    assert(res != NULL);
+    if (name == NULL)
+    {
+        assert(res->name.val == NULL);
+        assert(z_id_map_get(&zn->subscription_snapshot->routes, id) == NULL);
+    }
+    else
+    {
+        assert(res->name.val != NULL);
+        assert(res->name.len == strlen(name));
+        assert(strncmp(res->name.val, name, res->name.len) == 0);
+        _zn_subscription_route_t *route = (_zn_subscription_route_t *)z_id_map_get(&zn->subscription_snapshot->routes, id);
+        assert(route != NULL);
+        assert(route->len == 1);
+    }
+}
+
+/*=============================*/
+/*            Main             */
+/*=============================*/
+int main(void)
+{
+    setbuf(stdout, NULL);
+
+    zn_session_t *zn = null_session_make();
+
+    _zn_subscriber_t *sub = (_zn_subscriber_t *)malloc(sizeof(_zn_subscriber_t));
+    sub->id = 0;
+    sub->key = zn_rname("/a/**");
+    sub->info = zn_subinfo_default();
+    sub->callback = on_sample;
+    sub->arg = NULL;
+    int res = _zn_register_subscription(zn, _ZN_IS_LOCAL, sub);
+    assert(res == 0);
+
+    // The snapshot is published along with the subscription
+    _zn_subscription_snapshot_t *snap = zn->subscription_snapshot;
+    assert(snap != NULL);
+    assert(snap->len == 1);
+
+    printf(">>> Expand the names on declaration\n");
+    declare(zn, 1, zn_rname("/a"));
+    declare(zn, 2, zn_rid_with_suffix(1, "/b"));
+    declare(zn, 3, zn_rid_with_suffix(2, "/c"));
+    assert_name(zn, 1, "/a");
+    assert_name(zn, 2, "/a/b");
+    assert_name(zn, 3, "/a/b/c");
+
+    printf(">>> Expand the names of the resources declared before their base\n");
+    declare(zn, 5, zn_rid_with_suffix(4, "/e"));
+    declare(zn, 6, zn_rid_with_suffix(5, "/f"));
+    assert_name(zn, 5, NULL);
+    assert_name(zn, 6, NULL);
+    declare(zn, 4, zn_rid_with_suffix(1, "/d"));
+    assert_name(zn, 4, "/a/d");
+    assert_name(zn, 5, "/a/d/e");
+    assert_name(zn, 6, "/a/d/e/f");
+
+    printf(">>> Forget the names built on a forgotten resource\n");
+    _zn_unregister_resource(zn, _ZN_IS_REMOTE, _zn_get_resource_by_id(zn, _ZN_IS_REMOTE, 1));
+    assert(_zn_get_resource_by_id(zn, _ZN_IS_REMOTE, 1) == NULL);
+    assert_name(zn, 2, NULL);
+    assert_name(zn, 3, NULL);
+    assert_name(zn, 4, NULL);
+    assert_name(zn, 5, NULL);
+    assert_name(zn, 6, NULL);
+
+    printf(">>> Expand the names again on re-declaration\n");
+    declare(zn, 1, zn_rname("/a/x"));
+    assert_name(zn, 1, "/a/x");
+    assert_name(zn, 2, "/a/x/b");
+    assert_name(zn, 3, "/a/x/b/c");
+    assert_name(zn, 4, "/a/x/d");
+    assert_name(zn, 5, "/a/x/d/e");
+    assert_name(zn, 6, "/a/x/d/e/f");
+
+    printf(">>> Do not match the subscriptions out of the re-declared names\n");
+    _zn_unregister_resource(zn, _ZN_IS_REMOTE, _zn_get_resource_by_id(zn, _ZN_IS_REMOTE, 1));
+    declare(zn, 1, zn_rname("/z"));
+    _zn_resource_t *r = _zn_get_resource_by_id(zn, _ZN_IS_REMOTE, 6);
+    assert(r->name.len == strlen("/z/d/e/f"));
+    assert(strncmp(r->name.val, "/z/d/e/f", r->name.len) == 0);
+    assert(((_zn_subscription_route_t *)z_id_map_get(&zn->subscription_snapshot->routes, 6))->len == 0);
+
+    printf(">>> Patch the routes of the snapshot\n");
+    // The declarations of the remote resources did not drop the snapshot
+    assert(zn->subscription_snapshot == snap);
+    assert(z_id_map_len(&snap->routes) == z_id_map_len(&zn->remote_resources));
+    for (z_zint_t id = 1; id <= 6; id++)
+    {
+        _zn_subscription_route_t *route = (_zn_subscription_route_t *)z_id_map_get(&snap->routes, id);
+        assert(route != NULL);
+        assert(route->len == 0);
+    }
+    declare(zn, 7, zn_rname("/a/g"));
+    _zn_subscription_route_t *route = (_zn_subscription_route_t *)z_id_map_get(&snap->routes, 7);
+    assert(route != NULL);
+    assert(route->len == 1);
+    assert(route->subs[0]->callback == on_sample);
+    _zn_unregister_resource(zn, _ZN_IS_REMOTE, _zn_get_resource_by_id(zn, _ZN_IS_REMOTE, 1));
+    for (z_zint_t id = 1; id <= 6; id++)
+        assert(z_id_map_get(&snap->routes, id) == NULL);
+    assert(z_id_map_get(&snap->routes, 7) != NULL);
+    declare(zn, 1, zn_rname("/a"));
+    route = (_zn_subscription_route_t *)z_id_map_get(&snap->routes, 6);
+    assert(route != NULL);
+    assert(route->len == 1);
+    assert(route->name.len == strlen("/a/d/e/f"));
+    assert(zn->subscription_snapshot == snap);
+
+    printf(">>> Track the resources building on each one\n");
+    assert(z_list_len((z_list_t *)z_id_map_get(&zn->remote_resource_children, 1)) == 2);
+    _zn_unregister_resource(zn, _ZN_IS_REMOTE, _zn_get_resource_by_id(zn, _ZN_IS_REMOTE, 3));
+    assert(z_id_map_get(&zn->remote_resource_children, 2) == NULL);
+    _zn_unregister_resource(zn, _ZN_IS_REMOTE, _zn_get_resource_by_id(zn, _ZN_IS_REMOTE, 1));
+    declare(zn, 1, zn_rname("/a/y"));
+    assert_name(zn, 2, "/a/y/b");
+    assert_name(zn, 6, "/a/y/d/e/f");
+
+    _zn_session_free(zn);
+
+    return 0;
+}
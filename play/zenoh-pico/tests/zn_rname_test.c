@@ -13,9 +13,289 @@
  */
 
 #include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include "zenoh-pico/protocol/utils.h"
+#include "zenoh-pico/protocol/private/utils.h"
+#include "zenoh-pico/system/common.h"
 
-int main(void)
+#define RANDOM_RNAMES 300
+#define BENCH_RUNS 2000
+
+/*------------------ Recursive intersection, as a reference ------------------*/
+#define CEND(str) (str[0] == 0 || str[0] == '/')
+#define CWILD(str) (str[0] == '*')
+#define CNEXT(str) str + 1
+#define CEQUAL(str1, str2) str1[0] == str2[0]
+
+#define END(str) (str[0] == 0)
+#define WILD(str) (str[0] == '*' && str[1] == '*' && (str[2] == '/' || str[2] == 0))
+
+#define DEFINE_INTERSECT(name, end, wild, next, _elemintersect) \
+    int name(const char *c1, const char *c2)                    \
+    {                                                           \
+        if (end(c1) && end(c2))                                 \
+            return 1;                                           \
+        if (wild(c1) && end(c2))                                \
+            return name(next(c1), c2);                          \
+        if (end(c1) && wild(c2))                                \
+            return name(c1, next(c2));                          \
+        if (wild(c1) || wild(c2))                               \
+        {                                                       \
+            if (name(next(c1), c2))                             \
+                return 1;                                       \
+            else                                                \
+                return name(c1, next(c2));                      \
+        }                                                       \
+        if (end(c1) || end(c2))                                 \
+            return 0;                                           \
+        if (_elemintersect(c1, c2))                             \
+            return name(next(c1), next(c2));                    \
+        return 0;                                               \
+    }
+
+DEFINE_INTERSECT(ref_sub_chunk_intersect, CEND, CWILD, CNEXT, CEQUAL)
+
+int ref_chunk_intersect(const char *c1, const char *c2)
+{
+    if ((CEND(c1) && !CEND(c2)) || (!CEND(c1) && CEND(c2)))
+        return 0;
+    return ref_sub_chunk_intersect(c1, c2);
+}
+
+const char *ref_next(const char *str)
+{
+    char *res = strchr(str, '/');
+    if (res != NULL)
+        return res + 1;
+    return strchr(str, 0);
+}
+
+DEFINE_INTERSECT(ref_rname_intersect, END, WILD, ref_next, ref_chunk_intersect)
+
+const char *rnames[] = {
+    "", "/", "/a", "/a/", "/a/b", "/a/c", "/a/b/c", "/a/b/c/d/e", "/a/c/e", "/a/xb/c/xd/e",
+    "/abc", "/abcd", "/ab", "/abxxcxxcd", "/x/abc", "/x/abc*", "/x/ade", "/x/a*e", "/x/*e",
+    "/*", "/*/", "/ab*", "/ab*d", "/ab/*", "/a/*/c/*/e", "/a/*b/c/*d/e", "/x/*", "/x/a*d*e",
+    "/**", "/**/", "/ab/**", "/**/xyz", "/a/**/c/**/e", "/a/**/c/*/e/*", "/**/*", "/*/**",
+    "/a/b/xyz/d/e/f/xyz", "/a/b/b/b/c/d/d/c/d/e/f", "/**/c/**", "//", "/a//b"};
+#define RNAMES (sizeof(rnames) / sizeof(rnames[0]))
+
+/*------------------ Random resource names ------------------*/
+const char *random_chunks[] = {"", "a", "b", "ab", "*", "**", "a*", "*b", "a*b", "*a*"};
+#define RANDOM_CHUNKS (sizeof(random_chunks) / sizeof(random_chunks[0]))
+
+void random_rname(char *rname, int is_concrete)
+{
+    size_t chunks = 1 + (size_t)rand() % 5;
+    rname[0] = 0;
+    for (size_t i = 0; i < chunks; i++)
+    {
+        // The concrete resource names have no wildcard
+        size_t c = (size_t)rand() % (is_concrete ? 4 : RANDOM_CHUNKS);
+        strcat(rname, "/");
+        strcat(rname, random_chunks[c]);
+    }
+    if (rand() % 4 == 0)
+        strcat(rname, "/");
+}
+
+void test_intersect(void)
+{
+    printf("\n>> Intersection\n");
+    static char rnames_rand[RANDOM_RNAMES][64];
+    static zn_keyexpr_t crnames[RANDOM_RNAMES];
+    for (size_t i = 0; i < RANDOM_RNAMES; i++)
+    {
+        random_rname(rnames_rand[i], 0);
+        crnames[i] = zn_keyexpr_compile(rnames_rand[i]);
+    }
+
+    // The iterative intersection agrees with the recursive one
+    for (size_t i = 0; i < RNAMES; i++)
+    {
+        for (size_t j = 0; j < RNAMES; j++)
+            assert(zn_rname_intersect(rnames[i], rnames[j]) == ref_rname_intersect(rnames[i], rnames[j]));
+    }
+    for (size_t i = 0; i < RANDOM_RNAMES; i++)
+    {
+        for (size_t j = 0; j < RANDOM_RNAMES; j++)
+        {
+            int res = ref_rname_intersect(rnames_rand[i], rnames_rand[j]);
+            assert(zn_rname_intersect(rnames_rand[i], rnames_rand[j]) == res);
+            assert(zn_keyexpr_intersect(&crnames[i], &crnames[j]) == res);
+        }
+    }
+
+    // More chunks than fit on the stack
+    char deep[256] = "";
+    for (size_t i = 0; i < 40; i++)
+        strcat(deep, "/a");
+    assert(zn_rname_intersect("/**/a", deep));
+    assert(zn_rname_intersect(deep, "/a/**"));
+    assert(!zn_rname_intersect(deep, "/a/*"));
+
+    for (size_t i = 0; i < RANDOM_RNAMES; i++)
+        zn_keyexpr_free(&crnames[i]);
+}
+
+void test_includes(void)
+{
+    printf("\n>> Inclusion\n");
+    assert(zn_rname_includes("/a", "/a"));
+    assert(zn_rname_includes("/a/", "/a"));
+    assert(zn_rname_includes("/*", "/a"));
+    assert(zn_rname_includes("/*", "/a*"));
+    assert(zn_rname_includes("/*", "/*"));
+    assert(!zn_rname_includes("/a", "/*"));
+    assert(!zn_rname_includes("/a*", "/*"));
+    assert(zn_rname_includes("/a*", "/ab*"));
+    assert(zn_rname_includes("/a*b", "/a*xb"));
+    assert(!zn_rname_includes("/a*b", "/a*"));
+    assert(!zn_rname_includes("/*", "/"));
+    assert(zn_rname_includes("/**", "/"));
+    assert(zn_rname_includes("/**", "/a/b/*/**"));
+    assert(zn_rname_includes("/a/**", "/a/*/**"));
+    assert(!zn_rname_includes("/a/*", "/a/**"));
+    assert(!zn_rname_includes("/a/*/**", "/a/**"));
+    assert(zn_rname_includes("/**/c/**", "/a/b/c/d/**"));
+    assert(!zn_rname_includes("/**/c/**", "/a/b/*/d/**"));
+
+    static char rnames_rand[RANDOM_RNAMES][64];
+    static char concrete[RANDOM_RNAMES][64];
+    static zn_keyexpr_t crnames[RANDOM_RNAMES];
+    for (size_t i = 0; i < RANDOM_RNAMES; i++)
+    {
+        random_rname(rnames_rand[i], 0);
+        random_rname(concrete[i], 1);
+        crnames[i] = zn_keyexpr_compile(rnames_rand[i]);
+    }
+
+    // A resource name including another one matches all the concrete names this one does
+    size_t included = 0;
+    for (size_t i = 0; i < RANDOM_RNAMES; i++)
+    {
+        assert(zn_rname_includes(rnames_rand[i], rnames_rand[i]));
+        for (size_t j = 0; j < RANDOM_RNAMES; j++)
+        {
+            int res = zn_rname_includes(rnames_rand[i], rnames_rand[j]);
+            assert(zn_keyexpr_includes(&crnames[i], &crnames[j]) == res);
+            if (!res)
+                continue;
+
+            included++;
+            assert(zn_rname_intersect(rnames_rand[i], rnames_rand[j]));
+            for (size_t k = 0; k < RANDOM_RNAMES; k++)
+                assert(!zn_rname_intersect(rnames_rand[j], concrete[k]) || zn_rname_intersect(rnames_rand[i], concrete[k]));
+        }
+    }
+    printf("Included %zu pairs\n", included);
+
+    for (size_t i = 0; i < RANDOM_RNAMES; i++)
+        zn_keyexpr_free(&crnames[i]);
+}
+
+/*------------------ Microbenchmark, run with --bench ------------------*/
+void bench_intersect(const char *left, const char *right)
+{
+    zn_keyexpr_t cleft = zn_keyexpr_compile(left);
+    zn_keyexpr_t cright = zn_keyexpr_compile(right);
+    volatile int res = 0;
+
+    z_clock_t start = z_clock_now();
+    for (size_t i = 0; i < BENCH_RUNS; i++)
+        res += ref_rname_intersect(left, right);
+    clock_t ref = z_clock_elapsed_us(&start);
+
+    start = z_clock_now();
+    for (size_t i = 0; i < BENCH_RUNS; i++)
+        res += zn_rname_intersect(left, right);
+    clock_t iter = z_clock_elapsed_us(&start);
+
+    start = z_clock_now();
+    for (size_t i = 0; i < BENCH_RUNS; i++)
+        res += zn_keyexpr_intersect(&cleft, &cright);
+    clock_t compiled = z_clock_elapsed_us(&start);
+
+    printf("%s ~ %s: recursive %.3fus, iterative %.3fus, compiled %.3fus\n", left, right,
+           (double)ref / BENCH_RUNS, (double)iter / BENCH_RUNS, (double)compiled / BENCH_RUNS);
+
+    zn_keyexpr_free(&cleft);
+    zn_keyexpr_free(&cright);
+}
+
+void bench(void)
+{
+    printf("\n>> Microbenchmark\n");
+    bench_intersect("/demo/example/zenoh-pico/sensor/temperature", "/demo/example/zenoh-pico/sensor/temperature");
+    bench_intersect("/demo/*/zenoh-pico/**", "/demo/example/zenoh-pico/sensor/temperature");
+    bench_intersect("/a/**/b/**/c/**/d", "/a/x/x/x/x/x/x/x/x/x/x/x/x/x/x/b/x/x/x/x/x/x/c/x/x/x/x/x/x/e");
+    bench_intersect("/**/**/**/**/z", "/a/a/a/a/a/a/a/a/a/a/a/a/a/a/a/a/a");
+}
+
+void mark(void *value, void *arg)
+{
+    int *matched = (int *)arg;
+    size_t i = (uintptr_t)value - 1;
+    // Each value is visited at most once by a lookup
+    assert(matched[i] == 0);
+    matched[i] = 1;
+}
+
+void check_trie(_zn_rname_trie_t *trie, const int *indexed)
+{
+    for (size_t k = 0; k < RNAMES; k++)
+    {
+        int matched[RNAMES];
+        memset(matched, 0, sizeof(matched));
+        _zn_rname_trie_match(trie, rnames[k], mark, matched);
+
+        for (size_t i = 0; i < RNAMES; i++)
+            assert(matched[i] == (indexed[i] && zn_rname_intersect(rnames[i], rnames[k])));
+    }
+}
+
+void test_trie(void)
+{
+    _zn_rname_trie_t trie;
+    _zn_rname_trie_init(&trie);
+    int indexed[RNAMES];
+
+    // The trie matches the same resource names as the intersection
+    for (size_t i = 0; i < RNAMES; i++)
+    {
+        _zn_rname_trie_insert(&trie, rnames[i], (void *)(uintptr_t)(i + 1));
+        indexed[i] = 1;
+    }
+    assert(_zn_rname_trie_len(&trie) == RNAMES);
+    check_trie(&trie, indexed);
+
+    // Also once some resource names have been removed
+    for (size_t i = 0; i < RNAMES; i += 2)
+    {
+        assert(_zn_rname_trie_remove(&trie, rnames[i], (void *)(uintptr_t)(i + 1)) == 0);
+        assert(_zn_rname_trie_remove(&trie, rnames[i], (void *)(uintptr_t)(i + 1)) == -1);
+        indexed[i] = 0;
+    }
+    assert(_zn_rname_trie_remove(&trie, "/unknown", (void *)1) == -1);
+    check_trie(&trie, indexed);
+
+    for (size_t i = 1; i < RNAMES; i += 2)
+    {
+        assert(_zn_rname_trie_remove(&trie, rnames[i], (void *)(uintptr_t)(i + 1)) == 0);
+        indexed[i] = 0;
+    }
+    assert(_zn_rname_trie_len(&trie) == 0);
+    check_trie(&trie, indexed);
+
+    _zn_rname_trie_insert(&trie, "/a/b", (void *)1);
+    _zn_rname_trie_clear(&trie);
+    assert(_zn_rname_trie_len(&trie) == 0);
+}
+
+int main(int argc, char **argv)
 {
     assert(zn_rname_intersect("/", "/"));
     assert(zn_rname_intersect("/a", "/a"));
@@ -66,5 +346,13 @@ int main(void)
     assert(!zn_rname_intersect("/x/c*", "/x/abc*"));
     assert(!zn_rname_intersect("/x/*d", "/x/*e"));
 
+    test_intersect();
+    test_includes();
+    test_trie();
+
+    // The timings are only meaningful on an idle machine, not as part of the test suite
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0)
+        bench();
+
     return 0;
 }
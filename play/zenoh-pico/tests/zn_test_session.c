@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2017, 2021 ADLINK Technology Inc.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License 2.0 which is available at
+ * http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+ * which is available at https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+ *
+ * Contributors:
+ *   ADLINK zenoh team, <zenoh@adlink-labs.tech>
+ */
+
+#include <stdlib.h>
+#include <unistd.h>
+#include "zenoh-pico/session/private/utils.h"
+#include "zenoh-pico/transport/private/utils.h"
+#include "zn_test_session.h"
+
+/*=============================*/
+/*         Null link           */
+/*=============================*/
+void null_release(void *arg)
+{
+    (void)(arg);
+}
+
+zn_session_t *null_session_make(void)
+{
+    zn_session_t *zn = _zn_session_init();
+    zn->link = (_zn_link_t *)calloc(1, sizeof(_zn_link_t));
+    zn->link->release_f = null_release;
+    zn->locator = NULL;
+    _z_bytes_reset(&zn->local_pid);
+    _z_bytes_reset(&zn->remote_pid);
+    return zn;
+}
+
+/*=============================*/
+/*      Socket pair links      */
+/*=============================*/
+size_t pair_write(void *arg, const uint8_t *ptr, size_t len)
+{
+    _zn_link_t *l = (_zn_link_t *)arg;
+    return write(l->sock, ptr, len);
+}
+
+size_t pair_read(void *arg, uint8_t *ptr, size_t len)
+{
+    _zn_link_t *l = (_zn_link_t *)arg;
+    return read(l->sock, ptr, len);
+}
+
+void pair_release(void *arg)
+{
+    (void)(arg);
+}
+
+zn_session_t *pair_session_make(int sock, int is_streamed)
+{
+    _zn_link_t *l = (_zn_link_t *)calloc(1, sizeof(_zn_link_t));
+    l->sock = sock;
+    l->is_reliable = 1;
+    l->is_streamed = is_streamed;
+    l->mtu = ZN_BATCH_SIZE;
+    l->write_f = pair_write;
+    l->read_f = pair_read;
+    l->release_f = pair_release;
+
+    zn_session_t *zn = _zn_session_init();
+    zn->link = l;
+    zn->locator = NULL;
+    _z_bytes_reset(&zn->local_pid);
+    _z_bytes_reset(&zn->remote_pid);
+    zn->lease = 0;
+    zn->sn_resolution = ZN_SN_RESOLUTION;
+    zn->sn_resolution_half = zn->sn_resolution / 2;
+    zn->sn_tx_reliable = 0;
+    zn->sn_tx_best_effort = 0;
+    zn->sn_rx_reliable = ZN_SN_RESOLUTION - 1;
+    zn->sn_rx_best_effort = ZN_SN_RESOLUTION - 1;
+    return zn;
+}
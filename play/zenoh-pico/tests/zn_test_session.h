@@ -0,0 +1,34 @@
+/*
+ * Copyright (c) 2017, 2021 ADLINK Technology Inc.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License 2.0 which is available at
+ * http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+ * which is available at https://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+ *
+ * Contributors:
+ *   ADLINK zenoh team, <zenoh@adlink-labs.tech>
+ */
+
+#ifndef ZENOH_PICO_TESTS_SESSION_H
+#define ZENOH_PICO_TESTS_SESSION_H
+
+#include "zenoh-pico/session/types.h"
+
+/**
+ * Make a session over a link that neither sends nor receives anything.
+ */
+zn_session_t *null_session_make(void);
+
+/**
+ * Make a session over a link writing to and reading from one end of a socket pair.
+ *
+ * Parameters:
+ *     sock: The end of the socket pair, left open when the session is freed.
+ *     is_streamed: Whether the socket pair is of stream type.
+ */
+zn_session_t *pair_session_make(int sock, int is_streamed);
+
+#endif /* ZENOH_PICO_TESTS_SESSION_H */